@@ -40,6 +40,26 @@ public class Seahorse.AppSettings : GLib.Settings {
         set { set_boolean("server-auto-retrieve", value); }
     }
 
+    public uint server_search_max_results {
+        get { return get_uint("server-search-max-results"); }
+        set { set_uint("server-search-max-results", value); }
+    }
+
+    public uint server_search_quorum {
+        get { return get_uint("server-search-quorum"); }
+        set { set_uint("server-search-quorum", value); }
+    }
+
+    public uint server_search_timeout {
+        get { return get_uint("server-search-timeout"); }
+        set { set_uint("server-search-timeout", value); }
+    }
+
+    public uint server_search_deadline {
+        get { return get_uint("server-search-deadline"); }
+        set { set_uint("server-search-deadline", value); }
+    }
+
     public string server_publish_to {
         owned get { return get_string("server-publish-to"); }
         set { set_string("server-publish-to", value); }
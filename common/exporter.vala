@@ -42,6 +42,18 @@ public interface Exporter : GLib.Object {
 	[CCode (array_length_type = "size_t")]
 	public abstract async uint8[] export(GLib.Cancellable? cancellable) throws GLib.Error;
 
+	/**
+	 * Writes the exported data to output as it's produced, so it never has
+	 * to be in memory all at once. The output stream isn't closed.
+	 *
+	 * The default implementation writes out the result of export().
+	 */
+	public virtual async void export_to_stream(GLib.OutputStream output,
+	                                           GLib.Cancellable? cancellable) throws GLib.Error {
+		uint8[] bytes = yield this.export(cancellable);
+		yield output.write_all_async(bytes, GLib.Priority.DEFAULT, cancellable, null);
+	}
+
 	static GLib.File file_increment_unique(GLib.File file,
 	                                       ref uint state) {
 
@@ -73,10 +85,8 @@ public interface Exporter : GLib.Object {
 	                                 bool overwrite,
 	                                 GLib.Cancellable? cancellable) throws GLib.Error {
 
-		uint8[] bytes;
 		GLib.File outfile = file;
-
-		bytes = yield this.export(cancellable);
+		uint unique = 0;
 
 		/*
 		 * When not trying to overwrite we pass an invalid etag. This way
@@ -85,12 +95,14 @@ public interface Exporter : GLib.Object {
 		 */
 
 		while (true) {
-			uint unique = 0;
+			GLib.FileOutputStream output;
+
+			/* A new file is written in place, so it has to be cleaned up */
+			bool existed = outfile.query_exists(cancellable);
 			try {
-				yield outfile.replace_contents_async(bytes, overwrite ? null : "invalid etag",
-				                                 false, GLib.FileCreateFlags.PRIVATE,
-				                                 cancellable, null);
-				return true;
+				output = yield outfile.replace_async(overwrite ? null : "invalid etag",
+				                                     false, GLib.FileCreateFlags.PRIVATE,
+				                                     GLib.Priority.DEFAULT, cancellable);
 
 			} catch (GLib.IOError err) {
 				if (err is GLib.IOError.WRONG_ETAG) {
@@ -99,6 +111,28 @@ public interface Exporter : GLib.Object {
 				}
 				throw err;
 			}
+
+			try {
+				yield export_to_stream(output, cancellable);
+				yield output.close_async(GLib.Priority.DEFAULT, cancellable);
+			} catch (GLib.Error err) {
+				/* A cancelled close doesn't replace the original file */
+				var abort = new GLib.Cancellable();
+				abort.cancel();
+				try {
+					yield output.close_async(GLib.Priority.DEFAULT, abort);
+				} catch (GLib.Error ignored) {
+				}
+				if (!existed) {
+					try {
+						yield outfile.delete_async(GLib.Priority.DEFAULT, null);
+					} catch (GLib.Error ignored) {
+					}
+				}
+				throw err;
+			}
+
+			return true;
 		}
 	}
 }
@@ -36,6 +36,13 @@ public class Seahorse.ItemList : GLib.Object, GLib.ListModel {
     /** The filtered and sorted list store */
     private GLib.GenericArray<GLib.Object> items = new GLib.GenericArray<GLib.Object>();
 
+    /** Items that were added, but not sorted into the list yet */
+    private GLib.GenericArray<GLib.Object> pending = new GLib.GenericArray<GLib.Object>();
+    private uint pending_flush_id = 0;
+
+    /** Set while the base collection is going through a batch of changes */
+    private int batch_depth = 0;
+
     public enum ShowFilter {
         ANY,
         PERSONAL,
@@ -90,6 +97,13 @@ public class Seahorse.ItemList : GLib.Object, GLib.ListModel {
         collection.added.connect(on_collection_item_added);
         collection.removed.connect(on_collection_item_removed);
 
+        // If we can, wait until the end of a batch to sort in the new items
+        unowned var place = collection as Place;
+        if (place != null) {
+            place.batch_started.connect(on_batch_started);
+            place.batch_finished.connect(on_batch_finished);
+        }
+
         // Add the existing elements
         foreach (weak GLib.Object obj in collection.get_objects())
             this.items.add(obj);
@@ -106,25 +120,103 @@ public class Seahorse.ItemList : GLib.Object, GLib.ListModel {
         if (!item_matches_filters(object))
             return;
 
-        int index = this.items.length;
-        for (int i = 0; i < this.items.length; i++) {
-            if (compare_items(object, this.items[i]) < 0) {
-                index = i;
-                break;
-            }
-        }
-        this.items.insert(index, object);
-        items_changed(index, 0, 1);
+        // Items tend to come in bunches (e.g. while loading a keyring), so
+        // sort them in all at once. See flush_pending()
+        this.pending.add(object);
+        schedule_flush();
     }
 
     private void on_collection_item_removed(GLib.Object object) {
         uint index;
+        if (this.pending.find(object, out index)) {
+            this.pending.remove_index_fast(index);
+            return;
+        }
+
         if (this.items.find(object, out index)) {
             this.items.remove_index(index);
             items_changed(index, 1, 0);
         }
     }
 
+    private void on_batch_started(Place place) {
+        this.batch_depth++;
+    }
+
+    private void on_batch_finished(Place place) {
+        return_if_fail(this.batch_depth > 0);
+
+        this.batch_depth--;
+        if (this.batch_depth == 0)
+            flush_pending();
+    }
+
+    private void schedule_flush() {
+        // Either the end of the batch or the idle handler takes care of it
+        if (this.batch_depth > 0 || this.pending_flush_id != 0)
+            return;
+
+        // Make sure we're done before the next redraw
+        this.pending_flush_id = Idle.add(() => {
+            this.pending_flush_id = 0;
+            flush_pending();
+            return Source.REMOVE;
+        }, Priority.HIGH_IDLE);
+    }
+
+    /**
+     * Sorts the pending items into the list. We only need to sort the new
+     * items, after which we can merge them in, looking up each position
+     * with a binary search. Items that end up next to each other are
+     * announced together.
+     */
+    private void flush_pending() {
+        if (this.pending_flush_id != 0) {
+            Source.remove(this.pending_flush_id);
+            this.pending_flush_id = 0;
+        }
+
+        if (this.pending.length == 0)
+            return;
+
+        this.pending.sort(compare_items);
+
+        int start = 0;
+        int i = 0;
+        while (i < this.pending.length) {
+            int index = find_insert_position(this.pending[i], start);
+
+            // Take along the pending items which go in the same spot
+            int run = 1;
+            while (i + run < this.pending.length &&
+                   (index == this.items.length ||
+                    compare_items(this.pending[i + run], this.items[index]) < 0))
+                run++;
+
+            for (int j = 0; j < run; j++)
+                this.items.insert(index + j, this.pending[i + j]);
+            items_changed(index, 0, run);
+
+            start = index + run;
+            i += run;
+        }
+
+        this.pending.remove_range(0, this.pending.length);
+    }
+
+    // Returns the position of the first item after @start that sorts after @object
+    private int find_insert_position(GLib.Object object, int start) {
+        int low = start, high = this.items.length;
+        while (low < high) {
+            int mid = low + (high - low) / 2;
+            if (compare_items(object, this.items[mid]) < 0)
+                high = mid;
+            else
+                low = mid + 1;
+        }
+        return low;
+    }
+
     private bool item_matches_filters(GLib.Object object) {
         return matches_showfilter(object)
             && object_contains_filtered_text(object, this._filter_text);
@@ -197,6 +289,13 @@ public class Seahorse.ItemList : GLib.Object, GLib.ListModel {
      * Automatically called when you change filter_text to another value
      */
     public void refilter() {
+        // The pending items are in the base collection too
+        this.pending.remove_range(0, this.pending.length);
+        if (this.pending_flush_id != 0) {
+            Source.remove(this.pending_flush_id);
+            this.pending_flush_id = 0;
+        }
+
         // First remove all items
         var len = this.items.length;
         this.items.remove_range(0, len);
@@ -78,6 +78,21 @@ public interface Seahorse.Place : Gcr.Collection {
      */
     public abstract MenuModel? menu_model { owned get; }
 
+    /**
+     * Emitted before a batch of items is added to or removed from this
+     * Place, for example while loading. Each batch_started() is followed by
+     * a batch_finished().
+     *
+     * Listeners can use this to sort or filter once for the whole batch,
+     * rather than once for every single item.
+     */
+    public signal void batch_started();
+
+    /**
+     * Emitted after a batch of items was added or removed.
+     */
+    public signal void batch_finished();
+
     /**
      * Loads the items in this Place so they are available.
      *
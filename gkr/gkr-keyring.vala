@@ -160,6 +160,7 @@ public class Keyring : Secret.Collection, Gcr.Collection, Place, Deletable, Lock
 		if (!get_locked())
 			items = get_items();
 
+		batch_started();
 		foreach (var item in items) {
 			var object_path = item.get_object_path();
 			seen.add(object_path);
@@ -182,6 +183,7 @@ public class Keyring : Secret.Collection, Gcr.Collection, Place, Deletable, Lock
 				emit_removed (item);
 			}
 		}
+		batch_finished();
 	}
 
     public void on_action_set_default(SimpleAction action, Variant? param) {
@@ -36,6 +36,7 @@ typedef struct _TrackedPart {
     const void *progress_tag;
     char *details;
     TrackedState state;
+    double rate;
 } TrackedPart;
 
 typedef struct _TrackedTask {
@@ -437,6 +438,69 @@ seahorse_progress_update (GCancellable *cancellable,
     progress_update_display (task);
 }
 
+/**
+ * seahorse_progress_update_rate:
+ * @cancellable: The cancellable of the operation
+ * @progress_tag: The part of the operation
+ * @rate: The measured throughput, in items per second
+ *
+ * Records how fast the given part of the operation is going.
+ */
+void
+seahorse_progress_update_rate (GCancellable *cancellable,
+                               const void   *progress_tag,
+                               double        rate)
+{
+    TrackedTask *task = NULL;
+    TrackedPart *part;
+
+    if (!cancellable)
+        return;
+
+    g_return_if_fail (G_IS_CANCELLABLE (cancellable));
+    if (g_cancellable_is_cancelled (cancellable))
+        return;
+
+    if (tracked_tasks)
+        task = g_hash_table_lookup (tracked_tasks, cancellable);
+    if (task == NULL)
+        return;
+
+    part = tracked_part_find (task, find_part_progress_tag, progress_tag);
+    if (part == NULL) {
+        g_warning ("caller is trying to update rate of part of task that does not exist");
+        return;
+    }
+
+    part->rate = rate;
+}
+
+/**
+ * seahorse_progress_get_rate:
+ * @cancellable: The cancellable of the operation
+ * @progress_tag: The part of the operation
+ *
+ * Returns: The last throughput (in items per second) recorded with
+ *   seahorse_progress_update_rate(), or 0 if unknown
+ */
+double
+seahorse_progress_get_rate (GCancellable *cancellable,
+                            const void   *progress_tag)
+{
+    TrackedTask *task = NULL;
+    TrackedPart *part;
+
+    if (!cancellable || !tracked_tasks)
+        return 0.0;
+
+    task = g_hash_table_lookup (tracked_tasks, cancellable);
+    if (task == NULL)
+        return 0.0;
+
+    part = tracked_part_find (task, find_part_progress_tag, progress_tag);
+    return part ? part->rate : 0.0;
+}
+
 void
 seahorse_progress_end (GCancellable *cancellable,
                        const void   *progress_tag)
@@ -44,6 +44,13 @@ void          seahorse_progress_update          (GCancellable *cancellable,
                                                  const gchar *detail,
                                                  ...);
 
+void          seahorse_progress_update_rate     (GCancellable *cancellable,
+                                                 gconstpointer progress_tag,
+                                                 double rate);
+
+double        seahorse_progress_get_rate        (GCancellable *cancellable,
+                                                 gconstpointer progress_tag);
+
 void          seahorse_progress_end             (GCancellable *cancellable,
                                                  gconstpointer progress_tag);
 
@@ -40,11 +40,6 @@ void            seahorse_util_handle_error              (GError     **error,
                                                          const char  *description,
                                                          ...);
 
-unsigned int    seahorse_util_read_data_block           (GString      *buf,
-                                                         GInputStream *input,
-                                                         const char   *start,
-                                                         const char   *end);
-
 gboolean        seahorse_util_print_fd                  (int         fd,
                                                          const char *data);
 
@@ -70,11 +65,4 @@ gboolean    seahorse_ulong_equal   (gconstpointer v1,
 #define seahorse_util_version(a,b,c,d) ((SeahorseVersion)a << 48) + ((SeahorseVersion)b << 32) \
                                      + ((SeahorseVersion)c << 16) +  (SeahorseVersion)d
 
-#define     seahorse_util_wait_until(expr)                \
-    while (!(expr)) {                                     \
-        while (g_main_context_pending(NULL) && !(expr))   \
-            g_main_context_iteration (NULL, FALSE);       \
-        g_thread_yield ();                                \
-    }
-
 #endif /* __SEAHORSE_UTIL_H__ */
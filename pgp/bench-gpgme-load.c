@@ -0,0 +1,156 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures how long it takes to load a keyring full of secret keys, with
+ * both the two-pass (secret, then public keys) and the single-pass loader.
+ *
+ * Usage: bench-gpgme-load [MAX_KEYS]
+ */
+
+#include "seahorse-gpgme.h"
+#include "seahorse-gpgme-keyring.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <stdlib.h>
+
+static const unsigned int checkpoints[] = { 1000, 2500, 5000, 10000 };
+
+static void
+remove_recursive (const char *path)
+{
+    g_autoptr(GDir) dir = NULL;
+    const char *name;
+
+    dir = g_dir_open (path, 0, NULL);
+    while (dir && (name = g_dir_read_name (dir)) != NULL) {
+        g_autofree char *child = g_build_filename (path, name, NULL);
+        remove_recursive (child);
+    }
+    g_remove (path);
+}
+
+static void
+create_secret_keys (gpgme_ctx_t  ctx,
+                    unsigned int from,
+                    unsigned int to)
+{
+    for (unsigned int i = from; i < to; i++) {
+        g_autofree char *userid = NULL;
+        gpgme_error_t gerr;
+
+        userid = g_strdup_printf ("Bench Key %u <bench-%u@example.org>", i, i);
+        gerr = gpgme_op_createkey (ctx, userid, "ed25519", 0, 0, NULL,
+                                   GPGME_CREATE_NOPASSWD | GPGME_CREATE_FORCE);
+        if (!GPG_IS_OK (gerr))
+            g_error ("couldn't create key %u: %s", i, gpgme_strerror (gerr));
+    }
+}
+
+static void
+on_load_done (GObject      *source,
+              GAsyncResult *result,
+              void         *user_data)
+{
+    gboolean *done = user_data;
+    g_autoptr(GError) error = NULL;
+
+    seahorse_place_load_finish (SEAHORSE_PLACE (source), result, &error);
+    g_assert_no_error (error);
+    *done = TRUE;
+}
+
+/* Returns the time it took to load the keyring, in milliseconds */
+static double
+time_load (gboolean      single_pass,
+           unsigned int *n_keys)
+{
+    g_autoptr(SeahorseGpgmeKeyring) keyring = NULL;
+    gboolean done = FALSE;
+    gint64 start;
+
+    keyring = g_object_new (SEAHORSE_TYPE_GPGME_KEYRING,
+                            "single-pass", single_pass,
+                            "snapshot", FALSE,
+                            NULL);
+
+    start = g_get_monotonic_time ();
+    seahorse_place_load (SEAHORSE_PLACE (keyring), NULL, on_load_done, &done);
+    while (!done)
+        g_main_context_iteration (NULL, TRUE);
+
+    *n_keys = gcr_collection_get_length (GCR_COLLECTION (keyring));
+    return (g_get_monotonic_time () - start) / 1000.0;
+}
+
+int
+main (int argc, char **argv)
+{
+    g_autofree char *homedir = NULL;
+    g_autofree char *kill_agent = NULL;
+    g_autoptr(GError) error = NULL;
+    unsigned int max_keys = 10000;
+    unsigned int created = 0;
+    gpgme_ctx_t ctx;
+    gpgme_error_t gerr;
+
+    if (argc > 1)
+        max_keys = strtoul (argv[1], NULL, 10);
+
+    homedir = g_dir_make_tmp ("seahorse-gpgme-bench-XXXXXX.d", &error);
+    g_assert_no_error (error);
+
+    gpgme_check_version (NULL);
+    gpgme_set_engine_info (GPGME_PROTOCOL_OpenPGP, NULL, homedir);
+
+    ctx = seahorse_gpgme_keyring_new_context (&gerr);
+    if (ctx == NULL)
+        g_error ("couldn't create GPGME context: %s", gpgme_strerror (gerr));
+
+    g_print ("%8s %12s %12s\n", "keys", "two-pass", "single-pass");
+
+    for (unsigned int i = 0; i < G_N_ELEMENTS (checkpoints); i++) {
+        unsigned int target = MIN (checkpoints[i], max_keys);
+        unsigned int n_two, n_single;
+        double two_pass, single_pass;
+
+        if (target <= created)
+            break;
+
+        create_secret_keys (ctx, created, target);
+        created = target;
+
+        two_pass = time_load (FALSE, &n_two);
+        single_pass = time_load (TRUE, &n_single);
+        g_assert_cmpuint (n_two, ==, created);
+        g_assert_cmpuint (n_single, ==, created);
+
+        g_print ("%8u %9.1f ms %9.1f ms\n", created, two_pass, single_pass);
+    }
+
+    gpgme_release (ctx);
+
+    kill_agent = g_strdup_printf ("gpgconf --homedir %s --kill gpg-agent", homedir);
+    g_spawn_command_line_sync (kill_agent, NULL, NULL, NULL, NULL);
+    remove_recursive (homedir);
+
+    return 0;
+}
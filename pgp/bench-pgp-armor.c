@@ -0,0 +1,86 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures how long it takes to split a bundle of armored keys, like the
+ * ones uploaded to a keyserver, into separate keys.
+ *
+ * Usage: bench-pgp-armor [N_KEYS]
+ */
+
+#include "seahorse-pgp-armor.h"
+
+#include <stdlib.h>
+
+/* Roughly the size of an armored ed25519 key with one user ID */
+#define KEY_BODY_LINES 10
+
+static GBytes *
+create_bundle (unsigned int n_keys)
+{
+    GString *bundle = g_string_new (NULL);
+
+    for (unsigned int i = 0; i < n_keys; i++) {
+        g_string_append (bundle, "-----BEGIN PGP PUBLIC KEY BLOCK-----\n\n");
+        for (unsigned int line = 0; line < KEY_BODY_LINES; line++) {
+            g_string_append_printf (bundle, "%08X", i * KEY_BODY_LINES + line);
+            g_string_append (bundle, "mDMEX+Bl5RYJKwYBBAHaRw8BAQdA0123456789abcdefABCDEF/+\n");
+        }
+        g_string_append (bundle, "=AbCd\n-----END PGP PUBLIC KEY BLOCK-----\n");
+    }
+
+    return g_string_free_to_bytes (bundle);
+}
+
+int
+main (int argc, char **argv)
+{
+    g_autoptr(GBytes) bundle = NULL;
+    unsigned int n_keys = 100000;
+    double elapsed, mbytes;
+    gint64 start;
+
+    if (argc > 1)
+        n_keys = strtoul (argv[1], NULL, 10);
+
+    bundle = create_bundle (n_keys);
+    mbytes = g_bytes_get_size (bundle) / (1024.0 * 1024.0);
+
+    g_print ("%8s %10s %12s %12s\n", "keys", "size", "time", "throughput");
+
+    for (unsigned int round = 0; round < 3; round++) {
+        g_autoptr(GInputStream) input = NULL;
+        g_autoptr(GPtrArray) blocks = NULL;
+        g_autoptr(GError) error = NULL;
+
+        input = g_memory_input_stream_new_from_bytes (bundle);
+        start = g_get_monotonic_time ();
+        blocks = seahorse_pgp_armor_read_blocks (input, SEAHORSE_PGP_ARMOR_PUBLIC_KEY,
+                                                 NULL, &error);
+        elapsed = (g_get_monotonic_time () - start) / 1000.0;
+
+        g_assert_no_error (error);
+        g_assert_cmpuint (blocks->len, ==, n_keys);
+
+        g_print ("%8u %7.1f MB %9.1f ms %7.1f MB/s\n",
+                 n_keys, mbytes, elapsed, mbytes / (elapsed / 1000.0));
+    }
+
+    return 0;
+}
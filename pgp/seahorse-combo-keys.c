@@ -33,13 +33,18 @@ enum {
 typedef struct {
 	GHashTable *labels;
 	gboolean collision;
+	GHashTable *removed;    /* Objects still to be taken out of the model */
+	guint flush_id;
 } ComboClosure;
 
 static void
 combo_closure_free (gpointer data)
 {
 	ComboClosure *closure = data;
+	if (closure->flush_id)
+		g_source_remove (closure->flush_id);
 	g_hash_table_destroy (closure->labels);
+	g_hash_table_destroy (closure->removed);
 	g_slice_free (ComboClosure, closure);
 }
 
@@ -48,6 +53,8 @@ combo_closure_new (void)
 {
 	ComboClosure *closure = g_slice_new0 (ComboClosure);
 	closure->labels = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	closure->removed = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+	                                          g_object_unref, NULL);
 	return closure;
 }
 
@@ -150,6 +157,7 @@ on_collection_added (GcrCollection *collection,
                      GObject *obj,
                      gpointer user_data)
 {
+	ComboClosure *closure = g_object_get_data (user_data, "combo-keys-closure");
 	SeahorseObject *object = SEAHORSE_OBJECT (obj);
 	GtkComboBox *combo = GTK_COMBO_BOX (user_data);
 	GtkListStore *model;
@@ -157,6 +165,12 @@ on_collection_added (GcrCollection *collection,
 	const gchar *label;
 	gchar *markup;
 
+	/* Removed and added again before we got to it: still in the model */
+	if (g_hash_table_remove (closure->removed, object)) {
+		g_signal_connect (object, "notify::label", G_CALLBACK (on_label_changed), combo);
+		return;
+	}
+
 	model = GTK_LIST_STORE (gtk_combo_box_get_model (combo));
 
 	label = seahorse_object_get_label (object);
@@ -174,13 +188,11 @@ on_collection_added (GcrCollection *collection,
 	g_signal_connect (object, "notify::label", G_CALLBACK (on_label_changed), combo);
 }
 
-static void
-on_collection_removed (GcrCollection *collection,
-                       GObject *obj,
-                       gpointer user_data)
+/* Takes all the removed objects out of the model in a single pass */
+static gboolean
+on_flush_removed (gpointer user_data)
 {
 	ComboClosure *closure = g_object_get_data (user_data, "combo-keys-closure");
-	SeahorseObject *object = SEAHORSE_OBJECT (obj);
 	GtkComboBox *combo = GTK_COMBO_BOX (user_data);
 	GtkTreeModel *model;
 	GtkTreeIter iter;
@@ -188,26 +200,48 @@ on_collection_removed (GcrCollection *collection,
 	gpointer pntr;
 	gboolean valid;
 
+	closure->flush_id = 0;
+
 	model = gtk_combo_box_get_model (combo);
 	valid = gtk_tree_model_get_iter_first (model, &iter);
 
-	while (valid) {
+	while (valid && g_hash_table_size (closure->removed) > 0) {
 		gtk_tree_model_get (model, &iter,
 		                    COMBO_LABEL, &previous,
 		                    COMBO_POINTER, &pntr,
 		                    -1);
 
-		if (SEAHORSE_OBJECT (pntr) == object) {
+		if (pntr != NULL && g_hash_table_remove (closure->removed, pntr)) {
 			g_hash_table_remove (closure->labels, previous);
-			gtk_list_store_remove (GTK_LIST_STORE (model), &iter);
-			break;
+			valid = gtk_list_store_remove (GTK_LIST_STORE (model), &iter);
+		} else {
+			valid = gtk_tree_model_iter_next (model, &iter);
 		}
 
 		g_free (previous);
-		valid = gtk_tree_model_iter_next (model, &iter);
 	}
 
+	g_hash_table_remove_all (closure->removed);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+on_collection_removed (GcrCollection *collection,
+                       GObject *obj,
+                       gpointer user_data)
+{
+	ComboClosure *closure = g_object_get_data (user_data, "combo-keys-closure");
+	SeahorseObject *object = SEAHORSE_OBJECT (obj);
+	GtkComboBox *combo = GTK_COMBO_BOX (user_data);
+
 	g_signal_handlers_disconnect_by_func (object, on_label_changed, combo);
+
+	/* Objects tend to go away in bunches, so don't look for each one
+	 * separately, but take them all out of the model at once */
+	g_hash_table_add (closure->removed, g_object_ref (object));
+	if (closure->flush_id == 0)
+		closure->flush_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE, on_flush_removed,
+		                                     combo, NULL);
 }
 
 static void
@@ -23,7 +23,10 @@
 #include "seahorse-gpgme-data.h"
 
 #include <glib.h>
+#include <glib-unix.h>
 #include <gio/gio.h>
+#include <gio/gunixinputstream.h>
+#include <gio/gunixoutputstream.h>
 
 #include <gpgme.h>
 
@@ -32,305 +35,294 @@
 #include <stdlib.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <unistd.h>
 
-static int
-handle_gio_error (GError *err)
+/* ----------------------------------------------------------------------------------------
+ * PIPES
+ *
+ * The GIO stream is read or written in a thread, and handed to gpgme through
+ * a pipe. gpgme reads and writes that pipe with plain blocking calls, so the
+ * operation using the data has to run off the main loop too (eg: a
+ * synchronous gpgme operation in a thread). A full pipe then holds up gpgme
+ * until the stream catches up, instead of piling up data in memory. gpgme
+ * ignores SIGPIPE, so a side going away shows up as EPIPE.
+ */
+
+typedef struct {
+	int fd;                 /* Our end of the pipe, or -1 once closed */
+	gboolean input;
+	GTask *task;            /* Completes when both sides are done */
+	gboolean copied;
+	GError *error;
+} DataPipe;
+
+typedef struct {
+	GInputStream *from;
+	GOutputStream *to;
+	GOutputStreamSpliceFlags flags;
+} PipeCopy;
+
+static void
+pipe_copy_free (void *data)
 {
-	g_return_val_if_fail (err, -1);
-
-	if (err->message)
-		g_message ("%s", err->message);
-
-	switch (err->code) {
-	case G_IO_ERROR_FAILED:
-		errno = EIO;
-		break;
-	case G_IO_ERROR_NOT_FOUND:
-		errno = ENOENT;
-		break;
-	case G_IO_ERROR_EXISTS:
-		errno = EEXIST;
-		break;
-	case G_IO_ERROR_IS_DIRECTORY:
-		errno = EISDIR;
-		break;
-	case G_IO_ERROR_NOT_DIRECTORY:
-		errno = ENOTDIR;
-		break;
-	case G_IO_ERROR_NOT_EMPTY:
-		errno = ENOTEMPTY;
-		break;
-	case G_IO_ERROR_NOT_REGULAR_FILE:
-	case G_IO_ERROR_NOT_SYMBOLIC_LINK:
-	case G_IO_ERROR_NOT_MOUNTABLE_FILE:
-		errno = EBADF;
-		break;
-	case G_IO_ERROR_FILENAME_TOO_LONG:
-		errno = ENAMETOOLONG;
-		break;
-	case G_IO_ERROR_INVALID_FILENAME:
-		errno = EINVAL;
-		break;
-	case G_IO_ERROR_TOO_MANY_LINKS:
-		errno = EMLINK;
-		break;
-	case G_IO_ERROR_NO_SPACE:
-		errno = ENOSPC;
-		break;
-	case G_IO_ERROR_INVALID_ARGUMENT:
-		errno = EINVAL;
-		break;
-	case G_IO_ERROR_PERMISSION_DENIED:
-		errno = EPERM;
-		break;
-	case G_IO_ERROR_NOT_SUPPORTED:
-		errno = ENOTSUP;
-		break;
-	case G_IO_ERROR_NOT_MOUNTED:
-		errno = ENOENT;
-		break;
-	case G_IO_ERROR_ALREADY_MOUNTED:
-		errno = EALREADY;
-		break;
-	case G_IO_ERROR_CLOSED:
-		errno = EBADF;
-		break;
-	case G_IO_ERROR_CANCELLED:
-		errno = EINTR;
-		break;
-	case G_IO_ERROR_PENDING:
-		errno = EALREADY;
-		break;
-	case G_IO_ERROR_READ_ONLY:
-		errno = EACCES;
-		break;
-	case G_IO_ERROR_CANT_CREATE_BACKUP:
-		errno = EIO;
-		break;
-	case G_IO_ERROR_WRONG_ETAG:
-		errno = EACCES;
-		break;
-	case G_IO_ERROR_TIMED_OUT:
-		errno = EIO;
-		break;
-	case G_IO_ERROR_WOULD_RECURSE:
-		errno = ELOOP;
-		break;
-	case G_IO_ERROR_BUSY:
-		errno = EBUSY;
-		break;
-	case G_IO_ERROR_WOULD_BLOCK:
-		errno = EWOULDBLOCK;
-		break;
-	case G_IO_ERROR_HOST_NOT_FOUND:
-		errno = EHOSTDOWN;
-		break;
-	case G_IO_ERROR_WOULD_MERGE:
-		errno = EIO;
-		break;
-	case G_IO_ERROR_FAILED_HANDLED:
-		errno = 0;
-		break;
-	default:
-		errno = EIO;
-		break;
-	};
-
-	g_error_free (err);
-	return -1;
+	PipeCopy *copy = data;
+
+	g_object_unref (copy->from);
+	g_object_unref (copy->to);
+	g_free (copy);
 }
 
-/* ----------------------------------------------------------------------------------------
- * OUTPUT
- */
+static void
+pipe_copy_thread (GTask        *task,
+                  void         *source_object,
+                  void         *task_data,
+                  GCancellable *cancellable)
+{
+	PipeCopy *copy = task_data;
+	GError *error = NULL;
+
+	if (g_output_stream_splice (copy->to, copy->from, copy->flags,
+	                            cancellable, &error) < 0)
+		g_task_return_error (task, error);
+	else
+		g_task_return_boolean (task, TRUE);
+}
 
-/* Called by gpgme to read data */
-static ssize_t
-output_write(void *handle, const void *buffer, size_t size)
+static void
+data_pipe_maybe_complete (DataPipe *dpipe)
 {
-	GOutputStream* output = handle;
-	GError *err = NULL;
-	gsize written;
+	if (dpipe->fd >= 0 || !dpipe->copied)
+		return;
+
+	if (dpipe->error)
+		g_task_return_error (dpipe->task, g_steal_pointer (&dpipe->error));
+	else
+		g_task_return_boolean (dpipe->task, TRUE);
 
-	g_return_val_if_fail (G_IS_OUTPUT_STREAM (output), -1);
+	g_object_unref (dpipe->task);
+	g_free (dpipe);
+}
 
-	if (!g_output_stream_write_all (output, buffer, size, &written, NULL, &err))
-		return handle_gio_error (err);
+static void
+data_pipe_close (DataPipe *dpipe)
+{
+	if (dpipe->fd >= 0)
+		close (dpipe->fd);
+	dpipe->fd = -1;
+}
 
-	if (!g_output_stream_flush (output, NULL, &err))
-		return handle_gio_error (err);
+static void
+on_pipe_copied (GObject      *source,
+                GAsyncResult *result,
+                void         *user_data)
+{
+	DataPipe *dpipe = user_data;
+	GError *error = NULL;
+
+	if (!g_task_propagate_boolean (G_TASK (result), &error)) {
+		/* gpgme released the input before reading all of it, that's fine */
+		if (dpipe->input && dpipe->fd < 0 &&
+		    g_error_matches (error, G_IO_ERROR, G_IO_ERROR_BROKEN_PIPE))
+			g_clear_error (&error);
+		dpipe->error = error;
+	}
 
-	return written;
+	dpipe->copied = TRUE;
+	data_pipe_maybe_complete (dpipe);
 }
 
-/* Called from gpgme to seek a file */
-static off_t
-output_seek (void *handle, off_t offset, int whence)
+static DataPipe *
+data_pipe_new (GInputStream             *from,
+               GOutputStream            *to,
+               GOutputStreamSpliceFlags  flags,
+               int                       fd,
+               gboolean                  input,
+               GCancellable             *cancellable,
+               GAsyncReadyCallback       callback,
+               void                     *user_data)
 {
-	GSeekable *seek;
-	GSeekType from = 0;
-	GError *err = NULL;
-	GOutputStream* output = handle;
+	g_autoptr(GTask) copy_task = NULL;
+	DataPipe *dpipe;
+	PipeCopy *copy;
+
+	dpipe = g_new0 (DataPipe, 1);
+	dpipe->fd = fd;
+	dpipe->input = input;
+	dpipe->task = g_task_new (NULL, cancellable, callback, user_data);
+	g_task_set_source_tag (dpipe->task, data_pipe_new);
+
+	copy = g_new0 (PipeCopy, 1);
+	copy->from = from;
+	copy->to = to;
+	copy->flags = flags;
+
+	copy_task = g_task_new (NULL, cancellable, on_pipe_copied, dpipe);
+	g_task_set_task_data (copy_task, copy, pipe_copy_free);
+	g_task_run_in_thread (copy_task, pipe_copy_thread);
+
+	return dpipe;
+}
 
-	g_return_val_if_fail (G_IS_OUTPUT_STREAM (output), -1);
+/* Called by gpgme to write data, blocks while the pipe is full */
+static ssize_t
+pipe_write (void *handle, const void *buffer, size_t size)
+{
+	DataPipe *dpipe = handle;
+	ssize_t written;
 
-	if (!G_IS_SEEKABLE (output)) {
-		errno = EOPNOTSUPP;
-		return -1;
-	}
+	do {
+		written = write (dpipe->fd, buffer, size);
+	} while (written < 0 && errno == EINTR);
 
-	switch(whence)
-	{
-	case SEEK_SET:
-		from = G_SEEK_SET;
-		break;
-	case SEEK_CUR:
-		from = G_SEEK_CUR;
-		break;
-	case SEEK_END:
-		from = G_SEEK_END;
-		break;
-	default:
-		g_assert_not_reached();
-		break;
-	};
-
-	seek = G_SEEKABLE (output);
-	if (!g_seekable_seek (seek, offset, from, NULL, &err))
-		return handle_gio_error (err);
-
-	return offset;
+	return written;
 }
 
-/* Called by gpgme to close a file */
+/* Called by gpgme to close the data */
 static void
-output_release (void *handle)
+pipe_release (void *handle)
 {
-	GOutputStream* output = handle;
-	g_return_if_fail (G_IS_OUTPUT_STREAM (output));
+	DataPipe *dpipe = handle;
 
-	g_object_unref (output);
+	data_pipe_close (dpipe);
+	data_pipe_maybe_complete (dpipe);
 }
 
-/* GPGME vfs file operations */
-static struct gpgme_data_cbs output_cbs =
+static struct gpgme_data_cbs pipe_output_cbs =
 {
     NULL,
-    output_write,
-    output_seek,
-    output_release
+    pipe_write,
+    NULL,
+    pipe_release
 };
 
+/**
+ * seahorse_gpgme_data_output_pipe:
+ * @output: The stream to write to
+ * @cancellable: (nullable): Cancels writing to @output
+ * @callback: Called once the data was released, and all of it reached @output
+ * @user_data: Data for @callback
+ * @error: Error location, if the pipe can't be created
+ *
+ * Creates data which gpgme writes to a pipe, which is copied to @output in
+ * a thread. Writing blocks while @output is behind, so only use this from
+ * an operation which runs off the main loop. @output isn't flushed or
+ * closed. Release the data from the main loop.
+ *
+ * Returns: (transfer full) (nullable): The data. @callback isn't called
+ *   if this is %NULL.
+ */
 gpgme_data_t
-seahorse_gpgme_data_output (GOutputStream* output)
+seahorse_gpgme_data_output_pipe (GOutputStream       *output,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 void                *user_data,
+                                 GError             **error)
 {
-	gpgme_error_t gerr;
 	gpgme_data_t ret = NULL;
+	DataPipe *dpipe;
+	int fds[2];
 
 	g_return_val_if_fail (G_IS_OUTPUT_STREAM (output), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	gerr = gpgme_data_new_from_cbs (&ret, &output_cbs, output);
-	if (!GPG_IS_OK (gerr))
+	if (!g_unix_open_pipe (fds, FD_CLOEXEC, error))
 		return NULL;
 
-	g_object_ref (output);
+	dpipe = data_pipe_new (g_unix_input_stream_new (fds[0], TRUE),
+	                      g_object_ref (output),
+	                      G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE,
+	                      fds[1], FALSE, cancellable, callback, user_data);
+
+	if (!GPG_IS_OK (gpgme_data_new_from_cbs (&ret, &pipe_output_cbs, dpipe)))
+		g_error ("%s: failed to allocate gpgme_data_t", G_STRLOC);
+
 	return ret;
 }
 
-/* -------------------------------------------------------------------------------------
- * INPUT STREAMS
- */
-
-/* Called by gpgme to read data */
+/* Called by gpgme to read data, blocks until the thread catches up */
 static ssize_t
-input_read (void *handle, void *buffer, size_t size)
+pipe_read (void *handle, void *buffer, size_t size)
 {
-	GInputStream* input = handle;
-	GError *err = NULL;
-	gsize nread;
+	DataPipe *dpipe = handle;
+	ssize_t nread;
 
-	g_return_val_if_fail (G_IS_INPUT_STREAM (input), -1);
-
-	if (!g_input_stream_read_all (input, buffer, size, &nread, NULL, &err))
-		return handle_gio_error (err);
+	do {
+		nread = read (dpipe->fd, buffer, size);
+	} while (nread < 0 && errno == EINTR);
 
 	return nread;
 }
 
-/* Called from gpgme to seek a file */
-static off_t
-input_seek (void *handle, off_t offset, int whence)
-{
-	GSeekable *seek;
-	GSeekType from = 0;
-	GError *err = NULL;
-	GInputStream* input = handle;
-
-	g_return_val_if_fail (G_IS_INPUT_STREAM (input), -1);
-
-	if (!G_IS_SEEKABLE (input)) {
-		errno = EOPNOTSUPP;
-		return -1;
-	}
-
-	switch(whence)
-	{
-	case SEEK_SET:
-		from = G_SEEK_SET;
-		break;
-	case SEEK_CUR:
-		from = G_SEEK_CUR;
-		break;
-	case SEEK_END:
-		from = G_SEEK_END;
-		break;
-	default:
-		g_assert_not_reached();
-		break;
-	};
-
-	seek = G_SEEKABLE (input);
-	if (!g_seekable_seek (seek, offset, from, NULL, &err))
-		return handle_gio_error (err);
-
-	return offset;
-}
-
-/* Called by gpgme to close a file */
-static void
-input_release (void *handle)
-{
-	GInputStream* input = handle;
-	g_return_if_fail (G_IS_INPUT_STREAM (input));
-
-	g_object_unref (input);
-}
-
-/* GPGME vfs file operations */
-static struct gpgme_data_cbs input_cbs =
+static struct gpgme_data_cbs pipe_input_cbs =
 {
-    input_read,
+    pipe_read,
+    NULL,
     NULL,
-    input_seek,
-    input_release
+    pipe_release
 };
 
+/**
+ * seahorse_gpgme_data_input_pipe:
+ * @input: The stream to read from
+ * @cancellable: (nullable): Cancels reading from @input
+ * @callback: Called once the data was released, and reading @input is done
+ * @user_data: Data for @callback
+ * @error: Error location, if the pipe can't be created
+ *
+ * Creates data which gpgme reads from a pipe, which is filled from @input
+ * in a thread. Reading blocks until that thread catches up, so only use
+ * this from an operation which runs off the main loop. It's fine to
+ * release the data before all of @input was read. Release the data from
+ * the main loop.
+ *
+ * Returns: (transfer full) (nullable): The data. @callback isn't called
+ *   if this is %NULL.
+ */
 gpgme_data_t
-seahorse_gpgme_data_input (GInputStream* input)
+seahorse_gpgme_data_input_pipe (GInputStream        *input,
+                                GCancellable        *cancellable,
+                                GAsyncReadyCallback  callback,
+                                void                *user_data,
+                                GError             **error)
 {
-	gpgme_error_t gerr;
 	gpgme_data_t ret = NULL;
+	DataPipe *dpipe;
+	int fds[2];
 
 	g_return_val_if_fail (G_IS_INPUT_STREAM (input), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	gerr = gpgme_data_new_from_cbs (&ret, &input_cbs, input);
-	if (!GPG_IS_OK (gerr))
+	if (!g_unix_open_pipe (fds, FD_CLOEXEC, error))
 		return NULL;
 
-	g_object_ref (input);
+	dpipe = data_pipe_new (g_object_ref (input),
+	                      g_unix_output_stream_new (fds[1], TRUE),
+	                      G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+	                      fds[0], TRUE, cancellable, callback, user_data);
+
+	if (!GPG_IS_OK (gpgme_data_new_from_cbs (&ret, &pipe_input_cbs, dpipe)))
+		g_error ("%s: failed to allocate gpgme_data_t", G_STRLOC);
+
 	return ret;
 }
 
+/**
+ * seahorse_gpgme_data_pipe_finish:
+ * @result: The result passed to the callback
+ * @error: Error location
+ *
+ * Returns: Whether all the data was copied
+ */
+gboolean
+seahorse_gpgme_data_pipe_finish (GAsyncResult  *result,
+                                 GError       **error)
+{
+	g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+	g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == data_pipe_new, FALSE);
+
+	return g_task_propagate_boolean (G_TASK (result), error);
+}
+
 gpgme_data_t
 seahorse_gpgme_data_new ()
 {
@@ -21,6 +21,10 @@
 /**
  * A gpgme_data_t implementation which maps to a gio handle.
  * Allows for accessing data on remote machines (ie: smb, sftp)
+ *
+ * The stream is read or written in a thread, and handed to gpgme through a
+ * pipe. gpgme blocks on that pipe, so the operation using the data has to
+ * run in a thread as well, never from the main loop.
  */
 
 #pragma once
@@ -28,9 +32,20 @@
 #include <gpgme.h>
 #include <gio/gio.h>
 
-gpgme_data_t        seahorse_gpgme_data_input           (GInputStream* input);
+gpgme_data_t        seahorse_gpgme_data_input_pipe      (GInputStream        *input,
+                                                         GCancellable        *cancellable,
+                                                         GAsyncReadyCallback  callback,
+                                                         void                *user_data,
+                                                         GError             **error);
+
+gpgme_data_t        seahorse_gpgme_data_output_pipe     (GOutputStream       *output,
+                                                         GCancellable        *cancellable,
+                                                         GAsyncReadyCallback  callback,
+                                                         void                *user_data,
+                                                         GError             **error);
 
-gpgme_data_t        seahorse_gpgme_data_output          (GOutputStream* output);
+gboolean            seahorse_gpgme_data_pipe_finish     (GAsyncResult        *result,
+                                                         GError             **error);
 
 /*
  * GTK/Glib use a model where if allocation fails, the program exits. These
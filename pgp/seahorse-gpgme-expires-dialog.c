@@ -47,11 +47,20 @@ static GParamSpec *obj_props[N_PROPS] = { NULL, };
 
 G_DEFINE_TYPE (SeahorseGpgmeExpiresDialog, seahorse_gpgme_expires_dialog, GTK_TYPE_DIALOG)
 
+static void
+on_expires_changed (GObject *source, GAsyncResult *result, void *user_data)
+{
+    g_autoptr(GError) error = NULL;
+
+    if (!seahorse_gpgme_key_op_set_expires_finish (SEAHORSE_GPGME_SUBKEY (source),
+                                                   result, &error))
+        seahorse_util_handle_error (&error, NULL, _("Couldn’t change expiry date"));
+}
+
 static void
 seahorse_gpgme_expires_dialog_response (GtkDialog *dialog, int response)
 {
     SeahorseGpgmeExpiresDialog *self = SEAHORSE_GPGME_EXPIRES_DIALOG (dialog);
-    gpgme_error_t err;
     g_autoptr(GDateTime) expires = NULL;
     GDateTime *old_expires;
 
@@ -79,9 +88,9 @@ seahorse_gpgme_expires_dialog_response (GtkDialog *dialog, int response)
     if (expires == old_expires && (expires && g_date_time_equal (old_expires, expires)))
         return;
 
-    err = seahorse_gpgme_key_op_set_expires (self->subkey, expires);
-    if (!GPG_IS_OK (err))
-        seahorse_gpgme_handle_error (err, _("Couldn’t change expiry date"));
+    /* The dialog is gone by the time this finishes */
+    seahorse_gpgme_key_op_set_expires_async (self->subkey, expires, NULL,
+                                             on_expires_changed, NULL);
 }
 
 static void
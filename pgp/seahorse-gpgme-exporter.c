@@ -26,7 +26,6 @@
 #include "seahorse-gpgme-exporter.h"
 #include "seahorse-gpgme-key.h"
 #include "seahorse-gpgme-keyring.h"
-#include "seahorse-gpg-op.h"
 
 #include "libseahorse/seahorse-progress.h"
 #include "libseahorse/seahorse-util.h"
@@ -41,6 +40,7 @@ struct _SeahorseGpgmeExporter {
     GList *objects;
     gboolean armor;
     gboolean secret;
+    gboolean minimal;
 };
 
 enum {
@@ -49,7 +49,8 @@ enum {
     PROP_CONTENT_TYPE,
     PROP_FILE_FILTER,
     PROP_ARMOR,
-    PROP_SECRET
+    PROP_SECRET,
+    PROP_MINIMAL
 };
 
 static void   seahorse_gpgme_exporter_iface_init    (SeahorseExporterIface *iface);
@@ -145,6 +146,9 @@ seahorse_gpgme_exporter_get_property (GObject *object,
     case PROP_SECRET:
         g_value_set_boolean (value, self->secret);
         break;
+    case PROP_MINIMAL:
+        g_value_set_boolean (value, self->minimal);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -169,6 +173,9 @@ seahorse_gpgme_exporter_set_property (GObject *object,
     case PROP_SECRET:
         self->secret = g_value_get_boolean (value);
         break;
+    case PROP_MINIMAL:
+        self->minimal = g_value_get_boolean (value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -205,6 +212,11 @@ seahorse_gpgme_exporter_class_init (SeahorseGpgmeExporterClass *klass)
     g_object_class_install_property (gobject_class, PROP_SECRET,
                g_param_spec_boolean ("secret", "Secret", "Secret key export",
                                      FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    /* Leaves out all signatures except the latest self-signatures */
+    g_object_class_install_property (gobject_class, PROP_MINIMAL,
+               g_param_spec_boolean ("minimal", "Minimal", "Minimal key export",
+                                     FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static GList *
@@ -234,89 +246,159 @@ seahorse_gpgme_exporter_add_object (SeahorseExporter *exporter,
     return FALSE;
 }
 
+/* How many keys are exported with one gpg invocation */
+#define EXPORT_CHUNK_SIZE 1000
+
 typedef struct {
-    GPtrArray *keyids;
-    int at;
+    GPtrArray *keys;
+    gpgme_export_mode_t flags;
     gpgme_data_t data;
     gpgme_ctx_t gctx;
-    GMemoryOutputStream *output;
+    gpgme_error_t gerr;
+    GOutputStream *output;
+    GCancellable *cancellable;
 } GpgmeExportClosure;
 
 static void
 gpgme_export_closure_free (gpointer data)
 {
     GpgmeExportClosure *closure = data;
-    gpgme_data_release (closure->data);
-    g_clear_pointer (&closure->gctx, gpgme_release);
-    g_ptr_array_free (closure->keyids, TRUE);
+    g_clear_pointer (&closure->gctx, seahorse_gpgme_keyring_release_context);
+    g_clear_object (&closure->output);
+    g_clear_object (&closure->cancellable);
+    g_ptr_array_free (closure->keys, TRUE);
     g_free (closure);
 }
 
-
-static gboolean
-on_keyring_export_complete (gpgme_error_t gerr,
-                            gpointer user_data)
+/* The task completes here, once everything gpgme wrote reached the output */
+static void
+on_keyring_export_written (GObject      *source,
+                           GAsyncResult *result,
+                           gpointer      user_data)
 {
-    GTask *task = G_TASK (user_data);
-    SeahorseGpgmeExporter *self = g_task_get_source_object (task);
+    g_autoptr(GTask) task = G_TASK (user_data);
     GpgmeExportClosure *closure = g_task_get_task_data (task);
     g_autoptr(GError) error = NULL;
-    guint flags = 0;
 
-    if (seahorse_gpgme_propagate_error (gerr, &error)) {
+    if (seahorse_gpgme_propagate_error (closure->gerr, &error) ||
+        !seahorse_gpgme_data_pipe_finish (result, &error)) {
         g_task_return_error (task, g_steal_pointer (&error));
-        return FALSE; /* don't call again */
+        return;
     }
 
-    if (closure->at >= 0)
-        seahorse_progress_end (g_task_get_cancellable (task),
-                               closure->keyids->pdata[closure->at]);
+    g_task_return_boolean (task, TRUE);
+}
 
-    g_assert (closure->at < (int) closure->keyids->len);
-    closure->at++;
+typedef struct {
+    GCancellable *cancellable;
+    void *tag;
+    gboolean begin;
+} ExportProgress;
 
-    if (closure->at == (int) closure->keyids->len) {
-        g_task_return_pointer (task, g_steal_pointer (&closure->output), g_object_unref);
-        return FALSE; /* don't run this again */
-    }
+static void
+export_progress_free (void *data)
+{
+    ExportProgress *progress = data;
+    g_clear_object (&progress->cancellable);
+    g_free (progress);
+}
 
-    /* Do the next key in the list */
-    if (self->secret)
-        flags |= GPGME_EXPORT_MODE_SECRET;
-    gerr = gpgme_op_export_start (closure->gctx, closure->keyids->pdata[closure->at],
-                                  flags, closure->data);
+static gboolean
+on_export_progress (void *user_data)
+{
+    ExportProgress *progress = user_data;
 
-    if (seahorse_gpgme_propagate_error (gerr, &error)) {
-        g_task_return_error (task, g_steal_pointer (&error));
-        return FALSE; /* don't run this again */
+    if (progress->begin)
+        seahorse_progress_begin (progress->cancellable, progress->tag);
+    else
+        seahorse_progress_end (progress->cancellable, progress->tag);
+    return G_SOURCE_REMOVE;
+}
+
+/* Progress is tracked from the main loop */
+static void
+export_report_progress (GpgmeExportClosure *closure,
+                        unsigned int        at,
+                        gboolean            begin)
+{
+    ExportProgress *progress;
+
+    progress = g_new0 (ExportProgress, 1);
+    progress->cancellable = closure->cancellable ? g_object_ref (closure->cancellable) : NULL;
+    progress->tag = &closure->keys->pdata[at];
+    progress->begin = begin;
+    g_main_context_invoke_full (NULL, G_PRIORITY_DEFAULT, on_export_progress,
+                                progress, export_progress_free);
+}
+
+/* Exports the keys a chunk at a time, each of which blocks on the pipe */
+static void
+export_keys_thread (GTask        *task,
+                    void         *source_object,
+                    void         *task_data,
+                    GCancellable *unused)
+{
+    GpgmeExportClosure *closure = task_data;
+
+    for (unsigned int at = 0; at < closure->keys->len; at += EXPORT_CHUNK_SIZE) {
+        unsigned int chunk_len = MIN (EXPORT_CHUNK_SIZE, closure->keys->len - at);
+        g_autofree gpgme_key_t *chunk = NULL;
+
+        if (g_cancellable_is_cancelled (closure->cancellable)) {
+            closure->gerr = GPG_E (GPG_ERR_CANCELED);
+            break;
+        }
+
+        /* Each chunk of keys uses its first slot as the progress tag */
+        chunk = g_new0 (gpgme_key_t, chunk_len + 1);
+        memcpy (chunk, &closure->keys->pdata[at], chunk_len * sizeof (gpgme_key_t));
+
+        export_report_progress (closure, at, TRUE);
+        closure->gerr = gpgme_op_export_keys (closure->gctx, chunk,
+                                              closure->flags, closure->data);
+        export_report_progress (closure, at, FALSE);
+
+        if (!GPG_IS_OK (closure->gerr))
+            break;
     }
 
-    seahorse_progress_begin (g_task_get_cancellable (task),
-                             closure->keyids->pdata[closure->at]);
-    return TRUE; /* call this source again */
+    g_task_return_boolean (task, TRUE);
 }
 
 static void
-seahorse_gpgme_exporter_export_async (SeahorseExporter *exporter,
-                                      GCancellable *cancellable,
-                                      GAsyncReadyCallback callback,
-                                      gpointer user_data)
+on_keyring_export_complete (GObject      *source,
+                            GAsyncResult *result,
+                            gpointer      user_data)
+{
+    g_autoptr(GTask) task = G_TASK (user_data);
+    GpgmeExportClosure *closure = g_task_get_task_data (task);
+
+    /* Carries on in on_keyring_export_written() */
+    g_clear_pointer (&closure->data, gpgme_data_release);
+}
+
+static void
+seahorse_gpgme_exporter_export_to_stream_async (SeahorseExporter *exporter,
+                                                GOutputStream *output,
+                                                GCancellable *cancellable,
+                                                GAsyncReadyCallback callback,
+                                                gpointer user_data)
 {
     SeahorseGpgmeExporter *self = SEAHORSE_GPGME_EXPORTER (exporter);
     g_autoptr(GTask) task = NULL;
+    g_autoptr(GTask) export_task = NULL;
     GpgmeExportClosure *closure;
     g_autoptr(GError) error = NULL;
     gpgme_error_t gerr = 0;
-    g_autoptr(GSource) gsource = NULL;
     GList *l;
 
     task = g_task_new (exporter, cancellable, callback, user_data);
+    g_task_set_source_tag (task, seahorse_gpgme_exporter_export_to_stream_async);
     closure = g_new0 (GpgmeExportClosure, 1);
-    closure->gctx = seahorse_gpgme_keyring_new_context (&gerr);
-    closure->output = G_MEMORY_OUTPUT_STREAM (g_memory_output_stream_new (NULL, 0, g_realloc, g_free));
-    closure->data = seahorse_gpgme_data_output (G_OUTPUT_STREAM (closure->output));
-    closure->keyids = g_ptr_array_new_with_free_func (g_free);
-    closure->at = -1;
+    closure->gctx = seahorse_gpgme_keyring_acquire_context ("export", &gerr);
+    closure->output = g_object_ref (output);
+    closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+    closure->keys = g_ptr_array_new_with_free_func ((GDestroyNotify) gpgme_key_unref);
     g_task_set_task_data (task, closure, gpgme_export_closure_free);
 
     if (seahorse_gpgme_propagate_error (gerr, &error)) {
@@ -324,26 +406,92 @@ seahorse_gpgme_exporter_export_async (SeahorseExporter *exporter,
         return;
     }
 
+    closure->data = seahorse_gpgme_data_output_pipe (closure->output,
+                                                     cancellable,
+                                                     on_keyring_export_written,
+                                                     g_object_ref (task),
+                                                     &error);
+    if (closure->data == NULL) {
+        g_task_return_error (task, g_steal_pointer (&error));
+        g_object_unref (task); /* for the callback */
+        return;
+    }
+
     gpgme_set_armor (closure->gctx, self->armor);
+    if (self->secret)
+        closure->flags |= GPGME_EXPORT_MODE_SECRET;
+    if (self->minimal)
+        closure->flags |= GPGME_EXPORT_MODE_MINIMAL;
 
     /* Building list */
     for (l = self->objects; l != NULL; l = g_list_next (l)) {
-        SeahorsePgpKey *key;
-        gchar *keyid;
+        SeahorseGpgmeKey *key = SEAHORSE_GPGME_KEY (l->data);
+        gpgme_key_t gkey;
+
+        gkey = seahorse_gpgme_key_get_public (key);
+        if (gkey == NULL)
+            gkey = seahorse_gpgme_key_get_private (key);
+        if (gkey == NULL)
+            continue;
 
-        key = SEAHORSE_PGP_KEY (l->data);
-        keyid = g_strdup (seahorse_pgp_key_get_keyid (key));
-        seahorse_progress_prep (cancellable, keyid, NULL);
-        g_ptr_array_add (closure->keyids, keyid);
+        gpgme_key_ref (gkey);
+        g_ptr_array_add (closure->keys, gkey);
     }
 
-    gsource = seahorse_gpgme_gsource_new (closure->gctx, cancellable);
-    g_source_set_callback (gsource, (GSourceFunc)on_keyring_export_complete,
-                           g_object_ref (task), g_object_unref);
+    for (guint i = 0; i < closure->keys->len; i += EXPORT_CHUNK_SIZE)
+        seahorse_progress_prep (cancellable, &closure->keys->pdata[i], NULL);
+
+    /* A cancelled copy breaks the pipe, which fails the export */
+    export_task = g_task_new (self, NULL, on_keyring_export_complete, g_object_ref (task));
+    g_task_set_task_data (export_task, closure, NULL);
+    g_task_run_in_thread (export_task, export_keys_thread);
+}
+
+static void
+seahorse_gpgme_exporter_export_to_stream_finish (SeahorseExporter *exporter,
+                                                 GAsyncResult *result,
+                                                 GError **error)
+{
+    g_return_if_fail (g_task_is_valid (result, exporter));
+    g_return_if_fail (g_task_get_source_tag (G_TASK (result)) ==
+                      seahorse_gpgme_exporter_export_to_stream_async);
+
+    g_task_propagate_boolean (G_TASK (result), error);
+}
+
+static void
+on_export_to_memory_complete (GObject      *source,
+                              GAsyncResult *result,
+                              gpointer      user_data)
+{
+    g_autoptr(GTask) task = G_TASK (user_data);
+    GOutputStream *output = g_task_get_task_data (task);
+    GError *error = NULL;
+
+    seahorse_gpgme_exporter_export_to_stream_finish (SEAHORSE_EXPORTER (source),
+                                                     result, &error);
+    if (error != NULL)
+        g_task_return_error (task, error);
+    else
+        g_task_return_pointer (task, g_object_ref (output), g_object_unref);
+}
+
+static void
+seahorse_gpgme_exporter_export_async (SeahorseExporter *exporter,
+                                      GCancellable *cancellable,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data)
+{
+    g_autoptr(GTask) task = NULL;
+    GOutputStream *output;
+
+    task = g_task_new (exporter, cancellable, callback, user_data);
+    output = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
+    g_task_set_task_data (task, output, g_object_unref);
 
-    /* Get things started */
-    if (on_keyring_export_complete (0, task))
-        g_source_attach (gsource, g_main_context_default ());
+    seahorse_gpgme_exporter_export_to_stream_async (exporter, output, cancellable,
+                                                    on_export_to_memory_complete,
+                                                    g_steal_pointer (&task));
 }
 
 static guchar *
@@ -371,6 +519,8 @@ seahorse_gpgme_exporter_iface_init (SeahorseExporterIface *iface)
     iface->add_object = seahorse_gpgme_exporter_add_object;
     iface->export = seahorse_gpgme_exporter_export_async;
     iface->export_finish = seahorse_gpgme_exporter_export_finish;
+    iface->export_to_stream = seahorse_gpgme_exporter_export_to_stream_async;
+    iface->export_to_stream_finish = seahorse_gpgme_exporter_export_to_stream_finish;
     iface->get_objects = seahorse_gpgme_exporter_get_objects;
     iface->get_filename = seahorse_gpgme_exporter_get_filename;
     iface->get_content_type = seahorse_gpgme_exporter_get_content_type;
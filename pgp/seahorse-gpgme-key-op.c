@@ -26,7 +26,8 @@
 
 #include "seahorse-gpgme.h"
 #include "seahorse-gpgme-data.h"
-#include "seahorse-gpg-op.h"
+#include "seahorse-pgp-backend.h"
+#include "seahorse-pgp-packet.h"
 
 #include "libseahorse/seahorse-progress.h"
 #include "libseahorse/seahorse-util.h"
@@ -176,11 +177,11 @@ seahorse_gpgme_key_op_generate_async (SeahorseGpgmeKeyring *keyring,
     else
         parms = g_strdup_printf ("%s%d\n%s", start, length, common);
 
-    gctx = seahorse_gpgme_keyring_new_context (&gerr);
+    gctx = seahorse_gpgme_keyring_acquire_context ("generate", &gerr);
 
     task = g_task_new (keyring, cancellable, callback, user_data);
     gpgme_set_progress_cb (gctx, on_key_op_progress, task);
-    g_task_set_task_data (task, gctx, (GDestroyNotify) gpgme_release);
+    g_task_set_task_data (task, gctx, (GDestroyNotify) seahorse_gpgme_keyring_release_context);
 
     seahorse_progress_prep_and_begin (cancellable, task, NULL);
     gsource = seahorse_gpgme_gsource_new (gctx, cancellable);
@@ -220,19 +221,21 @@ op_delete (SeahorseGpgmeKey *pkey, gboolean secret)
     keyring = SEAHORSE_GPGME_KEYRING (seahorse_object_get_place (SEAHORSE_OBJECT (pkey)));
     g_return_val_if_fail (SEAHORSE_IS_GPGME_KEYRING (keyring), GPG_E (GPG_ERR_INV_KEYRING));
 
-    g_object_ref (pkey);
-
-    seahorse_util_wait_until ((key = seahorse_gpgme_key_get_public (pkey)) != NULL);
+    key = seahorse_gpgme_key_get_public (pkey);
+    if (key == NULL)
+        return GPG_E (GPG_ERR_NO_PUBKEY);
 
-    ctx = seahorse_gpgme_keyring_new_context (&gerr);
+    ctx = seahorse_gpgme_keyring_acquire_context ("delete", &gerr);
     if (ctx == NULL)
         return gerr;
 
+    g_object_ref (pkey);
+
     gerr = gpgme_op_delete (ctx, key, secret);
     if (GPG_IS_OK (gerr))
         seahorse_gpgme_keyring_remove_key (keyring, SEAHORSE_GPGME_KEY (pkey));
 
-    gpgme_release (ctx);
+    seahorse_gpgme_keyring_release_context (ctx);
     g_object_unref (pkey);
     return gerr;
 }
@@ -331,79 +334,186 @@ seahorse_gpgme_key_op_interact (void       *data,
     return parms->err;
 }
 
-/* Common edit operation */
-static gpgme_error_t
-edit_gpgme_key (gpgme_ctx_t       ctx,
-                gpgme_key_t       key,
-                SeahorseEditParm *parms)
-{
-    gboolean own_context = FALSE;
-    gpgme_data_t out;
-    gpgme_error_t gerr;
+typedef enum {
+    EDIT_REFRESH = 1 << 0,      /* Refresh the key once the edit is done */
+    EDIT_PROGRESS = 1 << 1,     /* Report progress on the cancellable */
+} EditFlags;
 
-    g_assert (key);
-    g_assert (parms);
+/* Starts one of GPGME's quick key editing calls */
+typedef gpgme_error_t (*QuickStartFunc) (gpgme_ctx_t  ctx,
+                                         gpgme_key_t  key,
+                                         void        *data);
 
-    gpgme_key_ref (key);
+/*
+ * A change to a key: either an edit state machine that drives
+ * gpg --edit-key, or a direct call for gpg versions that have one.
+ */
+typedef struct {
+    SeahorseEditParm *parms;
+    QuickStartFunc quick;
+    void *data;
+    GDestroyNotify free_data;
+} KeyOp;
 
-    if (ctx == NULL) {
-        ctx = seahorse_gpgme_keyring_new_context (&gerr);
-        if (ctx == NULL)
-            return gerr;
-        own_context = TRUE;
-    }
+typedef struct {
+    gpgme_ctx_t ctx;
+    gpgme_key_t key;
+    gpgme_data_t out;
+    SeahorseEditParm *parms;
+    void *data;
+    GDestroyNotify free_data;
+    EditFlags flags;
+} EditClosure;
+
+static void
+edit_closure_free (void *data)
+{
+    EditClosure *closure = data;
+
+    seahorse_gpgme_keyring_release_context (closure->ctx);
+    if (closure->out)
+        seahorse_gpgme_data_release (closure->out);
+    gpgme_key_unref (closure->key);
+    if (closure->free_data)
+        closure->free_data (closure->data);
+    g_free (closure->parms);
+    g_free (closure);
+}
 
-    out = seahorse_gpgme_data_new ();
+static gboolean
+on_edit_key_complete (gpgme_error_t gerr,
+                      void         *user_data)
+{
+    GTask *task = G_TASK (user_data);
+    EditClosure *closure = g_task_get_task_data (task);
+    g_autoptr(GError) error = NULL;
 
-    /* do edit callback, release data */
-    gerr = gpgme_op_interact (ctx, key, 0, seahorse_gpgme_key_op_interact, parms, out);
+    if (closure->flags & EDIT_PROGRESS)
+        seahorse_progress_end (g_task_get_cancellable (task), task);
+
+    if (GPG_IS_OK (gerr) && closure->parms)
+        gerr = closure->parms->err;
 
     if (gpgme_err_code (gerr) == GPG_ERR_BAD_PASSPHRASE) {
-        seahorse_util_show_error(NULL, _("Wrong password"), _("This was the third time you entered a wrong password. Please try again."));
+        g_task_return_new_error (task, SEAHORSE_GPGME_ERROR, GPG_ERR_BAD_PASSPHRASE,
+                                 _("This was the third time you entered a wrong password. Please try again."));
+        return FALSE; /* don't call again */
     }
 
-    seahorse_gpgme_data_release (out);
-    if (own_context)
-        gpgme_release (ctx);
-    gpgme_key_unref (key);
-    return gerr;
+    if (seahorse_gpgme_propagate_error (gerr, &error)) {
+        g_task_return_error (task, g_steal_pointer (&error));
+        return FALSE; /* don't call again */
+    }
+
+    if (closure->flags & EDIT_REFRESH)
+        seahorse_gpgme_key_refresh_matching (closure->key);
+    g_task_return_boolean (task, TRUE);
+    return FALSE; /* don't call again */
 }
 
-static gpgme_error_t
-edit_refresh_gpgme_key (gpgme_ctx_t ctx, gpgme_key_t key, SeahorseEditParm *parms)
+/*
+ * Runs @op on @key from the main loop. Takes ownership of what's in @op.
+ * If @signer is set, it's used for signing.
+ */
+static void
+key_op_start (void               *source_object,
+              gpgme_key_t         key,
+              gpgme_key_t         signer,
+              KeyOp              *op,
+              EditFlags           flags,
+              GCancellable       *cancellable,
+              GAsyncReadyCallback callback,
+              void               *user_data)
 {
+    g_autoptr(GTask) task = NULL;
+    g_autoptr(GSource) gsource = NULL;
+    g_autoptr(GError) error = NULL;
+    EditClosure *closure;
     gpgme_error_t gerr;
 
-    gerr = edit_gpgme_key (ctx, key, parms);
-    if (GPG_IS_OK (gerr))
-        seahorse_gpgme_key_refresh_matching (key);
+    task = g_task_new (source_object, cancellable, callback, user_data);
+    g_task_set_source_tag (task, key_op_start);
 
-    return gerr;
-}
+    closure = g_new0 (EditClosure, 1);
+    closure->key = key;
+    gpgme_key_ref (key);
+    closure->parms = op->parms;
+    closure->data = op->data;
+    closure->free_data = op->free_data;
+    closure->flags = flags;
+    closure->ctx = seahorse_gpgme_keyring_acquire_context ("edit", &gerr);
+    g_task_set_task_data (task, closure, edit_closure_free);
+
+    if (GPG_IS_OK (gerr) && signer != NULL)
+        gerr = gpgme_signers_add (closure->ctx, signer);
+
+    if (GPG_IS_OK (gerr)) {
+        gsource = seahorse_gpgme_gsource_new (closure->ctx, cancellable);
+        g_source_set_callback (gsource, G_SOURCE_FUNC (on_edit_key_complete),
+                               g_object_ref (task), g_object_unref);
+        if (op->parms) {
+            closure->out = seahorse_gpgme_data_new ();
+            gerr = gpgme_op_interact_start (closure->ctx, key, 0,
+                                            seahorse_gpgme_key_op_interact,
+                                            op->parms, closure->out);
+        } else {
+            gerr = op->quick (closure->ctx, key, op->data);
+        }
+    }
 
-static gpgme_error_t
-edit_key (SeahorseGpgmeKey *pkey, SeahorseEditParm *parms)
-{
-    SeahorseGpgmeKeyring *keyring;
-    gpgme_error_t gerr;
-    gpgme_key_t key;
-    gpgme_ctx_t ctx;
+    if (seahorse_gpgme_propagate_error (gerr, &error)) {
+        g_task_return_error (task, g_steal_pointer (&error));
+        return;
+    }
 
-    keyring = SEAHORSE_GPGME_KEYRING (seahorse_object_get_place (SEAHORSE_OBJECT (pkey)));
-    g_return_val_if_fail (SEAHORSE_IS_GPGME_KEYRING (keyring), GPG_E (GPG_ERR_INV_KEYRING));
+    if (flags & EDIT_PROGRESS)
+        seahorse_progress_prep_and_begin (cancellable, task, NULL);
+    g_source_attach (gsource, g_main_context_default ());
+}
 
-    g_object_ref (pkey);
+/* Like key_op_start(), refreshing the key once it's done */
+static void
+key_op_async (void               *source_object,
+              gpgme_key_t         key,
+              gpgme_key_t         signer,
+              KeyOp              *op,
+              GCancellable       *cancellable,
+              GAsyncReadyCallback callback,
+              void               *user_data)
+{
+    key_op_start (source_object, key, signer, op, EDIT_REFRESH | EDIT_PROGRESS,
+                  cancellable, callback, user_data);
+}
 
-    seahorse_util_wait_until ((key = seahorse_gpgme_key_get_public (pkey)) != NULL);
+/*
+ * Runs the edit state machine in @parms on @key from the main loop, and
+ * refreshes the key once it's done. Takes ownership of @parms, and of its
+ * data if @free_data is set. If @signer is set, it's used for signing.
+ */
+static void
+edit_key_async (void               *source_object,
+                gpgme_key_t         key,
+                gpgme_key_t         signer,
+                SeahorseEditParm   *parms,
+                GDestroyNotify      free_data,
+                GCancellable       *cancellable,
+                GAsyncReadyCallback callback,
+                void               *user_data)
+{
+    KeyOp op = { parms, NULL, parms->data, free_data };
+
+    key_op_async (source_object, key, signer, &op, cancellable, callback, user_data);
+}
 
-    ctx = seahorse_gpgme_keyring_new_context (&gerr);
-    if (ctx != NULL) {
-        gerr = edit_refresh_gpgme_key (ctx, key, parms);
-        gpgme_release (ctx);
-    }
+static gboolean
+edit_key_finish (void          *source_object,
+                 GAsyncResult  *result,
+                 GError       **error)
+{
+    g_return_val_if_fail (g_task_is_valid (result, source_object), FALSE);
+    g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == key_op_start, FALSE);
 
-    g_object_unref (pkey);
-    return gerr;
+    return g_task_propagate_boolean (G_TASK (result), error);
 }
 
 typedef struct
@@ -575,88 +685,218 @@ sign_transit (unsigned int   current_state,
     return next_state;
 }
 
-static gpgme_error_t
-sign_process (gpgme_key_t         signed_key,
-              gpgme_key_t         signing_key,
-              unsigned int        sign_index,
-              SeahorseSignCheck   check,
-              SeahorseSignOptions options)
+static void
+sign_parm_free (void *data)
 {
-    SeahorseEditParm *parms;
-    SignParm sign_parm;
-    gpgme_ctx_t ctx;
-    gpgme_error_t gerr;
+    SignParm *parm = data;
 
-    ctx = seahorse_gpgme_keyring_new_context (&gerr);
-    if (ctx == NULL)
-        return gerr;
+    g_free (parm->command);
+    g_free (parm);
+}
 
-    gerr = gpgme_signers_add (ctx, signing_key);
-    if (!GPG_IS_OK (gerr))
-        return gerr;
+/* gpg --quick-sign-key, which can't do certification levels or
+ * non-revocable signatures. It also silently does nothing for a key that's
+ * already signed, so we need the signatures to check that first. */
+static gboolean
+can_quick_sign (gpgme_key_t         signed_key,
+                SeahorseSignCheck   check,
+                SeahorseSignOptions options)
+{
+    return (signed_key->keylist_mode & GPGME_KEYLIST_MODE_SIGS) &&
+           check == SIGN_CHECK_NO_ANSWER &&
+           !(options & SIGN_NO_REVOKE) &&
+           seahorse_gpgme_get_engine_version () >= seahorse_util_version (2, 1, 12, 0);
+}
+
+typedef struct {
+    char *userid;               /* NULL for all user IDs */
+    char *signer_keyid;
+    unsigned long expires;      /* In seconds from now */
+    unsigned int flags;
+} QuickSignData;
+
+static void
+quick_sign_data_free (void *data)
+{
+    QuickSignData *sign = data;
+
+    g_free (sign->userid);
+    g_free (sign->signer_keyid);
+    g_free (sign);
+}
 
-    sign_parm.index = sign_index;
-    sign_parm.expire = ((options & SIGN_EXPIRES) != 0);
-    sign_parm.check = check;
-    sign_parm.command = g_strdup_printf ("%s%ssign",
-                                         (options & SIGN_NO_REVOKE) ? "nr" : "",
-                                         (options & SIGN_LOCAL) ? "l" : "");
+/* The edit machine notices an existing signature, gpg --quick-sign-key
+ * just silently does nothing. So check ourselves, see can_quick_sign(). */
+static gboolean
+is_already_signed (gpgme_key_t   key,
+                   QuickSignData *sign)
+{
+    g_return_val_if_fail (key->keylist_mode & GPGME_KEYLIST_MODE_SIGS, FALSE);
 
-    parms = seahorse_edit_parm_new (SIGN_START, sign_action, sign_transit, &sign_parm);
+    for (gpgme_user_id_t uid = key->uids; uid; uid = uid->next) {
+        gboolean found = FALSE;
 
-    gerr =  edit_refresh_gpgme_key (ctx, signed_key, parms);
-    g_free (sign_parm.command);
-    g_free (parms);
+        if (uid->revoked || (sign->userid && !g_str_equal (uid->uid, sign->userid)))
+            continue;
 
-    gpgme_release (ctx);
+        for (gpgme_key_sig_t sig = uid->signatures; sig && !found; sig = sig->next)
+            found = !sig->revoked && g_str_equal (sig->keyid, sign->signer_keyid);
+        if (!found)
+            return FALSE;
+    }
 
-    return gerr;
+    return TRUE;
 }
 
-gpgme_error_t
-seahorse_gpgme_key_op_sign_uid (SeahorseGpgmeUid    *uid,
-                                SeahorseGpgmeKey    *signer,
-                                SeahorseSignCheck    check,
-                                SeahorseSignOptions  options)
+static gpgme_error_t
+quick_sign_start (gpgme_ctx_t  ctx,
+                  gpgme_key_t  key,
+                  void        *data)
+{
+    QuickSignData *sign = data;
+
+    if (is_already_signed (key, sign))
+        return GPG_E (GPG_ERR_EALREADY);
+
+    return gpgme_op_keysign_start (ctx, key, sign->userid, sign->expires, sign->flags);
+}
+
+static void
+sign_key_op (KeyOp               *op,
+             gpgme_key_t          signed_key,
+             gpgme_key_t          signing_key,
+             unsigned int         sign_index,
+             const char          *userid,
+             SeahorseSignCheck    check,
+             SeahorseSignOptions  options)
+{
+    SignParm *sign_parm;
+
+    if (can_quick_sign (signed_key, check, options)) {
+        QuickSignData *sign = g_new0 (QuickSignData, 1);
+        gint64 now = g_get_real_time () / G_USEC_PER_SEC;
+
+        sign->userid = g_strdup (userid);
+        sign->signer_keyid = g_strdup (signing_key->subkeys->keyid);
+        if (options & SIGN_LOCAL)
+            sign->flags |= GPGME_KEYSIGN_LOCAL;
+
+        /* Either expire along with the key, or not at all */
+        if ((options & SIGN_EXPIRES) && signed_key->subkeys->expires > now)
+            sign->expires = signed_key->subkeys->expires - now;
+        else
+            sign->flags |= GPGME_KEYSIGN_NOEXPIRE;
+
+        op->quick = quick_sign_start;
+        op->data = sign;
+        op->free_data = quick_sign_data_free;
+        return;
+    }
+
+    sign_parm = g_new0 (SignParm, 1);
+    sign_parm->index = sign_index;
+    sign_parm->expire = ((options & SIGN_EXPIRES) != 0);
+    sign_parm->check = check;
+    sign_parm->command = g_strdup_printf ("%s%ssign",
+                                          (options & SIGN_NO_REVOKE) ? "nr" : "",
+                                          (options & SIGN_LOCAL) ? "l" : "");
+
+    op->parms = seahorse_edit_parm_new (SIGN_START, sign_action, sign_transit, sign_parm);
+    op->data = sign_parm;
+    op->free_data = sign_parm_free;
+}
+
+static void
+sign_key_async (void                *source_object,
+                gpgme_key_t          signed_key,
+                gpgme_key_t          signing_key,
+                unsigned int         sign_index,
+                const char          *userid,
+                SeahorseSignCheck    check,
+                SeahorseSignOptions  options,
+                GCancellable        *cancellable,
+                GAsyncReadyCallback  callback,
+                void                *user_data)
+{
+    KeyOp op = { NULL, };
+
+    sign_key_op (&op, signed_key, signing_key, sign_index, userid, check, options);
+    key_op_async (source_object, signed_key, signing_key, &op,
+                  cancellable, callback, user_data);
+}
+
+void
+seahorse_gpgme_key_op_sign_uid_async (SeahorseGpgmeUid    *uid,
+                                      SeahorseGpgmeKey    *signer,
+                                      SeahorseSignCheck    check,
+                                      SeahorseSignOptions  options,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      void                *user_data)
 {
     gpgme_key_t signing_key;
     gpgme_key_t signed_key;
     unsigned int sign_index;
 
-    seahorse_gpgme_key_get_private (signer);
-
-    g_return_val_if_fail (SEAHORSE_GPGME_IS_UID (uid), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
-    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (signer), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
+    g_return_if_fail (SEAHORSE_GPGME_IS_UID (uid));
+    g_return_if_fail (SEAHORSE_GPGME_IS_KEY (signer));
 
     signing_key = seahorse_gpgme_key_get_private (signer);
-    g_return_val_if_fail (signing_key, GPG_E (GPG_ERR_WRONG_KEY_USAGE));
+    g_return_if_fail (signing_key);
 
     signed_key = seahorse_gpgme_uid_get_pubkey (uid);
-    g_return_val_if_fail (signing_key, GPG_E (GPG_ERR_INV_VALUE));
+    g_return_if_fail (signed_key);
 
     sign_index = seahorse_gpgme_uid_get_actual_index (uid);
 
-    return sign_process (signed_key, signing_key, sign_index, check, options);
+    sign_key_async (uid, signed_key, signing_key, sign_index,
+                    seahorse_gpgme_uid_get_userid (uid)->uid, check, options,
+                    cancellable, callback, user_data);
 }
 
-gpgme_error_t
-seahorse_gpgme_key_op_sign (SeahorseGpgmeKey *pkey, SeahorseGpgmeKey *signer,
-                            SeahorseSignCheck check, SeahorseSignOptions options)
+gboolean
+seahorse_gpgme_key_op_sign_uid_finish (SeahorseGpgmeUid *uid,
+                                       GAsyncResult     *result,
+                                       GError          **error)
+{
+    g_return_val_if_fail (SEAHORSE_GPGME_IS_UID (uid), FALSE);
+
+    return edit_key_finish (uid, result, error);
+}
+
+void
+seahorse_gpgme_key_op_sign_async (SeahorseGpgmeKey    *pkey,
+                                  SeahorseGpgmeKey    *signer,
+                                  SeahorseSignCheck    check,
+                                  SeahorseSignOptions  options,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  void                *user_data)
 {
     gpgme_key_t signing_key;
     gpgme_key_t signed_key;
 
-    seahorse_gpgme_key_get_private (signer);
-
-    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (pkey), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
-    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (signer), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
+    g_return_if_fail (SEAHORSE_GPGME_IS_KEY (pkey));
+    g_return_if_fail (SEAHORSE_GPGME_IS_KEY (signer));
 
     signing_key = seahorse_gpgme_key_get_private (signer);
-    g_return_val_if_fail (signing_key, GPG_E (GPG_ERR_WRONG_KEY_USAGE));
+    g_return_if_fail (signing_key);
 
     signed_key = seahorse_gpgme_key_get_public (pkey);
+    g_return_if_fail (signed_key);
 
-    return sign_process (signed_key, signing_key, 0, check, options);
+    sign_key_async (pkey, signed_key, signing_key, 0, NULL, check, options,
+                    cancellable, callback, user_data);
+}
+
+gboolean
+seahorse_gpgme_key_op_sign_finish (SeahorseGpgmeKey *pkey,
+                                   GAsyncResult     *result,
+                                   GError          **error)
+{
+    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (pkey), FALSE);
+
+    return edit_key_finish (pkey, result, error);
 }
 
 static gboolean
@@ -702,11 +942,11 @@ seahorse_gpgme_key_op_change_pass_async (SeahorseGpgmeKey *pkey,
     g_return_if_fail (SEAHORSE_GPGME_IS_KEY (pkey));
     g_return_if_fail (seahorse_object_get_usage (SEAHORSE_OBJECT (pkey)) == SEAHORSE_USAGE_PRIVATE_KEY);
 
-    gctx = seahorse_gpgme_keyring_new_context (&gerr);
+    gctx = seahorse_gpgme_keyring_acquire_context ("change-pass", &gerr);
 
     task = g_task_new (pkey, cancellable, callback, user_data);
     gpgme_set_progress_cb (gctx, on_key_op_progress, task);
-    g_task_set_task_data (task, gctx, (GDestroyNotify) gpgme_release);
+    g_task_set_task_data (task, gctx, (GDestroyNotify) seahorse_gpgme_keyring_release_context);
 
     seahorse_progress_prep_and_begin (cancellable, task, NULL);
     gsource = seahorse_gpgme_gsource_new (gctx, cancellable);
@@ -852,58 +1092,78 @@ edit_trust_transit (unsigned int   current_state,
     return next_state;
 }
 
+static int
+trust_menu_choice (SeahorseValidity trust)
+{
+    switch (trust) {
+        case SEAHORSE_VALIDITY_NEVER:
+            return GPG_NEVER;
+        case SEAHORSE_VALIDITY_UNKNOWN:
+            return GPG_UNKNOWN;
+        case SEAHORSE_VALIDITY_MARGINAL:
+            return GPG_MARGINAL;
+        case SEAHORSE_VALIDITY_FULL:
+            return GPG_FULL;
+        case SEAHORSE_VALIDITY_ULTIMATE:
+            return GPG_ULTIMATE;
+        default:
+            return 1;
+    }
+}
+
 /**
- * seahorse_gpgme_key_op_set_trust:
+ * seahorse_gpgme_key_op_set_trust_async:
  * @pkey: #SeahorseGpgmeKey whose trust will be changed
  * @trust: New trust value that must be at least #SEAHORSE_VALIDITY_NEVER.
  * If @pkey is a #SeahorseKeyPair, then @trust cannot be #SEAHORSE_VALIDITY_UNKNOWN.
  * If @pkey is not a #SeahorseKeyPair, then @trust cannot be #SEAHORSE_VALIDITY_ULTIMATE.
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: The callback that will be called when the operation finishes
+ * @user_data: (closure callback): User data passed on to @callback
  *
  * Tries to change the owner trust of @pkey to @trust.
- *
- * Returns: Error value
  **/
-gpgme_error_t
-seahorse_gpgme_key_op_set_trust (SeahorseGpgmeKey *pkey, SeahorseValidity trust)
+void
+seahorse_gpgme_key_op_set_trust_async (SeahorseGpgmeKey    *pkey,
+                                       SeahorseValidity     trust,
+                                       GCancellable        *cancellable,
+                                       GAsyncReadyCallback  callback,
+                                       void                *user_data)
 {
     SeahorseEditParm *parms;
+    gpgme_key_t key;
     int menu_choice;
 
     g_debug ("[GPGME_KEY_OP] set_trust: trust = %i", trust);
 
-    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (pkey), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
-    g_return_val_if_fail (trust >= SEAHORSE_VALIDITY_NEVER, GPG_E (GPG_ERR_INV_VALUE));
-    g_return_val_if_fail (seahorse_gpgme_key_get_trust (pkey) != trust, GPG_E (GPG_ERR_INV_VALUE));
+    g_return_if_fail (SEAHORSE_GPGME_IS_KEY (pkey));
+    g_return_if_fail (trust >= SEAHORSE_VALIDITY_NEVER);
+    g_return_if_fail (seahorse_gpgme_key_get_trust (pkey) != trust);
 
     if (seahorse_object_get_usage (SEAHORSE_OBJECT (pkey)) == SEAHORSE_USAGE_PRIVATE_KEY)
-        g_return_val_if_fail (trust != SEAHORSE_VALIDITY_UNKNOWN, GPG_E (GPG_ERR_INV_VALUE));
+        g_return_if_fail (trust != SEAHORSE_VALIDITY_UNKNOWN);
     else
-        g_return_val_if_fail (trust != SEAHORSE_VALIDITY_ULTIMATE, GPG_E (GPG_ERR_INV_VALUE));
+        g_return_if_fail (trust != SEAHORSE_VALIDITY_ULTIMATE);
 
-    switch (trust) {
-        case SEAHORSE_VALIDITY_NEVER:
-            menu_choice = GPG_NEVER;
-            break;
-        case SEAHORSE_VALIDITY_UNKNOWN:
-            menu_choice = GPG_UNKNOWN;
-            break;
-        case SEAHORSE_VALIDITY_MARGINAL:
-            menu_choice = GPG_MARGINAL;
-            break;
-        case SEAHORSE_VALIDITY_FULL:
-            menu_choice = GPG_FULL;
-            break;
-        case SEAHORSE_VALIDITY_ULTIMATE:
-            menu_choice = GPG_ULTIMATE;
-            break;
-        default:
-            menu_choice = 1;
-    }
+    key = seahorse_gpgme_key_get_public (pkey);
+    g_return_if_fail (key);
+
+    menu_choice = trust_menu_choice (trust);
 
     parms = seahorse_edit_parm_new (TRUST_START, edit_trust_action,
         edit_trust_transit, GINT_TO_POINTER (menu_choice));
 
-    return edit_key (pkey, parms);
+    edit_key_async (pkey, key, NULL, parms, NULL, cancellable, callback, user_data);
+}
+
+gboolean
+seahorse_gpgme_key_op_set_trust_finish (SeahorseGpgmeKey *pkey,
+                                        GAsyncResult     *result,
+                                        GError          **error)
+{
+    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (pkey), FALSE);
+
+    return edit_key_finish (pkey, result, error);
 }
 
 typedef enum {
@@ -984,16 +1244,22 @@ edit_disable_transit (unsigned int   current_state,
  * @disabled: New disabled state
  *
  * Tries to change disabled state of @skey to @disabled.
- *
- * Returns: Error value
  **/
-gpgme_error_t
-seahorse_gpgme_key_op_set_disabled (SeahorseGpgmeKey *pkey, gboolean disabled)
+void
+seahorse_gpgme_key_op_set_disabled_async (SeahorseGpgmeKey    *pkey,
+                                          gboolean             disabled,
+                                          GCancellable        *cancellable,
+                                          GAsyncReadyCallback  callback,
+                                          void                *user_data)
 {
     char *command;
     SeahorseEditParm *parms;
+    gpgme_key_t key;
 
-    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (pkey), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
+    g_return_if_fail (SEAHORSE_GPGME_IS_KEY (pkey));
+
+    key = seahorse_gpgme_key_get_public (pkey);
+    g_return_if_fail (key);
 
     /* Get command and op */
     if (disabled)
@@ -1003,7 +1269,17 @@ seahorse_gpgme_key_op_set_disabled (SeahorseGpgmeKey *pkey, gboolean disabled)
 
     parms = seahorse_edit_parm_new (DISABLE_START, edit_disable_action, edit_disable_transit, command);
 
-    return edit_key (pkey, parms);
+    edit_key_async (pkey, key, NULL, parms, NULL, cancellable, callback, user_data);
+}
+
+gboolean
+seahorse_gpgme_key_op_set_disabled_finish (SeahorseGpgmeKey *pkey,
+                                           GAsyncResult     *result,
+                                           GError          **error)
+{
+    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (pkey), FALSE);
+
+    return edit_key_finish (pkey, result, error);
 }
 
 typedef struct
@@ -1131,35 +1407,131 @@ edit_expire_transit (unsigned int   current_state,
     return next_state;
 }
 
-gpgme_error_t
-seahorse_gpgme_key_op_set_expires (SeahorseGpgmeSubkey *subkey,
-                                   GDateTime           *expires)
+static void
+expire_parm_free (void *data)
+{
+    ExpireParm *parm = data;
+
+    g_clear_pointer (&parm->expires, g_date_time_unref);
+    g_free (parm);
+}
+
+/* gpg --quick-set-expire; both GPGME and gpg need to know about it */
+static gboolean
+can_quick_set_expire (void)
+{
+#if GPGME_VERSION_NUMBER >= 0x010f00
+    return gpgme_check_version ("1.15.0") != NULL &&
+           seahorse_gpgme_get_engine_version () >= seahorse_util_version (2, 1, 22, 0);
+#else
+    return FALSE;
+#endif
+}
+
+#if GPGME_VERSION_NUMBER >= 0x010f00
+typedef struct {
+    unsigned long expires;      /* In seconds from now, or 0 for never */
+    char *subkey_fpr;           /* NULL for the primary key */
+} QuickExpireData;
+
+static void
+quick_expire_data_free (void *data)
+{
+    QuickExpireData *expire = data;
+
+    g_free (expire->subkey_fpr);
+    g_free (expire);
+}
+
+static gpgme_error_t
+quick_expire_start (gpgme_ctx_t  ctx,
+                    gpgme_key_t  key,
+                    void        *data)
+{
+    QuickExpireData *expire = data;
+
+    return gpgme_op_setexpire_start (ctx, key, expire->expires, expire->subkey_fpr, 0);
+}
+#endif
+
+static void
+expire_key_op (KeyOp        *op,
+               gpgme_key_t   key,
+               unsigned int  index,
+               GDateTime    *expires)
+{
+    ExpireParm *exp_parm;
+
+#if GPGME_VERSION_NUMBER >= 0x010f00
+    if (can_quick_set_expire ()) {
+        gint64 seconds = 0;
+        gpgme_subkey_t subkey = key->subkeys;
+
+        for (unsigned int i = 0; i < index && subkey; i++)
+            subkey = subkey->next;
+        if (expires)
+            seconds = g_date_time_to_unix (expires) - g_get_real_time () / G_USEC_PER_SEC;
+
+        /* An expiry date in the past is left to the edit machine */
+        if (subkey && subkey->fpr && (expires == NULL || seconds > 0)) {
+            QuickExpireData *expire = g_new0 (QuickExpireData, 1);
+
+            expire->expires = seconds;
+            expire->subkey_fpr = index > 0 ? g_strdup (subkey->fpr) : NULL;
+            op->quick = quick_expire_start;
+            op->data = expire;
+            op->free_data = quick_expire_data_free;
+            return;
+        }
+    }
+#endif
+
+    exp_parm = g_new0 (ExpireParm, 1);
+    exp_parm->index = index;
+    exp_parm->expires = expires ? g_date_time_ref (expires) : NULL;
+
+    op->parms = seahorse_edit_parm_new (EXPIRE_START, edit_expire_action, edit_expire_transit, exp_parm);
+    op->data = exp_parm;
+    op->free_data = expire_parm_free;
+}
+
+void
+seahorse_gpgme_key_op_set_expires_async (SeahorseGpgmeSubkey *subkey,
+                                         GDateTime           *expires,
+                                         GCancellable        *cancellable,
+                                         GAsyncReadyCallback  callback,
+                                         void                *user_data)
 {
     GDateTime *old_expires;
-    ExpireParm exp_parm;
-    SeahorseEditParm *parms;
+    KeyOp op = { NULL, };
     SeahorsePgpKey *parent_key;
     gpgme_key_t key;
 
-    g_return_val_if_fail (SEAHORSE_GPGME_IS_SUBKEY (subkey), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
+    g_return_if_fail (SEAHORSE_GPGME_IS_SUBKEY (subkey));
 
     old_expires = seahorse_pgp_subkey_get_expires (SEAHORSE_PGP_SUBKEY (subkey));
-    g_return_val_if_fail (expires != old_expires, GPG_E (GPG_ERR_INV_VALUE));
+    g_return_if_fail (expires != old_expires);
 
     if (expires && old_expires)
-        g_return_val_if_fail (!g_date_time_equal (old_expires, expires),
-                              GPG_E (GPG_ERR_INV_VALUE));
+        g_return_if_fail (!g_date_time_equal (old_expires, expires));
 
     parent_key = seahorse_pgp_subkey_get_parent_key (SEAHORSE_PGP_SUBKEY (subkey));
     key = seahorse_gpgme_key_get_public (SEAHORSE_GPGME_KEY (parent_key));
-    g_return_val_if_fail (key, GPG_E (GPG_ERR_INV_VALUE));
+    g_return_if_fail (key);
 
-    exp_parm.index = seahorse_pgp_subkey_get_index (SEAHORSE_PGP_SUBKEY (subkey));
-    exp_parm.expires = expires;
+    expire_key_op (&op, key, seahorse_pgp_subkey_get_index (SEAHORSE_PGP_SUBKEY (subkey)),
+                   expires);
+    key_op_async (subkey, key, NULL, &op, cancellable, callback, user_data);
+}
 
-    parms = seahorse_edit_parm_new (EXPIRE_START, edit_expire_action, edit_expire_transit, &exp_parm);
+gboolean
+seahorse_gpgme_key_op_set_expires_finish (SeahorseGpgmeSubkey *subkey,
+                                          GAsyncResult        *result,
+                                          GError             **error)
+{
+    g_return_val_if_fail (SEAHORSE_GPGME_IS_SUBKEY (subkey), FALSE);
 
-    return edit_refresh_gpgme_key (NULL, key, parms);
+    return edit_key_finish (subkey, result, error);
 }
 
 typedef enum {
@@ -1271,24 +1643,42 @@ add_revoker_transit (unsigned int   current_state,
     return next_state;
 }
 
-gpgme_error_t
-seahorse_gpgme_key_op_add_revoker (SeahorseGpgmeKey *pkey, SeahorseGpgmeKey *revoker)
+void
+seahorse_gpgme_key_op_add_revoker_async (SeahorseGpgmeKey    *pkey,
+                                         SeahorseGpgmeKey    *revoker,
+                                         GCancellable        *cancellable,
+                                         GAsyncReadyCallback  callback,
+                                         void                *user_data)
 {
     SeahorseEditParm *parms;
     const char *keyid;
+    gpgme_key_t key;
 
-    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (pkey), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
-    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (revoker), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
-    g_return_val_if_fail (seahorse_object_get_usage (SEAHORSE_OBJECT (pkey)) == SEAHORSE_USAGE_PRIVATE_KEY, GPG_E (GPG_ERR_WRONG_KEY_USAGE));
-    g_return_val_if_fail (seahorse_object_get_usage (SEAHORSE_OBJECT (revoker)) == SEAHORSE_USAGE_PRIVATE_KEY, GPG_E (GPG_ERR_WRONG_KEY_USAGE));
+    g_return_if_fail (SEAHORSE_GPGME_IS_KEY (pkey));
+    g_return_if_fail (SEAHORSE_GPGME_IS_KEY (revoker));
+    g_return_if_fail (seahorse_object_get_usage (SEAHORSE_OBJECT (pkey)) == SEAHORSE_USAGE_PRIVATE_KEY);
+    g_return_if_fail (seahorse_object_get_usage (SEAHORSE_OBJECT (revoker)) == SEAHORSE_USAGE_PRIVATE_KEY);
 
     keyid = seahorse_pgp_key_get_keyid (SEAHORSE_PGP_KEY (pkey));
-    g_return_val_if_fail (keyid, GPG_E (GPG_ERR_INV_VALUE));
+    g_return_if_fail (keyid);
+
+    key = seahorse_gpgme_key_get_public (pkey);
+    g_return_if_fail (key);
 
     parms = seahorse_edit_parm_new (ADD_REVOKER_START, add_revoker_action,
-                                    add_revoker_transit, (gpointer)keyid);
+                                    add_revoker_transit, g_strdup (keyid));
 
-    return edit_key (pkey, parms);
+    edit_key_async (pkey, key, NULL, parms, g_free, cancellable, callback, user_data);
+}
+
+gboolean
+seahorse_gpgme_key_op_add_revoker_finish (SeahorseGpgmeKey *pkey,
+                                          GAsyncResult     *result,
+                                          GError          **error)
+{
+    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (pkey), FALSE);
+
+    return edit_key_finish (pkey, result, error);
 }
 
 static gboolean
@@ -1328,11 +1718,11 @@ seahorse_gpgme_key_op_add_uid_async (SeahorseGpgmeKey    *pkey,
     g_return_if_fail (SEAHORSE_GPGME_IS_KEY (pkey));
     g_return_if_fail (seahorse_object_get_usage (SEAHORSE_OBJECT (pkey)) == SEAHORSE_USAGE_PRIVATE_KEY);
 
-    gctx = seahorse_gpgme_keyring_new_context (&gerr);
+    gctx = seahorse_gpgme_keyring_acquire_context ("add-uid", &gerr);
 
     task = g_task_new (pkey, cancellable, callback, user_data);
     gpgme_set_progress_cb (gctx, on_key_op_progress, task);
-    g_task_set_task_data (task, gctx, (GDestroyNotify) gpgme_release);
+    g_task_set_task_data (task, gctx, (GDestroyNotify) seahorse_gpgme_keyring_release_context);
 
     seahorse_progress_prep_and_begin (cancellable, task, NULL);
     gsource = seahorse_gpgme_gsource_new (gctx, cancellable);
@@ -1386,11 +1776,11 @@ seahorse_gpgme_key_op_add_subkey_async (SeahorseGpgmeKey    *pkey,
     g_return_if_fail (seahorse_object_get_usage (SEAHORSE_OBJECT (pkey)) ==
                           SEAHORSE_USAGE_PRIVATE_KEY);
 
-    gctx = seahorse_gpgme_keyring_new_context (&gerr);
+    gctx = seahorse_gpgme_keyring_acquire_context ("add-subkey", &gerr);
 
     task = g_task_new (pkey, cancellable, callback, user_data);
     gpgme_set_progress_cb (gctx, on_key_op_progress, task);
-    g_task_set_task_data (task, gctx, (GDestroyNotify) gpgme_release);
+    g_task_set_task_data (task, gctx, (GDestroyNotify) seahorse_gpgme_keyring_release_context);
 
     seahorse_progress_prep_and_begin (cancellable, task, NULL);
     gsource = seahorse_gpgme_gsource_new (gctx, cancellable);
@@ -1559,32 +1949,45 @@ del_key_transit (unsigned int   current_state,
     return next_state;
 }
 
-gpgme_error_t
-seahorse_gpgme_key_op_del_subkey (SeahorseGpgmeSubkey *subkey)
+void
+seahorse_gpgme_key_op_del_subkey_async (SeahorseGpgmeSubkey *subkey,
+                                        GCancellable        *cancellable,
+                                        GAsyncReadyCallback  callback,
+                                        void                *user_data)
 {
     SeahorsePgpKey *parent_key;
     gpgme_key_t key;
     SeahorseEditParm *parms;
     int index;
 
-    g_return_val_if_fail (SEAHORSE_GPGME_IS_SUBKEY (subkey), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
+    g_return_if_fail (SEAHORSE_GPGME_IS_SUBKEY (subkey));
 
     parent_key = seahorse_pgp_subkey_get_parent_key (SEAHORSE_PGP_SUBKEY (subkey));
     key = seahorse_gpgme_key_get_public (SEAHORSE_GPGME_KEY (parent_key));
-    g_return_val_if_fail (key, GPG_E (GPG_ERR_INV_VALUE));
+    g_return_if_fail (key);
 
     index = seahorse_pgp_subkey_get_index (SEAHORSE_PGP_SUBKEY (subkey));
     parms = seahorse_edit_parm_new (DEL_KEY_START, del_key_action,
                                     del_key_transit, GUINT_TO_POINTER (index));
 
-    return edit_refresh_gpgme_key (NULL, key, parms);
+    edit_key_async (subkey, key, NULL, parms, NULL, cancellable, callback, user_data);
 }
 
-typedef struct
+gboolean
+seahorse_gpgme_key_op_del_subkey_finish (SeahorseGpgmeSubkey *subkey,
+                                         GAsyncResult        *result,
+                                         GError             **error)
 {
-    unsigned int          index;
-    SeahorseRevokeReason  reason;
-    const char           *description;
+    g_return_val_if_fail (SEAHORSE_GPGME_IS_SUBKEY (subkey), FALSE);
+
+    return edit_key_finish (subkey, result, error);
+}
+
+typedef struct
+{
+    unsigned int          index;
+    SeahorseRevokeReason  reason;
+    char                 *description;
 } RevSubkeyParm;
 
 typedef enum {
@@ -1740,33 +2143,58 @@ rev_subkey_transit (unsigned int   current_state,
     return next_state;
 }
 
-gpgme_error_t
-seahorse_gpgme_key_op_revoke_subkey (SeahorseGpgmeSubkey *subkey, SeahorseRevokeReason reason,
-                                     const char *description)
+static void
+rev_subkey_parm_free (void *data)
 {
-    RevSubkeyParm rev_parm;
+    RevSubkeyParm *parm = data;
+
+    g_free (parm->description);
+    g_free (parm);
+}
+
+void
+seahorse_gpgme_key_op_revoke_subkey_async (SeahorseGpgmeSubkey  *subkey,
+                                           SeahorseRevokeReason  reason,
+                                           const char           *description,
+                                           GCancellable         *cancellable,
+                                           GAsyncReadyCallback   callback,
+                                           void                 *user_data)
+{
+    RevSubkeyParm *rev_parm;
     SeahorseEditParm *parms;
     gpgme_subkey_t gsubkey;
     SeahorsePgpKey *parent_key;
     gpgme_key_t key;
 
-    g_return_val_if_fail (SEAHORSE_GPGME_IS_SUBKEY (subkey), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
+    g_return_if_fail (SEAHORSE_GPGME_IS_SUBKEY (subkey));
 
     gsubkey = seahorse_gpgme_subkey_get_subkey (subkey);
-    g_return_val_if_fail (!gsubkey->revoked, GPG_E (GPG_ERR_INV_VALUE));
+    g_return_if_fail (!gsubkey->revoked);
 
     parent_key = seahorse_pgp_subkey_get_parent_key (SEAHORSE_PGP_SUBKEY (subkey));
     key = seahorse_gpgme_key_get_public (SEAHORSE_GPGME_KEY (parent_key));
-    g_return_val_if_fail (key, GPG_E (GPG_ERR_INV_VALUE));
+    g_return_if_fail (key);
 
-    rev_parm.index = seahorse_pgp_subkey_get_index (SEAHORSE_PGP_SUBKEY (subkey));
-    rev_parm.reason = reason;
-    rev_parm.description = description;
+    rev_parm = g_new0 (RevSubkeyParm, 1);
+    rev_parm->index = seahorse_pgp_subkey_get_index (SEAHORSE_PGP_SUBKEY (subkey));
+    rev_parm->reason = reason;
+    rev_parm->description = g_strdup (description);
 
     parms = seahorse_edit_parm_new (REV_SUBKEY_START, rev_subkey_action,
-                                    rev_subkey_transit, &rev_parm);
+                                    rev_subkey_transit, rev_parm);
+
+    edit_key_async (subkey, key, NULL, parms, rev_subkey_parm_free,
+                    cancellable, callback, user_data);
+}
 
-    return edit_refresh_gpgme_key (NULL, key, parms);
+gboolean
+seahorse_gpgme_key_op_revoke_subkey_finish (SeahorseGpgmeSubkey *subkey,
+                                            GAsyncResult        *result,
+                                            GError             **error)
+{
+    g_return_val_if_fail (SEAHORSE_GPGME_IS_SUBKEY (subkey), FALSE);
+
+    return edit_key_finish (subkey, result, error);
 }
 
 typedef struct {
@@ -1923,11 +2351,11 @@ seahorse_gpgme_key_op_make_primary_async (SeahorseGpgmeUid *uid,
     key = seahorse_gpgme_uid_get_pubkey (uid);
     g_return_if_fail (key);
 
-    gctx = seahorse_gpgme_keyring_new_context (&gerr);
+    gctx = seahorse_gpgme_keyring_acquire_context ("make-primary", &gerr);
 
     task = g_task_new (uid, cancellable, callback, user_data);
     gpgme_set_progress_cb (gctx, on_key_op_progress, task);
-    g_task_set_task_data (task, gctx, (GDestroyNotify) gpgme_release);
+    g_task_set_task_data (task, gctx, (GDestroyNotify) seahorse_gpgme_keyring_release_context);
 
     seahorse_progress_prep_and_begin (cancellable, task, NULL);
     gsource = seahorse_gpgme_gsource_new (gctx, cancellable);
@@ -2083,28 +2511,42 @@ del_uid_transit (unsigned int   current_state,
     return next_state;
 }
 
-gpgme_error_t
-seahorse_gpgme_key_op_del_uid (SeahorseGpgmeUid *uid)
+void
+seahorse_gpgme_key_op_del_uid_async (SeahorseGpgmeUid    *uid,
+                                     GCancellable        *cancellable,
+                                     GAsyncReadyCallback  callback,
+                                     void                *user_data)
 {
-    DelUidParm del_uid_parm;
+    DelUidParm *del_uid_parm;
     SeahorseEditParm *parms;
     gpgme_key_t key;
 
-    g_return_val_if_fail (SEAHORSE_GPGME_IS_UID (uid), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
+    g_return_if_fail (SEAHORSE_GPGME_IS_UID (uid));
 
     key = seahorse_gpgme_uid_get_pubkey (uid);
-    g_return_val_if_fail (key, GPG_E (GPG_ERR_INV_VALUE));
+    g_return_if_fail (key);
 
-    del_uid_parm.index = seahorse_gpgme_uid_get_actual_index (uid);
+    del_uid_parm = g_new0 (DelUidParm, 1);
+    del_uid_parm->index = seahorse_gpgme_uid_get_actual_index (uid);
 
     parms = seahorse_edit_parm_new (DEL_UID_START, del_uid_action,
-                                    del_uid_transit, &del_uid_parm);
+                                    del_uid_transit, del_uid_parm);
+
+    edit_key_async (uid, key, NULL, parms, g_free, cancellable, callback, user_data);
+}
+
+gboolean
+seahorse_gpgme_key_op_del_uid_finish (SeahorseGpgmeUid *uid,
+                                      GAsyncResult     *result,
+                                      GError          **error)
+{
+    g_return_val_if_fail (SEAHORSE_GPGME_IS_UID (uid), FALSE);
 
-    return edit_refresh_gpgme_key (NULL, key, parms);
+    return edit_key_finish (uid, result, error);
 }
 
 typedef struct {
-    const char *filename;
+    char *filename;
 } PhotoIdAddParm;
 
 typedef enum {
@@ -2214,294 +2656,644 @@ photoid_add_transit (unsigned int   current_state,
     return next_state;
 }
 
-gpgme_error_t
-seahorse_gpgme_key_op_photo_add (SeahorseGpgmeKey *pkey, const char *filename)
+static void
+photoid_add_parm_free (void *data)
+{
+    PhotoIdAddParm *parm = data;
+
+    g_free (parm->filename);
+    g_free (parm);
+}
+
+void
+seahorse_gpgme_key_op_photo_add_async (SeahorseGpgmeKey    *pkey,
+                                       const char          *filename,
+                                       GCancellable        *cancellable,
+                                       GAsyncReadyCallback  callback,
+                                       void                *user_data)
 {
     SeahorseEditParm *parms;
-    PhotoIdAddParm photoid_add_parm;
+    PhotoIdAddParm *photoid_add_parm;
     gpgme_key_t key;
 
-    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (pkey), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
-    g_return_val_if_fail (filename, GPG_E (GPG_ERR_INV_VALUE));
+    g_return_if_fail (SEAHORSE_GPGME_IS_KEY (pkey));
+    g_return_if_fail (filename);
 
     key = seahorse_gpgme_key_get_public (pkey);
-    g_return_val_if_fail (key, GPG_E (GPG_ERR_INV_VALUE));
+    g_return_if_fail (key);
 
-    photoid_add_parm.filename = filename;
+    photoid_add_parm = g_new0 (PhotoIdAddParm, 1);
+    photoid_add_parm->filename = g_strdup (filename);
 
     parms = seahorse_edit_parm_new (PHOTO_ID_ADD_START, photoid_add_action,
-                                    photoid_add_transit, &photoid_add_parm);
+                                    photoid_add_transit, photoid_add_parm);
 
-    return edit_refresh_gpgme_key (NULL, key, parms);
+    edit_key_async (pkey, key, NULL, parms, photoid_add_parm_free,
+                    cancellable, callback, user_data);
 }
 
-gpgme_error_t
-seahorse_gpgme_key_op_photo_delete (SeahorseGpgmePhoto *photo)
+gboolean
+seahorse_gpgme_key_op_photo_add_finish (SeahorseGpgmeKey *pkey,
+                                        GAsyncResult     *result,
+                                        GError          **error)
+{
+    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (pkey), FALSE);
+
+    return edit_key_finish (pkey, result, error);
+}
+
+void
+seahorse_gpgme_key_op_photo_delete_async (SeahorseGpgmePhoto  *photo,
+                                          GCancellable        *cancellable,
+                                          GAsyncReadyCallback  callback,
+                                          void                *user_data)
 {
-    DelUidParm del_uid_parm;
+    DelUidParm *del_uid_parm;
     SeahorseEditParm *parms;
     gpgme_key_t key;
 
-    g_return_val_if_fail (SEAHORSE_IS_GPGME_PHOTO (photo), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
+    g_return_if_fail (SEAHORSE_IS_GPGME_PHOTO (photo));
 
     key = seahorse_gpgme_photo_get_pubkey (photo);
-    g_return_val_if_fail (key, GPG_E (GPG_ERR_INV_VALUE));
+    g_return_if_fail (key);
 
-    del_uid_parm.index = seahorse_gpgme_photo_get_index (photo);
+    del_uid_parm = g_new0 (DelUidParm, 1);
+    del_uid_parm->index = seahorse_gpgme_photo_get_index (photo);
 
     parms = seahorse_edit_parm_new (DEL_UID_START, del_uid_action,
-                                    del_uid_transit, &del_uid_parm);
+                                    del_uid_transit, del_uid_parm);
 
-    return edit_refresh_gpgme_key (NULL, key, parms);
+    edit_key_async (photo, key, NULL, parms, g_free, cancellable, callback, user_data);
 }
 
-typedef struct {
-    GList *photos;
-    unsigned int uid;
-    unsigned int num_uids;
-    char *output_file;
-    gpgme_key_t key;
-} PhotoIdLoadParm;
+gboolean
+seahorse_gpgme_key_op_photo_delete_finish (SeahorseGpgmePhoto *photo,
+                                           GAsyncResult       *result,
+                                           GError            **error)
+{
+    g_return_val_if_fail (SEAHORSE_IS_GPGME_PHOTO (photo), FALSE);
 
-typedef enum {
-    PHOTO_ID_LOAD_START,
-    PHOTO_ID_LOAD_SELECT,
-    PHOTO_ID_LOAD_OUTPUT_IMAGE,
-    PHOTO_ID_LOAD_DESELECT,
-    PHOTO_ID_LOAD_QUIT,
-    PHOTO_ID_LOAD_ERROR
-} PhotoIdLoadState;
-
-/* action helper for getting a list of photoids attached to a #SeahorseKey */
-static gpgme_error_t
-photoid_load_action (unsigned int state, gpointer data, int fd)
+    return edit_key_finish (photo, result, error);
+}
+
+static GdkPixbuf *
+load_photo_pixbuf (GBytes *image)
 {
-    PhotoIdLoadParm *parm = (PhotoIdLoadParm*)data;
+    g_autoptr(GdkPixbufLoader) loader = NULL;
+    g_autoptr(GError) error = NULL;
+    GdkPixbuf *pixbuf;
+
+    loader = gdk_pixbuf_loader_new ();
+    if (!gdk_pixbuf_loader_write_bytes (loader, image, &error) ||
+        !gdk_pixbuf_loader_close (loader, &error)) {
+        g_warning ("Loading photo failed: %s", error->message);
+        gdk_pixbuf_loader_close (loader, NULL);
+        return NULL;
+    }
 
-    switch (state) {
-        case PHOTO_ID_LOAD_SELECT:
-            PRINTF ((fd, "uid %d", parm->uid));
-            break;
-        case PHOTO_ID_LOAD_OUTPUT_IMAGE:
-            PRINT ((fd, "showphoto"));
-            break;
-        case PHOTO_ID_LOAD_DESELECT:
-            PRINTF ((fd, "uid %d", parm->uid));
-            break;
-        case PHOTO_ID_LOAD_QUIT:
-            PRINT ((fd, QUIT));
-            break;
-        default:
-            g_return_val_if_reached (GPG_E (GPG_ERR_GENERAL));
-            break;
+    pixbuf = gdk_pixbuf_loader_get_pixbuf (loader);
+    return pixbuf ? g_object_ref (pixbuf) : NULL;
+}
+
+/**
+ * seahorse_gpgme_key_op_photos_decode:
+ * @key: The public key the photos belong to
+ * @packets: (element-type SeahorsePgpPhotoPacket): The photos of @key
+ *
+ * Decodes the images of the photo IDs in @packets. This doesn't touch any
+ * global state, so it's fine to call from a worker thread. Photos that
+ * couldn't be decoded don't have a pixbuf.
+ *
+ * Returns: (transfer full) (element-type SeahorseGpgmePhoto): The photos
+ */
+GPtrArray *
+seahorse_gpgme_key_op_photos_decode (gpgme_key_t  key,
+                                     GPtrArray   *packets)
+{
+    GPtrArray *photos;
+
+    g_return_val_if_fail (key != NULL, NULL);
+    g_return_val_if_fail (packets != NULL, NULL);
+
+    photos = g_ptr_array_new_with_free_func (g_object_unref);
+    for (unsigned int i = 0; i < packets->len; i++) {
+        SeahorsePgpPhotoPacket *packet = g_ptr_array_index (packets, i);
+        g_autoptr(GdkPixbuf) pixbuf = NULL;
+
+        pixbuf = load_photo_pixbuf (packet->image);
+        g_ptr_array_add (photos, seahorse_gpgme_photo_new (key, pixbuf, packet->uid_index));
     }
 
-    seahorse_util_print_fd (fd, "\n");
+    return photos;
+}
+
+gpgme_error_t
+seahorse_gpgme_key_op_photos_load (SeahorseGpgmeKey *pkey)
+{
+    g_autoptr(GPtrArray) packets = NULL;
+    g_autoptr(GPtrArray) photos = NULL;
+    g_autoptr(GBytes) keyblock = NULL;
+    g_autoptr(GError) error = NULL;
+    gpgme_data_t data = NULL;
+    gpgme_error_t gerr;
+    gpgme_ctx_t ctx;
+    gpgme_key_t key;
+    char *buffer;
+    size_t len;
+
+    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (pkey), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
+
+    key = seahorse_gpgme_key_get_public (pkey);
+    g_return_val_if_fail (key, GPG_E (GPG_ERR_INV_VALUE));
+    g_return_val_if_fail (key->subkeys && key->subkeys->keyid, GPG_E (GPG_ERR_INV_VALUE));
+
+    /* Export the key in memory and read the photos straight out of its
+     * user attribute packets */
+    ctx = seahorse_gpgme_keyring_acquire_context ("photos", &gerr);
+    if (ctx == NULL)
+        return gerr;
+
+    gerr = gpgme_data_new (&data);
+    if (GPG_IS_OK (gerr))
+        gerr = gpgme_op_export (ctx, key->subkeys->keyid, 0, data);
+    seahorse_gpgme_keyring_release_context (ctx);
+
+    if (!GPG_IS_OK (gerr)) {
+        gpgme_data_release (data);
+        return gerr;
+    }
+
+    buffer = gpgme_data_release_and_get_mem (data, &len);
+    keyblock = g_bytes_new_with_free_func (buffer, len, gpgme_free, buffer);
+
+    packets = seahorse_pgp_packet_parse_photos (keyblock, &error);
+    if (packets == NULL) {
+        g_message ("Couldn't read the photos of key %s: %s",
+                   key->subkeys->keyid, error->message);
+        return GPG_E (GPG_ERR_INV_DATA);
+    }
+
+    g_debug ("Found %u photos in key %s", packets->len, key->subkeys->keyid);
+
+    photos = seahorse_gpgme_key_op_photos_decode (key, packets);
+    seahorse_gpgme_key_set_photos (pkey, photos);
     return GPG_OK;
 }
 
-static unsigned int
-photoid_load_transit (unsigned int   current_state,
-                      const char    *status,
-                      const char    *args,
-                      void          *data,
-                      gpgme_error_t *err)
+void
+seahorse_gpgme_key_op_photo_primary_async (SeahorseGpgmePhoto  *photo,
+                                           GCancellable        *cancellable,
+                                           GAsyncReadyCallback  callback,
+                                           void                *user_data)
 {
-    PhotoIdLoadParm *parm = (PhotoIdLoadParm*)data;
-    SeahorseGpgmePhoto *photo;
-    GdkPixbuf *pixbuf = NULL;
-    unsigned int next_state = 0;
-    struct stat st;
-    GError *error = NULL;
+    PrimaryParm *pri_parm;
+    SeahorseEditParm *parms;
+    gpgme_key_t key;
 
-    switch (current_state) {
+    g_return_if_fail (SEAHORSE_IS_GPGME_PHOTO (photo));
 
-    /* start, get photoid list */
-    case PHOTO_ID_LOAD_START:
-        if (g_str_equal (status, "GET_LINE") && g_str_equal (args, PROMPT))
-            next_state = PHOTO_ID_LOAD_SELECT;
-        else {
-            *err = GPG_E (GPG_ERR_GENERAL);
-            g_return_val_if_reached (PHOTO_ID_LOAD_ERROR);
-        }
-        break;
+    key = seahorse_gpgme_photo_get_pubkey (photo);
+    g_return_if_fail (key);
 
-    case PHOTO_ID_LOAD_SELECT:
-        if (g_str_equal (status, "GET_LINE") && g_str_equal (args, PROMPT)) {
-            next_state = PHOTO_ID_LOAD_OUTPUT_IMAGE;
-        } else {
-            *err = GPG_E (GPG_ERR_GENERAL);
-            g_return_val_if_reached (PHOTO_ID_LOAD_ERROR);
-        }
-        break;
+    pri_parm = g_new0 (PrimaryParm, 1);
+    pri_parm->index = seahorse_gpgme_photo_get_index (photo);
+
+    parms = seahorse_edit_parm_new (PRIMARY_START, primary_action,
+                                    primary_transit, pri_parm);
+
+    edit_key_async (photo, key, NULL, parms, g_free, cancellable, callback, user_data);
+}
 
-    case PHOTO_ID_LOAD_OUTPUT_IMAGE:
+gboolean
+seahorse_gpgme_key_op_photo_primary_finish (SeahorseGpgmePhoto *photo,
+                                            GAsyncResult       *result,
+                                            GError            **error)
+{
+    g_return_val_if_fail (SEAHORSE_IS_GPGME_PHOTO (photo), FALSE);
 
-        if (g_file_test (parm->output_file, G_FILE_TEST_EXISTS)) {
+    return edit_key_finish (photo, result, error);
+}
 
-            photo = seahorse_gpgme_photo_new (parm->key, NULL, parm->uid);
-            parm->photos = g_list_append (parm->photos, photo);
+/*
+ * Bulk operations run the same edit on a list of keys, eg: to certify all
+ * the keys from a key signing party. A couple of edits are kept in flight,
+ * so the next gpg is already starting up while the current one finishes.
+ * gpg serializes the keyring writes anyway, so more wouldn't help. The
+ * changed keys are reloaded in one go at the very end.
+ */
+#define BULK_MAX_IN_FLIGHT 2
 
-            if (g_stat (parm->output_file, &st) == -1) {
-                g_warning ("couldn't stat output image file '%s': %s", parm->output_file,
-                           g_strerror (errno));
+/* Fills in the change for one key. Returns FALSE without an error if
+ * there's nothing to do */
+typedef gboolean (*BulkPrepareFunc) (SeahorseGpgmeKey *pkey,
+                                     void             *data,
+                                     KeyOp            *op,
+                                     GError          **error);
 
-            } else if (st.st_size > 0) {
-                pixbuf = gdk_pixbuf_new_from_file (parm->output_file, &error);
-                if (pixbuf == NULL) {
-                    g_warning ("Loading image %s failed: %s", parm->output_file,
-                               error && error->message ? error->message : "unknown");
-                    g_error_free (error);
-                }
-            }
+typedef struct {
+    GPtrArray *keys;                /* SeahorseGpgmeKey */
+    unsigned int next;              /* Next key to start an edit for */
+    unsigned int in_flight;
+    gpgme_key_t signer;
+    BulkPrepareFunc prepare;
+    void *data;
+    GDestroyNotify free_data;
+    GHashTable *failures;           /* SeahorseGpgmeKey → GError */
+    GError *first_failure;          /* The first one that failed, to report */
+    GPtrArray *changed;             /* Fingerprints of the changed keys */
+} BulkClosure;
 
-            g_unlink (parm->output_file);
+typedef struct {
+    GTask *task;
+    unsigned int index;
+} BulkEdit;
 
-            /* Load a 'missing' icon */
-            if (!pixbuf) {
-                pixbuf = gtk_icon_theme_load_icon (gtk_icon_theme_get_default (),
-                                                   "gnome-unknown", 48, 0, NULL);
-            }
+static void
+bulk_closure_free (void *data)
+{
+    BulkClosure *closure = data;
+
+    g_ptr_array_unref (closure->keys);
+    if (closure->signer)
+        gpgme_key_unref (closure->signer);
+    if (closure->free_data && closure->data)
+        closure->free_data (closure->data);
+    g_hash_table_unref (closure->failures);
+    g_clear_error (&closure->first_failure);
+    g_ptr_array_unref (closure->changed);
+    g_free (closure);
+}
 
-            seahorse_pgp_photo_set_pixbuf (SEAHORSE_PGP_PHOTO (photo), pixbuf);
-            g_object_unref (pixbuf);
-        }
+/* Each key gets its own part in the progress, keyed by its slot */
+static const void *
+bulk_progress_tag (BulkClosure *closure,
+                   unsigned int index)
+{
+    return &closure->keys->pdata[index];
+}
 
-        if (g_str_equal (status, "GET_LINE") && g_str_equal (args, PROMPT)) {
-            next_state = PHOTO_ID_LOAD_DESELECT;
-        } else {
-            *err = GPG_E (GPG_ERR_GENERAL);
-            g_return_val_if_reached (PHOTO_ID_LOAD_ERROR);
-        }
-        break;
+static void
+bulk_add_failure (BulkClosure      *closure,
+                  SeahorseGpgmeKey *pkey,
+                  GError           *error)
+{
+    if (closure->first_failure == NULL)
+        closure->first_failure = g_error_copy (error);
+    g_hash_table_replace (closure->failures, g_object_ref (pkey), error);
+}
 
-    case PHOTO_ID_LOAD_DESELECT:
-        if (parm->uid < parm->num_uids) {
-            parm->uid = parm->uid + 1;
-            g_debug ("PhotoIDLoad Next UID %i", parm->uid);
-            if (g_str_equal (status, "GET_LINE") && g_str_equal (args, PROMPT)) {
-                next_state = PHOTO_ID_LOAD_SELECT;
-            } else {
-                *err = GPG_E (GPG_ERR_GENERAL);
-                g_return_val_if_reached (PHOTO_ID_LOAD_ERROR);
-            }
-        } else {
-            if (g_str_equal (status, "GET_LINE") && g_str_equal (args, PROMPT)) {
-                next_state = PHOTO_ID_LOAD_QUIT;
-                g_debug ("PhotoIDLoad Quiting Load");
-            } else {
-                *err = GPG_E (GPG_ERR_GENERAL);
-                g_return_val_if_reached (PHOTO_ID_LOAD_ERROR);
-            }
-        }
-        break;
+static void
+bulk_return (GTask *task)
+{
+    BulkClosure *closure = g_task_get_task_data (task);
+    unsigned int n_failed = g_hash_table_size (closure->failures);
+    GError *first = closure->first_failure;
 
-    case PHOTO_ID_LOAD_QUIT:
-        /* Shouldn't be reached */
-        *err = GPG_E (GPG_ERR_GENERAL);
-        g_debug ("PhotoIDLoad Reached Quit");
-        g_return_val_if_reached (PHOTO_ID_LOAD_ERROR);
-        break;
+    if (g_task_return_error_if_cancelled (task))
+        return;
 
-    default:
-        *err = GPG_E (GPG_ERR_GENERAL);
-        g_return_val_if_reached (PHOTO_ID_LOAD_ERROR);
-        break;
+    if (n_failed == 0) {
+        g_task_return_boolean (task, TRUE);
+        return;
     }
 
-    return next_state;
+    g_task_return_new_error (task, first->domain, first->code,
+                             ngettext ("Couldn’t change %u of %u key: %s",
+                                       "Couldn’t change %u of %u keys: %s",
+                                       closure->keys->len),
+                             n_failed, closure->keys->len, first->message);
 }
 
-gpgme_error_t
-seahorse_gpgme_key_op_photos_load (SeahorseGpgmeKey *pkey)
+static void
+on_bulk_keys_reloaded (GObject      *source,
+                       GAsyncResult *result,
+                       void         *user_data)
 {
-    /* Make sure there's enough room for the .jpg extension */
-    char image_path[]    = "/tmp/seahorse-photoid-XXXXXX\0\0\0\0";
+    g_autoptr(GTask) task = G_TASK (user_data);
+    g_autoptr(GError) error = NULL;
 
-    PhotoIdLoadParm photoid_load_parm;
-    gpgme_error_t gerr;
-    gpgme_key_t key;
-    const char *keyid;
-    int fd;
+    if (!seahorse_gpgme_keyring_reload_keys_finish (SEAHORSE_GPGME_KEYRING (source),
+                                                    result, &error))
+        g_message ("couldn't reload keys after changing them: %s", error->message);
 
-    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (pkey), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
+    bulk_return (task);
+}
 
-    key = seahorse_gpgme_key_get_public (pkey);
-    g_return_val_if_fail (key, GPG_E (GPG_ERR_INV_VALUE));
-    g_return_val_if_fail (key->subkeys && key->subkeys->keyid, GPG_E (GPG_ERR_INV_VALUE));
-    keyid = key->subkeys->keyid;
+static void bulk_start_edits (GTask *task);
 
-    g_debug ("PhotoIDLoad Start");
+static void
+on_bulk_edit_done (GObject      *source,
+                   GAsyncResult *result,
+                   void         *user_data)
+{
+    BulkEdit *edit = user_data;
+    g_autoptr(GTask) task = edit->task;
+    BulkClosure *closure = g_task_get_task_data (task);
+    SeahorseGpgmeKey *pkey = SEAHORSE_GPGME_KEY (source);
+    g_autoptr(GError) error = NULL;
 
-    fd = g_mkstemp (image_path);
-    if(fd == -1) {
-        gerr = GPG_E(GPG_ERR_GENERAL);
+    closure->in_flight--;
+    seahorse_progress_end (g_task_get_cancellable (task),
+                           bulk_progress_tag (closure, edit->index));
 
-    } else {
+    if (edit_key_finish (pkey, result, &error)) {
+        gpgme_key_t key = seahorse_gpgme_key_get_public (pkey);
 
-        g_unlink(image_path);
-        close(fd);
-        strcat (image_path, ".jpg");
+        if (key && key->subkeys && key->subkeys->fpr)
+            g_ptr_array_add (closure->changed, g_strdup (key->subkeys->fpr));
+    } else if (!g_error_matches (error, SEAHORSE_GPGME_ERROR, GPG_ERR_EALREADY)) {
+        /* Already signed keys are just left alone */
+        bulk_add_failure (closure, pkey, g_steal_pointer (&error));
+    }
 
-        photoid_load_parm.uid = 1;
-        photoid_load_parm.num_uids = 0;
-        photoid_load_parm.photos = NULL;
-        photoid_load_parm.output_file = image_path;
-        photoid_load_parm.key = key;
+    g_free (edit);
+    bulk_start_edits (task);
+}
 
-        g_debug ("PhotoIdLoad KeyID %s", keyid);
-        gerr = seahorse_gpg_op_num_uids (NULL, keyid, &(photoid_load_parm.num_uids));
-        g_debug ("PhotoIDLoad Number of UIDs %i", photoid_load_parm.num_uids);
+static void
+bulk_start_edits (GTask *task)
+{
+    BulkClosure *closure = g_task_get_task_data (task);
+    GCancellable *cancellable = g_task_get_cancellable (task);
+    SeahorseGpgmeKeyring *keyring;
 
-        if (GPG_IS_OK (gerr)) {
-            const char *oldpath;
-            g_autofree char *path = NULL;
-            SeahorseEditParm *parms;
+    while (closure->in_flight < BULK_MAX_IN_FLIGHT &&
+           closure->next < closure->keys->len &&
+           !g_cancellable_is_cancelled (cancellable)) {
+        unsigned int index = closure->next++;
+        SeahorseGpgmeKey *pkey = g_ptr_array_index (closure->keys, index);
+        const void *tag = bulk_progress_tag (closure, index);
+        KeyOp op = { NULL, };
+        g_autoptr(GError) error = NULL;
+        gpgme_key_t key;
+        BulkEdit *edit;
+
+        seahorse_progress_begin (cancellable, tag);
+
+        key = seahorse_gpgme_key_get_public (pkey);
+        if (key == NULL || !closure->prepare (pkey, closure->data, &op, &error)) {
+            if (key == NULL)
+                g_set_error_literal (&error, SEAHORSE_GPGME_ERROR, GPG_ERR_NO_PUBKEY,
+                                     _("The public key isn’t available"));
+            if (error != NULL)
+                bulk_add_failure (closure, pkey, g_steal_pointer (&error));
+            seahorse_progress_end (cancellable, tag);
+            continue;
+        }
 
-            setenv ("SEAHORSE_IMAGE_FILE", image_path, 1);
-            oldpath = getenv("PATH");
+        edit = g_new0 (BulkEdit, 1);
+        edit->task = g_object_ref (task);
+        edit->index = index;
 
-            path = g_strdup_printf ("%s:%s", EXECDIR, oldpath);
-            setenv ("PATH", path, 1);
+        closure->in_flight++;
+        key_op_start (pkey, key, closure->signer, &op, 0,
+                      cancellable, on_bulk_edit_done, edit);
+    }
 
-            parms = seahorse_edit_parm_new (PHOTO_ID_LOAD_START, photoid_load_action,
-                                            photoid_load_transit, &photoid_load_parm);
+    if (closure->in_flight > 0)
+        return;
 
-            /* generate list */
-            gerr = edit_gpgme_key (NULL, key, parms);
-            setenv ("PATH", oldpath, 1);
+    seahorse_progress_end (cancellable, task);
 
-            if (GPG_IS_OK (gerr)) {
-                for (GList *p = photoid_load_parm.photos; p; p = p->next) {
-                    seahorse_pgp_key_add_photo (SEAHORSE_PGP_KEY (pkey), p->data);
-                }
-            }
-        }
+    if (closure->changed->len == 0) {
+        bulk_return (task);
+        return;
+    }
 
-        g_list_free_full (photoid_load_parm.photos, g_object_unref);
+    /* Reload everything we changed at once. Even if we were cancelled,
+     * the keys that did change shouldn't look stale. */
+    g_ptr_array_add (closure->changed, NULL);
+    keyring = seahorse_pgp_backend_get_default_keyring (NULL);
+    seahorse_gpgme_keyring_reload_keys_async (keyring,
+                                              (const char * const *) closure->changed->pdata,
+                                              NULL, on_bulk_keys_reloaded,
+                                              g_object_ref (task));
+}
+
+static void
+bulk_edit_async (GPtrArray          *keys,
+                 gpgme_key_t         signer,
+                 BulkPrepareFunc     prepare,
+                 void               *data,
+                 GDestroyNotify      free_data,
+                 GCancellable       *cancellable,
+                 GAsyncReadyCallback callback,
+                 void               *user_data)
+{
+    g_autoptr(GTask) task = NULL;
+    BulkClosure *closure;
+
+    task = g_task_new (NULL, cancellable, callback, user_data);
+    g_task_set_source_tag (task, bulk_edit_async);
+
+    closure = g_new0 (BulkClosure, 1);
+    closure->keys = g_ptr_array_new_with_free_func (g_object_unref);
+    for (unsigned int i = 0; i < keys->len; i++)
+        g_ptr_array_add (closure->keys, g_object_ref (g_ptr_array_index (keys, i)));
+    closure->signer = signer;
+    if (signer)
+        gpgme_key_ref (signer);
+    closure->prepare = prepare;
+    closure->data = data;
+    closure->free_data = free_data;
+    closure->failures = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                               g_object_unref, (GDestroyNotify) g_error_free);
+    closure->changed = g_ptr_array_new_with_free_func (g_free);
+    g_task_set_task_data (task, closure, bulk_closure_free);
+
+    seahorse_progress_prep_and_begin (cancellable, task, NULL);
+    for (unsigned int i = 0; i < closure->keys->len; i++) {
+        SeahorseObject *object = g_ptr_array_index (closure->keys, i);
+        seahorse_progress_prep (cancellable, bulk_progress_tag (closure, i),
+                                "%s", seahorse_object_get_label (object));
     }
 
-    g_debug ("PhotoIDLoad Done");
+    bulk_start_edits (task);
+}
 
-    return gerr;
+/**
+ * seahorse_gpgme_key_op_bulk_finish:
+ * @result: The result passed to the callback
+ * @failures: (out) (optional) (element-type SeahorseGpgmeKey GError):
+ *   The keys that couldn't be changed, with the reason why
+ * @error: Error location
+ *
+ * Finishes one of the bulk operations, like
+ * seahorse_gpgme_key_op_sign_keys_async(). Fails if any of the keys
+ * couldn't be changed; the other keys are still changed in that case.
+ *
+ * Returns: Whether all the keys were changed
+ */
+gboolean
+seahorse_gpgme_key_op_bulk_finish (GAsyncResult  *result,
+                                   GHashTable   **failures,
+                                   GError       **error)
+{
+    BulkClosure *closure;
+
+    g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+    g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == bulk_edit_async, FALSE);
+
+    closure = g_task_get_task_data (G_TASK (result));
+    if (failures)
+        *failures = g_hash_table_ref (closure->failures);
+
+    return g_task_propagate_boolean (G_TASK (result), error);
 }
 
-gpgme_error_t
-seahorse_gpgme_key_op_photo_primary (SeahorseGpgmePhoto *photo)
+typedef struct {
+    gpgme_key_t signer;
+    SeahorseSignCheck check;
+    SeahorseSignOptions options;
+} BulkSignData;
+
+static gboolean
+bulk_prepare_sign (SeahorseGpgmeKey *pkey,
+                   void             *data,
+                   KeyOp            *op,
+                   GError          **error)
 {
-    PrimaryParm pri_parm;
-    SeahorseEditParm *parms;
-    gpgme_key_t key;
+    BulkSignData *sign_data = data;
 
-    g_return_val_if_fail (SEAHORSE_IS_GPGME_PHOTO (photo), GPG_E (GPG_ERR_WRONG_KEY_USAGE));
+    sign_key_op (op, seahorse_gpgme_key_get_public (pkey), sign_data->signer,
+                 0, NULL, sign_data->check, sign_data->options);
+    return TRUE;
+}
 
-    key = seahorse_gpgme_photo_get_pubkey (photo);
-    g_return_val_if_fail (key, GPG_E (GPG_ERR_INV_VALUE));
+/**
+ * seahorse_gpgme_key_op_sign_keys_async:
+ * @keys: (element-type SeahorseGpgmeKey): The keys to sign
+ * @signer: The key to sign with
+ * @check: How carefully the keys were checked
+ * @options: Options for the signatures
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: Called when done
+ * @user_data: Data for @callback
+ *
+ * Signs all the user IDs of all the @keys. Finish with
+ * seahorse_gpgme_key_op_bulk_finish().
+ */
+void
+seahorse_gpgme_key_op_sign_keys_async (GPtrArray           *keys,
+                                       SeahorseGpgmeKey    *signer,
+                                       SeahorseSignCheck    check,
+                                       SeahorseSignOptions  options,
+                                       GCancellable        *cancellable,
+                                       GAsyncReadyCallback  callback,
+                                       void                *user_data)
+{
+    BulkSignData *sign_data;
+    gpgme_key_t signing_key;
 
-    pri_parm.index = seahorse_gpgme_photo_get_index (photo);
+    g_return_if_fail (keys != NULL);
+    g_return_if_fail (SEAHORSE_GPGME_IS_KEY (signer));
 
-    parms = seahorse_edit_parm_new (PRIMARY_START, primary_action,
-                                    primary_transit, &pri_parm);
+    signing_key = seahorse_gpgme_key_get_private (signer);
+    g_return_if_fail (signing_key);
+
+    sign_data = g_new0 (BulkSignData, 1);
+    sign_data->signer = signing_key;
+    sign_data->check = check;
+    sign_data->options = options;
+
+    bulk_edit_async (keys, signing_key, bulk_prepare_sign, sign_data, g_free,
+                     cancellable, callback, user_data);
+}
+
+static gboolean
+bulk_prepare_trust (SeahorseGpgmeKey *pkey,
+                    void             *data,
+                    KeyOp            *op,
+                    GError          **error)
+{
+    SeahorseValidity trust = GPOINTER_TO_INT (data);
+    gboolean is_private;
+
+    if (seahorse_gpgme_key_get_trust (pkey) == trust)
+        return FALSE;
+
+    /* Same rules as the trust combo in the key properties */
+    is_private = seahorse_object_get_usage (SEAHORSE_OBJECT (pkey)) == SEAHORSE_USAGE_PRIVATE_KEY;
+    if ((is_private && trust == SEAHORSE_VALIDITY_UNKNOWN) ||
+        (!is_private && trust == SEAHORSE_VALIDITY_ULTIMATE)) {
+        g_set_error_literal (error, SEAHORSE_GPGME_ERROR, GPG_ERR_INV_VALUE,
+                             _("This trust level can’t be set on this key"));
+        return FALSE;
+    }
+
+    op->data = GINT_TO_POINTER (trust_menu_choice (trust));
+    op->parms = seahorse_edit_parm_new (TRUST_START, edit_trust_action,
+                                        edit_trust_transit, op->data);
+    return TRUE;
+}
+
+/**
+ * seahorse_gpgme_key_op_set_trust_keys_async:
+ * @keys: (element-type SeahorseGpgmeKey): The keys to change
+ * @trust: The new owner trust
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: Called when done
+ * @user_data: Data for @callback
+ *
+ * Sets the owner trust of all the @keys. Keys that already have that trust
+ * are left alone. Finish with seahorse_gpgme_key_op_bulk_finish().
+ */
+void
+seahorse_gpgme_key_op_set_trust_keys_async (GPtrArray           *keys,
+                                            SeahorseValidity     trust,
+                                            GCancellable        *cancellable,
+                                            GAsyncReadyCallback  callback,
+                                            void                *user_data)
+{
+    g_return_if_fail (keys != NULL);
+    g_return_if_fail (trust >= SEAHORSE_VALIDITY_NEVER);
 
-    return edit_refresh_gpgme_key (NULL, key, parms);
+    bulk_edit_async (keys, NULL, bulk_prepare_trust, GINT_TO_POINTER (trust), NULL,
+                     cancellable, callback, user_data);
+}
+
+static gboolean
+bulk_prepare_expires (SeahorseGpgmeKey *pkey,
+                      void             *data,
+                      KeyOp            *op,
+                      GError          **error)
+{
+    GDateTime *expires = data;
+    gpgme_key_t key;
+    gint64 new_expires;
+
+    /* Only the primary key, which is what gpg selects by default */
+    key = seahorse_gpgme_key_get_public (pkey);
+    new_expires = expires ? g_date_time_to_unix (expires) : 0;
+    if (key->subkeys && key->subkeys->expires == new_expires)
+        return FALSE;
+
+    expire_key_op (op, key, 0, expires);
+    return TRUE;
+}
+
+/**
+ * seahorse_gpgme_key_op_set_expires_keys_async:
+ * @keys: (element-type SeahorseGpgmeKey): The keys to change
+ * @expires: (nullable): The new expiry date, or %NULL for none
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: Called when done
+ * @user_data: Data for @callback
+ *
+ * Sets the expiry date of the primary key of all the @keys. Finish with
+ * seahorse_gpgme_key_op_bulk_finish().
+ */
+void
+seahorse_gpgme_key_op_set_expires_keys_async (GPtrArray           *keys,
+                                              GDateTime           *expires,
+                                              GCancellable        *cancellable,
+                                              GAsyncReadyCallback  callback,
+                                              void                *user_data)
+{
+    g_return_if_fail (keys != NULL);
+
+    bulk_edit_async (keys, NULL, bulk_prepare_expires,
+                     expires ? g_date_time_ref (expires) : NULL,
+                     (GDestroyNotify) g_date_time_unref,
+                     cancellable, callback, user_data);
 }
@@ -80,15 +80,53 @@ gpgme_error_t         seahorse_gpgme_key_op_delete           (SeahorseGpgmeKey *
 
 gpgme_error_t         seahorse_gpgme_key_op_delete_pair      (SeahorseGpgmeKey *pkey);
 
-gpgme_error_t         seahorse_gpgme_key_op_sign             (SeahorseGpgmeKey *key,
-                                                              SeahorseGpgmeKey *signer,
-                                                              SeahorseSignCheck check,
-                                                              SeahorseSignOptions options);
+void                  seahorse_gpgme_key_op_sign_async       (SeahorseGpgmeKey    *pkey,
+                                                              SeahorseGpgmeKey    *signer,
+                                                              SeahorseSignCheck    check,
+                                                              SeahorseSignOptions  options,
+                                                              GCancellable        *cancellable,
+                                                              GAsyncReadyCallback  callback,
+                                                              void                *user_data);
 
-gpgme_error_t         seahorse_gpgme_key_op_sign_uid         (SeahorseGpgmeUid    *uid,
+gboolean              seahorse_gpgme_key_op_sign_finish      (SeahorseGpgmeKey *pkey,
+                                                              GAsyncResult     *result,
+                                                              GError          **error);
+
+void                  seahorse_gpgme_key_op_sign_uid_async   (SeahorseGpgmeUid    *uid,
                                                               SeahorseGpgmeKey    *signer,
                                                               SeahorseSignCheck    check,
-                                                              SeahorseSignOptions  options);
+                                                              SeahorseSignOptions  options,
+                                                              GCancellable        *cancellable,
+                                                              GAsyncReadyCallback  callback,
+                                                              void                *user_data);
+
+gboolean              seahorse_gpgme_key_op_sign_uid_finish  (SeahorseGpgmeUid *uid,
+                                                              GAsyncResult     *result,
+                                                              GError          **error);
+
+void                  seahorse_gpgme_key_op_sign_keys_async  (GPtrArray           *keys,
+                                                              SeahorseGpgmeKey    *signer,
+                                                              SeahorseSignCheck    check,
+                                                              SeahorseSignOptions  options,
+                                                              GCancellable        *cancellable,
+                                                              GAsyncReadyCallback  callback,
+                                                              void                *user_data);
+
+void             seahorse_gpgme_key_op_set_trust_keys_async  (GPtrArray           *keys,
+                                                              SeahorseValidity     trust,
+                                                              GCancellable        *cancellable,
+                                                              GAsyncReadyCallback  callback,
+                                                              void                *user_data);
+
+void           seahorse_gpgme_key_op_set_expires_keys_async  (GPtrArray           *keys,
+                                                              GDateTime           *expires,
+                                                              GCancellable        *cancellable,
+                                                              GAsyncReadyCallback  callback,
+                                                              void                *user_data);
+
+gboolean              seahorse_gpgme_key_op_bulk_finish      (GAsyncResult  *result,
+                                                              GHashTable   **failures,
+                                                              GError       **error);
 
 void                 seahorse_gpgme_key_op_change_pass_async (SeahorseGpgmeKey *pkey,
                                                               GCancellable *cancellable,
@@ -99,17 +137,45 @@ gboolean            seahorse_gpgme_key_op_change_pass_finish (SeahorseGpgmeKey *
                                                               GAsyncResult *Result,
                                                               GError **error);
 
-gpgme_error_t         seahorse_gpgme_key_op_set_trust        (SeahorseGpgmeKey *pkey,
-                                                              SeahorseValidity validity);
+void                  seahorse_gpgme_key_op_set_trust_async  (SeahorseGpgmeKey    *pkey,
+                                                              SeahorseValidity     trust,
+                                                              GCancellable        *cancellable,
+                                                              GAsyncReadyCallback  callback,
+                                                              void                *user_data);
 
-gpgme_error_t         seahorse_gpgme_key_op_set_disabled     (SeahorseGpgmeKey *pkey,
-                                                              gboolean disabled);
+gboolean              seahorse_gpgme_key_op_set_trust_finish (SeahorseGpgmeKey *pkey,
+                                                              GAsyncResult     *result,
+                                                              GError          **error);
 
-gpgme_error_t         seahorse_gpgme_key_op_set_expires      (SeahorseGpgmeSubkey *subkey,
-                                                              GDateTime           *expires);
+void               seahorse_gpgme_key_op_set_disabled_async  (SeahorseGpgmeKey    *pkey,
+                                                              gboolean             disabled,
+                                                              GCancellable        *cancellable,
+                                                              GAsyncReadyCallback  callback,
+                                                              void                *user_data);
 
-gpgme_error_t         seahorse_gpgme_key_op_add_revoker      (SeahorseGpgmeKey *pkey,
-                                                              SeahorseGpgmeKey *revoker);
+gboolean           seahorse_gpgme_key_op_set_disabled_finish (SeahorseGpgmeKey *pkey,
+                                                              GAsyncResult     *result,
+                                                              GError          **error);
+
+void                seahorse_gpgme_key_op_set_expires_async  (SeahorseGpgmeSubkey *subkey,
+                                                              GDateTime           *expires,
+                                                              GCancellable        *cancellable,
+                                                              GAsyncReadyCallback  callback,
+                                                              void                *user_data);
+
+gboolean            seahorse_gpgme_key_op_set_expires_finish (SeahorseGpgmeSubkey *subkey,
+                                                              GAsyncResult        *result,
+                                                              GError             **error);
+
+void                seahorse_gpgme_key_op_add_revoker_async  (SeahorseGpgmeKey    *pkey,
+                                                              SeahorseGpgmeKey    *revoker,
+                                                              GCancellable        *cancellable,
+                                                              GAsyncReadyCallback  callback,
+                                                              void                *user_data);
+
+gboolean            seahorse_gpgme_key_op_add_revoker_finish (SeahorseGpgmeKey *pkey,
+                                                              GAsyncResult     *result,
+                                                              GError          **error);
 
 void                  seahorse_gpgme_key_op_add_uid_async    (SeahorseGpgmeKey    *pkey,
                                                               const char          *name,
@@ -132,7 +198,14 @@ gboolean          seahorse_gpgme_key_op_make_primary_finish (SeahorseGpgmeUid *u
                                                              GAsyncResult *result,
                                                              GError **error);
 
-gpgme_error_t         seahorse_gpgme_key_op_del_uid          (SeahorseGpgmeUid *uid);
+void                  seahorse_gpgme_key_op_del_uid_async    (SeahorseGpgmeUid    *uid,
+                                                              GCancellable        *cancellable,
+                                                              GAsyncReadyCallback  callback,
+                                                              void                *user_data);
+
+gboolean              seahorse_gpgme_key_op_del_uid_finish   (SeahorseGpgmeUid *uid,
+                                                              GAsyncResult     *result,
+                                                              GError          **error);
 
 void              seahorse_gpgme_key_op_add_subkey_async    (SeahorseGpgmeKey     *pkey,
                                                              SeahorseKeyEncType    type,
@@ -146,17 +219,55 @@ gboolean          seahorse_gpgme_key_op_add_subkey_finish   (SeahorseGpgmeKey *p
                                                              GAsyncResult *result,
                                                              GError **error);
 
-gpgme_error_t         seahorse_gpgme_key_op_del_subkey       (SeahorseGpgmeSubkey *subkey);
+void                 seahorse_gpgme_key_op_del_subkey_async  (SeahorseGpgmeSubkey *subkey,
+                                                              GCancellable        *cancellable,
+                                                              GAsyncReadyCallback  callback,
+                                                              void                *user_data);
+
+gboolean             seahorse_gpgme_key_op_del_subkey_finish (SeahorseGpgmeSubkey *subkey,
+                                                              GAsyncResult        *result,
+                                                              GError             **error);
 
-gpgme_error_t         seahorse_gpgme_key_op_revoke_subkey    (SeahorseGpgmeSubkey *subkey,
-                                                              SeahorseRevokeReason reason,
-                                                              const gchar *description);
+void              seahorse_gpgme_key_op_revoke_subkey_async  (SeahorseGpgmeSubkey  *subkey,
+                                                              SeahorseRevokeReason  reason,
+                                                              const char           *description,
+                                                              GCancellable         *cancellable,
+                                                              GAsyncReadyCallback   callback,
+                                                              void                 *user_data);
+
+gboolean          seahorse_gpgme_key_op_revoke_subkey_finish (SeahorseGpgmeSubkey *subkey,
+                                                              GAsyncResult        *result,
+                                                              GError             **error);
+
+void                  seahorse_gpgme_key_op_photo_add_async  (SeahorseGpgmeKey    *pkey,
+                                                              const char          *filename,
+                                                              GCancellable        *cancellable,
+                                                              GAsyncReadyCallback  callback,
+                                                              void                *user_data);
+
+gboolean              seahorse_gpgme_key_op_photo_add_finish (SeahorseGpgmeKey *pkey,
+                                                              GAsyncResult     *result,
+                                                              GError          **error);
 
-gpgme_error_t         seahorse_gpgme_key_op_photo_add        (SeahorseGpgmeKey *pkey,
-                                                              const gchar *filename);
+void               seahorse_gpgme_key_op_photo_delete_async  (SeahorseGpgmePhoto  *photo,
+                                                              GCancellable        *cancellable,
+                                                              GAsyncReadyCallback  callback,
+                                                              void                *user_data);
 
-gpgme_error_t         seahorse_gpgme_key_op_photo_delete     (SeahorseGpgmePhoto *photo);
+gboolean           seahorse_gpgme_key_op_photo_delete_finish (SeahorseGpgmePhoto *photo,
+                                                              GAsyncResult       *result,
+                                                              GError            **error);
 
 gpgme_error_t         seahorse_gpgme_key_op_photos_load      (SeahorseGpgmeKey *key);
 
-gpgme_error_t         seahorse_gpgme_key_op_photo_primary    (SeahorseGpgmePhoto *photo);
+GPtrArray *           seahorse_gpgme_key_op_photos_decode    (gpgme_key_t  key,
+                                                              GPtrArray   *packets);
+
+void              seahorse_gpgme_key_op_photo_primary_async  (SeahorseGpgmePhoto  *photo,
+                                                              GCancellable        *cancellable,
+                                                              GAsyncReadyCallback  callback,
+                                                              void                *user_data);
+
+gboolean          seahorse_gpgme_key_op_photo_primary_finish (SeahorseGpgmePhoto *photo,
+                                                              GAsyncResult       *result,
+                                                              GError            **error);
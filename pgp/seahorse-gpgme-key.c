@@ -29,11 +29,14 @@
 #include "seahorse-gpgme-uid.h"
 #include "seahorse-pgp-backend.h"
 #include "seahorse-pgp-key.h"
+#include "seahorse-pgp-subkey.h"
 
 #include "seahorse-common.h"
 
 #include "libseahorse/seahorse-util.h"
 
+#include <gcr/gcr.h>
+
 #include <glib/gi18n.h>
 
 #include <string.h>
@@ -57,6 +60,8 @@ struct _SeahorseGpgmeKey {
     gboolean photos_loaded;      /* Photos were loaded */
 
     int block_loading;           /* Loading is blocked while this flag is set */
+
+    SeahorseGpgmeSnapshotKey *snapshot;  /* What we show until the key is loaded */
 };
 
 static void       seahorse_gpgme_key_deletable_iface       (SeahorseDeletableIface *iface);
@@ -77,7 +82,7 @@ load_gpgme_key (const gchar *keyid,
     gpgme_ctx_t ctx;
     gpgme_error_t gerr;
 
-    ctx = seahorse_gpgme_keyring_new_context (&gerr);
+    ctx = seahorse_gpgme_keyring_acquire_context ("load-key", &gerr);
     if (gerr != 0)
         return FALSE;
 
@@ -88,7 +93,7 @@ load_gpgme_key (const gchar *keyid,
         gpgme_op_keylist_end (ctx);
     }
 
-    gpgme_release (ctx);
+    seahorse_gpgme_keyring_release_context (ctx);
 
     if (seahorse_gpgme_propagate_error (gerr, &error)) {
         g_message ("couldn't load GPGME key: %s", error->message);
@@ -99,6 +104,8 @@ load_gpgme_key (const gchar *keyid,
     return TRUE;
 }
 
+static void       load_key_private         (SeahorseGpgmeKey *self);
+
 static void
 load_key_public (SeahorseGpgmeKey *self, int list_mode)
 {
@@ -115,6 +122,11 @@ load_key_public (SeahorseGpgmeKey *self, int list_mode)
     ret = load_gpgme_key (keyid, list_mode, FALSE, &key);
     if (ret) {
         self->list_mode = list_mode;
+
+        /* A key from the snapshot might be a personal key */
+        if (self->has_secret && !self->seckey)
+            load_key_private (self);
+
         seahorse_gpgme_key_set_public (self, key);
         gpgme_key_unref (key);
     }
@@ -154,6 +166,392 @@ require_key_private (SeahorseGpgmeKey *self)
     return self->seckey != NULL;
 }
 
+/*
+ * Lazy loads which are requested asynchronously are coalesced: everything
+ * that was asked for during one main loop iteration gets resolved by a
+ * worker thread, with one keylist operation per list mode.
+ */
+#define LOADER_MAX_PATTERNS 256
+
+typedef struct {
+    int list_mode;
+    gboolean refresh;           /* Load again, even if we have it already */
+} LoadRequest;
+
+typedef struct _LoadBatch {
+    GPtrArray *tasks;           /* One GTask per caller */
+    GHashTable *keys;           /* keyid -> SeahorseGpgmeKey */
+    GHashTable *modes;          /* keyid -> list mode to load the public key with */
+    GHashTable *secret;         /* keyids of the secret keys to load */
+    GHashTable *by_mode;        /* list mode -> GPtrArray of keyids */
+    GPtrArray *secret_keyids;
+    GHashTable *public_keys;    /* keyid -> gpgme_key_t, filled by the worker */
+    GHashTable *secret_keys;    /* keyid -> gpgme_key_t, filled by the worker */
+} LoadBatch;
+
+static GPtrArray *pending_loads = NULL;
+static unsigned int pending_loads_id = 0;
+
+static void
+load_batch_free (void *data)
+{
+    LoadBatch *batch = data;
+
+    g_ptr_array_unref (batch->tasks);
+    g_hash_table_unref (batch->keys);
+    g_hash_table_unref (batch->modes);
+    g_hash_table_unref (batch->secret);
+    g_hash_table_unref (batch->by_mode);
+    g_ptr_array_unref (batch->secret_keyids);
+    g_hash_table_unref (batch->public_keys);
+    g_hash_table_unref (batch->secret_keys);
+    g_free (batch);
+}
+
+static gpgme_error_t
+list_keys_into (gpgme_ctx_t  ctx,
+                GPtrArray   *keyids,
+                int          list_mode,
+                gboolean     secret,
+                GHashTable  *results)
+{
+    gpgme_error_t gerr = GPG_OK;
+
+    gpgme_set_keylist_mode (ctx, list_mode);
+
+    for (unsigned int i = 0; i < keyids->len && GPG_IS_OK (gerr); i += LOADER_MAX_PATTERNS) {
+        g_autofree const char **patterns = NULL;
+        unsigned int n_patterns;
+        gpgme_key_t key;
+
+        n_patterns = MIN (keyids->len - i, LOADER_MAX_PATTERNS);
+        patterns = g_new0 (const char *, n_patterns + 1);
+        for (unsigned int j = 0; j < n_patterns; j++)
+            patterns[j] = g_ptr_array_index (keyids, i + j);
+
+        gerr = gpgme_op_keylist_ext_start (ctx, patterns, secret, 0);
+        while (GPG_IS_OK (gerr)) {
+            gerr = gpgme_op_keylist_next (ctx, &key);
+            if (!GPG_IS_OK (gerr))
+                break;
+            if (key->subkeys && key->subkeys->keyid)
+                g_hash_table_replace (results, g_strdup (key->subkeys->keyid), key);
+            else
+                gpgme_key_unref (key);
+        }
+
+        if (gpgme_err_code (gerr) == GPG_ERR_EOF)
+            gerr = GPG_OK;
+        gpgme_op_keylist_end (ctx);
+    }
+
+    return gerr;
+}
+
+static void
+load_batch_thread (GTask        *task,
+                   void         *source_object,
+                   void         *task_data,
+                   GCancellable *cancellable)
+{
+    LoadBatch *batch = task_data;
+    g_autoptr(GError) error = NULL;
+    GHashTableIter iter;
+    void *mode, *keyids;
+    gpgme_error_t gerr;
+    gpgme_ctx_t ctx;
+
+    ctx = seahorse_gpgme_keyring_acquire_context ("lazy-load", &gerr);
+    if (ctx == NULL) {
+        seahorse_gpgme_propagate_error (gerr, &error);
+        g_task_return_error (task, g_steal_pointer (&error));
+        return;
+    }
+
+    gerr = GPG_OK;
+    if (batch->secret_keyids->len > 0)
+        gerr = list_keys_into (ctx, batch->secret_keyids, GPGME_KEYLIST_MODE_LOCAL,
+                               TRUE, batch->secret_keys);
+
+    g_hash_table_iter_init (&iter, batch->by_mode);
+    while (GPG_IS_OK (gerr) && g_hash_table_iter_next (&iter, &mode, &keyids))
+        gerr = list_keys_into (ctx, keyids, GPOINTER_TO_INT (mode),
+                               FALSE, batch->public_keys);
+
+    seahorse_gpgme_keyring_release_context (ctx);
+
+    if (seahorse_gpgme_propagate_error (gerr, &error))
+        g_task_return_error (task, g_steal_pointer (&error));
+    else
+        g_task_return_boolean (task, TRUE);
+}
+
+static gboolean
+has_key_loaded (SeahorseGpgmeKey *self, int list_mode)
+{
+    return self->pubkey && (self->list_mode & list_mode) == list_mode &&
+           (!self->has_secret || self->seckey);
+}
+
+static void
+on_load_batch_done (GObject      *source,
+                    GAsyncResult *result,
+                    void         *user_data)
+{
+    LoadBatch *batch = g_task_get_task_data (G_TASK (result));
+    g_autoptr(GError) error = NULL;
+    GHashTableIter iter;
+    void *keyid, *value;
+
+    if (!g_task_propagate_boolean (G_TASK (result), &error))
+        g_message ("couldn't load GPGME keys: %s", error->message);
+
+    /* Secret keys go first, so the public key is realized as personal */
+    g_hash_table_iter_init (&iter, batch->keys);
+    while (g_hash_table_iter_next (&iter, &keyid, &value)) {
+        SeahorseGpgmeKey *self = value;
+        gpgme_key_t key;
+
+        key = g_hash_table_lookup (batch->secret_keys, keyid);
+        if (key != NULL)
+            seahorse_gpgme_key_set_private (self, key);
+
+        key = g_hash_table_lookup (batch->public_keys, keyid);
+        if (key != NULL) {
+            self->list_mode = GPOINTER_TO_INT (g_hash_table_lookup (batch->modes, keyid));
+            seahorse_gpgme_key_set_public (self, key);
+        }
+    }
+
+    for (unsigned int i = 0; i < batch->tasks->len; i++) {
+        GTask *task = g_ptr_array_index (batch->tasks, i);
+        SeahorseGpgmeKey *self = g_task_get_source_object (task);
+        LoadRequest *request = g_task_get_task_data (task);
+        int list_mode = request->list_mode;
+
+        if (g_task_return_error_if_cancelled (task))
+            continue;
+
+        if (self->pubkey && (self->list_mode & list_mode) == list_mode)
+            g_task_return_boolean (task, TRUE);
+        else if (error != NULL)
+            g_task_return_error (task, g_error_copy (error));
+        else
+            g_task_return_new_error (task, SEAHORSE_GPGME_ERROR, GPG_ERR_NO_PUBKEY,
+                                     _("Couldn’t find the key %s"),
+                                     seahorse_pgp_key_get_keyid (SEAHORSE_PGP_KEY (self)));
+    }
+}
+
+static gboolean
+on_flush_pending_loads (void *user_data)
+{
+    g_autoptr(GTask) task = NULL;
+    GHashTableIter iter;
+    void *keyid, *value;
+    LoadBatch *batch;
+
+    pending_loads_id = 0;
+
+    batch = g_new0 (LoadBatch, 1);
+    batch->tasks = g_steal_pointer (&pending_loads);
+    batch->keys = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+    batch->modes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    batch->secret = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    batch->public_keys = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                g_free, (GDestroyNotify) gpgme_key_unref);
+    batch->secret_keys = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                g_free, (GDestroyNotify) gpgme_key_unref);
+
+    /* Every key is listed once, in all the modes that were asked for */
+    for (unsigned int i = 0; i < batch->tasks->len; i++) {
+        GTask *caller = g_ptr_array_index (batch->tasks, i);
+        SeahorseGpgmeKey *self = g_task_get_source_object (caller);
+        LoadRequest *request = g_task_get_task_data (caller);
+        int list_mode = request->list_mode;
+        const char *id;
+
+        /* Not worth listing any more, it's failed once the batch is done */
+        if (g_cancellable_is_cancelled (g_task_get_cancellable (caller)))
+            continue;
+
+        id = seahorse_pgp_key_get_keyid (SEAHORSE_PGP_KEY (self));
+        list_mode |= self->list_mode |
+                     GPOINTER_TO_INT (g_hash_table_lookup (batch->modes, id));
+
+        g_hash_table_replace (batch->keys, g_strdup (id), g_object_ref (self));
+        g_hash_table_replace (batch->modes, g_strdup (id), GINT_TO_POINTER (list_mode));
+
+        if ((self->has_secret && !self->seckey) || (request->refresh && self->seckey))
+            g_hash_table_add (batch->secret, g_strdup (id));
+    }
+
+    /* Group the keys by the list mode they need */
+    batch->by_mode = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                            NULL, (GDestroyNotify) g_ptr_array_unref);
+    batch->secret_keyids = g_ptr_array_new ();
+    g_hash_table_iter_init (&iter, batch->keys);
+    while (g_hash_table_iter_next (&iter, &keyid, &value)) {
+        SeahorseGpgmeKey *self = value;
+        void *mode = g_hash_table_lookup (batch->modes, keyid);
+        GPtrArray *keyids;
+
+        keyids = g_hash_table_lookup (batch->by_mode, mode);
+        if (keyids == NULL) {
+            keyids = g_ptr_array_new ();
+            g_hash_table_insert (batch->by_mode, mode, keyids);
+        }
+        g_ptr_array_add (keyids, keyid);
+
+        if (g_hash_table_contains (batch->secret, keyid))
+            g_ptr_array_add (batch->secret_keyids, keyid);
+    }
+
+    g_debug ("loading %u GPGME keys in one go", g_hash_table_size (batch->keys));
+
+    task = g_task_new (NULL, NULL, on_load_batch_done, NULL);
+    g_task_set_source_tag (task, on_flush_pending_loads);
+    g_task_set_task_data (task, batch, load_batch_free);
+    g_task_run_in_thread (task, load_batch_thread);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* Adds a load to the batch that runs on the next idle */
+static void
+queue_load (SeahorseGpgmeKey    *self,
+            int                  list_mode,
+            gboolean             refresh,
+            GCancellable        *cancellable,
+            GAsyncReadyCallback  callback,
+            void                *user_data)
+{
+    g_autoptr(GTask) task = NULL;
+    LoadRequest *request;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_set_source_tag (task, seahorse_gpgme_key_load_async);
+    request = g_new0 (LoadRequest, 1);
+    request->list_mode = list_mode;
+    request->refresh = refresh;
+    g_task_set_task_data (task, request, g_free);
+
+    if (self->block_loading || (!refresh && has_key_loaded (self, list_mode))) {
+        g_task_return_boolean (task, TRUE);
+        return;
+    }
+
+    if (pending_loads == NULL)
+        pending_loads = g_ptr_array_new_with_free_func (g_object_unref);
+    g_ptr_array_add (pending_loads, g_steal_pointer (&task));
+
+    if (pending_loads_id == 0)
+        pending_loads_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE,
+                                            on_flush_pending_loads, NULL, NULL);
+}
+
+/**
+ * seahorse_gpgme_key_load_async:
+ * @self: A key
+ * @list_mode: The keylist mode the public key should be loaded with
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: Called when the key is loaded
+ * @user_data: Data for @callback
+ *
+ * Makes sure the public key is loaded with at least @list_mode, as well as
+ * the secret key if there is one. Unlike the synchronous getters, this
+ * doesn't run gpg right away: all keys that are requested during the same
+ * main loop iteration are loaded together.
+ */
+void
+seahorse_gpgme_key_load_async (SeahorseGpgmeKey    *self,
+                               int                  list_mode,
+                               GCancellable        *cancellable,
+                               GAsyncReadyCallback  callback,
+                               void                *user_data)
+{
+    g_return_if_fail (SEAHORSE_GPGME_IS_KEY (self));
+
+    queue_load (self, list_mode, FALSE, cancellable, callback, user_data);
+}
+
+/**
+ * seahorse_gpgme_key_refresh_async:
+ * @self: A key
+ * @list_mode: The keylist mode the public key should be loaded with
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: Called when the key is loaded
+ * @user_data: Data for @callback
+ *
+ * Like seahorse_gpgme_key_load_async(), but loads the public key (and the
+ * secret key, if there is one) again even if we already have them, eg: to
+ * show a key that might have changed behind our back. Finish with
+ * seahorse_gpgme_key_load_finish().
+ */
+void
+seahorse_gpgme_key_refresh_async (SeahorseGpgmeKey    *self,
+                                  int                  list_mode,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  void                *user_data)
+{
+    g_return_if_fail (SEAHORSE_GPGME_IS_KEY (self));
+
+    queue_load (self, list_mode, TRUE, cancellable, callback, user_data);
+}
+
+gboolean
+seahorse_gpgme_key_load_finish (SeahorseGpgmeKey *self,
+                                GAsyncResult     *result,
+                                GError          **error)
+{
+    g_return_val_if_fail (g_task_is_valid (result, self), FALSE);
+
+    return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/**
+ * seahorse_gpgme_key_set_photos:
+ * @self: A key
+ * @photos: (element-type SeahorseGpgmePhoto) (nullable): The new photos
+ *
+ * Replaces all the photos of the key at once. Photos without an image get a
+ * placeholder icon.
+ */
+void
+seahorse_gpgme_key_set_photos (SeahorseGpgmeKey *self,
+                               GPtrArray        *photos)
+{
+    GListModel *model;
+    unsigned int n_old;
+
+    g_return_if_fail (SEAHORSE_GPGME_IS_KEY (self));
+
+    self->photos_loaded = TRUE;
+
+    model = seahorse_pgp_key_get_photos (SEAHORSE_PGP_KEY (self));
+    n_old = g_list_model_get_n_items (model);
+    if (n_old == 0 && (photos == NULL || photos->len == 0))
+        return;
+
+    for (unsigned int i = 0; photos && i < photos->len; i++) {
+        SeahorsePgpPhoto *photo = g_ptr_array_index (photos, i);
+        g_autoptr(GdkPixbuf) pixbuf = NULL;
+
+        if (seahorse_pgp_photo_get_pixbuf (photo) != NULL)
+            continue;
+
+        /* Load a 'missing' icon */
+        pixbuf = gtk_icon_theme_load_icon (gtk_icon_theme_get_default (),
+                                           "gnome-unknown", 48, 0, NULL);
+        seahorse_pgp_photo_set_pixbuf (photo, pixbuf);
+    }
+
+    g_list_store_splice (G_LIST_STORE (model), 0, n_old,
+                         photos ? photos->pdata : NULL,
+                         photos ? photos->len : 0);
+}
+
 static void
 load_key_photos (SeahorseGpgmeKey *self)
 {
@@ -165,8 +563,6 @@ load_key_photos (SeahorseGpgmeKey *self)
     gerr = seahorse_gpgme_key_op_photos_load (self);
     if (!GPG_IS_OK (gerr))
         g_message ("couldn't load key photos: %s", gpgme_strerror (gerr));
-    else
-        self->photos_loaded = TRUE;
 }
 
 static void
@@ -293,6 +689,47 @@ realize_subkeys (SeahorseGpgmeKey *self)
                          results->pdata, results->len);
 }
 
+/* Shows what the snapshot remembered, without asking gpg about the key */
+static void
+realize_snapshot (SeahorseGpgmeKey *self)
+{
+    SeahorseGpgmeSnapshotKey *snapshot = self->snapshot;
+    g_autoptr(SeahorsePgpSubkey) subkey = NULL;
+    g_autoptr(GDateTime) created = NULL;
+    g_autoptr(GDateTime) expires = NULL;
+    g_autoptr(GIcon) icon = NULL;
+
+    subkey = seahorse_pgp_subkey_new ();
+    seahorse_pgp_subkey_set_keyid (subkey, snapshot->keyid);
+    seahorse_pgp_subkey_set_fingerprint (subkey, snapshot->fingerprint);
+    seahorse_pgp_subkey_set_algorithm (subkey, snapshot->algo);
+    seahorse_pgp_subkey_set_length (subkey, snapshot->length);
+    if (snapshot->created > 0) {
+        created = g_date_time_new_from_unix_utc (snapshot->created);
+        seahorse_pgp_subkey_set_created (subkey, created);
+    }
+    if (snapshot->expires > 0) {
+        expires = g_date_time_new_from_unix_utc (snapshot->expires);
+        seahorse_pgp_subkey_set_expires (subkey, expires);
+    }
+    seahorse_pgp_key_add_subkey (SEAHORSE_PGP_KEY (self), subkey);
+
+    if (snapshot->usage == SEAHORSE_USAGE_PRIVATE_KEY)
+        icon = g_themed_icon_new (GCR_ICON_KEY_PAIR);
+    else
+        icon = g_themed_icon_new (GCR_ICON_KEY);
+
+    g_object_set (self,
+                  "usage", snapshot->usage,
+                  "object-flags", snapshot->flags,
+                  "label", snapshot->label,
+                  "markup", snapshot->markup,
+                  "nickname", snapshot->nickname,
+                  "identifier", seahorse_pgp_key_calc_identifier (snapshot->keyid),
+                  "icon", icon,
+                  NULL);
+}
+
 void
 seahorse_gpgme_key_realize (SeahorseGpgmeKey *self)
 {
@@ -364,7 +801,7 @@ seahorse_gpgme_key_ensure_signatures (SeahorseGpgmeKey *self)
 void
 seahorse_gpgme_key_refresh (SeahorseGpgmeKey *self)
 {
-    if (self->pubkey)
+    if (self->pubkey || self->snapshot)
         load_key_public (self, self->list_mode);
     if (self->seckey)
         load_key_private (self);
@@ -376,7 +813,7 @@ static SeahorseDeleter *
 seahorse_gpgme_key_create_deleter (SeahorseDeletable *deletable)
 {
     SeahorseGpgmeKey *self = SEAHORSE_GPGME_KEY (deletable);
-    if (self->seckey)
+    if (require_key_private (self))
         return seahorse_gpgme_secret_deleter_new (self);
     else
         return seahorse_gpgme_key_deleter_new (self);
@@ -447,6 +884,7 @@ seahorse_gpgme_key_set_public (SeahorseGpgmeKey *self, gpgme_key_t key)
     if (self->pubkey) {
         gpgme_key_ref (self->pubkey);
         self->list_mode |= self->pubkey->keylist_mode;
+        g_clear_pointer (&self->snapshot, seahorse_gpgme_snapshot_key_free);
     }
 
     obj = G_OBJECT (self);
@@ -494,6 +932,8 @@ seahorse_gpgme_key_get_validity (SeahorseGpgmeKey *self)
 {
     g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (self), SEAHORSE_VALIDITY_UNKNOWN);
 
+    if (!self->pubkey && self->snapshot)
+        return self->snapshot->validity;
     if (!require_key_public (self, GPGME_KEYLIST_MODE_LOCAL))
         return SEAHORSE_VALIDITY_UNKNOWN;
 
@@ -511,6 +951,9 @@ SeahorseValidity
 seahorse_gpgme_key_get_trust (SeahorseGpgmeKey *self)
 {
     g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (self), SEAHORSE_VALIDITY_UNKNOWN);
+
+    if (!self->pubkey && self->snapshot)
+        return self->snapshot->trust;
     if (!require_key_public (self, GPGME_KEYLIST_MODE_LOCAL))
         return SEAHORSE_VALIDITY_UNKNOWN;
 
@@ -624,6 +1067,7 @@ seahorse_gpgme_key_object_dispose (GObject *obj)
     if (self->seckey)
         gpgme_key_unref (self->seckey);
     self->pubkey = self->seckey = NULL;
+    g_clear_pointer (&self->snapshot, seahorse_gpgme_snapshot_key_free);
 
     G_OBJECT_CLASS (seahorse_gpgme_key_parent_class)->dispose (obj);
 }
@@ -677,3 +1121,78 @@ seahorse_gpgme_key_new (SeahorsePlace *sksrc,
                          "seckey", seckey,
                          NULL);
 }
+
+/**
+ * seahorse_gpgme_key_new_from_snapshot:
+ * @place: The keyring the key is in
+ * @snapshot: What the keyring snapshot remembered of the key
+ *
+ * Creates a key that shows what was remembered in a keyring snapshot. The
+ * actual key is only loaded from gpg once it is really needed, or the
+ * keyring sets it.
+ *
+ * Returns: (transfer full): The new key
+ */
+SeahorseGpgmeKey *
+seahorse_gpgme_key_new_from_snapshot (SeahorsePlace                  *place,
+                                      const SeahorseGpgmeSnapshotKey *snapshot)
+{
+    SeahorseGpgmeKey *self;
+
+    g_return_val_if_fail (snapshot != NULL, NULL);
+    g_return_val_if_fail (snapshot->keyid != NULL, NULL);
+
+    self = g_object_new (SEAHORSE_GPGME_TYPE_KEY, "place", place, NULL);
+    self->snapshot = seahorse_gpgme_snapshot_key_copy (snapshot);
+    self->has_secret = (snapshot->usage == SEAHORSE_USAGE_PRIVATE_KEY);
+    realize_snapshot (self);
+
+    return self;
+}
+
+/**
+ * seahorse_gpgme_key_to_snapshot:
+ * @self: A #SeahorseGpgmeKey
+ *
+ * Returns: (transfer full) (nullable): What a keyring snapshot should
+ *   remember of @self, or %NULL if nothing is loaded yet
+ */
+SeahorseGpgmeSnapshotKey *
+seahorse_gpgme_key_to_snapshot (SeahorseGpgmeKey *self)
+{
+    SeahorsePgpKey *pkey = SEAHORSE_PGP_KEY (self);
+    SeahorseGpgmeSnapshotKey *snapshot;
+    GDateTime *created, *expires;
+
+    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (self), NULL);
+
+    if (self->snapshot)
+        return seahorse_gpgme_snapshot_key_copy (self->snapshot);
+    if (!self->pubkey)
+        return NULL;
+
+    snapshot = g_new0 (SeahorseGpgmeSnapshotKey, 1);
+    snapshot->keyid = g_strdup (seahorse_pgp_key_get_keyid (pkey));
+    snapshot->fingerprint = g_strdup (seahorse_pgp_key_get_fingerprint (pkey));
+    snapshot->algo = g_strdup (seahorse_pgp_key_get_algo (pkey));
+    snapshot->length = seahorse_pgp_key_get_length (pkey);
+
+    created = seahorse_pgp_key_get_created (pkey);
+    snapshot->created = created ? g_date_time_to_unix (created) : 0;
+    expires = seahorse_pgp_key_get_expires (pkey);
+    snapshot->expires = expires ? g_date_time_to_unix (expires) : 0;
+
+    g_object_get (self,
+                  "label", &snapshot->label,
+                  "markup", &snapshot->markup,
+                  "nickname", &snapshot->nickname,
+                  "object-flags", &snapshot->flags,
+                  "usage", &snapshot->usage,
+                  NULL);
+    snapshot->validity = seahorse_gpgme_key_get_validity (self);
+    snapshot->trust = seahorse_gpgme_key_get_trust (self);
+    snapshot->n_subkeys = g_list_model_get_n_items (seahorse_pgp_key_get_subkeys (pkey));
+    snapshot->n_uids = g_list_model_get_n_items (seahorse_pgp_key_get_uids (pkey));
+
+    return snapshot;
+}
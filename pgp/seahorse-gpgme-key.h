@@ -23,6 +23,7 @@
 
 #include <gpgme.h>
 
+#include "seahorse-gpgme-snapshot.h"
 #include "seahorse-pgp-key.h"
 
 #define SEAHORSE_GPGME_TYPE_KEY (seahorse_gpgme_key_get_type ())
@@ -34,12 +35,36 @@ SeahorseGpgmeKey* seahorse_gpgme_key_new                 (SeahorsePlace *sksrc,
                                                           gpgme_key_t pubkey,
                                                           gpgme_key_t seckey);
 
+SeahorseGpgmeKey* seahorse_gpgme_key_new_from_snapshot   (SeahorsePlace                  *place,
+                                                          const SeahorseGpgmeSnapshotKey *snapshot);
+
+SeahorseGpgmeSnapshotKey * seahorse_gpgme_key_to_snapshot (SeahorseGpgmeKey *self);
+
 void              seahorse_gpgme_key_refresh              (SeahorseGpgmeKey *self);
 
 void              seahorse_gpgme_key_realize              (SeahorseGpgmeKey *self);
 
 void              seahorse_gpgme_key_ensure_signatures    (SeahorseGpgmeKey *self);
 
+void              seahorse_gpgme_key_load_async           (SeahorseGpgmeKey    *self,
+                                                           int                  list_mode,
+                                                           GCancellable        *cancellable,
+                                                           GAsyncReadyCallback  callback,
+                                                           void                *user_data);
+
+void              seahorse_gpgme_key_refresh_async        (SeahorseGpgmeKey    *self,
+                                                           int                  list_mode,
+                                                           GCancellable        *cancellable,
+                                                           GAsyncReadyCallback  callback,
+                                                           void                *user_data);
+
+gboolean          seahorse_gpgme_key_load_finish          (SeahorseGpgmeKey *self,
+                                                           GAsyncResult     *result,
+                                                           GError          **error);
+
+void              seahorse_gpgme_key_set_photos           (SeahorseGpgmeKey *self,
+                                                           GPtrArray        *photos);
+
 gpgme_key_t       seahorse_gpgme_key_get_public           (SeahorseGpgmeKey *self);
 
 void              seahorse_gpgme_key_set_public           (SeahorseGpgmeKey *self,
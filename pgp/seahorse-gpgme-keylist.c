@@ -0,0 +1,380 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#undef G_LOG_DOMAIN
+#define G_LOG_DOMAIN "operation"
+
+#include "seahorse-gpgme-keylist.h"
+
+#include "seahorse-gpgme.h"
+#include "seahorse-gpgme-keyring.h"
+
+/* Amount of keys the worker collects before handing them over */
+#define KEYLIST_BATCH_SIZE 50
+
+/* Amount of batches that may be waiting for the main thread */
+#define KEYLIST_MAX_QUEUED 8
+
+struct _SeahorseGpgmeKeylist {
+    int refs;
+
+    /* Set on construction, read-only afterwards */
+    char **patterns;
+    gboolean secret;
+    gpgme_keylist_mode_t mode;
+
+    /* Only touched on the main context */
+    GMainContext *context;
+    SeahorseGpgmeKeylistReadyFunc ready;
+    void *user_data;
+    GDestroyNotify destroy;
+
+    /* Protected by lock */
+    GMutex lock;
+    GCond space;
+    GQueue batches;                 /* Queue of GPtrArray of gpgme_key_t */
+    GSource *wakeup;                /* Pending dispatch on the main context */
+    gpgme_ctx_t gctx;               /* Context the worker is listing with */
+    gboolean cancelled;
+    gboolean done;
+    gpgme_error_t status;
+};
+
+/**
+ * seahorse_gpgme_keylist_new:
+ * @patterns: (nullable): The patterns to list, or %NULL for all keys
+ * @secret: Whether to list secret keys
+ * @mode: The keylist mode to use
+ *
+ * Prepares a key listing. Use seahorse_gpgme_keylist_start() to actually
+ * start listing on a worker thread.
+ *
+ * Returns: (transfer full): The new keylist
+ */
+SeahorseGpgmeKeylist *
+seahorse_gpgme_keylist_new (const char         **patterns,
+                            gboolean             secret,
+                            gpgme_keylist_mode_t mode)
+{
+    SeahorseGpgmeKeylist *self;
+
+    self = g_new0 (SeahorseGpgmeKeylist, 1);
+    self->refs = 1;
+    self->patterns = g_strdupv ((char **) patterns);
+    self->secret = secret;
+    self->mode = mode;
+    g_mutex_init (&self->lock);
+    g_cond_init (&self->space);
+    g_queue_init (&self->batches);
+
+    return self;
+}
+
+SeahorseGpgmeKeylist *
+seahorse_gpgme_keylist_ref (SeahorseGpgmeKeylist *self)
+{
+    g_return_val_if_fail (self != NULL, NULL);
+
+    g_atomic_int_inc (&self->refs);
+    return self;
+}
+
+static void
+drop_ready_func (SeahorseGpgmeKeylist *self)
+{
+    GDestroyNotify destroy = self->destroy;
+    void *user_data = self->user_data;
+
+    self->ready = NULL;
+    self->user_data = NULL;
+    self->destroy = NULL;
+
+    if (destroy)
+        (destroy) (user_data);
+}
+
+void
+seahorse_gpgme_keylist_unref (SeahorseGpgmeKeylist *self)
+{
+    g_return_if_fail (self != NULL);
+
+    if (!g_atomic_int_dec_and_test (&self->refs))
+        return;
+
+    /* The worker and any pending wakeup hold a reference */
+    g_assert (self->gctx == NULL);
+    g_assert (self->wakeup == NULL);
+
+    drop_ready_func (self);
+    g_queue_clear_full (&self->batches, (GDestroyNotify) g_ptr_array_unref);
+    g_clear_pointer (&self->context, g_main_context_unref);
+    g_strfreev (self->patterns);
+    g_cond_clear (&self->space);
+    g_mutex_clear (&self->lock);
+    g_free (self);
+}
+
+static void     schedule_wakeup_unlocked     (SeahorseGpgmeKeylist *self);
+
+static gboolean
+on_keylist_wakeup (void *user_data)
+{
+    SeahorseGpgmeKeylist *self = user_data;
+    gboolean again = G_SOURCE_REMOVE;
+    gboolean finished;
+
+    g_mutex_lock (&self->lock);
+    g_clear_pointer (&self->wakeup, g_source_unref);
+    g_mutex_unlock (&self->lock);
+
+    if (self->ready)
+        again = (self->ready) (self, self->user_data);
+
+    /* Come back later for whatever the caller didn't get to yet */
+    g_mutex_lock (&self->lock);
+    finished = !again && self->done && g_queue_is_empty (&self->batches);
+    if (self->ready && (again || !g_queue_is_empty (&self->batches)))
+        schedule_wakeup_unlocked (self);
+    g_mutex_unlock (&self->lock);
+
+    /* Nothing more will come, so release the caller's data */
+    if (finished)
+        drop_ready_func (self);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* Must be called with the lock held */
+static void
+schedule_wakeup_unlocked (SeahorseGpgmeKeylist *self)
+{
+    if (self->wakeup != NULL)
+        return;
+
+    self->wakeup = g_idle_source_new ();
+    g_source_set_priority (self->wakeup, G_PRIORITY_LOW);
+    g_source_set_callback (self->wakeup, on_keylist_wakeup,
+                           seahorse_gpgme_keylist_ref (self),
+                           (GDestroyNotify) seahorse_gpgme_keylist_unref);
+    g_source_attach (self->wakeup, self->context);
+}
+
+/* Returns FALSE if the listing was cancelled while waiting for space */
+static gboolean
+push_batch (SeahorseGpgmeKeylist *self,
+            GPtrArray            *batch)
+{
+    g_mutex_lock (&self->lock);
+
+    while (!self->cancelled && self->batches.length >= KEYLIST_MAX_QUEUED)
+        g_cond_wait (&self->space, &self->lock);
+
+    if (self->cancelled) {
+        g_mutex_unlock (&self->lock);
+        g_ptr_array_unref (batch);
+        return FALSE;
+    }
+
+    g_queue_push_tail (&self->batches, batch);
+    schedule_wakeup_unlocked (self);
+
+    g_mutex_unlock (&self->lock);
+    return TRUE;
+}
+
+static GPtrArray *
+new_batch (void)
+{
+    return g_ptr_array_new_full (KEYLIST_BATCH_SIZE,
+                                 (GDestroyNotify) gpgme_key_unref);
+}
+
+static void *
+keylist_thread (void *data)
+{
+    SeahorseGpgmeKeylist *self = data;
+    g_autoptr(GPtrArray) batch = NULL;
+    gpgme_ctx_t gctx;
+    gpgme_error_t gerr = 0;
+    gpgme_key_t key;
+
+    gctx = seahorse_gpgme_keyring_acquire_context ("keylist", &gerr);
+    if (gctx != NULL) {
+        gpgme_set_keylist_mode (gctx, self->mode);
+
+        g_mutex_lock (&self->lock);
+        self->gctx = gctx;
+        if (self->cancelled)
+            gerr = GPG_E (GPG_ERR_CANCELED);
+        g_mutex_unlock (&self->lock);
+
+        if (gerr == 0 && self->patterns)
+            gerr = gpgme_op_keylist_ext_start (gctx, (const char **) self->patterns,
+                                               self->secret, 0);
+        else if (gerr == 0)
+            gerr = gpgme_op_keylist_start (gctx, NULL, self->secret);
+    }
+
+    batch = new_batch ();
+    while (GPG_IS_OK (gerr)) {
+        gerr = gpgme_op_keylist_next (gctx, &key);
+        if (!GPG_IS_OK (gerr))
+            break;
+
+        g_ptr_array_add (batch, key);
+        if (batch->len < KEYLIST_BATCH_SIZE)
+            continue;
+
+        if (!push_batch (self, g_steal_pointer (&batch))) {
+            gerr = GPG_E (GPG_ERR_CANCELED);
+            break;
+        }
+        batch = new_batch ();
+    }
+
+    /* The end of the listing is reported as EOF */
+    if (gpgme_err_code (gerr) == GPG_ERR_EOF)
+        gerr = GPG_OK;
+
+    if (gctx != NULL) {
+        gpgme_op_keylist_end (gctx);
+
+        g_mutex_lock (&self->lock);
+        self->gctx = NULL;
+        g_mutex_unlock (&self->lock);
+
+        seahorse_gpgme_keyring_release_context (gctx);
+    }
+
+    g_mutex_lock (&self->lock);
+    if (self->cancelled)
+        gerr = GPG_E (GPG_ERR_CANCELED);
+    if (GPG_IS_OK (gerr) && batch && batch->len > 0)
+        g_queue_push_tail (&self->batches, g_steal_pointer (&batch));
+    self->status = gerr;
+    self->done = TRUE;
+    schedule_wakeup_unlocked (self);
+    g_mutex_unlock (&self->lock);
+
+    g_debug ("keylist worker finished: %s", gpgme_strerror (gerr));
+    seahorse_gpgme_keylist_unref (self);
+    return NULL;
+}
+
+/**
+ * seahorse_gpgme_keylist_start:
+ * @self: The keylist
+ * @ready: Called on the current thread-default main context whenever
+ *   batches are available or the listing is done
+ * @user_data: Data for @ready
+ * @destroy: (nullable): Called for @user_data once the listing is done
+ *
+ * Starts listing keys on a worker thread.
+ */
+void
+seahorse_gpgme_keylist_start (SeahorseGpgmeKeylist         *self,
+                              SeahorseGpgmeKeylistReadyFunc ready,
+                              void                         *user_data,
+                              GDestroyNotify                destroy)
+{
+    GThread *thread;
+
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (self->context == NULL);
+
+    self->context = g_main_context_ref_thread_default ();
+    self->ready = ready;
+    self->user_data = user_data;
+    self->destroy = destroy;
+
+    thread = g_thread_new ("seahorse-keylist", keylist_thread,
+                           seahorse_gpgme_keylist_ref (self));
+    g_thread_unref (thread);
+}
+
+/**
+ * seahorse_gpgme_keylist_pop:
+ * @self: The keylist
+ *
+ * Takes the oldest batch of listed keys, if any.
+ *
+ * Returns: (transfer full) (nullable) (element-type gpgme_key_t): A batch of
+ *   keys, or %NULL if there's none available right now
+ */
+GPtrArray *
+seahorse_gpgme_keylist_pop (SeahorseGpgmeKeylist *self)
+{
+    GPtrArray *batch;
+
+    g_return_val_if_fail (self != NULL, NULL);
+
+    g_mutex_lock (&self->lock);
+    batch = g_queue_pop_head (&self->batches);
+    g_cond_signal (&self->space);
+    g_mutex_unlock (&self->lock);
+
+    return batch;
+}
+
+/**
+ * seahorse_gpgme_keylist_is_done:
+ * @self: The keylist
+ * @gerr: (out) (optional): The result of the listing
+ *
+ * Returns: Whether the listing has finished and all batches were popped
+ */
+gboolean
+seahorse_gpgme_keylist_is_done (SeahorseGpgmeKeylist *self,
+                                gpgme_error_t        *gerr)
+{
+    gboolean done;
+
+    g_return_val_if_fail (self != NULL, FALSE);
+
+    g_mutex_lock (&self->lock);
+    done = self->done && g_queue_is_empty (&self->batches);
+    if (done && gerr)
+        *gerr = self->status;
+    g_mutex_unlock (&self->lock);
+
+    return done;
+}
+
+/**
+ * seahorse_gpgme_keylist_cancel:
+ * @self: The keylist
+ *
+ * Cancels the listing. The ready function will still be called once the
+ * worker has stopped, with a %GPG_ERR_CANCELED status. Can be called from
+ * any thread.
+ */
+void
+seahorse_gpgme_keylist_cancel (SeahorseGpgmeKeylist *self)
+{
+    g_return_if_fail (self != NULL);
+
+    g_mutex_lock (&self->lock);
+    self->cancelled = TRUE;
+    if (self->gctx != NULL)
+        gpgme_cancel_async (self->gctx);
+    g_cond_broadcast (&self->space);
+    g_mutex_unlock (&self->lock);
+}
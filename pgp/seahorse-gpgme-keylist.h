@@ -0,0 +1,74 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SeahorseGpgmeKeylist: Lists GPGME keys on a worker thread.
+ *
+ * - gpgme_op_keylist_next() blocks on the gpg pipe, so we don't want to call
+ *   it from the main loop.
+ * - The worker thread collects the listed keys in batches and puts them in a
+ *   bounded queue. If the queue is full, the worker waits until the main
+ *   thread has caught up.
+ * - Whenever new batches (or the end of the listing) are available, the
+ *   ready function is dispatched on the main context which started the
+ *   listing.
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <gpgme.h>
+
+typedef struct _SeahorseGpgmeKeylist SeahorseGpgmeKeylist;
+
+/**
+ * SeahorseGpgmeKeylistReadyFunc:
+ * @keylist: The keylist
+ * @user_data: The data passed to seahorse_gpgme_keylist_start()
+ *
+ * Called on the main context whenever batches can be popped from @keylist
+ * or the listing has finished.
+ *
+ * Returns: %G_SOURCE_CONTINUE to be called again even if no new batches
+ *   arrive in the meantime, %G_SOURCE_REMOVE otherwise
+ */
+typedef gboolean (*SeahorseGpgmeKeylistReadyFunc) (SeahorseGpgmeKeylist *keylist,
+                                                   void                 *user_data);
+
+SeahorseGpgmeKeylist *  seahorse_gpgme_keylist_new      (const char         **patterns,
+                                                         gboolean             secret,
+                                                         gpgme_keylist_mode_t mode);
+
+SeahorseGpgmeKeylist *  seahorse_gpgme_keylist_ref      (SeahorseGpgmeKeylist *self);
+
+void                    seahorse_gpgme_keylist_unref    (SeahorseGpgmeKeylist *self);
+
+void                    seahorse_gpgme_keylist_start    (SeahorseGpgmeKeylist         *self,
+                                                         SeahorseGpgmeKeylistReadyFunc ready,
+                                                         void                         *user_data,
+                                                         GDestroyNotify                destroy);
+
+GPtrArray *             seahorse_gpgme_keylist_pop      (SeahorseGpgmeKeylist *self);
+
+gboolean                seahorse_gpgme_keylist_is_done  (SeahorseGpgmeKeylist *self,
+                                                         gpgme_error_t        *gerr);
+
+void                    seahorse_gpgme_keylist_cancel   (SeahorseGpgmeKeylist *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (SeahorseGpgmeKeylist, seahorse_gpgme_keylist_unref)
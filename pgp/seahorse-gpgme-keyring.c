@@ -28,8 +28,12 @@
 #include "seahorse-gpgme-data.h"
 #include "seahorse-gpgme.h"
 #include "seahorse-gpgme-key-op.h"
+#include "seahorse-gpgme-keylist.h"
+#include "seahorse-gpgme-snapshot.h"
 #include "seahorse-pgp-actions.h"
+#include "seahorse-pgp-armor.h"
 #include "seahorse-pgp-key.h"
+#include "seahorse-pgp-packet.h"
 
 #include "seahorse-common.h"
 
@@ -39,14 +43,32 @@
 #include <gcr/gcr.h>
 
 #include <glib/gi18n.h>
+#include <glib-unix.h>
+#include <gio/gunixinputstream.h>
+#include <gio/gunixoutputstream.h>
 
 #include <stdlib.h>
 #include <string.h>
 #include <libintl.h>
 #include <locale.h>
 
-/* Amount of keys to load in a batch */
-#define DEFAULT_LOAD_BATCH 50
+/* Default time (in microseconds) to spend on loading keys per main loop iteration */
+#define DEFAULT_LOAD_BUDGET 4000
+
+/* Above this many changed keys an incremental refresh just reloads everything */
+#define INCREMENTAL_MAX_RELOAD 256
+
+/* The import pre-filter reads this much at a time, and checks the keys it
+ * split from that once they add up to a batch */
+#define PREFILTER_READ_SIZE (64 * 1024)
+#define PREFILTER_BATCH_SIZE (1024 * 1024)
+
+/* Seconds to wait for more changes before saving a keyring snapshot */
+#define SNAPSHOT_SAVE_DELAY 2
+
+/* Photos are loaded on a few worker threads, a chunk of keys at a time */
+#define PHOTO_POOL_MAX_JOBS 4
+#define PHOTO_JOB_MAX_KEYS 64
 
 struct _SeahorseGpgmeKeyring {
     GObject parent_instance;
@@ -54,7 +76,18 @@ struct _SeahorseGpgmeKeyring {
     GHashTable *keys;
     unsigned int scheduled_refresh;         /* Source for refresh timeout */
     GFileMonitor *monitor_handle;           /* For monitoring the .gnupg directory */
-    GList *orphan_secret;                   /* Orphan secret keys */
+    GHashTable *orphan_secret;              /* Orphan secret keys, by keyid */
+    GHashTable *digests;                    /* Key digests for incremental refreshes */
+    unsigned int load_budget;               /* Microseconds to spend loading per iteration */
+    gboolean single_pass;                   /* List secret keys along with public keys */
+    gboolean use_snapshot;                  /* Start from the last keyring snapshot */
+    unsigned int scheduled_snapshot;        /* Source for the snapshot save timeout */
+    gboolean snapshot_dirty;                /* Keys changed since the last snapshot */
+    gboolean snapshot_writing;              /* A snapshot is being written */
+    gboolean import_prefilter;              /* Don't hand gpg keys it already has */
+    GHashTable *import_index;               /* ImportIndexEntry by fingerprint */
+    GThreadPool *photo_pool;                /* Loads the photos of listed keys */
+    GCancellable *photo_cancellable;        /* Stops the photo loading on dispose */
     GActionGroup *actions;
 };
 
@@ -69,6 +102,10 @@ enum {
     PROP_ACTION_PREFIX,
     PROP_MENU_MODEL,
     PROP_SHOW_IF_EMPTY,
+    PROP_LOAD_BUDGET,
+    PROP_SINGLE_PASS,
+    PROP_SNAPSHOT,
+    PROP_IMPORT_PREFILTER,
     N_PROPS
 };
 
@@ -83,9 +120,23 @@ G_DEFINE_TYPE_WITH_CODE (SeahorseGpgmeKeyring, seahorse_gpgme_keyring, G_TYPE_OB
 
 enum {
     LOAD_FULL = 0x01,
-    LOAD_PHOTOS = 0x02
+    LOAD_PHOTOS = 0x02,
+    LOAD_INCREMENTAL = 0x04,
+    LOAD_WITH_SECRET = 0x08
 };
 
+static void     seahorse_gpgme_keyring_refresh_async      (SeahorseGpgmeKeyring *self,
+                                                           GCancellable         *cancellable,
+                                                           GAsyncReadyCallback   callback,
+                                                           void                 *user_data);
+
+static void     seahorse_gpgme_keyring_load_full_async    (SeahorseGpgmeKeyring *self,
+                                                           const char          **patterns,
+                                                           int                   parts,
+                                                           GCancellable         *cancellable,
+                                                           GAsyncReadyCallback   callback,
+                                                           void                 *user_data);
+
 static gpgme_error_t
 passphrase_get (void       *hook,
                 const char *uid_hint,
@@ -147,31 +198,166 @@ passphrase_get (void       *hook,
 
 typedef struct {
     SeahorseGpgmeKeyring *keyring;
-    gpgme_ctx_t gctx;
+    SeahorseGpgmeKeylist *keylist;
+    GCancellable *cancellable;
+    unsigned long cancelled_sig;
     GHashTable *checks;
+    GPtrArray *changed;
+    GHashTable *digests;                    /* Of the changed keys, see list_one_key() */
+    GPtrArray *photo_keys;                  /* Keys waiting for their photos */
     int parts;
     int loaded;
+
+    /* The batch we're working through */
+    GPtrArray *batch;
+    unsigned int batch_at;
+
+    /* For tuning how many keys we take per main loop iteration */
+    gint64 started;
+    gint64 key_cost;
 } keyring_list_closure;
 
 static void
 keyring_list_free (void *data)
 {
     keyring_list_closure *closure = data;
-    if (closure->gctx)
-        gpgme_release (closure->gctx);
+    if (closure->cancellable) {
+        g_cancellable_disconnect (closure->cancellable, closure->cancelled_sig);
+        g_object_unref (closure->cancellable);
+    }
+    if (closure->keylist) {
+        seahorse_gpgme_keylist_cancel (closure->keylist);
+        seahorse_gpgme_keylist_unref (closure->keylist);
+    }
     if (closure->checks)
         g_hash_table_destroy (closure->checks);
+    if (closure->changed)
+        g_ptr_array_unref (closure->changed);
+    if (closure->digests)
+        g_hash_table_destroy (closure->digests);
+    if (closure->photo_keys)
+        g_ptr_array_unref (closure->photo_keys);
+    if (closure->batch)
+        g_ptr_array_unref (closure->batch);
     g_clear_object (&closure->keyring);
     g_free (closure);
 }
 
-/* Add a key to the context  */
+/*
+ * Summarizes everything of a key that can be seen in a plain (local, no
+ * signatures) listing, including whether there is a secret key for it. If
+ * the digest of a key didn't change between two listings, there's no need
+ * to realize it again.
+ */
+static char *
+calc_key_digest (gpgme_key_t key)
+{
+    g_autoptr(GChecksum) checksum = NULL;
+    g_autoptr(GString) buf = NULL;
+
+    buf = g_string_new (NULL);
+    g_string_append_printf (buf, "%s:%lu:%d%d%d%d%d:%d\n",
+                            key->fpr ? key->fpr : "",
+                            key->last_update,
+                            key->revoked, key->expired, key->disabled,
+                            key->invalid, key->secret, key->owner_trust);
+
+    for (gpgme_subkey_t subkey = key->subkeys; subkey; subkey = subkey->next)
+        g_string_append_printf (buf, "sub:%s:%ld:%d%d%d\n",
+                                subkey->keyid, subkey->expires,
+                                subkey->revoked, subkey->expired,
+                                subkey->disabled);
+
+    for (gpgme_user_id_t uid = key->uids; uid; uid = uid->next)
+        g_string_append_printf (buf, "uid:%s:%d:%d%d\n",
+                                uid->uid ? uid->uid : "", uid->validity,
+                                uid->revoked, uid->invalid);
+
+    checksum = g_checksum_new (G_CHECKSUM_SHA1);
+    g_checksum_update (checksum, (const guchar *) buf->str, buf->len);
+    return g_strdup (g_checksum_get_string (checksum));
+}
+
+/*
+ * Summarizes the signatures on a key listed with GPGME_KEYLIST_MODE_SIGS,
+ * which a plain listing doesn't show. Returns NULL for other listings.
+ */
+static char *
+calc_signatures_digest (gpgme_key_t key)
+{
+    g_autoptr(GChecksum) checksum = NULL;
+    g_autoptr(GString) buf = NULL;
+
+    if (!(key->keylist_mode & GPGME_KEYLIST_MODE_SIGS))
+        return NULL;
+
+    buf = g_string_new (NULL);
+    for (gpgme_user_id_t uid = key->uids; uid; uid = uid->next) {
+        g_string_append_printf (buf, "uid:%s\n", uid->uid ? uid->uid : "");
+        for (gpgme_key_sig_t sig = uid->signatures; sig; sig = sig->next)
+            g_string_append_printf (buf, "sig:%s:%ld:%ld:%d%d%d\n",
+                                    sig->keyid ? sig->keyid : "",
+                                    sig->timestamp, sig->expires,
+                                    sig->revoked, sig->expired, sig->exportable);
+    }
+
+    checksum = g_checksum_new (G_CHECKSUM_SHA1);
+    g_checksum_update (checksum, (const guchar *) buf->str, buf->len);
+    return g_strdup (g_checksum_get_string (checksum));
+}
+
+/* Returns the new digest if the key changed since it was last realized */
+static char *
+calc_changed_key_digest (SeahorseGpgmeKeyring *self,
+                         gpgme_key_t           key)
+{
+    g_autofree char *digest = NULL;
+    const char *prev;
+
+    digest = calc_key_digest (key);
+    prev = g_hash_table_lookup (self->digests, key->subkeys->keyid);
+    if (prev && g_str_equal (prev, digest))
+        return NULL;
+
+    return g_steal_pointer (&digest);
+}
+
+/* Remembers the digest of a key that was just realized */
+static void
+update_key_digest (SeahorseGpgmeKeyring *self,
+                   gpgme_key_t           key)
+{
+    char *digest;
+    const char *prev;
+
+    digest = calc_key_digest (key);
+    prev = g_hash_table_lookup (self->digests, key->subkeys->keyid);
+    if (prev == NULL || !g_str_equal (prev, digest))
+        self->snapshot_dirty = TRUE;
+
+    g_hash_table_replace (self->digests, g_strdup (key->subkeys->keyid), digest);
+}
+
+/* Whether public key listings can tell us about secret keys too */
+static gboolean
+can_list_with_secret (void)
+{
+    return seahorse_gpgme_get_engine_version () >= seahorse_util_version (2, 1, 0, 0);
+}
+
+/*
+ * Add a key to the context. If @with_secret is set, @key comes from a
+ * listing with GPGME_KEYLIST_MODE_WITH_SECRET, so it is a public key which
+ * also tells us whether there is a matching secret key.
+ */
 static SeahorseGpgmeKey *
 add_key_to_context (SeahorseGpgmeKeyring *self,
-                    gpgme_key_t           key)
+                    gpgme_key_t           key,
+                    gboolean              with_secret)
 {
     SeahorseGpgmeKey *pkey = NULL;
     SeahorseGpgmeKey *prev;
+    g_autofree char *orphan_keyid = NULL;
     const char *keyid;
 
     g_return_val_if_fail (SEAHORSE_IS_GPGME_KEYRING (self), NULL);
@@ -180,23 +366,40 @@ add_key_to_context (SeahorseGpgmeKeyring *self,
     keyid = key->subkeys->keyid;
     g_return_val_if_fail (keyid, NULL);
 
+    if (with_secret || !key->secret)
+        update_key_digest (self, key);
+
     prev = seahorse_gpgme_keyring_lookup (self, keyid);
 
     /* Check if we can just replace the key on the object */
     if (prev != NULL) {
-        if (key->secret)
+        if (with_secret)
+            g_object_set (prev,
+                          "pubkey", key,
+                          "seckey", key->secret ? key : NULL,
+                          NULL);
+        else if (key->secret)
             g_object_set (prev, "seckey", key, NULL);
         else
             g_object_set (prev, "pubkey", key, NULL);
         return prev;
     }
 
+    /* A single pass listing gives us everything at once */
+    if (with_secret) {
+        pkey = seahorse_gpgme_key_new (SEAHORSE_PLACE (self), key,
+                                       key->secret ? key : NULL);
+        g_hash_table_insert (self->keys, g_strdup (keyid), pkey);
+        gcr_collection_emit_added (GCR_COLLECTION (self), G_OBJECT (pkey));
+        return pkey;
+    }
+
     /* Create a new key with secret */
     if (key->secret) {
         pkey = seahorse_gpgme_key_new (SEAHORSE_PLACE (self), NULL, key);
 
         /* Since we don't have a public key yet, save this away */
-        self->orphan_secret = g_list_append (self->orphan_secret, pkey);
+        g_hash_table_replace (self->orphan_secret, g_strdup (keyid), pkey);
 
         /* No key was loaded as far as everyone is concerned */
         return NULL;
@@ -205,24 +408,10 @@ add_key_to_context (SeahorseGpgmeKeyring *self,
     /* Just a new public key */
 
     /* Check for orphans */
-    for (GList *l = self->orphan_secret; l; l = g_list_next (l)) {
-        gpgme_key_t seckey;
-
-        seckey = seahorse_gpgme_key_get_private (l->data);
-        g_return_val_if_fail (seckey && seckey->subkeys && seckey->subkeys->keyid, NULL);
-
-        /* Look for a matching key */
-        if (g_str_equal (keyid, seckey->subkeys->keyid)) {
-
-            /* Set it up properly */
-            pkey = SEAHORSE_GPGME_KEY (l->data);
-            g_object_set (pkey, "pubkey", key, NULL);
-
-            /* Remove item from orphan list cleanly */
-            self->orphan_secret = g_list_remove_link (self->orphan_secret, l);
-            g_list_free (l);
-            break;
-        }
+    if (g_hash_table_steal_extended (self->orphan_secret, keyid,
+                                     (void **) &orphan_keyid, (void **) &pkey)) {
+        /* Set it up properly */
+        g_object_set (pkey, "pubkey", key, NULL);
     }
 
     if (pkey == NULL)
@@ -248,71 +437,414 @@ remove_key (SeahorseGpgmeKeyring *self,
         seahorse_gpgme_keyring_remove_key (self, key);
 }
 
-/* Completes one batch of key loading */
-static gboolean
-on_idle_list_batch_of_keys (void *data)
+static void
+on_keyring_changed_loaded (GObject      *source,
+                           GAsyncResult *result,
+                           void         *user_data)
 {
-    GTask *task = G_TASK (data);
+    g_autoptr(GTask) task = G_TASK (user_data);
     keyring_list_closure *closure = g_task_get_task_data (task);
+    g_autoptr(GError) error = NULL;
+    GHashTableIter iter;
+    char *keyid, *digest;
+
+    /* The changed keys are tried again on the next refresh */
+    if (!g_task_propagate_boolean (G_TASK (result), &error)) {
+        g_task_return_error (task, g_steal_pointer (&error));
+        return;
+    }
+
+    /* Only now are the changed keys realized */
+    g_hash_table_iter_init (&iter, closure->digests);
+    while (g_hash_table_iter_next (&iter, (void **) &keyid, (void **) &digest)) {
+        g_hash_table_replace (closure->keyring->digests, keyid, digest);
+        g_hash_table_iter_steal (&iter);
+    }
+
+    g_task_return_boolean (task, TRUE);
+}
+
+/* Takes in a single key that the keylist worker handed over */
+static void
+list_one_key (keyring_list_closure *closure,
+              gpgme_key_t           key)
+{
+    SeahorseGpgmeKey *pkey;
+
+    if (!key->subkeys || !key->subkeys->keyid)
+        return;
+
+    /* During a refresh if only new or removed keys */
+    if (closure->checks) {
+        /* Make note that this key exists in key ring */
+        g_hash_table_remove (closure->checks, key->subkeys->keyid);
+    }
+
+    closure->loaded++;
+
+    /* Only the keys that changed get realized again, see below. Their
+     * digests are only remembered once that worked out. */
+    if (closure->parts & LOAD_INCREMENTAL) {
+        g_autofree char *digest = calc_changed_key_digest (closure->keyring, key);
+
+        if (digest && key->fpr) {
+            g_ptr_array_add (closure->changed, g_strdup (key->fpr));
+            g_hash_table_replace (closure->digests, g_strdup (key->subkeys->keyid),
+                                  g_steal_pointer (&digest));
+        }
+        return;
+    }
+
+    pkey = add_key_to_context (closure->keyring, key,
+                               closure->parts & LOAD_WITH_SECRET);
+
+    /* Photos are filled in later, see queue_photo_loads() */
+    if (pkey && closure->photo_keys)
+        g_ptr_array_add (closure->photo_keys, g_object_ref (pkey));
+}
+
+typedef struct {
+    char *fingerprint;
     SeahorseGpgmeKey *pkey;
+    gpgme_key_t pubkey;
+    GPtrArray *photos;                      /* Decoded by the worker */
+} PhotoJobKey;
+
+typedef struct {
+    GWeakRef keyring;
+    GCancellable *cancellable;              /* Of the listing that queued us */
+    GCancellable *keyring_cancellable;
+    GPtrArray *keys;                        /* PhotoJobKey */
+    gboolean complete;
+} PhotoJob;
+
+static void
+photo_job_key_free (void *data)
+{
+    PhotoJobKey *entry = data;
+
+    g_free (entry->fingerprint);
+    g_clear_object (&entry->pkey);
+    gpgme_key_unref (entry->pubkey);
+    g_clear_pointer (&entry->photos, g_ptr_array_unref);
+    g_free (entry);
+}
+
+static void
+photo_job_free (void *data)
+{
+    PhotoJob *job = data;
+
+    g_weak_ref_clear (&job->keyring);
+    g_clear_object (&job->cancellable);
+    g_clear_object (&job->keyring_cancellable);
+    g_ptr_array_unref (job->keys);
+    g_free (job);
+}
+
+static gboolean
+photo_job_is_cancelled (PhotoJob *job)
+{
+    return g_cancellable_is_cancelled (job->cancellable) ||
+           g_cancellable_is_cancelled (job->keyring_cancellable);
+}
+
+/* Runs on the main thread, once the worker is done with a job */
+static gboolean
+on_photo_job_done (void *user_data)
+{
+    PhotoJob *job = user_data;
+    g_autoptr(SeahorseGpgmeKeyring) self = NULL;
+
+    self = g_weak_ref_get (&job->keyring);
+    if (self == NULL || !job->complete || photo_job_is_cancelled (job))
+        return G_SOURCE_REMOVE;
+
+    for (unsigned int i = 0; i < job->keys->len; i++) {
+        PhotoJobKey *entry = g_ptr_array_index (job->keys, i);
+        const char *keyid = entry->pubkey->subkeys->keyid;
+
+        /* The key might have been removed or replaced in the meantime */
+        if (g_hash_table_lookup (self->keys, keyid) != entry->pkey)
+            continue;
+
+        seahorse_gpgme_key_set_photos (entry->pkey, entry->photos);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * Runs on one of the photo pool threads. All the keys of the job are
+ * exported at once, and only the keys that turn out to have user attribute
+ * packets get any further work done for them.
+ */
+static void
+photo_job_run (void *data,
+               void *user_data)
+{
+    PhotoJob *job = data;
+    g_autoptr(GHashTable) by_fingerprint = NULL;
+    g_autoptr(GPtrArray) packets = NULL;
+    g_autoptr(GBytes) exported = NULL;
+    g_autoptr(GError) error = NULL;
+    g_autofree const char **patterns = NULL;
+    gpgme_data_t export = NULL;
+    gpgme_error_t gerr;
+    gpgme_ctx_t ctx;
+    char *buffer;
+    size_t len;
+
+    if (photo_job_is_cancelled (job))
+        goto done;
+
+    patterns = g_new0 (const char *, job->keys->len + 1);
+    for (unsigned int i = 0; i < job->keys->len; i++) {
+        PhotoJobKey *entry = g_ptr_array_index (job->keys, i);
+        patterns[i] = entry->fingerprint;
+    }
+
+    ctx = seahorse_gpgme_keyring_acquire_context ("photos", &gerr);
+    if (ctx != NULL) {
+        gerr = gpgme_data_new (&export);
+        if (GPG_IS_OK (gerr))
+            gerr = gpgme_op_export_ext (ctx, patterns, 0, export);
+        seahorse_gpgme_keyring_release_context (ctx);
+    }
+
+    if (!GPG_IS_OK (gerr)) {
+        g_message ("couldn't export keys to load their photos: %s", gpgme_strerror (gerr));
+        gpgme_data_release (export);
+        goto done;
+    }
+
+    buffer = gpgme_data_release_and_get_mem (export, &len);
+    exported = g_bytes_new_with_free_func (buffer, len, gpgme_free, buffer);
+
+    packets = seahorse_pgp_packet_parse_keyring_photos (exported, &error);
+    if (packets == NULL) {
+        g_message ("couldn't read the photos of exported keys: %s", error->message);
+        goto done;
+    }
+
+    by_fingerprint = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                            NULL, (GDestroyNotify) g_ptr_array_unref);
+    for (unsigned int i = 0; i < packets->len; i++) {
+        SeahorsePgpPhotoPacket *packet = g_ptr_array_index (packets, i);
+        GPtrArray *key_packets;
+
+        if (packet->fingerprint == NULL)
+            continue;
+
+        key_packets = g_hash_table_lookup (by_fingerprint, packet->fingerprint);
+        if (key_packets == NULL) {
+            key_packets = g_ptr_array_new ();
+            g_hash_table_insert (by_fingerprint, packet->fingerprint, key_packets);
+        }
+        g_ptr_array_add (key_packets, packet);
+    }
+
+    for (unsigned int i = 0; i < job->keys->len; i++) {
+        PhotoJobKey *entry = g_ptr_array_index (job->keys, i);
+        GPtrArray *key_packets;
+
+        if (photo_job_is_cancelled (job))
+            goto done;
+
+        key_packets = g_hash_table_lookup (by_fingerprint, entry->fingerprint);
+        if (key_packets != NULL)
+            entry->photos = seahorse_gpgme_key_op_photos_decode (entry->pubkey, key_packets);
+    }
+
+    g_debug ("loaded photos of %u out of %u keys",
+             g_hash_table_size (by_fingerprint), job->keys->len);
+    job->complete = TRUE;
+
+done:
+    /* Keys and photos are only ever let go of on the main thread */
+    g_idle_add_full (G_PRIORITY_DEFAULT_IDLE, on_photo_job_done, job, photo_job_free);
+}
+
+/* Hands the keys we listed so far over to the photo pool, in full chunks
+ * unless @flush is set */
+static void
+queue_photo_loads (keyring_list_closure *closure,
+                   gboolean              flush)
+{
+    SeahorseGpgmeKeyring *self = closure->keyring;
+    GPtrArray *photo_keys = closure->photo_keys;
+
+    if (photo_keys == NULL)
+        return;
+
+    while (photo_keys->len >= PHOTO_JOB_MAX_KEYS || (flush && photo_keys->len > 0)) {
+        unsigned int n_keys = MIN (photo_keys->len, PHOTO_JOB_MAX_KEYS);
+        PhotoJob *job;
+
+        job = g_new0 (PhotoJob, 1);
+        g_weak_ref_init (&job->keyring, self);
+        job->keys = g_ptr_array_new_with_free_func (photo_job_key_free);
+
+        for (unsigned int i = 0; i < n_keys; i++) {
+            SeahorseGpgmeKey *pkey = g_ptr_array_index (photo_keys, i);
+            gpgme_key_t pubkey = seahorse_gpgme_key_get_public (pkey);
+            PhotoJobKey *entry;
+
+            if (pubkey == NULL || pubkey->subkeys == NULL || pubkey->subkeys->fpr == NULL)
+                continue;
+
+            entry = g_new0 (PhotoJobKey, 1);
+            entry->fingerprint = g_strdup (pubkey->subkeys->fpr);
+            entry->pkey = g_object_ref (pkey);
+            entry->pubkey = pubkey;
+            gpgme_key_ref (pubkey);
+            g_ptr_array_add (job->keys, entry);
+        }
+        g_ptr_array_remove_range (photo_keys, 0, n_keys);
+
+        if (job->keys->len == 0) {
+            photo_job_free (job);
+            continue;
+        }
+
+        if (self->photo_pool == NULL) {
+            self->photo_pool = g_thread_pool_new (photo_job_run, NULL,
+                                                  PHOTO_POOL_MAX_JOBS, FALSE, NULL);
+            self->photo_cancellable = g_cancellable_new ();
+        }
+
+        if (closure->cancellable)
+            job->cancellable = g_object_ref (closure->cancellable);
+        job->keyring_cancellable = g_object_ref (self->photo_cancellable);
+        g_thread_pool_push (self->photo_pool, job, NULL);
+    }
+}
+
+/*
+ * Takes in keys until the time budget for this main loop iteration is used
+ * up. We stop early if the next key probably wouldn't fit in the budget any
+ * more, based on what the keys took so far.
+ */
+static gboolean
+list_keylist_batch (SeahorseGpgmeKeylist *keylist,
+                    GTask                *task)
+{
+    keyring_list_closure *closure = g_task_get_task_data (task);
+    GCancellable *cancellable = g_task_get_cancellable (task);
     GHashTableIter iter;
-    gpgme_key_t key;
-    unsigned int batch;
+    gpgme_error_t gerr;
+    g_autoptr(GError) error = NULL;
     g_autofree char *detail = NULL;
     const char *keyid;
+    gint64 start, deadline, now;
+
+    now = start = g_get_monotonic_time ();
+    deadline = start + closure->keyring->load_budget;
+    if (closure->started == 0)
+        closure->started = start;
+
+    do {
+        gint64 before = now;
+
+        if (closure->batch && closure->batch_at >= closure->batch->len)
+            g_clear_pointer (&closure->batch, g_ptr_array_unref);
+        if (closure->batch == NULL) {
+            closure->batch = seahorse_gpgme_keylist_pop (keylist);
+            closure->batch_at = 0;
+            if (closure->batch == NULL)
+                break;
+        }
 
-    /* We load until done if batch is zero */
-    batch = DEFAULT_LOAD_BATCH;
+        list_one_key (closure, g_ptr_array_index (closure->batch, closure->batch_at++));
 
-    while (batch-- > 0) {
-        if (!GPG_IS_OK (gpgme_op_keylist_next (closure->gctx, &key))) {
+        /* Keep a moving average of how long a key takes */
+        now = g_get_monotonic_time ();
+        if (closure->key_cost == 0)
+            closure->key_cost = now - before;
+        else
+            closure->key_cost = (closure->key_cost * 7 + (now - before)) / 8;
+    } while (now + closure->key_cost < deadline);
 
-            gpgme_op_keylist_end (closure->gctx);
+    queue_photo_loads (closure, FALSE);
 
-            /* If we were a refresh loader, then we remove the keys we didn't find */
-            if (closure->checks) {
-                g_hash_table_iter_init (&iter, closure->checks);
-                while (g_hash_table_iter_next (&iter, (void **) &keyid, NULL))
-                    remove_key (closure->keyring, keyid);
-            }
+    detail = g_strdup_printf (ngettext ("Loaded %d key", "Loaded %d keys", closure->loaded), closure->loaded);
+    seahorse_progress_update (cancellable, task, detail);
+    if (now > closure->started)
+        seahorse_progress_update_rate (cancellable, task,
+                                       closure->loaded * (double) G_USEC_PER_SEC /
+                                       (now - closure->started));
 
-            seahorse_progress_end (g_task_get_cancellable (task), task);
-            g_task_return_boolean (task, TRUE);
-            return FALSE; /* Remove event handler */
-        }
+    /* More keys we didn't get to yet */
+    if (closure->batch && closure->batch_at < closure->batch->len)
+        return G_SOURCE_CONTINUE;
 
-        g_return_val_if_fail (key->subkeys && key->subkeys->keyid, FALSE);
+    if (!seahorse_gpgme_keylist_is_done (keylist, &gerr))
+        return G_SOURCE_REMOVE;
 
-        /* During a refresh if only new or removed keys */
-        if (closure->checks) {
-            /* Make note that this key exists in key ring */
-            g_hash_table_remove (closure->checks, key->subkeys->keyid);
-        }
+    queue_photo_loads (closure, TRUE);
 
-        pkey = add_key_to_context (closure->keyring, key);
+    g_debug ("listed %d keys in %" G_GINT64_FORMAT " ms, %" G_GINT64_FORMAT " us per key",
+             closure->loaded, (now - closure->started) / 1000, closure->key_cost);
+    seahorse_progress_end (cancellable, task);
 
-        /* Load additional info */
-        if (pkey && closure->parts & LOAD_PHOTOS)
-            seahorse_gpgme_key_op_photos_load (pkey);
+    if (seahorse_gpgme_propagate_error (gerr, &error)) {
+        g_task_return_error (task, g_steal_pointer (&error));
+        return G_SOURCE_REMOVE;
+    }
 
-        gpgme_key_unref (key);
-        closure->loaded++;
+    /* If we were a refresh loader, then we remove the keys we didn't find */
+    if (closure->checks) {
+        g_hash_table_iter_init (&iter, closure->checks);
+        while (g_hash_table_iter_next (&iter, (void **) &keyid, NULL))
+            remove_key (closure->keyring, keyid);
     }
 
-    detail = g_strdup_printf (ngettext("Loaded %d key", "Loaded %d keys", closure->loaded), closure->loaded);
-    seahorse_progress_update (g_task_get_cancellable (task), task, detail);
+    if (closure->changed && closure->changed->len > 0) {
+        const char **patterns = NULL;
 
-    return TRUE;
+        /* Lots of changes: a full listing is cheaper than huge patterns */
+        g_debug ("%u keys changed since the last refresh", closure->changed->len);
+        if (closure->changed->len <= INCREMENTAL_MAX_RELOAD) {
+            g_ptr_array_add (closure->changed, NULL);
+            patterns = (const char **) closure->changed->pdata;
+        }
+
+        seahorse_gpgme_keyring_load_full_async (closure->keyring, patterns, 0,
+                                                cancellable,
+                                                on_keyring_changed_loaded,
+                                                g_object_ref (task));
+        return G_SOURCE_REMOVE;
+    }
+
+    g_task_return_boolean (task, TRUE);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+on_keylist_batch_ready (SeahorseGpgmeKeylist *keylist,
+                        void                 *user_data)
+{
+    GTask *task = G_TASK (user_data);
+    g_autoptr(SeahorseGpgmeKeyring) self = NULL;
+    gboolean again;
+
+    self = g_object_ref (g_task_get_source_object (task));
+
+    /* Listeners can deal with all the keys of this slice at once */
+    g_signal_emit_by_name (self, "batch-started");
+    again = list_keylist_batch (keylist, task);
+    g_signal_emit_by_name (self, "batch-finished");
+
+    return again;
 }
 
 static void
 on_keyring_list_cancelled (GCancellable *cancellable,
                            void         *user_data)
 {
-    GTask *task = G_TASK (user_data);
-    keyring_list_closure *closure = g_task_get_task_data (task);
+    SeahorseGpgmeKeylist *keylist = user_data;
 
-    gpgme_op_keylist_end (closure->gctx);
+    seahorse_gpgme_keylist_cancel (keylist);
 }
 
 static void
@@ -326,35 +858,32 @@ seahorse_gpgme_keyring_list_async (SeahorseGpgmeKeyring *self,
 {
     g_autoptr(GTask) task = NULL;
     keyring_list_closure *closure;
+    gpgme_keylist_mode_t mode;
     SeahorseObject *object;
-    gpgme_error_t gerr = 0;
     GHashTableIter iter;
-    g_autoptr(GError) error = NULL;
 
     task = g_task_new (self, cancellable, callback, user_data);
 
     closure = g_new0 (keyring_list_closure, 1);
     closure->parts = parts;
-    closure->gctx = seahorse_gpgme_keyring_new_context (&gerr);
     closure->keyring = g_object_ref (self);
     g_task_set_task_data (task, closure, keyring_list_free);
 
-    /* Start the key listing */
-    if (closure->gctx) {
-        if (parts & LOAD_FULL)
-            gpgme_set_keylist_mode (closure->gctx, GPGME_KEYLIST_MODE_SIGS |
-                                    gpgme_get_keylist_mode (closure->gctx));
-        if (patterns)
-            gerr = gpgme_op_keylist_ext_start (closure->gctx, patterns, secret, 0);
-        else
-            gerr = gpgme_op_keylist_start (closure->gctx, NULL, secret);
-    }
-
-    if (gerr != 0) {
-        seahorse_gpgme_propagate_error (gerr, &error);
-        g_task_return_error (task, g_steal_pointer (&error));
-        return;
-    }
+    /* The key listing itself runs on a worker thread */
+    mode = GPGME_KEYLIST_MODE_LOCAL;
+    if (parts & LOAD_FULL)
+        mode |= GPGME_KEYLIST_MODE_SIGS;
+    if (parts & LOAD_WITH_SECRET)
+        mode |= GPGME_KEYLIST_MODE_WITH_SECRET;
+    closure->keylist = seahorse_gpgme_keylist_new (patterns, secret, mode);
+
+    if (parts & LOAD_INCREMENTAL) {
+        closure->changed = g_ptr_array_new_with_free_func (g_free);
+        closure->digests = g_hash_table_new_full (seahorse_pgp_keyid_hash,
+                                                  seahorse_pgp_keyid_equal,
+                                                  g_free, g_free);
+    } else if (parts & LOAD_PHOTOS)
+        closure->photo_keys = g_ptr_array_new_with_free_func (g_object_unref);
 
     /* Loading all the keys? */
     if (patterns == NULL) {
@@ -365,7 +894,9 @@ seahorse_gpgme_keyring_list_async (SeahorseGpgmeKeyring *self,
                                                  g_free, NULL);
         g_hash_table_iter_init (&iter, self->keys);
         while (g_hash_table_iter_next (&iter, (void **) &keyid, (void **) &object)) {
-            if ((secret && seahorse_object_get_usage (object) == SEAHORSE_USAGE_PRIVATE_KEY) ||
+            /* These list all public keys, personal or not */
+            if ((parts & (LOAD_INCREMENTAL | LOAD_WITH_SECRET)) ||
+                (secret && seahorse_object_get_usage (object) == SEAHORSE_USAGE_PRIVATE_KEY) ||
                 (!secret && seahorse_object_get_usage (object) == SEAHORSE_USAGE_PUBLIC_KEY)) {
                 keyid = g_strdup (keyid);
                 g_hash_table_insert (closure->checks, keyid, keyid);
@@ -374,13 +905,16 @@ seahorse_gpgme_keyring_list_async (SeahorseGpgmeKeyring *self,
     }
 
     seahorse_progress_prep_and_begin (cancellable, task, NULL);
-    if (cancellable)
-        g_cancellable_connect (cancellable,
-                               G_CALLBACK (on_keyring_list_cancelled),
-                               task, NULL);
+    if (cancellable) {
+        closure->cancellable = g_object_ref (cancellable);
+        closure->cancelled_sig = g_cancellable_connect (cancellable,
+                                                        G_CALLBACK (on_keyring_list_cancelled),
+                                                        seahorse_gpgme_keylist_ref (closure->keylist),
+                                                        (GDestroyNotify) seahorse_gpgme_keylist_unref);
+    }
 
-    g_idle_add_full (G_PRIORITY_LOW, on_idle_list_batch_of_keys,
-                     g_steal_pointer (&task), g_object_unref);
+    seahorse_gpgme_keylist_start (closure->keylist, on_keylist_batch_ready,
+                                  g_steal_pointer (&task), g_object_unref);
 }
 
 static gboolean
@@ -415,6 +949,7 @@ scheduled_dummy (void *user_data)
 typedef struct {
     SeahorseGpgmeKeyring *self;
     const char **patterns;
+    int parts;
 } keyring_load_closure;
 
 static void
@@ -441,7 +976,7 @@ on_keyring_secret_list_complete (GObject      *source,
     }
 
     /* Public keys */
-    seahorse_gpgme_keyring_list_async (self, patterns, 0, FALSE, cancellable,
+    seahorse_gpgme_keyring_list_async (self, patterns, closure->parts, FALSE, cancellable,
                                        on_keyring_public_list_complete,
                                        g_steal_pointer (&task));
 }
@@ -485,173 +1020,953 @@ seahorse_gpgme_keyring_load_full_async (SeahorseGpgmeKeyring *self,
     closure = g_new0 (keyring_load_closure, 1);
     closure->self = self;
     closure->patterns = patterns;
+    closure->parts = parts;
     g_task_set_task_data (task, closure, g_free);
 
-    /* Secret keys */
+    /* Public and secret keys in one go, if gpg can do that */
+    if (self->single_pass && can_list_with_secret ()) {
+        seahorse_gpgme_keyring_list_async (self, patterns, parts | LOAD_WITH_SECRET, FALSE,
+                                           cancellable,
+                                           on_keyring_public_list_complete,
+                                           g_object_ref (task));
+        return;
+    }
+
+    /* Otherwise fall back to listing the secret keys first. Only the public
+     * listing has the signatures, see on_keyring_secret_list_complete() */
     seahorse_gpgme_keyring_list_async (self, patterns, 0, TRUE, cancellable,
                                        on_keyring_secret_list_complete,
                                        g_object_ref (task));
 
-    /* Public keys -- see on_keyring_secret_list_complete() */
+    /* Public keys -- see on_keyring_secret_list_complete() */
+}
+
+static void
+on_keyring_reload_keys_loaded (GObject      *source,
+                               GAsyncResult *result,
+                               void         *user_data)
+{
+    g_autoptr(GTask) task = G_TASK (user_data);
+    g_autoptr(GError) error = NULL;
+
+    if (!g_task_propagate_boolean (G_TASK (result), &error)) {
+        g_task_return_error (task, g_steal_pointer (&error));
+        return;
+    }
+
+    g_task_return_boolean (task, TRUE);
+}
+
+/**
+ * seahorse_gpgme_keyring_reload_keys_async:
+ * @self: A #SeahorseGpgmeKeyring
+ * @fingerprints: (array zero-terminated=1): The keys to reload
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: Called when done
+ * @user_data: Data for @callback
+ *
+ * Reloads the given keys, including their signatures, in a single listing.
+ * Use this after changing a bunch of keys instead of refreshing each one.
+ */
+void
+seahorse_gpgme_keyring_reload_keys_async (SeahorseGpgmeKeyring *self,
+                                          const char * const   *fingerprints,
+                                          GCancellable         *cancellable,
+                                          GAsyncReadyCallback   callback,
+                                          void                 *user_data)
+{
+    g_autoptr(GTask) task = NULL;
+    char **patterns;
+
+    g_return_if_fail (SEAHORSE_IS_GPGME_KEYRING (self));
+    g_return_if_fail (fingerprints != NULL);
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_set_source_tag (task, seahorse_gpgme_keyring_reload_keys_async);
+
+    /* The listing only borrows the patterns */
+    patterns = g_strdupv ((char **) fingerprints);
+    g_task_set_task_data (task, patterns, (GDestroyNotify) g_strfreev);
+
+    if (patterns[0] == NULL) {
+        g_task_return_boolean (task, TRUE);
+        return;
+    }
+
+    seahorse_gpgme_keyring_load_full_async (self, (const char **) patterns,
+                                            LOAD_FULL, cancellable,
+                                            on_keyring_reload_keys_loaded,
+                                            g_object_ref (task));
+}
+
+gboolean
+seahorse_gpgme_keyring_reload_keys_finish (SeahorseGpgmeKeyring *self,
+                                           GAsyncResult         *result,
+                                           GError              **error)
+{
+    g_return_val_if_fail (SEAHORSE_IS_GPGME_KEYRING (self), FALSE);
+    g_return_val_if_fail (g_task_is_valid (result, self), FALSE);
+
+    return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/**
+ * seahorse_gpgme_keyring_lookup:
+ * @self: A #SeahorseGpgmeKeyring
+ * @keyid: A PGP key id
+ *
+ * Looks up the key for @keyid in @self and returns it (or %NULL if not found).
+ *
+ * Returns: (transfer none) (nullable): The requested key, or %NULL
+ */
+SeahorseGpgmeKey *
+seahorse_gpgme_keyring_lookup (SeahorseGpgmeKeyring *self,
+                               const char           *keyid)
+{
+    g_return_val_if_fail (SEAHORSE_IS_GPGME_KEYRING (self), NULL);
+    g_return_val_if_fail (keyid != NULL, NULL);
+
+    return g_hash_table_lookup (self->keys, keyid);
+}
+
+void
+seahorse_gpgme_keyring_remove_key (SeahorseGpgmeKeyring *self,
+                                   SeahorseGpgmeKey *key)
+{
+    const char *keyid;
+
+    g_return_if_fail (SEAHORSE_IS_GPGME_KEYRING (self));
+    g_return_if_fail (SEAHORSE_GPGME_IS_KEY (key));
+
+    keyid = seahorse_pgp_key_get_keyid (SEAHORSE_PGP_KEY (key));
+    g_return_if_fail (g_hash_table_lookup (self->keys, keyid) == key);
+
+    g_object_ref (key);
+    g_hash_table_remove (self->digests, keyid);
+    g_hash_table_remove (self->keys, keyid);
+    self->snapshot_dirty = TRUE;
+    gcr_collection_emit_removed (GCR_COLLECTION (self), G_OBJECT (key));
+    g_object_unref (key);
+
+}
+
+static void queue_snapshot (SeahorseGpgmeKeyring *self);
+
+static void
+on_snapshot_written (GObject      *source,
+                     GAsyncResult *result,
+                     void         *user_data)
+{
+    g_autoptr(SeahorseGpgmeKeyring) self = SEAHORSE_GPGME_KEYRING (user_data);
+    g_autoptr(GError) error = NULL;
+
+    if (!seahorse_gpgme_snapshot_write_finish (result, &error))
+        g_message ("couldn't write key snapshot: %s", error->message);
+
+    /* Keys may have changed again while this one was being written */
+    self->snapshot_writing = FALSE;
+    queue_snapshot (self);
+}
+
+/* Remembers the current state of the keyring for the next startup */
+static gboolean
+save_snapshot (void *user_data)
+{
+    SeahorseGpgmeKeyring *self = SEAHORSE_GPGME_KEYRING (user_data);
+    g_autoptr(GPtrArray) snapshot = NULL;
+    GHashTableIter iter;
+    const char *keyid;
+    SeahorseGpgmeKey *key;
+
+    self->scheduled_snapshot = 0;
+    self->snapshot_dirty = FALSE;
+    self->snapshot_writing = TRUE;
+
+    snapshot = g_ptr_array_new_full (g_hash_table_size (self->keys),
+                                     (GDestroyNotify) seahorse_gpgme_snapshot_key_free);
+    g_hash_table_iter_init (&iter, self->keys);
+    while (g_hash_table_iter_next (&iter, (void **) &keyid, (void **) &key)) {
+        SeahorseGpgmeSnapshotKey *record;
+
+        record = seahorse_gpgme_key_to_snapshot (key);
+        if (record == NULL)
+            continue;
+
+        g_free (record->digest);
+        record->digest = g_strdup (g_hash_table_lookup (self->digests, keyid));
+        g_ptr_array_add (snapshot, record);
+    }
+
+    seahorse_gpgme_snapshot_write_async (snapshot, NULL, on_snapshot_written,
+                                         g_object_ref (self));
+    return G_SOURCE_REMOVE;
+}
+
+/* Saves a snapshot once the keys stop changing, one write at a time */
+static void
+queue_snapshot (SeahorseGpgmeKeyring *self)
+{
+    if (!self->use_snapshot || !self->snapshot_dirty)
+        return;
+    if (self->snapshot_writing || self->scheduled_snapshot != 0)
+        return;
+
+    self->scheduled_snapshot = g_timeout_add_seconds (SNAPSHOT_SAVE_DELAY,
+                                                      save_snapshot, self);
+}
+
+/* Fills the keyring with what the last snapshot remembered */
+static gboolean
+load_snapshot (SeahorseGpgmeKeyring *self)
+{
+    g_autoptr(GPtrArray) snapshot = NULL;
+    g_autoptr(GError) error = NULL;
+
+    snapshot = seahorse_gpgme_snapshot_read (&error);
+    if (error != NULL)
+        g_message ("couldn't read key snapshot: %s", error->message);
+    if (snapshot == NULL)
+        return FALSE;
+
+    g_signal_emit_by_name (self, "batch-started");
+    for (unsigned int i = 0; i < snapshot->len; i++) {
+        SeahorseGpgmeSnapshotKey *record = g_ptr_array_index (snapshot, i);
+        SeahorseGpgmeKey *pkey;
+
+        if (g_hash_table_contains (self->keys, record->keyid))
+            continue;
+
+        /* The digest lets the refresh skip keys that didn't change */
+        if (record->digest && record->digest[0])
+            g_hash_table_replace (self->digests, g_strdup (record->keyid),
+                                  g_strdup (record->digest));
+
+        pkey = seahorse_gpgme_key_new_from_snapshot (SEAHORSE_PLACE (self), record);
+        g_hash_table_insert (self->keys, g_strdup (record->keyid), pkey);
+        gcr_collection_emit_added (GCR_COLLECTION (self), G_OBJECT (pkey));
+    }
+    g_signal_emit_by_name (self, "batch-finished");
+
+    return TRUE;
+}
+
+static void
+on_keyring_refreshed (GObject      *source,
+                      GAsyncResult *result,
+                      void         *user_data)
+{
+    SeahorseGpgmeKeyring *self = SEAHORSE_GPGME_KEYRING (source);
+    g_autoptr(GError) error = NULL;
+
+    if (!seahorse_gpgme_keyring_list_finish (self, result, &error)) {
+        if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_message ("couldn't refresh keys: %s", error->message);
+        return;
+    }
+
+    queue_snapshot (self);
+}
+
+static void
+on_keyring_loaded (GObject      *source,
+                   GAsyncResult *result,
+                   void         *user_data)
+{
+    g_autoptr(GTask) task = G_TASK (user_data);
+    SeahorseGpgmeKeyring *self = SEAHORSE_GPGME_KEYRING (source);
+    g_autoptr(GError) error = NULL;
+
+    if (!g_task_propagate_boolean (G_TASK (result), &error)) {
+        g_task_return_error (task, g_steal_pointer (&error));
+        return;
+    }
+
+    queue_snapshot (self);
+    g_task_return_boolean (task, TRUE);
+}
+
+static void
+seahorse_gpgme_keyring_load_async (SeahorsePlace      *place,
+                                   GCancellable       *cancellable,
+                                   GAsyncReadyCallback callback,
+                                   void               *user_data)
+{
+    SeahorseGpgmeKeyring *self = SEAHORSE_GPGME_KEYRING (place);
+    g_autoptr(GTask) task = NULL;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+
+    /* Show what we had last time right away, and catch up in the background */
+    if (self->use_snapshot && load_snapshot (self)) {
+        g_debug ("loaded keys from snapshot, revalidating...");
+        seahorse_gpgme_keyring_refresh_async (self, NULL, on_keyring_refreshed, NULL);
+        g_task_return_boolean (task, TRUE);
+        return;
+    }
+
+    seahorse_gpgme_keyring_load_full_async (self, NULL, 0, cancellable,
+                                            on_keyring_loaded,
+                                            g_steal_pointer (&task));
+}
+
+static gboolean
+seahorse_gpgme_keyring_load_finish (SeahorsePlace *place,
+                                    GAsyncResult  *result,
+                                    GError       **error)
+{
+    g_return_val_if_fail (g_task_is_valid (result, place), FALSE);
+
+    return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/* What the last pre-filtered import saw of a key */
+typedef struct {
+    char *imported;                         /* Signatures of the keyblock we imported */
+    char *digest;                           /* The key's digest right after */
+    char *signatures;                       /* See calc_signatures_digest() */
+} ImportIndexEntry;
+
+static void
+import_index_entry_free (void *data)
+{
+    ImportIndexEntry *entry = data;
+    g_free (entry->imported);
+    g_free (entry->digest);
+    g_free (entry->signatures);
+    g_free (entry);
+}
+
+typedef struct {
+    SeahorseGpgmeKeyring *keyring;
+    gpgme_ctx_t gctx;
+    gpgme_data_t data;
+    gpgme_error_t gerr;
+    char **patterns;                        /* The keys to reload */
+    GPtrArray *imported;                    /* Fingerprints gpg imported */
+    GPtrArray *skipped;                     /* Fingerprints we didn't hand to gpg */
+
+    /* When pre-filtering */
+    GInputStream *input;                    /* What's being imported */
+    GInputStream *filtered_in;              /* What gpg reads */
+    GOutputStream *filtered;                /* The other end, for the keys gpg should see */
+    SeahorsePgpArmorDecoder *decoder;       /* If the input is armored */
+    GByteArray *decoded;
+    SeahorsePgpKeyblockSplitter *splitter;
+    GPtrArray *keyblocks;                   /* SeahorsePgpKeyblock, waiting to be checked */
+    gsize keyblocks_size;
+    gboolean input_done;
+    gboolean import_started;                /* Once there's something for gpg */
+    GPtrArray *sending;                     /* SeahorsePgpKeyblock, being written */
+    GArray *vectors;                        /* GOutputVector, for each of those */
+    GHashTable *sent;                       /* Fingerprint → signatures we handed to gpg */
+    GError *prefilter_error;
+    SeahorseGpgmeKeylist *keylist;          /* Signatures of the keys we might skip */
+    GHashTable *signatures;                 /* Fingerprint → signatures digest */
+} keyring_import_closure;
+
+static void
+keyring_import_free (void *data)
+{
+    keyring_import_closure *closure = data;
+    seahorse_gpgme_keyring_release_context (closure->gctx);
+    g_object_unref (closure->keyring);
+    g_strfreev (closure->patterns);
+    g_ptr_array_unref (closure->imported);
+    g_ptr_array_unref (closure->skipped);
+    g_clear_object (&closure->input);
+    g_clear_object (&closure->filtered_in);
+    g_clear_object (&closure->filtered);
+    g_clear_pointer (&closure->decoder, seahorse_pgp_armor_decoder_free);
+    g_clear_pointer (&closure->decoded, g_byte_array_unref);
+    g_clear_pointer (&closure->splitter, seahorse_pgp_keyblock_splitter_free);
+    g_clear_pointer (&closure->keyblocks, g_ptr_array_unref);
+    g_clear_pointer (&closure->sending, g_ptr_array_unref);
+    g_clear_pointer (&closure->vectors, g_array_unref);
+    g_clear_pointer (&closure->sent, g_hash_table_unref);
+    g_clear_error (&closure->prefilter_error);
+    if (closure->keylist) {
+        seahorse_gpgme_keylist_cancel (closure->keylist);
+        seahorse_gpgme_keylist_unref (closure->keylist);
+    }
+    g_clear_pointer (&closure->signatures, g_hash_table_unref);
+    g_free (closure);
+}
+
+/* Remembers the keys gpg now has, so the next import can skip them */
+static void
+update_import_index (keyring_import_closure *closure)
+{
+    SeahorseGpgmeKeyring *self = closure->keyring;
+
+    if (closure->sent == NULL)
+        return;
+
+    for (unsigned int i = 0; i < closure->imported->len; i++) {
+        const char *fingerprint = g_ptr_array_index (closure->imported, i);
+        g_autofree char *signatures = NULL;
+        SeahorseGpgmeKey *pkey;
+        ImportIndexEntry *entry;
+        const char *imported;
+        const char *digest;
+
+        imported = g_hash_table_lookup (closure->sent, fingerprint);
+        digest = g_hash_table_lookup (self->digests, fingerprint);
+        pkey = g_hash_table_lookup (self->keys, fingerprint);
+        if (imported == NULL || digest == NULL || pkey == NULL)
+            continue;
+
+        /* The keys were reloaded with their signatures after the import */
+        signatures = calc_signatures_digest (seahorse_gpgme_key_get_public (pkey));
+        if (signatures == NULL)
+            continue;
+
+        entry = g_hash_table_lookup (self->import_index, fingerprint);
+        if (entry == NULL) {
+            entry = g_new0 (ImportIndexEntry, 1);
+            g_hash_table_replace (self->import_index, g_strdup (fingerprint), entry);
+        }
+
+        g_free (entry->imported);
+        entry->imported = g_strdup (imported);
+        g_free (entry->digest);
+        entry->digest = g_strdup (digest);
+        g_free (entry->signatures);
+        entry->signatures = g_steal_pointer (&signatures);
+    }
+}
+
+static void
+keyring_import_done (GTask *task)
+{
+    keyring_import_closure *closure = g_task_get_task_data (task);
+    GHashTable *keys = closure->keyring->keys;
+    g_autoptr(GList) results = NULL;
+
+    for (unsigned int i = 0; i < closure->imported->len; i++) {
+        const char *fpr = g_ptr_array_index (closure->imported, i);
+        SeahorseObject *object;
+
+        object = g_hash_table_lookup (keys, fpr);
+        if (object == NULL) {
+            g_warning ("imported key but then couldn't find it in keyring: %s", fpr);
+            continue;
+        }
+
+        results = g_list_prepend (results, object);
+    }
+
+    /* These were checked to be in the keyring before skipping them */
+    for (unsigned int i = 0; i < closure->skipped->len; i++) {
+        SeahorseObject *object;
+
+        object = g_hash_table_lookup (keys, g_ptr_array_index (closure->skipped, i));
+        if (object != NULL)
+            results = g_list_prepend (results, object);
+    }
+
+    update_import_index (closure);
+
+    seahorse_progress_end (g_task_get_cancellable (task), task);
+    g_task_return_pointer (task, g_steal_pointer (&results), (GDestroyNotify) g_list_free);
+}
+
+static void
+on_keyring_import_loaded (GObject      *source,
+                          GAsyncResult *result,
+                          void         *user_data)
+{
+    g_autoptr(GTask) task = G_TASK (user_data);
+
+    keyring_import_done (task);
+}
+
+/* The pre-filter remembers the signatures of what it imported, so an
+ * unchanged key that we don't have the signatures of is reloaded anyway */
+static gboolean
+has_signatures_loaded (SeahorseGpgmeKeyring *self,
+                       const char           *fingerprint)
+{
+    SeahorseGpgmeKey *pkey;
+    gpgme_key_t key;
+
+    pkey = g_hash_table_lookup (self->keys, fingerprint);
+    if (pkey == NULL)
+        return FALSE;
+
+    key = seahorse_gpgme_key_get_public (pkey);
+    return key != NULL && (key->keylist_mode & GPGME_KEYLIST_MODE_SIGS);
+}
+
+/* Once gpgme is done, and we're done feeding it the input */
+static void
+on_keyring_import_input_done (GObject      *source,
+                              GAsyncResult *result,
+                              void         *user_data)
+{
+    g_autoptr(GTask) task = G_TASK (user_data);
+    keyring_import_closure *closure = g_task_get_task_data (task);
+    gpgme_import_result_t results;
+    gpgme_import_status_t import;
+    g_autoptr(GPtrArray) patterns = NULL;
+    g_autoptr(GError) error = NULL;
+    const char *msg;
+
+    /* gpg is done reading, so a pre-filter that's still writing can stop */
+    if (closure->filtered_in)
+        g_input_stream_close (closure->filtered_in, NULL, NULL);
+
+    if (seahorse_gpgme_propagate_error (closure->gerr, &error) ||
+        !seahorse_gpgme_data_pipe_finish (result, &error)) {
+        g_task_return_error (task, g_steal_pointer (&error));
+        return;
+    }
+
+    /* The pre-filter ended the input early */
+    if (closure->prefilter_error) {
+        g_task_return_error (task, g_error_copy (closure->prefilter_error));
+        return;
+    }
+
+    /* Figure out which keys were imported */
+    results = gpgme_op_import_result (closure->gctx);
+    if (results == NULL) {
+        g_task_return_pointer (task, NULL, NULL);
+        return;
+    }
+
+    /* Only keys that gpg actually changed need reloading, or ones we
+     * haven't loaded at all yet */
+    patterns = g_ptr_array_new ();
+    for (import = results->imports; import != NULL; import = import->next) {
+        if (!GPG_IS_OK (import->result) || import->fpr == NULL)
+            continue;
+
+        g_ptr_array_add (closure->imported, g_strdup (import->fpr));
+        if (import->status != 0 ||
+            !g_hash_table_contains (closure->keyring->keys, import->fpr) ||
+            (closure->sent && !has_signatures_loaded (closure->keyring, import->fpr)))
+            g_ptr_array_add (patterns, g_strdup (import->fpr));
+    }
+
+    /* See if we've managed to import any ... */
+    if (closure->imported->len == 0 && closure->skipped->len == 0) {
+        /* ... try and find out why */
+        if (results->considered > 0 && results->no_user_id) {
+            msg = _("Invalid key data (missing UIDs). This may be due to a computer with a date set in the future or a missing self-signature.");
+            g_task_return_new_error (task, SEAHORSE_ERROR, -1, "%s", msg);
+            return;
+        }
+
+        g_task_return_pointer (task, NULL, NULL);
+        return;
+    }
+
+    if (patterns->len == 0) {
+        keyring_import_done (task);
+        return;
+    }
+
+    /* Reload the keys that changed */
+    g_ptr_array_add (patterns, NULL);
+    closure->patterns = (char **) g_ptr_array_free (g_steal_pointer (&patterns), FALSE);
+    seahorse_gpgme_keyring_load_full_async (closure->keyring,
+                                            (const char **) closure->patterns,
+                                            LOAD_FULL,
+                                            g_task_get_cancellable (task),
+                                            on_keyring_import_loaded,
+                                            g_steal_pointer (&task));
+}
+
+/* Runs the import itself, which blocks on the input pipe */
+static void
+keyring_import_thread (GTask        *task,
+                       void         *source_object,
+                       void         *task_data,
+                       GCancellable *cancellable)
+{
+    keyring_import_closure *closure = task_data;
+
+    closure->gerr = gpgme_op_import (closure->gctx, closure->data);
+    g_task_return_boolean (task, TRUE);
+}
+
+static void
+on_keyring_import_complete (GObject      *source,
+                            GAsyncResult *result,
+                            void         *user_data)
+{
+    g_autoptr(GTask) task = G_TASK (user_data);
+    keyring_import_closure *closure = g_task_get_task_data (task);
+
+    /* Carries on in on_keyring_import_input_done() */
+    g_clear_pointer (&closure->data, gpgme_data_release);
+}
+
+static gboolean
+keyring_import_start (GTask        *task,
+                      GInputStream *input)
+{
+    keyring_import_closure *closure = g_task_get_task_data (task);
+    GCancellable *cancellable = g_task_get_cancellable (task);
+    g_autoptr(GTask) import_task = NULL;
+    g_autoptr(GError) error = NULL;
+
+    closure->data = seahorse_gpgme_data_input_pipe (input, cancellable,
+                                                    on_keyring_import_input_done,
+                                                    g_object_ref (task),
+                                                    &error);
+    if (closure->data == NULL) {
+        g_task_return_error (task, g_steal_pointer (&error));
+        g_object_unref (task); /* for the callback */
+        return FALSE;
+    }
+
+    /* A cancelled copy ends the input, which ends the import */
+    import_task = g_task_new (NULL, NULL, on_keyring_import_complete, g_object_ref (task));
+    g_task_set_task_data (import_task, closure, NULL);
+    g_task_run_in_thread (import_task, keyring_import_thread);
+    return TRUE;
 }
 
-/**
- * seahorse_gpgme_keyring_lookup:
- * @self: A #SeahorseGpgmeKeyring
- * @keyid: A PGP key id
- *
- * Looks up the key for @keyid in @self and returns it (or %NULL if not found).
- *
- * Returns: (transfer none) (nullable): The requested key, or %NULL
- */
-SeahorseGpgmeKey *
-seahorse_gpgme_keyring_lookup (SeahorseGpgmeKeyring *self,
-                               const char           *keyid)
+/* Whether gpg might already have everything @keyblock could tell it. This
+ * only looks at what we know already, see is_keyblock_known() */
+static gboolean
+is_keyblock_maybe_known (SeahorseGpgmeKeyring *self,
+                         SeahorsePgpKeyblock  *keyblock)
 {
-    g_return_val_if_fail (SEAHORSE_IS_GPGME_KEYRING (self), NULL);
-    g_return_val_if_fail (keyid != NULL, NULL);
+    ImportIndexEntry *entry;
+    const char *digest;
 
-    return g_hash_table_lookup (self->keys, keyid);
+    /* There's no telling what changed in a secret key */
+    if (keyblock->secret || keyblock->fingerprint == NULL)
+        return FALSE;
+
+    /* Only the very same signatures as last time. A late certification or
+     * a revocation can be older than anything we've seen of the key. */
+    entry = g_hash_table_lookup (self->import_index, keyblock->fingerprint);
+    if (entry == NULL || !g_str_equal (keyblock->signatures, entry->imported))
+        return FALSE;
+
+    /* Anything else changing the key (eg: gpg --refresh-keys) changes the digest */
+    digest = g_hash_table_lookup (self->digests, keyblock->fingerprint);
+    return digest != NULL && g_str_equal (digest, entry->digest) &&
+           g_hash_table_contains (self->keys, keyblock->fingerprint);
 }
 
-void
-seahorse_gpgme_keyring_remove_key (SeahorseGpgmeKeyring *self,
-                                   SeahorseGpgmeKey *key)
+/* Whether gpg already has everything @keyblock could tell it. Signatures
+ * that were removed since (eg: with gpg --edit-key delsig) don't show up in
+ * the digest, so the signatures we just listed have to match too. */
+static gboolean
+is_keyblock_known (keyring_import_closure *closure,
+                   SeahorsePgpKeyblock    *keyblock)
 {
-    const char *keyid;
+    ImportIndexEntry *entry;
+    const char *signatures;
 
-    g_return_if_fail (SEAHORSE_IS_GPGME_KEYRING (self));
-    g_return_if_fail (SEAHORSE_GPGME_IS_KEY (key));
+    if (closure->signatures == NULL ||
+        !is_keyblock_maybe_known (closure->keyring, keyblock))
+        return FALSE;
 
-    keyid = seahorse_pgp_key_get_keyid (SEAHORSE_PGP_KEY (key));
-    g_return_if_fail (g_hash_table_lookup (self->keys, keyid) == key);
+    entry = g_hash_table_lookup (closure->keyring->import_index, keyblock->fingerprint);
+    signatures = g_hash_table_lookup (closure->signatures, keyblock->fingerprint);
+    return signatures != NULL && entry->signatures != NULL &&
+           g_str_equal (signatures, entry->signatures);
+}
 
-    g_object_ref (key);
-    g_hash_table_remove (self->keys, keyid);
-    gcr_collection_emit_removed (GCR_COLLECTION (self), G_OBJECT (key));
-    g_object_unref (key);
+/*
+ * The pre-filter reads the import a chunk at a time, and splits it into keys.
+ * Once those add up to a batch, the keys that look unchanged are listed with
+ * their signatures in one go. Then the keys gpg doesn't have yet are written
+ * to the pipe it reads from. Only a batch of keys is in memory at a time, and
+ * gpg gets going on the first one while the rest is still being read. If
+ * gpg already has all the keys, it isn't started at all.
+ */
 
-}
+static void prefilter_read (GTask *task);
 
+/* Ends the input, which ends the import. An error is returned once gpg is
+ * done with what it got so far. */
 static void
-seahorse_gpgme_keyring_load_async (SeahorsePlace      *place,
-                                   GCancellable       *cancellable,
-                                   GAsyncReadyCallback callback,
-                                   void               *user_data)
+prefilter_stop (GTask  *task,
+                GError *error)
 {
-    SeahorseGpgmeKeyring *self = SEAHORSE_GPGME_KEYRING (place);
-    seahorse_gpgme_keyring_load_full_async (self, NULL, 0, cancellable,
-                                            callback, user_data);
+    keyring_import_closure *closure = g_task_get_task_data (task);
+
+    if (!closure->import_started) {
+        if (error != NULL)
+            g_task_return_error (task, error);
+        else
+            keyring_import_done (task);
+        return;
+    }
+
+    if (error != NULL && closure->prefilter_error == NULL)
+        closure->prefilter_error = g_steal_pointer (&error);
+    g_clear_error (&error);
+
+    g_output_stream_close (closure->filtered, NULL, NULL);
 }
 
-static gboolean
-seahorse_gpgme_keyring_load_finish (SeahorsePlace *place,
-                                    GAsyncResult  *result,
-                                    GError       **error)
+/* Once a batch is done with */
+static void
+prefilter_next (GTask *task)
 {
-    g_return_val_if_fail (g_task_is_valid (result, place), FALSE);
+    keyring_import_closure *closure = g_task_get_task_data (task);
 
-    return g_task_propagate_boolean (G_TASK (result), error);
+    if (closure->input_done)
+        prefilter_stop (task, NULL);
+    else
+        prefilter_read (task);
 }
 
-typedef struct {
-    SeahorseGpgmeKeyring *keyring;
-    gpgme_ctx_t gctx;
-    gpgme_data_t data;
-    char **patterns;
-} keyring_import_closure;
-
 static void
-keyring_import_free (void *data)
+on_prefilter_written (GObject      *source,
+                      GAsyncResult *result,
+                      void         *user_data)
 {
-    keyring_import_closure *closure = data;
-    if (closure->gctx)
-        gpgme_release (closure->gctx);
-    gpgme_data_release (closure->data);
-    g_object_unref (closure->keyring);
-    g_strfreev (closure->patterns);
-    g_free (closure);
+    g_autoptr(GTask) task = G_TASK (user_data);
+    keyring_import_closure *closure = g_task_get_task_data (task);
+    g_autoptr(GError) error = NULL;
+
+    g_clear_pointer (&closure->sending, g_ptr_array_unref);
+    g_clear_pointer (&closure->vectors, g_array_unref);
+
+    if (!g_output_stream_writev_all_finish (G_OUTPUT_STREAM (source), result, NULL, &error))
+        prefilter_stop (task, g_steal_pointer (&error));
+    else
+        prefilter_next (task);
 }
 
+/* Hands gpg the keys of the batch it doesn't have yet */
 static void
-on_keyring_import_loaded (GObject      *source,
-                          GAsyncResult *result,
-                          void         *user_data)
+prefilter_write (GTask *task)
 {
-    g_autoptr(GTask) task = G_TASK (user_data);
     keyring_import_closure *closure = g_task_get_task_data (task);
-    g_autoptr(GList) keys = NULL;
+    g_autoptr(GPtrArray) keyblocks = NULL;
+    unsigned int skipped = closure->skipped->len;
 
-    for (unsigned int i = 0; closure->patterns[i] != NULL; i++) {
-        SeahorseObject *object;
+    keyblocks = g_steal_pointer (&closure->keyblocks);
+    closure->keyblocks = g_ptr_array_new_with_free_func ((GDestroyNotify) seahorse_pgp_keyblock_free);
+    closure->keyblocks_size = 0;
 
-        object = g_hash_table_lookup (closure->keyring->keys, closure->patterns[i]);
-        if (object == NULL) {
-            g_warning ("imported key but then couldn't find it in keyring: %s",
-                       closure->patterns[i]);
+    closure->sending = g_ptr_array_new_with_free_func ((GDestroyNotify) seahorse_pgp_keyblock_free);
+    closure->vectors = g_array_new (FALSE, FALSE, sizeof (GOutputVector));
+    for (unsigned int i = 0; i < keyblocks->len; i++) {
+        SeahorsePgpKeyblock *keyblock = g_ptr_array_index (keyblocks, i);
+        GOutputVector vector;
+
+        if (is_keyblock_known (closure, keyblock)) {
+            g_ptr_array_add (closure->skipped, g_strdup (keyblock->fingerprint));
             continue;
         }
 
-        keys = g_list_prepend (keys, object);
+        if (keyblock->fingerprint != NULL)
+            g_hash_table_replace (closure->sent, g_strdup (keyblock->fingerprint),
+                                  g_strdup (keyblock->signatures));
+
+        vector.buffer = g_bytes_get_data (keyblock->packets, &vector.size);
+        g_array_append_val (closure->vectors, vector);
+        g_ptr_array_add (closure->sending, g_steal_pointer (&g_ptr_array_index (keyblocks, i)));
     }
 
-    seahorse_progress_end (g_task_get_cancellable (task), task);
-    g_task_return_pointer (task, g_steal_pointer (&keys), (GDestroyNotify) g_list_free);
+    g_clear_pointer (&closure->signatures, g_hash_table_unref);
+    g_debug ("[import] skipping %u of %u keys that are already known",
+             closure->skipped->len - skipped, keyblocks->len);
+
+    if (closure->vectors->len == 0) {
+        g_clear_pointer (&closure->sending, g_ptr_array_unref);
+        g_clear_pointer (&closure->vectors, g_array_unref);
+        prefilter_next (task);
+        return;
+    }
+
+    if (!closure->import_started) {
+        closure->import_started = TRUE;
+        if (!keyring_import_start (task, closure->filtered_in))
+            return;
+    }
+
+    g_output_stream_writev_all_async (closure->filtered,
+                                      (GOutputVector *) closure->vectors->data,
+                                      closure->vectors->len,
+                                      G_PRIORITY_DEFAULT,
+                                      g_task_get_cancellable (task),
+                                      on_prefilter_written,
+                                      g_object_ref (task));
 }
 
 static gboolean
-on_keyring_import_complete (gpgme_error_t gerr, void *user_data)
+on_import_signatures_listed (SeahorseGpgmeKeylist *keylist,
+                             void                 *user_data)
 {
     GTask *task = G_TASK (user_data);
     keyring_import_closure *closure = g_task_get_task_data (task);
-    gpgme_import_result_t results;
-    int i;
-    gpgme_import_status_t import;
     g_autoptr(GError) error = NULL;
-    const char *msg;
+    GPtrArray *batch;
+    gpgme_error_t gerr;
+
+    while ((batch = seahorse_gpgme_keylist_pop (keylist)) != NULL) {
+        for (unsigned int i = 0; i < batch->len; i++) {
+            gpgme_key_t key = g_ptr_array_index (batch, i);
+            char *signatures;
+
+            signatures = calc_signatures_digest (key);
+            if (key->fpr && signatures)
+                g_hash_table_replace (closure->signatures, g_strdup (key->fpr), signatures);
+            else
+                g_free (signatures);
+        }
+        g_ptr_array_unref (batch);
+    }
 
-    if (seahorse_gpgme_propagate_error (gerr, &error)) {
-        g_task_return_error (task, g_steal_pointer (&error));
-        return FALSE; /* don't call again */
+    if (!seahorse_gpgme_keylist_is_done (keylist, &gerr))
+        return G_SOURCE_REMOVE;
+
+    if (g_cancellable_set_error_if_cancelled (g_task_get_cancellable (task), &error)) {
+        prefilter_stop (task, g_steal_pointer (&error));
+        return G_SOURCE_REMOVE;
     }
 
-    /* Figure out which keys were imported */
-    results = gpgme_op_import_result (closure->gctx);
-    if (results == NULL) {
-        g_task_return_pointer (task, NULL, NULL);
-        return FALSE; /* don't call again */
+    /* Then we just can't skip anything */
+    if (!GPG_IS_OK (gerr)) {
+        g_debug ("[import] couldn't list signatures: %s", gpgme_strerror (gerr));
+        g_clear_pointer (&closure->signatures, g_hash_table_unref);
+    }
+
+    prefilter_write (task);
+    return G_SOURCE_REMOVE;
+}
+
+/* Lists the signatures of the keys in the batch that look unchanged */
+static void
+prefilter_check (GTask *task)
+{
+    keyring_import_closure *closure = g_task_get_task_data (task);
+    g_autoptr(GPtrArray) patterns = NULL;
+
+    patterns = g_ptr_array_new ();
+    for (unsigned int i = 0; i < closure->keyblocks->len; i++) {
+        SeahorsePgpKeyblock *keyblock = g_ptr_array_index (closure->keyblocks, i);
+        if (is_keyblock_maybe_known (closure->keyring, keyblock))
+            g_ptr_array_add (patterns, keyblock->fingerprint);
     }
 
-    /* Dig out all the fingerprints for use as load patterns */
-    closure->patterns = g_new0 (char*, results->considered + 1);
-    for (i = 0, import = results->imports;
-         i < results->considered && import;
-         import = import->next) {
-        if (GPG_IS_OK (import->result))
-            closure->patterns[i++] = g_strdup (import->fpr);
+    if (patterns->len == 0) {
+        prefilter_write (task);
+        return;
     }
 
-    /* See if we've managed to import any ... */
-    if (closure->patterns[0] == NULL) {
-        /* ... try and find out why */
-        if (results->considered > 0 && results->no_user_id) {
-            msg = _("Invalid key data (missing UIDs). This may be due to a computer with a date set in the future or a missing self-signature.");
-            g_task_return_new_error (task, SEAHORSE_ERROR, -1, "%s", msg);
+    g_ptr_array_add (patterns, NULL);
+    closure->signatures = g_hash_table_new_full (seahorse_pgp_keyid_hash,
+                                                 seahorse_pgp_keyid_equal,
+                                                 g_free, g_free);
+    g_clear_pointer (&closure->keylist, seahorse_gpgme_keylist_unref);
+    closure->keylist = seahorse_gpgme_keylist_new ((const char **) patterns->pdata, FALSE,
+                                                   GPGME_KEYLIST_MODE_LOCAL |
+                                                   GPGME_KEYLIST_MODE_SIGS);
+    seahorse_gpgme_keylist_start (closure->keylist, on_import_signatures_listed,
+                                  g_object_ref (task), g_object_unref);
+}
+
+static void
+on_prefilter_read (GObject      *source,
+                   GAsyncResult *result,
+                   void         *user_data)
+{
+    g_autoptr(GTask) task = G_TASK (user_data);
+    keyring_import_closure *closure = g_task_get_task_data (task);
+    g_autoptr(GBytes) bytes = NULL;
+    g_autoptr(GError) error = NULL;
+    unsigned int split = closure->keyblocks->len;
+    const guint8 *data;
+    gsize len;
+
+    bytes = g_input_stream_read_bytes_finish (G_INPUT_STREAM (source), result, &error);
+    if (bytes == NULL) {
+        prefilter_stop (task, g_steal_pointer (&error));
+        return;
+    }
+
+    data = g_bytes_get_data (bytes, &len);
+    if (len == 0) {
+        closure->input_done = TRUE;
+        if (closure->splitter)
+            seahorse_pgp_keyblock_splitter_finish (closure->splitter, closure->keyblocks);
+
+    } else {
+        /* Binary packets always have the top bit of the first byte set */
+        if (closure->splitter == NULL) {
+            const char * const types[] = {
+                SEAHORSE_PGP_ARMOR_PUBLIC_KEY, SEAHORSE_PGP_ARMOR_PRIVATE_KEY, NULL
+            };
+
+            closure->splitter = seahorse_pgp_keyblock_splitter_new ();
+            if (!(data[0] & 0x80))
+                closure->decoder = seahorse_pgp_armor_decoder_new (types);
         }
 
-        g_task_return_pointer (task, NULL, NULL);
-        return FALSE; /* don't call again */
+        /* Anything armored that isn't a key is dropped */
+        if (closure->decoder) {
+            g_byte_array_set_size (closure->decoded, 0);
+            seahorse_pgp_armor_decoder_feed (closure->decoder, (const char *) data, len,
+                                             closure->decoded);
+            data = closure->decoded->data;
+            len = closure->decoded->len;
+        }
+
+        seahorse_pgp_keyblock_splitter_feed (closure->splitter, data, len, closure->keyblocks);
     }
 
-    /* Reload public keys */
-    seahorse_gpgme_keyring_load_full_async (closure->keyring,
-                                            (const char **) closure->patterns,
-                                            LOAD_FULL,
-                                            g_task_get_cancellable (task),
-                                            on_keyring_import_loaded,
-                                            g_object_ref (task));
+    for (unsigned int i = split; i < closure->keyblocks->len; i++) {
+        SeahorsePgpKeyblock *keyblock = g_ptr_array_index (closure->keyblocks, i);
+        closure->keyblocks_size += g_bytes_get_size (keyblock->packets);
+    }
+
+    if (closure->input_done || closure->keyblocks_size >= PREFILTER_BATCH_SIZE)
+        prefilter_check (task);
+    else
+        prefilter_read (task);
+}
+
+static void
+prefilter_read (GTask *task)
+{
+    keyring_import_closure *closure = g_task_get_task_data (task);
+
+    g_input_stream_read_bytes_async (closure->input, PREFILTER_READ_SIZE,
+                                     G_PRIORITY_DEFAULT, g_task_get_cancellable (task),
+                                     on_prefilter_read, g_object_ref (task));
+}
+
+static void
+prefilter_start (GTask        *task,
+                 GInputStream *input)
+{
+    keyring_import_closure *closure = g_task_get_task_data (task);
+    g_autoptr(GError) error = NULL;
+    int fds[2];
+
+    if (!g_unix_open_pipe (fds, FD_CLOEXEC, &error)) {
+        g_task_return_error (task, g_steal_pointer (&error));
+        return;
+    }
+
+    closure->input = g_object_ref (input);
+    closure->filtered_in = g_unix_input_stream_new (fds[0], TRUE);
+    closure->filtered = g_unix_output_stream_new (fds[1], TRUE);
+    closure->decoded = g_byte_array_new ();
+    closure->keyblocks = g_ptr_array_new_with_free_func ((GDestroyNotify) seahorse_pgp_keyblock_free);
+    closure->sent = g_hash_table_new_full (seahorse_pgp_keyid_hash,
+                                           seahorse_pgp_keyid_equal,
+                                           g_free, g_free);
+
+    /* Writing waits for gpg to catch up, without blocking the main loop */
+    if (!g_unix_set_fd_nonblocking (fds[1], TRUE, &error)) {
+        g_task_return_error (task, g_steal_pointer (&error));
+        return;
+    }
 
-    return FALSE; /* don't call again */
+    prefilter_read (task);
 }
 
 void
@@ -665,29 +1980,26 @@ seahorse_gpgme_keyring_import_async (SeahorseGpgmeKeyring *self,
     keyring_import_closure *closure;
     gpgme_error_t gerr = 0;
     g_autoptr(GError) error = NULL;
-    g_autoptr(GSource) gsource = NULL;
 
     task = g_task_new (self, cancellable, callback, user_data);
     closure = g_new0 (keyring_import_closure, 1);
-    closure->gctx = seahorse_gpgme_keyring_new_context (&gerr);
-    closure->data = seahorse_gpgme_data_input (input);
+    closure->gctx = seahorse_gpgme_keyring_acquire_context ("import", &gerr);
     closure->keyring = g_object_ref (self);
+    closure->imported = g_ptr_array_new_with_free_func (g_free);
+    closure->skipped = g_ptr_array_new_with_free_func (g_free);
     g_task_set_task_data (task, closure, keyring_import_free);
 
-    if (gerr == 0) {
-        seahorse_progress_prep_and_begin (cancellable, task, NULL);
-        gsource = seahorse_gpgme_gsource_new (closure->gctx, cancellable);
-        g_source_set_callback (gsource, (GSourceFunc)on_keyring_import_complete,
-                               g_steal_pointer (&task), g_object_unref);
-        gerr = gpgme_op_import_start (closure->gctx, closure->data);
-    }
-
     if (seahorse_gpgme_propagate_error (gerr, &error)) {
         g_task_return_error (task, g_steal_pointer (&error));
         return;
     }
 
-    g_source_attach (gsource, g_main_context_default ());
+    seahorse_progress_prep_and_begin (cancellable, task, NULL);
+
+    if (self->import_prefilter)
+        prefilter_start (task, input);
+    else
+        keyring_import_start (task, input);
 }
 
 GList *
@@ -700,6 +2012,33 @@ seahorse_gpgme_keyring_import_finish (SeahorseGpgmeKeyring *self,
     return g_task_propagate_pointer (G_TASK (result), error);
 }
 
+/*
+ * Cheaply lists all keys (no signatures) and only realizes the keys which
+ * were added or changed since we last saw them. Keys which are gone are
+ * removed.
+ *
+ * The listing has to tell us about secret keys too, or a secret key that
+ * was added or removed wouldn't change anything. Without a single pass
+ * listing, everything is loaded again.
+ */
+static void
+seahorse_gpgme_keyring_refresh_async (SeahorseGpgmeKeyring *self,
+                                      GCancellable         *cancellable,
+                                      GAsyncReadyCallback   callback,
+                                      void                 *user_data)
+{
+    if (!self->single_pass || !can_list_with_secret ()) {
+        seahorse_gpgme_keyring_load_full_async (self, NULL, 0, cancellable,
+                                                callback, user_data);
+        return;
+    }
+
+    g_debug ("refreshing changed keys...");
+    seahorse_gpgme_keyring_list_async (self, NULL,
+                                       LOAD_INCREMENTAL | LOAD_WITH_SECRET, FALSE,
+                                       cancellable, callback, user_data);
+}
+
 static gboolean
 scheduled_refresh (void *user_data)
 {
@@ -707,7 +2046,7 @@ scheduled_refresh (void *user_data)
 
     g_debug ("scheduled refresh event ocurring now");
     cancel_scheduled_refresh (self);
-    seahorse_gpgme_keyring_load_async (SEAHORSE_PLACE (self), NULL, NULL, NULL);
+    seahorse_gpgme_keyring_refresh_async (self, NULL, on_keyring_refreshed, NULL);
 
     return G_SOURCE_REMOVE;
 }
@@ -750,6 +2089,15 @@ seahorse_gpgme_keyring_init (SeahorseGpgmeKeyring *self)
     self->keys = g_hash_table_new_full (seahorse_pgp_keyid_hash,
                                         seahorse_pgp_keyid_equal,
                                         g_free, g_object_unref);
+    self->digests = g_hash_table_new_full (seahorse_pgp_keyid_hash,
+                                           seahorse_pgp_keyid_equal,
+                                           g_free, g_free);
+    self->orphan_secret = g_hash_table_new_full (seahorse_pgp_keyid_hash,
+                                                 seahorse_pgp_keyid_equal,
+                                                 g_free, g_object_unref);
+    self->import_index = g_hash_table_new_full (seahorse_pgp_keyid_hash,
+                                                seahorse_pgp_keyid_equal,
+                                                g_free, import_index_entry_free);
 
     self->scheduled_refresh = 0;
     self->monitor_handle = NULL;
@@ -877,6 +2225,18 @@ seahorse_gpgme_keyring_get_property (GObject     *obj,
     case PROP_SHOW_IF_EMPTY:
         g_value_set_boolean (value, TRUE);
         break;
+    case PROP_LOAD_BUDGET:
+        g_value_set_uint (value, SEAHORSE_GPGME_KEYRING (obj)->load_budget);
+        break;
+    case PROP_SINGLE_PASS:
+        g_value_set_boolean (value, SEAHORSE_GPGME_KEYRING (obj)->single_pass);
+        break;
+    case PROP_SNAPSHOT:
+        g_value_set_boolean (value, SEAHORSE_GPGME_KEYRING (obj)->use_snapshot);
+        break;
+    case PROP_IMPORT_PREFILTER:
+        g_value_set_boolean (value, SEAHORSE_GPGME_KEYRING (obj)->import_prefilter);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
         break;
@@ -895,6 +2255,18 @@ seahorse_gpgme_keyring_set_property (GObject      *obj,
     case PROP_LABEL:
         seahorse_gpgme_keyring_set_label (place, g_value_get_boxed (value));
         break;
+    case PROP_LOAD_BUDGET:
+        SEAHORSE_GPGME_KEYRING (obj)->load_budget = g_value_get_uint (value);
+        break;
+    case PROP_SINGLE_PASS:
+        SEAHORSE_GPGME_KEYRING (obj)->single_pass = g_value_get_boolean (value);
+        break;
+    case PROP_SNAPSHOT:
+        SEAHORSE_GPGME_KEYRING (obj)->use_snapshot = g_value_get_boolean (value);
+        break;
+    case PROP_IMPORT_PREFILTER:
+        SEAHORSE_GPGME_KEYRING (obj)->import_prefilter = g_value_get_boolean (value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
         break;
@@ -907,13 +2279,18 @@ seahorse_gpgme_keyring_dispose (GObject *object)
     SeahorseGpgmeKeyring *self = SEAHORSE_GPGME_KEYRING (object);
 
     g_hash_table_remove_all (self->keys);
+    g_hash_table_remove_all (self->digests);
+    g_hash_table_remove_all (self->import_index);
 
     cancel_scheduled_refresh (self);
+    g_clear_handle_id (&self->scheduled_snapshot, g_source_remove);
     g_clear_object (&self->monitor_handle);
 
-    for (GList *l = self->orphan_secret; l; l = g_list_next (l))
-        g_object_unref (l->data);
-    g_clear_pointer (&self->orphan_secret, g_list_free);
+    /* Queued photo jobs will just drop their results */
+    if (self->photo_cancellable)
+        g_cancellable_cancel (self->photo_cancellable);
+
+    g_hash_table_remove_all (self->orphan_secret);
 
     G_OBJECT_CLASS (seahorse_gpgme_keyring_parent_class)->dispose (object);
 }
@@ -924,7 +2301,13 @@ seahorse_gpgme_keyring_finalize (GObject *object)
     SeahorseGpgmeKeyring *self = SEAHORSE_GPGME_KEYRING (object);
 
     g_clear_object (&self->actions);
+    if (self->photo_pool)
+        g_thread_pool_free (self->photo_pool, FALSE, FALSE);
+    g_clear_object (&self->photo_cancellable);
     g_hash_table_destroy (self->keys);
+    g_hash_table_destroy (self->digests);
+    g_hash_table_destroy (self->orphan_secret);
+    g_hash_table_destroy (self->import_index);
 
     /* All monitoring and scheduling should be done */
     g_assert (self->scheduled_refresh == 0);
@@ -959,6 +2342,30 @@ seahorse_gpgme_keyring_class_init (SeahorseGpgmeKeyringClass *klass)
     g_object_class_override_property (gobject_class, PROP_ACTION_PREFIX, "action-prefix");
     g_object_class_override_property (gobject_class, PROP_MENU_MODEL, "menu-model");
     g_object_class_override_property (gobject_class, PROP_SHOW_IF_EMPTY, "show-if-empty");
+
+    g_object_class_install_property (gobject_class, PROP_LOAD_BUDGET,
+        g_param_spec_uint ("load-budget", "Load budget",
+                           "Time in microseconds to spend on loading keys per main loop iteration",
+                           1, G_MAXUINT, DEFAULT_LOAD_BUDGET,
+                           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property (gobject_class, PROP_SINGLE_PASS,
+        g_param_spec_boolean ("single-pass", "Single pass",
+                              "List secret keys along with the public keys, if gpg supports it",
+                              TRUE,
+                              G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property (gobject_class, PROP_SNAPSHOT,
+        g_param_spec_boolean ("snapshot", "Snapshot",
+                              "Show the keys from the last snapshot of the keyring while loading",
+                              TRUE,
+                              G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property (gobject_class, PROP_IMPORT_PREFILTER,
+        g_param_spec_boolean ("import-prefilter", "Import pre-filter",
+                              "Skip importing keys that haven't changed since the last import",
+                              TRUE,
+                              G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -1027,12 +2434,51 @@ seahorse_gpgme_keyring_new (void)
     return g_object_new (SEAHORSE_TYPE_GPGME_KEYRING, NULL);
 }
 
-gpgme_ctx_t
-seahorse_gpgme_keyring_new_context (gpgme_error_t *gerr)
+/*
+ * Setting up a context checks the engine version and copies the engine
+ * info every time. Short operations therefore borrow a context from a small
+ * pool and hand it back when they're done.
+ */
+#define CONTEXT_POOL_MAX 4
+
+typedef struct _ContextStats {
+    unsigned int created;
+    unsigned int reused;
+} ContextStats;
+
+static GMutex context_pool_lock;
+static GQueue context_pool = G_QUEUE_INIT;
+static GHashTable *context_stats = NULL;
+
+/* Must be called with context_pool_lock held */
+static ContextStats *
+lookup_context_stats_unlocked (const char *operation)
+{
+    ContextStats *stats;
+
+    if (operation == NULL)
+        operation = "unpooled";
+
+    if (context_stats == NULL)
+        context_stats = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                               g_free, g_free);
+
+    stats = g_hash_table_lookup (context_stats, operation);
+    if (stats == NULL) {
+        stats = g_new0 (ContextStats, 1);
+        g_hash_table_insert (context_stats, g_strdup (operation), stats);
+    }
+    return stats;
+}
+
+static gpgme_ctx_t
+create_context (const char    *operation,
+                gpgme_error_t *gerr)
 {
     gpgme_protocol_t proto = GPGME_PROTOCOL_OpenPGP;
     gpgme_error_t error = 0;
     gpgme_ctx_t ctx = NULL;
+    unsigned int created;
 
     error = gpgme_engine_check_version (proto);
     if (error == 0)
@@ -1050,7 +2496,130 @@ seahorse_gpgme_keyring_new_context (gpgme_error_t *gerr)
 
     gpgme_set_passphrase_cb (ctx, passphrase_get, NULL);
     gpgme_set_keylist_mode (ctx, GPGME_KEYLIST_MODE_LOCAL);
+
+    g_mutex_lock (&context_pool_lock);
+    created = ++lookup_context_stats_unlocked (operation)->created;
+    g_mutex_unlock (&context_pool_lock);
+
+    g_debug ("created GPGME context for %s (%u so far)",
+             operation ? operation : "unpooled", created);
+
+    if (gerr)
+        *gerr = 0;
+    return ctx;
+}
+
+/* Puts a context back into the state create_context() left it in */
+static void
+reset_context (gpgme_ctx_t ctx)
+{
+    struct gpgme_io_cbs io_cbs = { NULL, };
+
+    /* A SeahorseGpgmeGSource may have been attached, and is gone by now */
+    gpgme_set_io_cbs (ctx, &io_cbs);
+
+    gpgme_set_passphrase_cb (ctx, passphrase_get, NULL);
+    gpgme_set_progress_cb (ctx, NULL, NULL);
+    gpgme_set_status_cb (ctx, NULL, NULL);
+    gpgme_set_keylist_mode (ctx, GPGME_KEYLIST_MODE_LOCAL);
+    gpgme_set_pinentry_mode (ctx, GPGME_PINENTRY_MODE_DEFAULT);
+    gpgme_set_armor (ctx, 0);
+    gpgme_set_textmode (ctx, 0);
+    gpgme_set_offline (ctx, 0);
+    gpgme_signers_clear (ctx);
+    gpgme_sig_notation_clear (ctx);
+}
+
+gpgme_ctx_t
+seahorse_gpgme_keyring_new_context (gpgme_error_t *gerr)
+{
+    return create_context (NULL, gerr);
+}
+
+/**
+ * seahorse_gpgme_keyring_acquire_context:
+ * @operation: A short name for what the context is used for
+ * @gerr: (out) (optional): The error if no context could be created
+ *
+ * Borrows a context which is set up the same way as one from
+ * seahorse_gpgme_keyring_new_context(). Hand it back with
+ * seahorse_gpgme_keyring_release_context() once the operation on it has
+ * finished. This may be called from any thread.
+ *
+ * Returns: (transfer full) (nullable): A context, or %NULL on failure
+ */
+gpgme_ctx_t
+seahorse_gpgme_keyring_acquire_context (const char    *operation,
+                                        gpgme_error_t *gerr)
+{
+    gpgme_ctx_t ctx;
+
+    g_return_val_if_fail (operation != NULL, NULL);
+
+    g_mutex_lock (&context_pool_lock);
+    ctx = g_queue_pop_head (&context_pool);
+    if (ctx != NULL)
+        lookup_context_stats_unlocked (operation)->reused++;
+    g_mutex_unlock (&context_pool_lock);
+
+    if (ctx == NULL)
+        return create_context (operation, gerr);
+
     if (gerr)
         *gerr = 0;
     return ctx;
 }
+
+/**
+ * seahorse_gpgme_keyring_release_context:
+ * @ctx: (transfer full) (nullable): A context
+ *
+ * Hands back a context from seahorse_gpgme_keyring_acquire_context(). No
+ * operation may be running on @ctx anymore. Any settings which were changed
+ * on it are reset, so it can be handed out again.
+ */
+void
+seahorse_gpgme_keyring_release_context (gpgme_ctx_t ctx)
+{
+    if (ctx == NULL)
+        return;
+
+    reset_context (ctx);
+
+    g_mutex_lock (&context_pool_lock);
+    if (context_pool.length < CONTEXT_POOL_MAX) {
+        g_queue_push_head (&context_pool, ctx);
+        ctx = NULL;
+    }
+    g_mutex_unlock (&context_pool_lock);
+
+    if (ctx != NULL)
+        gpgme_release (ctx);
+}
+
+/**
+ * seahorse_gpgme_keyring_get_context_stats:
+ * @operation: (nullable): The name passed to
+ *   seahorse_gpgme_keyring_acquire_context(), or %NULL for contexts from
+ *   seahorse_gpgme_keyring_new_context()
+ * @created: (out) (optional): How many contexts were created
+ * @reused: (out) (optional): How many times a pooled context was handed out
+ *
+ * Reports how many contexts an operation needed, so we can tell how well
+ * the pool works.
+ */
+void
+seahorse_gpgme_keyring_get_context_stats (const char   *operation,
+                                          unsigned int *created,
+                                          unsigned int *reused)
+{
+    ContextStats *stats;
+
+    g_mutex_lock (&context_pool_lock);
+    stats = lookup_context_stats_unlocked (operation);
+    if (created)
+        *created = stats->created;
+    if (reused)
+        *reused = stats->reused;
+    g_mutex_unlock (&context_pool_lock);
+}
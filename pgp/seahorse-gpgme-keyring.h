@@ -50,12 +50,31 @@ SeahorseGpgmeKeyring * seahorse_gpgme_keyring_new            (void);
 
 gpgme_ctx_t            seahorse_gpgme_keyring_new_context    (gpgme_error_t *gerr);
 
+gpgme_ctx_t            seahorse_gpgme_keyring_acquire_context (const char    *operation,
+                                                               gpgme_error_t *gerr);
+
+void                   seahorse_gpgme_keyring_release_context (gpgme_ctx_t ctx);
+
+void                   seahorse_gpgme_keyring_get_context_stats (const char   *operation,
+                                                                 unsigned int *created,
+                                                                 unsigned int *reused);
+
 SeahorseGpgmeKey *     seahorse_gpgme_keyring_lookup         (SeahorseGpgmeKeyring *self,
                                                               const char           *keyid);
 
 void                   seahorse_gpgme_keyring_remove_key     (SeahorseGpgmeKeyring *self,
                                                               SeahorseGpgmeKey *key);
 
+void                   seahorse_gpgme_keyring_reload_keys_async  (SeahorseGpgmeKeyring *self,
+                                                                  const char * const   *fingerprints,
+                                                                  GCancellable         *cancellable,
+                                                                  GAsyncReadyCallback   callback,
+                                                                  void                 *user_data);
+
+gboolean               seahorse_gpgme_keyring_reload_keys_finish (SeahorseGpgmeKeyring *self,
+                                                                  GAsyncResult         *result,
+                                                                  GError              **error);
+
 void                   seahorse_gpgme_keyring_import_async   (SeahorseGpgmeKeyring *self,
                                                               GInputStream *input,
                                                               GCancellable *cancellable,
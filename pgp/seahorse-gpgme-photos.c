@@ -239,6 +239,26 @@ add_image_files (GtkWidget *dialog)
     gtk_file_chooser_add_filter (GTK_FILE_CHOOSER (dialog), filter);
 }
 
+static void
+on_photo_added (GObject *source, GAsyncResult *result, void *user_data)
+{
+	g_autofree char *tempfile = user_data;
+	g_autoptr(GError) error = NULL;
+
+	if (tempfile)
+		unlink (tempfile);
+
+	if (seahorse_gpgme_key_op_photo_add_finish (SEAHORSE_GPGME_KEY (source), result, &error))
+		return;
+
+	/* A special error value set by seahorse_key_op_photoid_add to
+	   denote an invalid format file */
+	if (g_error_matches (error, SEAHORSE_GPGME_ERROR, GPG_ERR_USER_1))
+		seahorse_util_show_error (NULL, _("Couldn’t add photo"),
+		                          _("The file could not be loaded. It may be in an invalid format."));
+	else
+		seahorse_util_handle_error (&error, NULL, _("Couldn’t add photo"));
+}
 
 gboolean
 seahorse_gpgme_photo_add (SeahorseGpgmeKey *pkey,
@@ -248,9 +268,7 @@ seahorse_gpgme_photo_add (SeahorseGpgmeKey *pkey,
 	gchar *filename = NULL;
 	gchar *tempfile = NULL;
 	GError *error = NULL;
-	gpgme_error_t gerr;
 	GtkWidget *chooser;
-	gboolean res = TRUE;
 
 	g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (pkey), FALSE);
 
@@ -278,35 +296,31 @@ seahorse_gpgme_photo_add (SeahorseGpgmeKey *pkey,
 
 	if (!prepare_photo_id (parent, filename, &tempfile, &error)) {
 		seahorse_util_handle_error (&error, NULL, _("Couldn’t prepare photo"));
+		g_free (filename);
 		return FALSE;
 	}
 
-	gerr = seahorse_gpgme_key_op_photo_add (pkey, tempfile ? tempfile : filename);
-	if (!GPG_IS_OK (gerr)) {
-
-		/* A special error value set by seahorse_key_op_photoid_add to
-		   denote an invalid format file */
-		if (gerr == GPG_E (GPG_ERR_USER_1))
-			seahorse_util_show_error (NULL, _("Couldn’t add photo"),
-			                          _("The file could not be loaded. It may be in an invalid format."));
-		else
-			seahorse_gpgme_handle_error (gerr, _("Couldn’t add photo"));
-		res = FALSE;
-	}
+	/* The temporary file is removed once gpg is done with it */
+	seahorse_gpgme_key_op_photo_add_async (pkey, tempfile ? tempfile : filename,
+	                                       NULL, on_photo_added, tempfile);
 
 	g_free (filename);
-	if (tempfile) {
-		unlink (tempfile);
-		g_free (tempfile);
-	}
+	return TRUE;
+}
+
+static void
+on_photo_deleted (GObject *source, GAsyncResult *result, void *user_data)
+{
+    g_autoptr(GError) error = NULL;
 
-	return res;
+    if (!seahorse_gpgme_key_op_photo_delete_finish (SEAHORSE_GPGME_PHOTO (source),
+                                                    result, &error))
+        seahorse_util_handle_error (&error, NULL, _("Couldn’t delete photo"));
 }
 
 gboolean
 seahorse_gpgme_photo_delete (SeahorseGpgmePhoto *photo, GtkWindow *parent)
 {
-    gpgme_error_t gerr;
     GtkWidget *dlg;
     int response;
 
@@ -325,11 +339,6 @@ seahorse_gpgme_photo_delete (SeahorseGpgmePhoto *photo, GtkWindow *parent)
     if (response != GTK_RESPONSE_ACCEPT)
         return FALSE;
 
-    gerr = seahorse_gpgme_key_op_photo_delete (photo);
-    if (!GPG_IS_OK (gerr)) {
-	    seahorse_gpgme_handle_error (gerr, _("Couldn’t delete photo"));
-        return FALSE;
-    }
-
+    seahorse_gpgme_key_op_photo_delete_async (photo, NULL, on_photo_deleted, NULL);
     return TRUE;
 }
@@ -55,6 +55,16 @@ static GParamSpec *obj_props[N_PROPS] = { NULL, };
 G_DEFINE_TYPE (SeahorseGpgmeRevokeDialog, seahorse_gpgme_revoke_dialog, GTK_TYPE_DIALOG)
 
 
+static void
+on_subkey_revoked (GObject *source, GAsyncResult *result, void *user_data)
+{
+    g_autoptr(GError) error = NULL;
+
+    if (!seahorse_gpgme_key_op_revoke_subkey_finish (SEAHORSE_GPGME_SUBKEY (source),
+                                                     result, &error))
+        seahorse_util_handle_error (&error, NULL, _("Couldn’t revoke subkey"));
+}
+
 static void
 on_gpgme_revoke_ok_clicked (GtkButton *button,
                             gpointer user_data)
@@ -62,7 +72,6 @@ on_gpgme_revoke_ok_clicked (GtkButton *button,
     SeahorseGpgmeRevokeDialog *self = SEAHORSE_GPGME_REVOKE_DIALOG (user_data);
     SeahorseRevokeReason reason;
     const char *description;
-    gpgme_error_t err;
     GtkTreeModel *model;
     GtkTreeIter iter;
     GValue value = G_VALUE_INIT;
@@ -76,9 +85,8 @@ on_gpgme_revoke_ok_clicked (GtkButton *button,
 
     description = gtk_entry_get_text (GTK_ENTRY (self->description_entry));
 
-    err = seahorse_gpgme_key_op_revoke_subkey (self->subkey, reason, description);
-    if (!GPG_IS_OK (err))
-        seahorse_gpgme_handle_error (err, _("Couldn’t revoke subkey"));
+    seahorse_gpgme_key_op_revoke_subkey_async (self->subkey, reason, description,
+                                               NULL, on_subkey_revoked, NULL);
 }
 
 static void
@@ -35,6 +35,7 @@ struct _SeahorseGpgmeSignDialog {
     GtkDialog parent_instance;
 
     SeahorseObject *to_sign;
+    GPtrArray *keys;            /* SeahorseGpgmeKey, when signing several */
 
     GtkWidget *to_sign_name_label;
 
@@ -91,6 +92,43 @@ on_gpgme_sign_choice_toggled (GtkToggleButton *toggle,
                             gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (self->sign_choice_careful)));
 }
 
+static void
+on_key_signed (GObject *source, GAsyncResult *result, void *user_data)
+{
+    g_autoptr(SeahorsePgpKey) signer = SEAHORSE_PGP_KEY (user_data);
+    g_autoptr(GError) error = NULL;
+    gboolean ok;
+
+    if (SEAHORSE_GPGME_IS_UID (source))
+        ok = seahorse_gpgme_key_op_sign_uid_finish (SEAHORSE_GPGME_UID (source), result, &error);
+    else
+        ok = seahorse_gpgme_key_op_sign_finish (SEAHORSE_GPGME_KEY (source), result, &error);
+
+    if (ok)
+        return;
+
+    if (g_error_matches (error, SEAHORSE_GPGME_ERROR, GPG_ERR_EALREADY)) {
+        GtkWidget *w;
+
+        w = gtk_message_dialog_new (NULL, GTK_DIALOG_MODAL, GTK_MESSAGE_INFO, GTK_BUTTONS_CLOSE,
+                                    _("This key was already signed by\n“%s”"),
+                                    seahorse_object_get_label (SEAHORSE_OBJECT (signer)));
+        gtk_dialog_run (GTK_DIALOG (w));
+        gtk_widget_destroy (w);
+    } else {
+        seahorse_util_handle_error (&error, NULL, _("Couldn’t sign key"));
+    }
+}
+
+static void
+on_keys_signed (GObject *source, GAsyncResult *result, void *user_data)
+{
+    g_autoptr(GError) error = NULL;
+
+    if (!seahorse_gpgme_key_op_bulk_finish (result, NULL, &error))
+        seahorse_util_handle_error (&error, NULL, _("Couldn’t sign keys"));
+}
+
 static void
 seahorse_gpgme_sign_dialog_response (GtkDialog *dialog, int response)
 {
@@ -98,7 +136,6 @@ seahorse_gpgme_sign_dialog_response (GtkDialog *dialog, int response)
     SeahorseSignCheck check;
     SeahorseSignOptions options = 0;
     SeahorsePgpKey *signer;
-    gpgme_error_t err;
 
     if (response != GTK_RESPONSE_OK)
         return;
@@ -130,26 +167,21 @@ seahorse_gpgme_sign_dialog_response (GtkDialog *dialog, int response)
     g_assert (!signer || (SEAHORSE_GPGME_IS_KEY (signer) &&
                           seahorse_object_get_usage (SEAHORSE_OBJECT (signer)) == SEAHORSE_USAGE_PRIVATE_KEY));
 
-    if (SEAHORSE_GPGME_IS_UID (self->to_sign))
-        err = seahorse_gpgme_key_op_sign_uid (SEAHORSE_GPGME_UID (self->to_sign), SEAHORSE_GPGME_KEY (signer), check, options);
+    /* The dialog is gone by the time this finishes */
+    if (self->keys)
+        seahorse_gpgme_key_op_sign_keys_async (self->keys,
+                                               SEAHORSE_GPGME_KEY (signer), check, options,
+                                               NULL, on_keys_signed, NULL);
+    else if (SEAHORSE_GPGME_IS_UID (self->to_sign))
+        seahorse_gpgme_key_op_sign_uid_async (SEAHORSE_GPGME_UID (self->to_sign),
+                                              SEAHORSE_GPGME_KEY (signer), check, options,
+                                              NULL, on_key_signed, g_object_ref (signer));
     else if (SEAHORSE_GPGME_IS_KEY (self->to_sign))
-        err = seahorse_gpgme_key_op_sign (SEAHORSE_GPGME_KEY (self->to_sign), SEAHORSE_GPGME_KEY (signer), check, options);
+        seahorse_gpgme_key_op_sign_async (SEAHORSE_GPGME_KEY (self->to_sign),
+                                          SEAHORSE_GPGME_KEY (signer), check, options,
+                                          NULL, on_key_signed, g_object_ref (signer));
     else
-        g_assert (FALSE);
-
-
-    if (!GPG_IS_OK (err)) {
-        if (gpgme_err_code (err) == GPG_ERR_EALREADY) {
-            GtkWidget *w;
-
-            w = gtk_message_dialog_new (GTK_WINDOW (self), GTK_DIALOG_MODAL, GTK_MESSAGE_INFO, GTK_BUTTONS_CLOSE,
-                                        _("This key was already signed by\n“%s”"),
-                                        seahorse_object_get_label (SEAHORSE_OBJECT (signer)));
-            gtk_dialog_run (GTK_DIALOG (w));
-            gtk_widget_destroy (w);
-        } else
-            seahorse_gpgme_handle_error (err, _("Couldn’t sign key"));
-    }
+        g_assert_not_reached ();
 }
 
 static void
@@ -195,6 +227,7 @@ seahorse_gpgme_sign_dialog_finalize (GObject *obj)
     SeahorseGpgmeSignDialog *self = SEAHORSE_GPGME_SIGN_DIALOG (obj);
 
     g_clear_object (&self->to_sign);
+    g_clear_pointer (&self->keys, g_ptr_array_unref);
 
     G_OBJECT_CLASS (seahorse_gpgme_sign_dialog_parent_class)->finalize (obj);
 }
@@ -203,13 +236,17 @@ static void
 seahorse_gpgme_sign_dialog_constructed (GObject *obj)
 {
     SeahorseGpgmeSignDialog *self = SEAHORSE_GPGME_SIGN_DIALOG (obj);
-    g_autofree char *userid = NULL;
 
     G_OBJECT_CLASS (seahorse_gpgme_sign_dialog_parent_class)->constructed (obj);
 
-    userid = g_markup_printf_escaped("<i>%s</i>",
-                                     seahorse_object_get_label (self->to_sign));
-    gtk_label_set_markup (GTK_LABEL (self->to_sign_name_label), userid);
+    /* Several keys get their names filled in later */
+    if (self->to_sign) {
+        g_autofree char *userid = NULL;
+
+        userid = g_markup_printf_escaped("<i>%s</i>",
+                                         seahorse_object_get_label (self->to_sign));
+        gtk_label_set_markup (GTK_LABEL (self->to_sign_name_label), userid);
+    }
 
     /* Initial choice */
     on_gpgme_sign_choice_toggled (NULL, self);
@@ -264,15 +301,12 @@ seahorse_gpgme_sign_dialog_class_init (SeahorseGpgmeSignDialogClass *klass)
     dialog_class->response = seahorse_gpgme_sign_dialog_response;
 }
 
-SeahorseGpgmeSignDialog *
-seahorse_gpgme_sign_dialog_new (SeahorseObject *to_sign)
+static SeahorseGpgmeSignDialog *
+sign_dialog_new (SeahorseObject *to_sign)
 {
     g_autoptr(SeahorseGpgmeSignDialog) self = NULL;
     GcrCollection *collection;
 
-    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (to_sign) ||
-                          SEAHORSE_GPGME_IS_UID (to_sign), NULL);
-
     /* If no signing keys then we can't sign */
     collection = seahorse_keyset_pgp_signers_new ();
     if (gcr_collection_get_length (collection) == 0) {
@@ -280,6 +314,7 @@ seahorse_gpgme_sign_dialog_new (SeahorseObject *to_sign)
            generate or import a key */
         seahorse_util_show_error (NULL, _("No keys usable for signing"),
                 _("You have no personal PGP keys that can be used to indicate your trust of this key."));
+        g_object_unref (collection);
         return NULL;
     }
 
@@ -303,3 +338,73 @@ seahorse_gpgme_sign_dialog_new (SeahorseObject *to_sign)
 
     return g_steal_pointer (&self);
 }
+
+SeahorseGpgmeSignDialog *
+seahorse_gpgme_sign_dialog_new (SeahorseObject *to_sign)
+{
+    g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (to_sign) ||
+                          SEAHORSE_GPGME_IS_UID (to_sign), NULL);
+
+    return sign_dialog_new (to_sign);
+}
+
+/* How many key names we list before summing up the rest */
+#define MAX_LISTED_KEYS 5
+
+/**
+ * seahorse_gpgme_sign_dialog_new_for_keys:
+ * @keys: (element-type SeahorseGpgmeKey): The keys to sign
+ *
+ * Creates a dialog that signs all the user IDs of all the @keys at once,
+ * eg: after a key signing party.
+ *
+ * Returns: (transfer full) (nullable): The dialog, or %NULL if there's no
+ *   key to sign with
+ */
+SeahorseGpgmeSignDialog *
+seahorse_gpgme_sign_dialog_new_for_keys (GPtrArray *keys)
+{
+    SeahorseGpgmeSignDialog *self;
+    g_autoptr(GString) names = NULL;
+
+    g_return_val_if_fail (keys != NULL && keys->len > 0, NULL);
+
+    for (unsigned int i = 0; i < keys->len; i++)
+        g_return_val_if_fail (SEAHORSE_GPGME_IS_KEY (g_ptr_array_index (keys, i)), NULL);
+
+    if (keys->len == 1)
+        return seahorse_gpgme_sign_dialog_new (g_ptr_array_index (keys, 0));
+
+    self = sign_dialog_new (NULL);
+    if (self == NULL)
+        return NULL;
+
+    self->keys = g_ptr_array_new_with_free_func (g_object_unref);
+    names = g_string_new (NULL);
+    for (unsigned int i = 0; i < keys->len; i++) {
+        SeahorseObject *key = g_ptr_array_index (keys, i);
+
+        g_ptr_array_add (self->keys, g_object_ref (key));
+
+        if (i < MAX_LISTED_KEYS) {
+            g_autofree char *name = NULL;
+
+            name = g_markup_printf_escaped ("<i>%s</i>", seahorse_object_get_label (key));
+            g_string_append_printf (names, "%s%s", i > 0 ? "\n" : "", name);
+        }
+    }
+
+    if (keys->len > MAX_LISTED_KEYS) {
+        unsigned int n_others = keys->len - MAX_LISTED_KEYS;
+
+        g_string_append_c (names, '\n');
+        g_string_append_printf (names,
+                                ngettext ("and %u other key", "and %u other keys", n_others),
+                                n_others);
+    }
+
+    gtk_window_set_title (GTK_WINDOW (self), _("Sign Keys"));
+    gtk_label_set_markup (GTK_LABEL (self->to_sign_name_label), names->str);
+
+    return self;
+}
@@ -30,3 +30,5 @@ G_DECLARE_FINAL_TYPE (SeahorseGpgmeSignDialog, seahorse_gpgme_sign_dialog,
                       GtkDialog)
 
 SeahorseGpgmeSignDialog*   seahorse_gpgme_sign_dialog_new    (SeahorseObject *to_sign);
+
+SeahorseGpgmeSignDialog*   seahorse_gpgme_sign_dialog_new_for_keys (GPtrArray *keys);
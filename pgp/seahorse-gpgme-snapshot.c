@@ -0,0 +1,461 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#undef G_LOG_DOMAIN
+#define G_LOG_DOMAIN "operation"
+
+#include "seahorse-gpgme-snapshot.h"
+
+#include <glib/gstdio.h>
+
+#include <gpgme.h>
+
+#include <errno.h>
+#include <string.h>
+
+#define SNAPSHOT_MAGIC "SEAHSNAP"
+#define SNAPSHOT_MAGIC_LEN 8
+
+/* Bump this whenever the record layout, or how the digests are calculated,
+ * changes */
+#define SNAPSHOT_VERSION 2
+
+/* What the keyring files looked like when the snapshot was taken */
+typedef struct {
+    gint64 pubring_mtime;
+    gint64 pubring_size;
+    gint64 trustdb_mtime;
+    gint64 trustdb_size;
+} SnapshotStamps;
+
+typedef struct {
+    const guint8 *at;
+    const guint8 *end;
+    gboolean failed;
+} SnapshotReader;
+
+SeahorseGpgmeSnapshotKey *
+seahorse_gpgme_snapshot_key_copy (const SeahorseGpgmeSnapshotKey *key)
+{
+    SeahorseGpgmeSnapshotKey *copy;
+
+    g_return_val_if_fail (key != NULL, NULL);
+
+    copy = g_new (SeahorseGpgmeSnapshotKey, 1);
+    *copy = *key;
+    copy->keyid = g_strdup (key->keyid);
+    copy->fingerprint = g_strdup (key->fingerprint);
+    copy->digest = g_strdup (key->digest);
+    copy->label = g_strdup (key->label);
+    copy->markup = g_strdup (key->markup);
+    copy->nickname = g_strdup (key->nickname);
+    copy->algo = g_strdup (key->algo);
+    return copy;
+}
+
+void
+seahorse_gpgme_snapshot_key_free (SeahorseGpgmeSnapshotKey *key)
+{
+    if (key == NULL)
+        return;
+
+    g_free (key->keyid);
+    g_free (key->fingerprint);
+    g_free (key->digest);
+    g_free (key->label);
+    g_free (key->markup);
+    g_free (key->nickname);
+    g_free (key->algo);
+    g_free (key);
+}
+
+/* The directory gpg uses, which isn't necessarily the default one */
+static const char *
+get_gpg_homedir (void)
+{
+    gpgme_engine_info_t engine;
+
+    if (gpgme_get_engine_info (&engine) == 0) {
+        for (; engine != NULL; engine = engine->next) {
+            if (engine->protocol == GPGME_PROTOCOL_OpenPGP && engine->home_dir)
+                return engine->home_dir;
+        }
+    }
+
+    return gpgme_get_dirinfo ("homedir");
+}
+
+/* Each GnuPG home directory gets its own snapshot */
+static char *
+get_snapshot_path (const char *homedir)
+{
+    g_autofree char *checksum = NULL;
+    g_autofree char *filename = NULL;
+
+    checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1,
+                                              homedir ? homedir : "", -1);
+    filename = g_strdup_printf ("gnupg-%.16s.snapshot", checksum);
+    return g_build_filename (g_get_user_cache_dir (), "seahorse", filename, NULL);
+}
+
+static void
+stamp_file (const char *homedir,
+            const char *name,
+            gint64     *mtime,
+            gint64     *size)
+{
+    g_autofree char *path = NULL;
+    g_autoptr(GFile) file = NULL;
+    g_autoptr(GFileInfo) info = NULL;
+
+    *mtime = *size = 0;
+    if (homedir == NULL)
+        return;
+
+    path = g_build_filename (homedir, name, NULL);
+    file = g_file_new_for_path (path);
+    info = g_file_query_info (file,
+                              G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                              G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC ","
+                              G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                              G_FILE_QUERY_INFO_NONE, NULL, NULL);
+    if (info == NULL)
+        return;
+
+    *mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC +
+             g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+    *size = g_file_info_get_size (info);
+}
+
+static void
+get_current_stamps (const char     *homedir,
+                    SnapshotStamps *stamps)
+{
+    /* GnuPG < 2.1 keeps the public keys in pubring.gpg */
+    stamp_file (homedir, "pubring.kbx", &stamps->pubring_mtime, &stamps->pubring_size);
+    if (stamps->pubring_mtime == 0)
+        stamp_file (homedir, "pubring.gpg", &stamps->pubring_mtime, &stamps->pubring_size);
+    stamp_file (homedir, "trustdb.gpg", &stamps->trustdb_mtime, &stamps->trustdb_size);
+}
+
+static gboolean
+stamps_equal (const SnapshotStamps *a,
+              const SnapshotStamps *b)
+{
+    return a->pubring_mtime == b->pubring_mtime &&
+           a->pubring_size == b->pubring_size &&
+           a->trustdb_mtime == b->trustdb_mtime &&
+           a->trustdb_size == b->trustdb_size;
+}
+
+/* -----------------------------------------------------------------------------
+ * READING
+ */
+
+static gboolean
+reader_take (SnapshotReader *reader,
+             void           *data,
+             gsize           len)
+{
+    if (reader->failed || (gsize) (reader->end - reader->at) < len) {
+        reader->failed = TRUE;
+        return FALSE;
+    }
+
+    memcpy (data, reader->at, len);
+    reader->at += len;
+    return TRUE;
+}
+
+static guint32
+read_uint32 (SnapshotReader *reader)
+{
+    guint32 val = 0;
+    reader_take (reader, &val, sizeof (val));
+    return val;
+}
+
+static gint64
+read_int64 (SnapshotReader *reader)
+{
+    gint64 val = 0;
+    reader_take (reader, &val, sizeof (val));
+    return val;
+}
+
+static char *
+read_string (SnapshotReader *reader)
+{
+    guint32 len;
+    char *str;
+
+    len = read_uint32 (reader);
+    if (reader->failed || (gsize) (reader->end - reader->at) < len) {
+        reader->failed = TRUE;
+        return NULL;
+    }
+
+    str = g_strndup ((const char *) reader->at, len);
+    reader->at += len;
+    return str;
+}
+
+static SeahorseGpgmeSnapshotKey *
+read_key (SnapshotReader *reader)
+{
+    g_autoptr(SeahorseGpgmeSnapshotKey) key = NULL;
+
+    key = g_new0 (SeahorseGpgmeSnapshotKey, 1);
+    key->keyid = read_string (reader);
+    key->fingerprint = read_string (reader);
+    key->digest = read_string (reader);
+    key->label = read_string (reader);
+    key->markup = read_string (reader);
+    key->nickname = read_string (reader);
+    key->algo = read_string (reader);
+    key->length = read_uint32 (reader);
+    key->created = read_int64 (reader);
+    key->expires = read_int64 (reader);
+    key->flags = read_uint32 (reader);
+    key->usage = read_uint32 (reader);
+    key->validity = read_uint32 (reader);
+    key->trust = read_uint32 (reader);
+    key->n_subkeys = read_uint32 (reader);
+    key->n_uids = read_uint32 (reader);
+
+    if (reader->failed || key->keyid == NULL || !key->keyid[0])
+        return NULL;
+
+    return g_steal_pointer (&key);
+}
+
+/**
+ * seahorse_gpgme_snapshot_read:
+ * @error: The location to store an error
+ *
+ * Reads back the last snapshot of the GnuPG keyring. It's not an error if
+ * there is no snapshot, or if the keyring changed since it was taken.
+ *
+ * Returns: (transfer full) (nullable) (element-type SeahorseGpgmeSnapshotKey):
+ *   The keys in the snapshot, or %NULL if there is no usable snapshot
+ */
+GPtrArray *
+seahorse_gpgme_snapshot_read (GError **error)
+{
+    const char *homedir;
+    g_autofree char *path = NULL;
+    g_autoptr(GMappedFile) mapped = NULL;
+    g_autoptr(GPtrArray) keys = NULL;
+    g_autoptr(GError) err = NULL;
+    char magic[SNAPSHOT_MAGIC_LEN] = { 0, };
+    SnapshotReader reader = { NULL, };
+    SnapshotStamps stamps, current;
+    guint32 version, n_keys;
+
+    g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+    homedir = get_gpg_homedir ();
+    path = get_snapshot_path (homedir);
+
+    mapped = g_mapped_file_new (path, FALSE, &err);
+    if (mapped == NULL) {
+        if (!g_error_matches (err, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+            g_propagate_error (error, g_steal_pointer (&err));
+        return NULL;
+    }
+
+    reader.at = (const guint8 *) g_mapped_file_get_contents (mapped);
+    reader.end = reader.at + g_mapped_file_get_length (mapped);
+
+    reader_take (&reader, magic, SNAPSHOT_MAGIC_LEN);
+    version = read_uint32 (&reader);
+    if (reader.failed || memcmp (magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LEN) != 0 ||
+        version != SNAPSHOT_VERSION) {
+        g_debug ("ignoring key snapshot with unknown format: %s", path);
+        return NULL;
+    }
+
+    n_keys = read_uint32 (&reader);
+    stamps.pubring_mtime = read_int64 (&reader);
+    stamps.pubring_size = read_int64 (&reader);
+    stamps.trustdb_mtime = read_int64 (&reader);
+    stamps.trustdb_size = read_int64 (&reader);
+
+    get_current_stamps (homedir, &current);
+    if (!reader.failed && !stamps_equal (&stamps, &current)) {
+        g_debug ("keyring changed since the key snapshot was taken");
+        return NULL;
+    }
+
+    keys = g_ptr_array_new_with_free_func ((GDestroyNotify) seahorse_gpgme_snapshot_key_free);
+    for (guint32 i = 0; i < n_keys && !reader.failed; i++) {
+        SeahorseGpgmeSnapshotKey *key = read_key (&reader);
+        if (key != NULL)
+            g_ptr_array_add (keys, key);
+    }
+
+    if (reader.failed) {
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                     "Corrupt key snapshot: %s", path);
+        return NULL;
+    }
+
+    g_debug ("read %u keys from key snapshot", keys->len);
+    return g_steal_pointer (&keys);
+}
+
+/* -----------------------------------------------------------------------------
+ * WRITING
+ */
+
+static void
+write_uint32 (GByteArray *buf,
+              guint32     val)
+{
+    g_byte_array_append (buf, (const guint8 *) &val, sizeof (val));
+}
+
+static void
+write_int64 (GByteArray *buf,
+             gint64      val)
+{
+    g_byte_array_append (buf, (const guint8 *) &val, sizeof (val));
+}
+
+static void
+write_string (GByteArray *buf,
+              const char *str)
+{
+    gsize len = str ? strlen (str) : 0;
+
+    write_uint32 (buf, len);
+    g_byte_array_append (buf, (const guint8 *) str, len);
+}
+
+static void
+write_key (GByteArray                     *buf,
+           const SeahorseGpgmeSnapshotKey *key)
+{
+    write_string (buf, key->keyid);
+    write_string (buf, key->fingerprint);
+    write_string (buf, key->digest);
+    write_string (buf, key->label);
+    write_string (buf, key->markup);
+    write_string (buf, key->nickname);
+    write_string (buf, key->algo);
+    write_uint32 (buf, key->length);
+    write_int64 (buf, key->created);
+    write_int64 (buf, key->expires);
+    write_uint32 (buf, key->flags);
+    write_uint32 (buf, key->usage);
+    write_uint32 (buf, key->validity);
+    write_uint32 (buf, key->trust);
+    write_uint32 (buf, key->n_subkeys);
+    write_uint32 (buf, key->n_uids);
+}
+
+static void
+snapshot_write_thread (GTask        *task,
+                       void         *source_object,
+                       void         *task_data,
+                       GCancellable *cancellable)
+{
+    GPtrArray *keys = task_data;
+    const char *homedir;
+    g_autofree char *path = NULL;
+    g_autofree char *dir = NULL;
+    g_autoptr(GByteArray) buf = NULL;
+    g_autoptr(GError) error = NULL;
+    SnapshotStamps stamps;
+
+    homedir = get_gpg_homedir ();
+    path = get_snapshot_path (homedir);
+    get_current_stamps (homedir, &stamps);
+
+    buf = g_byte_array_new ();
+    g_byte_array_append (buf, (const guint8 *) SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LEN);
+    write_uint32 (buf, SNAPSHOT_VERSION);
+    write_uint32 (buf, keys->len);
+    write_int64 (buf, stamps.pubring_mtime);
+    write_int64 (buf, stamps.pubring_size);
+    write_int64 (buf, stamps.trustdb_mtime);
+    write_int64 (buf, stamps.trustdb_size);
+
+    for (guint i = 0; i < keys->len; i++)
+        write_key (buf, g_ptr_array_index (keys, i));
+
+    if (g_task_return_error_if_cancelled (task))
+        return;
+
+    dir = g_path_get_dirname (path);
+    if (g_mkdir_with_parents (dir, 0700) < 0) {
+        int errsv = errno;
+        g_task_return_new_error (task, G_IO_ERROR, g_io_error_from_errno (errsv),
+                                 "Couldn't create directory %s: %s",
+                                 dir, g_strerror (errsv));
+        return;
+    }
+
+    /* This replaces the file atomically, so readers never see half of it */
+    if (!g_file_set_contents (path, (const char *) buf->data, buf->len, &error)) {
+        g_task_return_error (task, g_steal_pointer (&error));
+        return;
+    }
+
+    g_debug ("wrote %u keys to key snapshot", keys->len);
+    g_task_return_boolean (task, TRUE);
+}
+
+/**
+ * seahorse_gpgme_snapshot_write_async:
+ * @keys: (element-type SeahorseGpgmeSnapshotKey): The keys in the keyring
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: Called when the snapshot was written
+ * @user_data: Data for @callback
+ *
+ * Writes a new snapshot of the keyring on a worker thread. @keys must not be
+ * modified anymore after calling this.
+ */
+void
+seahorse_gpgme_snapshot_write_async (GPtrArray          *keys,
+                                     GCancellable       *cancellable,
+                                     GAsyncReadyCallback callback,
+                                     void               *user_data)
+{
+    g_autoptr(GTask) task = NULL;
+
+    g_return_if_fail (keys != NULL);
+    g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+    task = g_task_new (NULL, cancellable, callback, user_data);
+    g_task_set_source_tag (task, seahorse_gpgme_snapshot_write_async);
+    g_task_set_task_data (task, g_ptr_array_ref (keys), (GDestroyNotify) g_ptr_array_unref);
+    g_task_run_in_thread (task, snapshot_write_thread);
+}
+
+gboolean
+seahorse_gpgme_snapshot_write_finish (GAsyncResult *result,
+                                      GError      **error)
+{
+    g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+    return g_task_propagate_boolean (G_TASK (result), error);
+}
@@ -0,0 +1,75 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SeahorseGpgmeSnapshot: A cache of what the GnuPG keyring looked like.
+ *
+ * - Listing a big keyring with gpg takes a while, so the first thing we show
+ *   on startup is the snapshot we wrote after the previous listing.
+ * - The snapshot remembers the size and modification time of the keyring
+ *   and the trust database. If any of those changed, it's ignored.
+ * - The snapshot lives in the user cache directory and is memory mapped when
+ *   reading it back.
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+#include "seahorse-common.h"
+
+typedef struct _SeahorseGpgmeSnapshotKey {
+    char *keyid;
+    char *fingerprint;
+    char *digest;               /* See calc_key_digest() in the keyring */
+
+    /* Primary user ID */
+    char *label;
+    char *markup;
+    char *nickname;
+
+    /* Primary subkey */
+    char *algo;
+    unsigned int length;
+    gint64 created;             /* Unix time, or 0 if unknown */
+    gint64 expires;             /* Unix time, or 0 if it doesn't expire */
+
+    unsigned int flags;         /* SeahorseFlags */
+    SeahorseUsage usage;
+    SeahorseValidity validity;
+    SeahorseValidity trust;
+    unsigned int n_subkeys;
+    unsigned int n_uids;
+} SeahorseGpgmeSnapshotKey;
+
+SeahorseGpgmeSnapshotKey * seahorse_gpgme_snapshot_key_copy   (const SeahorseGpgmeSnapshotKey *key);
+
+void                       seahorse_gpgme_snapshot_key_free   (SeahorseGpgmeSnapshotKey *key);
+
+GPtrArray *                seahorse_gpgme_snapshot_read       (GError **error);
+
+void                       seahorse_gpgme_snapshot_write_async  (GPtrArray          *keys,
+                                                                 GCancellable       *cancellable,
+                                                                 GAsyncReadyCallback callback,
+                                                                 void               *user_data);
+
+gboolean                   seahorse_gpgme_snapshot_write_finish (GAsyncResult *result,
+                                                                 GError      **error);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (SeahorseGpgmeSnapshotKey, seahorse_gpgme_snapshot_key_free)
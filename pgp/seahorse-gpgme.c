@@ -244,6 +244,35 @@ seahorse_gpgme_get_keytype_table (SeahorseKeyTypeTable *table)
 	return gerr;
 }
 
+/**
+ * seahorse_gpgme_get_engine_version:
+ *
+ * Looks up the version of the OpenPGP engine (ie. gpg) that GPGME uses.
+ *
+ * Returns: The version, or 0 if it couldn't be determined
+ **/
+SeahorseVersion
+seahorse_gpgme_get_engine_version (void)
+{
+	static SeahorseVersion version = 0;
+	static gsize initialized = 0;
+
+	if (g_once_init_enter (&initialized)) {
+		gpgme_engine_info_t engine = NULL;
+
+		if (GPG_IS_OK (gpgme_get_engine_info (&engine))) {
+			while (engine && engine->protocol != GPGME_PROTOCOL_OpenPGP)
+				engine = engine->next;
+			if (engine && engine->version)
+				version = seahorse_util_parse_version (engine->version);
+		}
+
+		g_once_init_leave (&initialized, 1);
+	}
+
+	return version;
+}
+
 /**
  * seahorse_gpgme_get_algo_string:
  * @type: The algo type
@@ -28,6 +28,8 @@
 
 #include "seahorse-common.h"
 
+#include "libseahorse/seahorse-util.h"
+
 typedef struct _SeahorseKeyTypeTable *SeahorseKeyTypeTable;
 
 struct _SeahorseKeyTypeTable {
@@ -58,6 +60,8 @@ SeahorseValidity   seahorse_gpgme_convert_validity  (gpgme_validity_t validity);
 
 gpgme_error_t      seahorse_gpgme_get_keytype_table (SeahorseKeyTypeTable *table);
 
+SeahorseVersion    seahorse_gpgme_get_engine_version (void);
+
 GSource *          seahorse_gpgme_gsource_new       (gpgme_ctx_t gctx,
                                                      GCancellable *cancellable);
 
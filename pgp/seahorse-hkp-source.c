@@ -27,6 +27,8 @@
 
 #include "seahorse-hkp-source.h"
 
+#include "seahorse-keyserver-cache.h"
+#include "seahorse-pgp-armor.h"
 #include "seahorse-pgp-key.h"
 #include "seahorse-pgp-subkey.h"
 #include "seahorse-pgp-uid.h"
@@ -51,12 +53,28 @@
 #define PGP_KEY_BEGIN   "-----BEGIN PGP PUBLIC KEY BLOCK-----"
 #define PGP_KEY_END     "-----END PGP PUBLIC KEY BLOCK-----"
 
+/* Enough to fetch a few keys in parallel, without hammering the server */
+#define DEFAULT_MAX_CONNECTIONS 4
+
 G_DEFINE_QUARK (seahorse-hkp-error, seahorse_hkp_error);
 
 struct _SeahorseHKPSource {
     SeahorseServerSource parent;
+
+    SoupSession *session;               /* Shared by all operations, created on demand */
+    unsigned int max_connections;       /* Per host, for new sessions */
+    unsigned int max_results;           /* Per search, or 0 for no limit */
+};
+
+enum {
+    PROP_0,
+    PROP_MAX_CONNECTIONS,
+    PROP_MAX_RESULTS,
+    N_PROPS
 };
 
+static GParamSpec *obj_props[N_PROPS] = { NULL, };
+
 G_DEFINE_TYPE (SeahorseHKPSource, seahorse_hkp_source, SEAHORSE_TYPE_SERVER_SOURCE);
 
 /* Helper method */
@@ -103,8 +121,14 @@ get_http_server_uri (SeahorseHKPSource *self,
                         scheme, NULL, host, port, path, query, NULL);
 }
 
+/*
+ * All operations on a source share one session, so they share its
+ * connections too: libsoup keeps them alive between requests, and uses
+ * HTTP/2 with servers that offer it. That way only the first request to a
+ * hkps:// server pays for the DNS lookup and the TCP and TLS handshakes.
+ */
 static SoupSession *
-create_hkp_soup_session (void)
+get_hkp_soup_session (SeahorseHKPSource *self)
 {
     SoupSession *session;
 #ifdef WITH_DEBUG
@@ -112,7 +136,11 @@ create_hkp_soup_session (void)
     const char *env;
 #endif
 
-    session = soup_session_new ();
+    if (self->session != NULL)
+        return g_object_ref (self->session);
+
+    session = soup_session_new_with_options ("max-conns-per-host", self->max_connections,
+                                             NULL);
 
 #ifdef WITH_DEBUG
     env = g_getenv ("G_MESSAGES_DEBUG");
@@ -122,7 +150,60 @@ create_hkp_soup_session (void)
     }
 #endif
 
-    return session;
+    self->session = session;
+    return g_object_ref (session);
+}
+
+/* Counts how many connections an operation had to set up */
+typedef struct {
+    const char *operation;
+    unsigned int requests;
+    unsigned int connections;
+    unsigned int handshakes;
+} ConnectionStats;
+
+static void
+connection_stats_free (void *data)
+{
+    ConnectionStats *stats = data;
+
+    g_debug ("[hkp] %s: %u requests, %u new connections, %u TLS handshakes",
+             stats->operation, stats->requests, stats->connections, stats->handshakes);
+    g_free (stats);
+}
+
+static void
+on_message_network_event (SoupMessage        *message,
+                          GSocketClientEvent  event,
+                          GIOStream          *connection,
+                          void               *user_data)
+{
+    ConnectionStats *stats = g_object_get_data (G_OBJECT (user_data), "hkp-stats");
+
+    if (event == G_SOCKET_CLIENT_CONNECTED)
+        stats->connections++;
+    else if (event == G_SOCKET_CLIENT_TLS_HANDSHAKED)
+        stats->handshakes++;
+}
+
+static void
+track_connections (GTask       *task,
+                   SoupMessage *message,
+                   const char  *operation)
+{
+    ConnectionStats *stats;
+
+    stats = g_object_get_data (G_OBJECT (task), "hkp-stats");
+    if (stats == NULL) {
+        stats = g_new0 (ConnectionStats, 1);
+        stats->operation = operation;
+        g_object_set_data_full (G_OBJECT (task), "hkp-stats",
+                                stats, connection_stats_free);
+    }
+
+    stats->requests++;
+    g_signal_connect_object (message, "network-event",
+                             G_CALLBACK (on_message_network_event), task, 0);
 }
 
 
@@ -229,170 +310,285 @@ parse_hkp_flags (char *flags)
     return flag;
 }
 
+/*
+ * SeahorseHKPIndexParser: parses a machine readable index, as sent by
+ * "op=index&options=mr", a chunk at a time. See:
+ * https://tools.ietf.org/html/draft-shaw-openpgp-hkp-00#section-5
+ */
+struct _SeahorseHKPIndexParser {
+    GString *line;                      /* Incomplete line from the last chunk */
+    SeahorsePgpKey *key;                /* The key the uid lines are for */
+    GPtrArray *keys;                    /* Complete keys, not taken yet */
+    unsigned int key_total;             /* As announced in the info line */
+    unsigned int key_count;
+};
+
 /**
- * parse_hkp_index:
- * response: The HKP server response to parse
- *
- * Extracts the key data from the HKP server response
+ * seahorse_hkp_index_parser_new:
  *
- * Returns: (transfer full): The parsed list of keys
+ * Returns: (transfer full): A new parser
  */
-GList *
-seahorse_hkp_parse_lookup_response (const char *response)
+SeahorseHKPIndexParser *
+seahorse_hkp_index_parser_new (void)
 {
-    /* Use The OpenPGP HTTP Keyserver Protocol (HKP) to search and get keys
-     * https://tools.ietf.org/html/draft-shaw-openpgp-hkp-00#section-5 */
-    g_auto(GStrv) lines = NULL;
-    SeahorsePgpKey *key = NULL;
-    GList *keys = NULL;
-    guint key_total = 0, key_count = 0;
+    SeahorseHKPIndexParser *parser;
 
-    lines = g_strsplit (response, "\n", 0);
-    for (char **l = lines; *l; l++) {
-        char *line = *l;
-        g_auto(GStrv) columns = NULL;
+    parser = g_new0 (SeahorseHKPIndexParser, 1);
+    parser->line = g_string_new (NULL);
+    parser->keys = g_ptr_array_new_with_free_func (g_object_unref);
+    return parser;
+}
+
+void
+seahorse_hkp_index_parser_free (SeahorseHKPIndexParser *parser)
+{
+    if (parser == NULL)
+        return;
+
+    g_string_free (parser->line, TRUE);
+    g_clear_object (&parser->key);
+    g_ptr_array_unref (parser->keys);
+    g_free (parser);
+}
+
+/* The uids of a key come after it, so it's complete once the next one starts */
+static void
+index_parser_complete_key (SeahorseHKPIndexParser *parser)
+{
+    if (parser->key == NULL)
+        return;
+
+    seahorse_pgp_key_realize (parser->key);
+    g_ptr_array_add (parser->keys, g_steal_pointer (&parser->key));
+}
 
-        if (!*line) {
-          g_debug ("HKP Parser: skip empty line");
-          continue;
+static void
+index_parser_parse_line (SeahorseHKPIndexParser *parser,
+                         char                   *line)
+{
+    g_auto(GStrv) columns = NULL;
+
+    g_strchomp (line);
+    if (!*line)
+        return;
+
+    /* split the line using hkp delimiter */
+    columns = g_strsplit_set (line, ":", 7);
+
+    /* info header */
+    /* info:<version>:<count> */
+    if (g_ascii_strncasecmp (columns[0], "info", 4) == 0) {
+        if (!columns[1] || !columns[2]){
+            g_debug("HKP Parse: Invalid info line: %s", line);
+        } else {
+            parser->key_total = strtol(columns[2], NULL, 10);
         }
 
-        g_debug ("%s", line);
+    /* start a new key */
+    /* pub:<keyid>:<algo>:<keylen>:<creationdate>:<expirationdate>:<flags> */
+    } else if (g_ascii_strncasecmp (columns[0], "pub", 3) == 0) {
+        const char *fpr;
+        g_autofree char *fingerprint = NULL;
+        const char *algo = NULL;
+        g_autoptr (SeahorsePgpSubkey) subkey = NULL;
+        long created = 0, expired = 0;
+        g_autoptr(GDateTime) created_date = NULL;
+        g_autoptr(GDateTime) expired_date = NULL;
+        SeahorseFlags flags;
+
+        index_parser_complete_key (parser);
+        parser->key_count++;
+
+        if (!columns[0] || !columns[1] || !columns[2] || !columns[3] || !columns[4]) {
+            g_message ("Invalid key line from server: %s", line);
+            return;
+        }
 
-        /* split the line using hkp delimiter */
-        columns = g_strsplit_set (line, ":", 7);
+        /* Cut the length and fingerprint */
+        fpr = columns[1];
 
-        /* info header */
-        /* info:<version>:<count> */
-        if (g_ascii_strncasecmp (columns[0], "info", 4) == 0) {
-            if (!columns[1] && !columns[2]){
-                g_debug("HKP Parse: Invalid info line: %s", line);
-            } else {
-                key_total = strtol(columns[2], NULL, 10);
-            }
+        /* Check out the key type */
+        switch (strtol(columns[2], NULL, 10)) {
+            case 1:
+            case 2:
+            case 3:
+                 algo = "RSA";
+                break;
+            case 17:
+                algo = "DSA";
+                break;
+            default:
+               break;
+        }
 
-        /* start a new key */
-        /* pub:<keyid>:<algo>:<keylen>:<creationdate>:<expirationdate>:<flags> */
-        } else if (g_ascii_strncasecmp (columns[0], "pub", 3) == 0) {
-            const char *fpr;
-            g_autofree char *fingerprint = NULL;
-            const char *algo = NULL;
-            g_autoptr (SeahorsePgpSubkey) subkey = NULL;
-            long created = 0, expired = 0;
-            g_autoptr(GDateTime) created_date = NULL;
-            g_autoptr(GDateTime) expired_date = NULL;
-            SeahorseFlags flags;
-
-            key_count++;
-
-            if (!columns[0] || !columns[1] || !columns[2] || !columns[3] || !columns[4]) {
-                g_message ("Invalid key line from server: %s", line);
-                continue;
-            }
+        /* set dates */
+        /* created */
+        created = strtol (columns[4], NULL, 10);
+        if (created > 0)
+            created_date = g_date_time_new_from_unix_utc (created);
+
+        /* expires (optional) */
+        if (columns[5]) {
+            expired = strtol (columns[5], NULL, 10);
+            if (expired > 0)
+                expired_date = g_date_time_new_from_unix_utc (expired);
+        }
 
-            /* Cut the length and fingerprint */
-            fpr = columns[1];
-            if (fpr == NULL)
-                g_message ("couldn't find key fingerprint in line from server: %s", line);
-
-            /* Check out the key type */
-            switch (strtol(columns[2], NULL, 10)) {
-                case 1:
-                case 2:
-                case 3:
-                     algo = "RSA";
-                    break;
-                case 17:
-                    algo = "DSA";
-                    break;
-                default:
-                   break;
-            }
-            g_debug ("Algo: %s", algo);
-
-            /* set dates */
-            /* created */
-            if (!columns[4]) {
-                g_debug ("HKP Parse: No created date for key on line: %s", line);
-            } else {
-                created = strtol (columns[4], NULL, 10);
-                if (created > 0)
-                    created_date = g_date_time_new_from_unix_utc (created);
-            }
+        /* set flags (optional) */
+        flags = SEAHORSE_FLAG_EXPORTABLE;
+        if (columns[6])
+            flags |= parse_hkp_flags (columns[6]);
+
+        /* create key */
+        parser->key = seahorse_pgp_key_new ();
+        g_object_set (parser->key, "object-flags", flags, NULL);
+
+        /* Add all the info to the key */
+        subkey = seahorse_pgp_subkey_new ();
+        seahorse_pgp_subkey_set_keyid (subkey, fpr);
+
+        fingerprint = seahorse_pgp_subkey_calc_fingerprint (fpr);
+        seahorse_pgp_subkey_set_fingerprint (subkey, fingerprint);
+
+        seahorse_pgp_subkey_set_flags (subkey, flags);
+        seahorse_pgp_subkey_set_created (subkey, created_date);
+        seahorse_pgp_subkey_set_expires (subkey, expired_date);
+        seahorse_pgp_subkey_set_length (subkey, strtol (columns[3], NULL, 10));
+        if (algo)
+            seahorse_pgp_subkey_set_algorithm (subkey, algo);
+        seahorse_pgp_key_add_subkey (parser->key, subkey);
+
+    /* A UID for the key */
+    } else if (g_ascii_strncasecmp (columns[0], "uid", 3) == 0) {
+        g_autoptr (SeahorsePgpUid) uid = NULL;
+        g_autofree char *uid_string = NULL;
+
+        if (!parser->key) {
+            g_debug("HKP Parse: Warning: seen uid line before keyline, skipping");
+            return;
+        }
 
-            /* expires (optional) */
-            if (columns[5]) {
-                expired = strtol (columns[5], NULL, 10);
-                if (expired > 0)
-                    expired_date = g_date_time_new_from_unix_utc (expired);
-            }
+        if (!columns[0] || !columns[1] || !columns[2]) {
+            g_message ("HKP Parse: Invalid uid line from server: %s", line);
+            return;
+        }
 
-            /* set flags (optional) */
-            flags = SEAHORSE_FLAG_EXPORTABLE;
-            if (columns[6])
-                flags |= parse_hkp_flags (columns[6]);
-
-            /* create key */
-            g_debug("HKP Parse: found new key");
-            key = seahorse_pgp_key_new ();
-            g_object_set (key, "object-flags", flags, NULL);
-
-            /* Add all the info to the key */
-            subkey = seahorse_pgp_subkey_new ();
-            seahorse_pgp_subkey_set_keyid (subkey, fpr);
-
-            fingerprint = seahorse_pgp_subkey_calc_fingerprint (fpr);
-            seahorse_pgp_subkey_set_fingerprint (subkey, fingerprint);
-
-            seahorse_pgp_subkey_set_flags (subkey, flags);
-            seahorse_pgp_subkey_set_created (subkey, created_date);
-            seahorse_pgp_subkey_set_expires (subkey, expired_date);
-            seahorse_pgp_subkey_set_length (subkey, strtol (columns[3], NULL, 10));
-            if (algo)
-                seahorse_pgp_subkey_set_algorithm (subkey, algo);
-            seahorse_pgp_key_add_subkey (key, subkey);
-
-            /* Now add it to the list */
-            keys = g_list_prepend (keys, key);
-
-        /* A UID for the key */
-        } else if (g_ascii_strncasecmp (columns[0], "uid", 3) == 0) {
-            g_autoptr (SeahorsePgpUid) uid = NULL;
-            g_autofree char *uid_string = NULL;
-
-            if (!key) {
-                g_debug("HKP Parse: Warning: seen uid line before keyline, skipping");
-                continue;
-            }
+        uid_string = g_uri_unescape_string (columns[1], NULL);
+        uid = seahorse_pgp_uid_new (parser->key, uid_string);
+        seahorse_pgp_key_add_uid (parser->key, uid);
+    }
+}
 
-            g_debug("HKP Parse: handle uid");
+/**
+ * seahorse_hkp_index_parser_feed:
+ * @parser: The parser
+ * @data: The next chunk of the index
+ * @len: The length of @data
+ *
+ * Parses all the complete lines in @data, and keeps the rest for the
+ * next chunk.
+ */
+void
+seahorse_hkp_index_parser_feed (SeahorseHKPIndexParser *parser,
+                                const char             *data,
+                                gsize                   len)
+{
+    const char *end = data + len;
 
-            if (!columns[0] || !columns[1] || !columns[2]) {
-                g_message ("HKP Parse: Invalid uid line from server: %s", line);
-                continue;
-            }
+    g_return_if_fail (parser != NULL);
+
+    while (data < end) {
+        const char *eol = memchr (data, '\n', end - data);
 
-            uid_string = g_uri_unescape_string (columns[1], NULL);
-            g_debug("HKP Parse: decoded uid string: %s", uid_string);
+        if (eol == NULL) {
+            g_string_append_len (parser->line, data, end - data);
+            break;
+        }
 
-            uid = seahorse_pgp_uid_new (key, uid_string);
-            seahorse_pgp_key_add_uid (key, uid);
+        /* Only copy the line if part of it came with the last chunk */
+        if (parser->line->len > 0) {
+            g_string_append_len (parser->line, data, eol - data);
+            index_parser_parse_line (parser, parser->line->str);
+            g_string_truncate (parser->line, 0);
+        } else {
+            g_autofree char *line = g_strndup (data, eol - data);
+            index_parser_parse_line (parser, line);
         }
+
+        data = eol + 1;
     }
+}
 
-    /* Make sure the keys are realized */
-    for (GList *k = keys; k; k = g_list_next (k))
-        seahorse_pgp_key_realize (SEAHORSE_PGP_KEY (k->data));
+/**
+ * seahorse_hkp_index_parser_finish:
+ * @parser: The parser
+ *
+ * Parses what's left once the whole index was fed, which completes the
+ * last key.
+ */
+void
+seahorse_hkp_index_parser_finish (SeahorseHKPIndexParser *parser)
+{
+    g_return_if_fail (parser != NULL);
+
+    if (parser->line->len > 0) {
+        index_parser_parse_line (parser, parser->line->str);
+        g_string_truncate (parser->line, 0);
+    }
+    index_parser_complete_key (parser);
 
-    if (key_total != 0 && key_total != key_count) {
-        g_warning ("HKP Parse: Could only parse %d keys out of %d", key_count, key_total);
+    if (parser->key_total != 0 && parser->key_total != parser->key_count) {
+        g_warning ("HKP Parse: Could only parse %u keys out of %u",
+                   parser->key_count, parser->key_total);
     } else {
-        g_debug ("HKP Parse: %d keys parsed successfully", key_count);
+        g_debug ("HKP Parse: %u keys parsed successfully", parser->key_count);
     }
+}
+
+/**
+ * seahorse_hkp_index_parser_take_keys:
+ * @parser: The parser
+ *
+ * Returns: (transfer full) (element-type SeahorsePgpKey): The keys that
+ *   were completed since the last call, in the order of the index
+ */
+GPtrArray *
+seahorse_hkp_index_parser_take_keys (SeahorseHKPIndexParser *parser)
+{
+    GPtrArray *keys;
 
+    g_return_val_if_fail (parser != NULL, NULL);
+
+    keys = g_steal_pointer (&parser->keys);
+    parser->keys = g_ptr_array_new_with_free_func (g_object_unref);
     return keys;
 }
 
+/**
+ * seahorse_hkp_parse_lookup_response:
+ * @response: The HKP server response to parse
+ *
+ * Extracts the key data from the HKP server response
+ *
+ * Returns: (transfer full): The parsed list of keys
+ */
+GList *
+seahorse_hkp_parse_lookup_response (const char *response)
+{
+    g_autoptr(SeahorseHKPIndexParser) parser = NULL;
+    g_autoptr(GPtrArray) keys = NULL;
+    GList *list = NULL;
+
+    parser = seahorse_hkp_index_parser_new ();
+    seahorse_hkp_index_parser_feed (parser, response, strlen (response));
+    seahorse_hkp_index_parser_finish (parser);
+
+    keys = seahorse_hkp_index_parser_take_keys (parser);
+    for (unsigned int i = keys->len; i > 0; i--)
+        list = g_list_prepend (list, g_object_ref (g_ptr_array_index (keys, i - 1)));
+    return list;
+}
+
 /**
 * response: The server response
 *
@@ -466,21 +662,21 @@ detect_key (const char *text, int len, const char **start, const char **end)
     return TRUE;
 }
 
-static void
-on_session_cancelled (GCancellable *cancellable,
-                     void *user_data)
-{
-    SoupSession *session = user_data;
-    soup_session_abort (session);
-}
+/* Search results are parsed as they come in, a chunk at a time */
+#define SEARCH_READ_SIZE (16 * 1024)
 
 typedef struct {
     SeahorseHKPSource *source;
     SoupSession *session;
     SoupMessage *message;
-    GString *response;
-    int requests;
+    GInputStream *input;
+    SeahorseHKPIndexParser *parser;
+    unsigned int n_results;
     GcrSimpleCollection *results;
+    char *server;
+    char *query;
+    SeahorseKeyserverCacheEntry *cached;    /* A stale answer, to revalidate */
+    GByteArray *body;                       /* The new answer, for the cache */
 } SearchClosure;
 
 static void
@@ -489,42 +685,195 @@ source_search_free (void *data)
     SearchClosure *closure = data;
     g_clear_object (&closure->source);
     g_clear_object (&closure->message);
-    if (closure->response != NULL)
-        g_string_free (closure->response, TRUE);
+    g_clear_object (&closure->input);
+    g_clear_pointer (&closure->parser, seahorse_hkp_index_parser_free);
     g_clear_object (&closure->session);
     g_clear_object (&closure->results);
+    g_free (closure->server);
+    g_free (closure->query);
+    g_clear_pointer (&closure->cached, seahorse_keyserver_cache_entry_free);
+    if (closure->body)
+        g_byte_array_unref (closure->body);
     g_free (closure);
 }
 
+/* Returns FALSE once the results are capped */
+static gboolean
+search_add_results (SearchClosure *closure)
+{
+    g_autoptr(GPtrArray) keys = NULL;
+    unsigned int max = closure->source->max_results;
+
+    keys = seahorse_hkp_index_parser_take_keys (closure->parser);
+    for (unsigned int i = 0; i < keys->len; i++) {
+        SeahorsePgpKey *key = g_ptr_array_index (keys, i);
+
+        if (max != 0 && closure->n_results >= max)
+            return FALSE;
+
+        g_object_set (key, "place", closure->source, NULL);
+        gcr_simple_collection_add (closure->results, G_OBJECT (key));
+        closure->n_results++;
+    }
+
+    return max == 0 || closure->n_results < max;
+}
+
 static void
-on_search_message_complete (GObject *object,
-                            GAsyncResult *result,
-                            void *user_data)
+search_complete (GTask *task)
+{
+    SearchClosure *closure = g_task_get_task_data (task);
+
+    seahorse_progress_end (g_task_get_cancellable (task), closure->message);
+    g_task_return_boolean (task, TRUE);
+}
+
+static void
+search_parse_cached (SearchClosure *closure,
+                     GBytes        *body)
+{
+    const char *data;
+    gsize len;
+
+    data = g_bytes_get_data (body, &len);
+    closure->parser = seahorse_hkp_index_parser_new ();
+    seahorse_hkp_index_parser_feed (closure->parser, data, len);
+    seahorse_hkp_index_parser_finish (closure->parser);
+    search_add_results (closure);
+}
+
+/* Remembers a response, with its validators so it can be revalidated later */
+static void
+store_response (SeahorseKeyserverCacheKind  kind,
+                const char                 *server,
+                const char                 *operation,
+                const char                 *query,
+                SoupMessage                *message,
+                GBytes                     *body)
+{
+    SoupMessageHeaders *headers;
+
+    headers = soup_message_get_response_headers (message);
+    seahorse_keyserver_cache_store (seahorse_keyserver_cache_get_default (),
+                                    server, operation, query, kind, body,
+                                    soup_message_headers_get_one (headers, "ETag"),
+                                    soup_message_headers_get_one (headers, "Last-Modified"));
+}
+
+static void
+add_conditional_headers (SoupMessage                 *message,
+                         SeahorseKeyserverCacheEntry *cached)
+{
+    SoupMessageHeaders *headers;
+
+    headers = soup_message_get_request_headers (message);
+    if (cached->etag)
+        soup_message_headers_replace (headers, "If-None-Match", cached->etag);
+    if (cached->last_modified)
+        soup_message_headers_replace (headers, "If-Modified-Since", cached->last_modified);
+}
+
+static void
+on_search_read (GObject *object,
+                GAsyncResult *result,
+                void *user_data)
+{
+    g_autoptr(GTask) task = G_TASK (user_data);
+    SearchClosure *closure = g_task_get_task_data (task);
+    g_autoptr(GBytes) bytes = NULL;
+    g_autoptr(GError) error = NULL;
+    const char *data;
+    gsize len;
+
+    bytes = g_input_stream_read_bytes_finish (closure->input, result, &error);
+    if (bytes == NULL) {
+        seahorse_progress_end (g_task_get_cancellable (task), closure->message);
+        g_task_return_error (task, g_steal_pointer (&error));
+        return;
+    }
+
+    data = g_bytes_get_data (bytes, &len);
+    if (len == 0) {
+        g_autoptr(GBytes) body = NULL;
+
+        seahorse_hkp_index_parser_finish (closure->parser);
+        search_add_results (closure);
+
+        body = g_byte_array_free_to_bytes (g_steal_pointer (&closure->body));
+        store_response (SEAHORSE_KEYSERVER_CACHE_SEARCH, closure->server, "index",
+                        closure->query, closure->message, body);
+        search_complete (task);
+        return;
+    }
+
+    seahorse_hkp_index_parser_feed (closure->parser, data, len);
+    g_byte_array_append (closure->body, data, len);
+
+    /* We didn't read all of it, so there's nothing to cache */
+    if (!search_add_results (closure)) {
+        g_message ("Stopped HKP search after %u results", closure->n_results);
+        search_complete (task);
+        return;
+    }
+
+    g_input_stream_read_bytes_async (closure->input, SEARCH_READ_SIZE,
+                                     G_PRIORITY_DEFAULT,
+                                     g_task_get_cancellable (task),
+                                     on_search_read, g_steal_pointer (&task));
+}
+
+static void
+on_search_message_sent (GObject *object,
+                        GAsyncResult *result,
+                        void *user_data)
 {
     SoupSession *session = SOUP_SESSION (object);
     g_autoptr(GTask) task = G_TASK (user_data);
     SearchClosure *closure = g_task_get_task_data (task);
     GCancellable *cancellable = g_task_get_cancellable (task);
-    g_autoptr(GBytes) response = NULL;
     g_autoptr(GError) error = NULL;
-    g_autolist(SeahorsePgpKey) keys = NULL;
+    unsigned int status;
 
-    seahorse_progress_end (cancellable, closure->message);
-
-    response = soup_session_send_and_read_finish (session, result, &error);
-    if (response == NULL) {
+    closure->input = soup_session_send_finish (session, result, &error);
+    if (closure->input == NULL) {
+        seahorse_progress_end (cancellable, closure->message);
         g_task_return_error (task, g_steal_pointer (&error));
         return;
     }
 
-    closure->response = g_string_new_len (g_bytes_get_data (response, NULL),
-                                          g_bytes_get_size (response));
-    keys = seahorse_hkp_parse_lookup_response (closure->response->str);
-    for (GList *l = keys; l; l = g_list_next (l)) {
-        g_object_set (l->data, "place", closure->source, NULL);
-        gcr_simple_collection_add (closure->results, l->data);
+    /* Key servers say there were no matches with a 404 */
+    status = soup_message_get_status (closure->message);
+    if (status == SOUP_STATUS_NOT_FOUND) {
+        search_complete (task);
+        return;
+    }
+
+    /* What we have is still what the server would send */
+    if (status == SOUP_STATUS_NOT_MODIFIED && closure->cached != NULL) {
+        g_debug ("[hkp] cached search results for '%s' are still valid", closure->query);
+        seahorse_keyserver_cache_store (seahorse_keyserver_cache_get_default (),
+                                        closure->server, "index", closure->query,
+                                        SEAHORSE_KEYSERVER_CACHE_SEARCH,
+                                        closure->cached->body,
+                                        closure->cached->etag,
+                                        closure->cached->last_modified);
+        search_parse_cached (closure, closure->cached->body);
+        search_complete (task);
+        return;
     }
-    g_task_return_boolean (task, TRUE);
+
+    if (!SOUP_STATUS_IS_SUCCESSFUL (status)) {
+        seahorse_progress_end (cancellable, closure->message);
+        g_task_return_new_error (task, HKP_ERROR_DOMAIN, status, "%s",
+                                 soup_message_get_reason_phrase (closure->message));
+        return;
+    }
+
+    closure->parser = seahorse_hkp_index_parser_new ();
+    closure->body = g_byte_array_new ();
+    g_input_stream_read_bytes_async (closure->input, SEARCH_READ_SIZE,
+                                     G_PRIORITY_DEFAULT, cancellable,
+                                     on_search_read, g_steal_pointer (&task));
 }
 
 static gboolean
@@ -562,46 +911,51 @@ seahorse_hkp_source_search_async (SeahorseServerSource *source,
     task = g_task_new (source, cancellable, callback, user_data);
     closure = g_new0 (SearchClosure, 1);
     closure->source = g_object_ref (self);
-    closure->session = create_hkp_soup_session ();
+    closure->session = get_hkp_soup_session (self);
     closure->results = g_object_ref (results);
+    closure->server = seahorse_place_get_uri (SEAHORSE_PLACE (self));
     g_task_set_task_data (task, closure, source_search_free);
 
+    if (is_hex_keyid (match))
+        closure->query = g_strdup_printf ("0x%s", match);
+    else
+        closure->query = g_strdup (match);
+
+    closure->cached = seahorse_keyserver_cache_lookup (seahorse_keyserver_cache_get_default (),
+                                                       closure->server, "index",
+                                                       closure->query);
+    if (closure->cached != NULL && closure->cached->fresh) {
+        g_debug ("[hkp] using cached search results for '%s'", closure->query);
+        search_parse_cached (closure, closure->cached->body);
+        g_task_return_boolean (task, TRUE);
+        return;
+    }
+
     form = g_hash_table_new (g_str_hash, g_str_equal);
     g_hash_table_insert (form, "op", "index");
     g_hash_table_insert (form, "options", "mr");
-
-    if (is_hex_keyid (match)) {
-        g_autofree char *hexfpr = NULL;
-
-        hexfpr = g_strdup_printf ("0x%s", match);
-        g_hash_table_insert (form, "search", hexfpr);
-    } else {
-        g_hash_table_insert (form, "search", (char *)match);
-    }
-
+    g_hash_table_insert (form, "search", closure->query);
     g_hash_table_insert (form, "fingerprint", "on");
 
     uri = get_http_server_uri (self, "/pks/lookup", form);
     g_return_if_fail (uri);
 
     closure->message = soup_message_new_from_uri ("GET", uri);
+    if (closure->cached != NULL)
+        add_conditional_headers (closure->message, closure->cached);
 
     seahorse_progress_prep_and_begin (cancellable, closure->message, NULL);
 
     uri_str = g_uri_to_string_partial (uri, G_URI_HIDE_PASSWORD);
     g_debug ("Sending HKP search query to '%s'", uri_str);
 
-    soup_session_send_and_read_async (closure->session,
-                                      closure->message,
-                                      G_PRIORITY_DEFAULT,
-                                      cancellable,
-                                      on_search_message_complete,
-                                      g_steal_pointer (&task));
-
-    if (cancellable)
-        g_cancellable_connect (cancellable,
-                               G_CALLBACK (on_session_cancelled),
-                               closure->session, NULL);
+    track_connections (task, closure->message, "search");
+    soup_session_send_async (closure->session,
+                             closure->message,
+                             G_PRIORITY_DEFAULT,
+                             cancellable,
+                             on_search_message_sent,
+                             g_steal_pointer (&task));
 }
 
 static gboolean
@@ -629,7 +983,7 @@ source_import_free (void *data)
     ImportClosure *closure = data;
     g_object_unref (closure->source);
     g_object_unref (closure->input);
-    g_object_unref (closure->message);
+    g_clear_object (&closure->message);
     g_object_unref (closure->session);
     g_free (closure);
 }
@@ -675,37 +1029,22 @@ on_import_message_complete (GObject *object,
 }
 
 static void
-seahorse_hkp_source_import_async (SeahorseServerSource *source,
-                                  GInputStream *input,
-                                  GCancellable *cancellable,
-                                  GAsyncReadyCallback callback,
-                                  void *user_data)
+on_import_blocks_read (GObject *object,
+                       GAsyncResult *result,
+                       void *user_data)
 {
-    SeahorseHKPSource *self = SEAHORSE_HKP_SOURCE (source);
-    g_autoptr(GTask) task = NULL;
-    ImportClosure *closure;
+    g_autoptr(GTask) task = G_TASK (user_data);
+    ImportClosure *closure = g_task_get_task_data (task);
+    SeahorseHKPSource *self = closure->source;
+    GCancellable *cancellable = g_task_get_cancellable (task);
     g_autoptr(GPtrArray) keydata = NULL;
     g_autoptr(GUri) uri = NULL;
+    g_autoptr(GError) error = NULL;
 
-    task = g_task_new (source, cancellable, callback, user_data);
-    closure = g_new0 (ImportClosure, 1);
-    closure->input = g_object_ref (input);
-    closure->source = g_object_ref (self);
-    closure->session = create_hkp_soup_session ();
-    g_task_set_task_data (task, closure, source_import_free);
-
-    keydata = g_ptr_array_new_with_free_func (g_free);
-    for (;;) {
-        g_autoptr(GString) buf = g_string_sized_new (2048);
-        guint len;
-
-        len = seahorse_util_read_data_block (buf, input,
-                                             "-----BEGIN PGP PUBLIC KEY BLOCK-----",
-                                             "-----END PGP PUBLIC KEY BLOCK-----");
-        if (len <= 0)
-            break;
-
-        g_ptr_array_add (keydata, g_string_free (g_steal_pointer (&buf), FALSE));
+    keydata = seahorse_pgp_armor_read_blocks_finish (closure->input, result, &error);
+    if (keydata == NULL) {
+        g_task_return_error (task, g_steal_pointer (&error));
+        return;
     }
 
     if (keydata->len == 0) {
@@ -718,33 +1057,54 @@ seahorse_hkp_source_import_async (SeahorseServerSource *source,
     g_return_if_fail (uri);
 
     for (unsigned int i = 0; i < keydata->len; i++) {
-        const char *keytext = g_ptr_array_index (keydata, i);
+        GBytes *block = g_ptr_array_index (keydata, i);
         g_autofree char *key = NULL;
         g_autoptr(GBytes) bytes = NULL;
 
+        g_clear_object (&closure->message);
         closure->message = soup_message_new_from_uri ("POST", uri);
 
-        key = soup_form_encode ("keytext", keytext, NULL);
+        /* The blocks we read are nul-terminated */
+        key = soup_form_encode ("keytext", g_bytes_get_data (block, NULL), NULL);
         bytes = g_bytes_new_static (key, strlen (key));
         soup_message_set_request_body_from_bytes (closure->message,
                                                   "application/x-www-form-urlencoded",
                                                   bytes);
 
+        track_connections (task, closure->message, "import");
         soup_session_send_and_read_async (closure->session,
                                           closure->message,
                                           G_PRIORITY_DEFAULT,
                                           cancellable,
                                           on_import_message_complete,
-                                          g_steal_pointer (&task));
+                                          g_object_ref (task));
 
         closure->requests++;
         seahorse_progress_prep_and_begin (cancellable, GUINT_TO_POINTER (closure->requests), NULL);
     }
+}
+
+static void
+seahorse_hkp_source_import_async (SeahorseServerSource *source,
+                                  GInputStream *input,
+                                  GCancellable *cancellable,
+                                  GAsyncReadyCallback callback,
+                                  void *user_data)
+{
+    SeahorseHKPSource *self = SEAHORSE_HKP_SOURCE (source);
+    g_autoptr(GTask) task = NULL;
+    ImportClosure *closure;
 
-    if (cancellable)
-        g_cancellable_connect (cancellable,
-                               G_CALLBACK (on_session_cancelled),
-                               closure->session, NULL);
+    task = g_task_new (source, cancellable, callback, user_data);
+    closure = g_new0 (ImportClosure, 1);
+    closure->input = g_object_ref (input);
+    closure->source = g_object_ref (self);
+    closure->session = get_hkp_soup_session (self);
+    g_task_set_task_data (task, closure, source_import_free);
+
+    seahorse_pgp_armor_read_blocks_async (input, SEAHORSE_PGP_ARMOR_PUBLIC_KEY,
+                                          cancellable, on_import_blocks_read,
+                                          g_steal_pointer (&task));
 }
 
 static GList *
@@ -758,70 +1118,342 @@ seahorse_hkp_source_import_finish (SeahorseServerSource *source,
 }
 
 
+/*
+ * Keys are retrieved one request per key, since HKP has no way to ask for
+ * several keys at once. To not get rate limited, at most max-connections
+ * requests are in flight, and keys the server couldn't give us right now
+ * are retried a few times.
+ */
+
+#define EXPORT_MAX_ATTEMPTS      3
+#define EXPORT_RETRY_DELAY       1       /* Seconds, doubled on each attempt */
+#define EXPORT_MAX_RETRY_DELAY   10      /* Caps our own back off */
+#define EXPORT_MAX_RETRY_AFTER   300     /* Caps what the server asks for */
+
+typedef struct {
+    GTask *task;                        /* Only while in flight or waiting for a retry */
+    char *search;
+    unsigned int attempts;
+    SoupMessage *message;
+    SeahorseKeyserverCacheKind kind;
+    SeahorseKeyserverCacheEntry *cached;    /* A stale answer, to revalidate */
+} ExportItem;
+
 typedef struct {
     SeahorseHKPSource *source;
+    char *server;
     GString *data;
     gsize data_len;
     SoupSession *session;
-    SoupMessage *message;
-    int requests;
+    GQueue *queue;                      /* ExportItem, waiting to be sent */
+    unsigned int in_flight;
+    unsigned int retrying;
+    unsigned int total;
+    unsigned int failed;
+    GError *error;                      /* Why the first key failed */
 } ExportClosure;
 
+static void
+export_item_free (ExportItem *item)
+{
+    g_clear_object (&item->task);
+    g_free (item->search);
+    g_clear_object (&item->message);
+    g_clear_pointer (&item->cached, seahorse_keyserver_cache_entry_free);
+    g_free (item);
+}
+
 static void
 export_closure_free (void *data)
 {
     ExportClosure *closure = data;
     g_clear_object (&closure->source);
+    g_free (closure->server);
     if (closure->data)
         g_string_free (closure->data, TRUE);
-    g_clear_object (&closure->message);
+    g_queue_free_full (closure->queue, (GDestroyNotify) export_item_free);
     g_clear_object (&closure->session);
+    g_clear_error (&closure->error);
     g_free (closure);
 }
 
+static void     export_send_next        (GTask *task);
+
+static void
+export_append_keys (ExportClosure *closure,
+                    GBytes        *response)
+{
+    const char *start, *end, *text;
+    size_t len;
+
+    end = text = g_bytes_get_data (response, &len);
+    for (;;) {
+        len -= end - text;
+        text = end;
+
+        if (!detect_key (text, len, &start, &end))
+            break;
+
+        g_string_append_len (closure->data, start, end - start);
+        g_string_append_c (closure->data, '\n');
+    }
+}
+
+static void
+export_complete (GTask *task)
+{
+    ExportClosure *closure = g_task_get_task_data (task);
+    GError *error = NULL;
+
+    if (g_cancellable_set_error_if_cancelled (g_task_get_cancellable (task), &error)) {
+        g_task_return_error (task, error);
+        return;
+    }
+
+    /* Keep what we got, unless we got nothing at all */
+    if (closure->failed > 0) {
+        if (closure->data->len == 0) {
+            g_task_return_error (task, g_steal_pointer (&closure->error));
+            return;
+        }
+
+        g_message ("Couldn't retrieve %u of %u keys from the key server: %s",
+                   closure->failed, closure->total, closure->error->message);
+    }
+
+    closure->data_len = closure->data->len;
+    g_task_return_pointer (task,
+                           g_string_free (g_steal_pointer (&closure->data), FALSE),
+                           g_free);
+}
+
+static void
+export_item_done (GTask      *task,
+                  ExportItem *item,
+                  GError     *error)
+{
+    ExportClosure *closure = g_task_get_task_data (task);
+
+    seahorse_progress_end (g_task_get_cancellable (task), item);
+
+    if (error != NULL) {
+        g_debug ("[hkp] couldn't retrieve key %s: %s", item->search, error->message);
+        closure->failed++;
+        if (closure->error == NULL)
+            closure->error = error;
+        else
+            g_error_free (error);
+    }
+
+    export_item_free (item);
+}
+
+static gboolean
+on_export_retry (void *user_data)
+{
+    ExportItem *item = user_data;
+    g_autoptr(GTask) task = g_steal_pointer (&item->task);
+    ExportClosure *closure = g_task_get_task_data (task);
+    GError *error = NULL;
+
+    closure->retrying--;
+    if (g_cancellable_set_error_if_cancelled (g_task_get_cancellable (task), &error))
+        export_item_done (task, item, error);
+    else
+        g_queue_push_head (closure->queue, item);
+
+    export_send_next (task);
+    return G_SOURCE_REMOVE;
+}
+
+/* Waits for the delay, but not any longer once the export is cancelled */
+static void
+export_schedule_retry (GTask        *task,
+                       ExportItem   *item,
+                       unsigned int  delay)
+{
+    GCancellable *cancellable = g_task_get_cancellable (task);
+    g_autoptr(GSource) source = NULL;
+
+    source = g_timeout_source_new_seconds (delay);
+    if (cancellable != NULL) {
+        g_autoptr(GSource) cancelled = g_cancellable_source_new (cancellable);
+
+        g_source_set_dummy_callback (cancelled);
+        g_source_add_child_source (source, cancelled);
+    }
+
+    g_source_set_callback (source, on_export_retry, item, NULL);
+    g_source_attach (source, g_main_context_get_thread_default ());
+}
+
+/* How long the server asked us to wait, or our own back off */
+static unsigned int
+export_retry_delay (ExportItem *item)
+{
+    SoupMessageHeaders *headers;
+    const char *retry_after = NULL;
+    guint64 delay;
+
+    if (item->message) {
+        headers = soup_message_get_response_headers (item->message);
+        retry_after = soup_message_headers_get_one (headers, "Retry-After");
+    }
+    if (retry_after != NULL &&
+        g_ascii_string_to_unsigned (retry_after, 10, 0, G_MAXUINT, &delay, NULL))
+        return MIN (delay, EXPORT_MAX_RETRY_AFTER);
+
+    delay = EXPORT_RETRY_DELAY << (item->attempts - 1);
+    return MIN (delay, EXPORT_MAX_RETRY_DELAY);
+}
+
+static gboolean
+is_retryable_status (unsigned int status)
+{
+    return status == 429 /* Too Many Requests */ ||
+           status == SOUP_STATUS_INTERNAL_SERVER_ERROR ||
+           status == SOUP_STATUS_BAD_GATEWAY ||
+           status == SOUP_STATUS_SERVICE_UNAVAILABLE ||
+           status == SOUP_STATUS_GATEWAY_TIMEOUT;
+}
+
 static void
 on_export_message_complete (GObject *object,
                             GAsyncResult *result,
                             void *user_data)
 {
     SoupSession *session = SOUP_SESSION (object);
-    g_autoptr(GTask) task = G_TASK (user_data);
+    ExportItem *item = user_data;
+    g_autoptr(GTask) task = g_steal_pointer (&item->task);
     ExportClosure *closure = g_task_get_task_data (task);
-    GCancellable *cancellable = g_task_get_cancellable (task);
     g_autoptr(GBytes) response = NULL;
-    g_autoptr(GError) error = NULL;
-    const char *start, *end, *text;
-    size_t len;
+    GError *error = NULL;
+    unsigned int status;
 
-    seahorse_progress_end (cancellable, closure->message);
+    g_assert (closure->in_flight > 0);
+    closure->in_flight--;
 
     response = soup_session_send_and_read_finish (session, result, &error);
-    if (response == NULL) {
-        g_task_return_error (task, g_steal_pointer (&error));
+    status = soup_message_get_status (item->message);
+
+    if (response != NULL && status == SOUP_STATUS_NOT_MODIFIED && item->cached != NULL) {
+        g_debug ("[hkp] cached key %s is still valid", item->search);
+        seahorse_keyserver_cache_store (seahorse_keyserver_cache_get_default (),
+                                        closure->server, "get", item->search,
+                                        item->kind, item->cached->body,
+                                        item->cached->etag,
+                                        item->cached->last_modified);
+        export_append_keys (closure, item->cached->body);
+
+    } else if (response != NULL && SOUP_STATUS_IS_SUCCESSFUL (status)) {
+        store_response (item->kind, closure->server, "get", item->search,
+                        item->message, response);
+        export_append_keys (closure, response);
+
+    /* The server doesn't have it, which isn't an error */
+    } else if (response != NULL && status == SOUP_STATUS_NOT_FOUND) {
+        g_debug ("[hkp] key %s not found", item->search);
+
+    } else if (item->attempts < EXPORT_MAX_ATTEMPTS &&
+               (response != NULL ? is_retryable_status (status) :
+                !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))) {
+        unsigned int delay = export_retry_delay (item);
+
+        g_debug ("[hkp] retrying key %s in %u seconds", item->search, delay);
+        g_clear_error (&error);
+        g_clear_object (&item->message);
+        item->task = g_object_ref (task);
+        closure->retrying++;
+        export_schedule_retry (task, item, delay);
+        export_send_next (task);
         return;
+
+    } else if (response != NULL) {
+        error = g_error_new (HKP_ERROR_DOMAIN, status, "%s",
+                             soup_message_get_reason_phrase (item->message));
     }
 
-    end = text = g_bytes_get_data (response, &len);
-    for (;;) {
-        len -= end - text;
-        text = end;
+    export_item_done (task, item, error);
+    export_send_next (task);
+}
 
-        if (!detect_key (text, len, &start, &end))
-            break;
+static void
+export_send_item (GTask      *task,
+                  ExportItem *item)
+{
+    ExportClosure *closure = g_task_get_task_data (task);
+    g_autoptr(GHashTable) form = NULL;
+    g_autoptr(GUri) uri = NULL;
 
-        g_string_append_len (closure->data, start, end - start);
-        g_string_append_c (closure->data, '\n');
+    form = g_hash_table_new (g_str_hash, g_str_equal);
+    g_hash_table_insert (form, "op", "get");
+    g_hash_table_insert (form, "options", "mr");
+    g_hash_table_insert (form, "search", item->search);
+
+    uri = get_http_server_uri (closure->source, "/pks/lookup", form);
+    if (uri == NULL) {
+        export_item_done (task, item,
+                          g_error_new_literal (HKP_ERROR_DOMAIN, 0,
+                                               _("Invalid key server address")));
+        return;
     }
 
-    g_assert (closure->requests > 0);
-    closure->requests--;
+    if (item->attempts++ == 0) {
+        seahorse_progress_begin (g_task_get_cancellable (task), item);
 
-    if (closure->requests == 0) {
-        closure->data_len = closure->data->len;
-        g_task_return_pointer (task,
-                               g_string_free (g_steal_pointer (&closure->data), FALSE),
-                               g_free);
+        item->cached = seahorse_keyserver_cache_lookup (seahorse_keyserver_cache_get_default (),
+                                                        closure->server, "get", item->search);
+        if (item->cached != NULL && item->cached->fresh) {
+            g_debug ("[hkp] using cached key %s", item->search);
+            export_append_keys (closure, item->cached->body);
+            export_item_done (task, item, NULL);
+            return;
+        }
     }
+
+    item->message = soup_message_new_from_uri ("GET", uri);
+    if (item->cached != NULL)
+        add_conditional_headers (item->message, item->cached);
+    item->task = g_object_ref (task);
+    closure->in_flight++;
+
+    track_connections (task, item->message, "export");
+    soup_session_send_and_read_async (closure->session,
+                                      item->message,
+                                      G_PRIORITY_DEFAULT,
+                                      g_task_get_cancellable (task),
+                                      on_export_message_complete,
+                                      item);
+}
+
+/* Keeps the window of requests full, and completes once all are done */
+static void
+export_send_next (GTask *task)
+{
+    ExportClosure *closure = g_task_get_task_data (task);
+    unsigned int window = MAX (closure->source->max_connections, 1);
+
+    while (closure->in_flight < window && !g_queue_is_empty (closure->queue))
+        export_send_item (task, g_queue_pop_head (closure->queue));
+
+    if (closure->in_flight == 0 && closure->retrying == 0 &&
+        g_queue_is_empty (closure->queue))
+        export_complete (task);
+}
+
+static gboolean
+is_fingerprint (const char *keyid)
+{
+    size_t len = strlen (keyid);
+
+    if (len != 40 && len != 64)
+        return FALSE;
+
+    for (size_t i = 0; i < len; i++)
+        if (!g_ascii_isxdigit (keyid[i]))
+            return FALSE;
+
+    return TRUE;
 }
 
 static void
@@ -838,8 +1470,10 @@ seahorse_hkp_source_export_async (SeahorseServerSource *source,
     task = g_task_new (self, cancellable, callback, user_data);
     closure = g_new0 (ExportClosure, 1);
     closure->source = g_object_ref (self);
+    closure->server = seahorse_place_get_uri (SEAHORSE_PLACE (self));
     closure->data = g_string_sized_new (1024);
-    closure->session = create_hkp_soup_session ();
+    closure->session = get_hkp_soup_session (self);
+    closure->queue = g_queue_new ();
     g_task_set_task_data (task, closure, export_closure_free);
 
     if (!keyids || !keyids[0]) {
@@ -847,48 +1481,36 @@ seahorse_hkp_source_export_async (SeahorseServerSource *source,
         return;
     }
 
-
     for (int i = 0; keyids[i] != NULL; i++) {
         const char *fpr = keyids[i];
+        ExportItem *item;
         size_t len;
-        g_autofree char *hexfpr = NULL;
-        g_autoptr(GHashTable) form = NULL;
-        g_autoptr(GUri) uri = NULL;
 
-        form = g_hash_table_new (g_str_hash, g_str_equal);
+        item = g_new0 (ExportItem, 1);
 
-        /* Get the key id and limit it to 16 characters */
+        /* A full fingerprint always names the same key, so it can be cached
+         * longer. It's also what we ask for then, so the answer can't be
+         * some other key with the same key id. */
         len = strlen (fpr);
-        if (len > 16)
-            fpr += (len - 16);
+        if (is_fingerprint (fpr)) {
+            item->kind = SEAHORSE_KEYSERVER_CACHE_KEY;
+        } else {
+            item->kind = SEAHORSE_KEYSERVER_CACHE_SEARCH;
+
+            /* Get the key id and limit it to 16 characters */
+            if (len > 16)
+                fpr += (len - 16);
+        }
 
         /* prepend the hex prefix (0x) to make keyservers happy */
-        hexfpr = g_strdup_printf ("0x%s", fpr);
+        item->search = g_strdup_printf ("0x%s", fpr);
+        g_queue_push_tail (closure->queue, item);
+        closure->total++;
 
-        /* The get key URI */
-        g_hash_table_insert (form, "op", "get");
-        g_hash_table_insert (form, "search", (char *)hexfpr);
-
-        uri = get_http_server_uri (self, "/pks/lookup", form);
-        g_return_if_fail (uri);
-
-        closure->message = soup_message_new_from_uri ("GET", uri);
-
-        soup_session_send_and_read_async (closure->session,
-                                          closure->message,
-                                          G_PRIORITY_DEFAULT,
-                                          cancellable,
-                                          on_export_message_complete,
-                                          g_steal_pointer (&task));
-
-        closure->requests++;
-        seahorse_progress_prep_and_begin (cancellable, closure->message, NULL);
+        seahorse_progress_prep (cancellable, item, NULL);
     }
 
-    if (cancellable)
-        g_cancellable_connect (cancellable,
-                               G_CALLBACK (on_session_cancelled),
-                               closure->session, NULL);
+    export_send_next (task);
 }
 
 static void *
@@ -912,17 +1534,90 @@ seahorse_hkp_source_init (SeahorseHKPSource *hsrc)
 {
 }
 
+static void
+seahorse_hkp_source_get_property (GObject      *object,
+                                  unsigned int  prop_id,
+                                  GValue       *value,
+                                  GParamSpec   *pspec)
+{
+    SeahorseHKPSource *self = SEAHORSE_HKP_SOURCE (object);
+
+    switch (prop_id) {
+    case PROP_MAX_CONNECTIONS:
+        g_value_set_uint (value, self->max_connections);
+        break;
+    case PROP_MAX_RESULTS:
+        g_value_set_uint (value, self->max_results);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+seahorse_hkp_source_set_property (GObject      *object,
+                                  unsigned int  prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+    SeahorseHKPSource *self = SEAHORSE_HKP_SOURCE (object);
+
+    switch (prop_id) {
+    case PROP_MAX_CONNECTIONS:
+        /* Running operations keep the old session, the next ones get a new one */
+        self->max_connections = g_value_get_uint (value);
+        g_clear_object (&self->session);
+        break;
+    case PROP_MAX_RESULTS:
+        self->max_results = g_value_get_uint (value);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+seahorse_hkp_source_finalize (GObject *object)
+{
+    SeahorseHKPSource *self = SEAHORSE_HKP_SOURCE (object);
+
+    g_clear_object (&self->session);
+
+    G_OBJECT_CLASS (seahorse_hkp_source_parent_class)->finalize (object);
+}
+
 static void
 seahorse_hkp_source_class_init (SeahorseHKPSourceClass *klass)
 {
+    GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
     SeahorseServerSourceClass *server_class = SEAHORSE_SERVER_SOURCE_CLASS (klass);
 
+    gobject_class->get_property = seahorse_hkp_source_get_property;
+    gobject_class->set_property = seahorse_hkp_source_set_property;
+    gobject_class->finalize = seahorse_hkp_source_finalize;
+
     server_class->search_async = seahorse_hkp_source_search_async;
     server_class->search_finish = seahorse_hkp_source_search_finish;
     server_class->export_async = seahorse_hkp_source_export_async;
     server_class->export_finish = seahorse_hkp_source_export_finish;
     server_class->import_async = seahorse_hkp_source_import_async;
     server_class->import_finish = seahorse_hkp_source_import_finish;
+
+    obj_props[PROP_MAX_CONNECTIONS] =
+        g_param_spec_uint ("max-connections", "Max connections",
+                           "How many connections to keep open to the key server at most",
+                           1, G_MAXUINT, DEFAULT_MAX_CONNECTIONS,
+                           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS);
+
+    obj_props[PROP_MAX_RESULTS] =
+        g_param_spec_uint ("max-results", "Max results",
+                           "How many keys a search returns at most, or 0 for no limit",
+                           0, G_MAXUINT, 0,
+                           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS);
+
+    g_object_class_install_properties (gobject_class, N_PROPS, obj_props);
 }
 
 /**
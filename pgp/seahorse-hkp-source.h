@@ -43,6 +43,22 @@ gboolean              seahorse_hkp_is_valid_uri    (const char *uri);
 
 GList *               seahorse_hkp_parse_lookup_response  (const char *response);
 
+typedef struct _SeahorseHKPIndexParser SeahorseHKPIndexParser;
+
+SeahorseHKPIndexParser * seahorse_hkp_index_parser_new       (void);
+
+void                  seahorse_hkp_index_parser_free      (SeahorseHKPIndexParser *parser);
+
+void                  seahorse_hkp_index_parser_feed      (SeahorseHKPIndexParser *parser,
+                                                           const char             *data,
+                                                           gsize                   len);
+
+void                  seahorse_hkp_index_parser_finish    (SeahorseHKPIndexParser *parser);
+
+GPtrArray *           seahorse_hkp_index_parser_take_keys (SeahorseHKPIndexParser *parser);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (SeahorseHKPIndexParser, seahorse_hkp_index_parser_free)
+
 
 #define HKP_ERROR_DOMAIN (seahorse_hkp_error_quark())
 GQuark            seahorse_hkp_error_quark       (void);
@@ -0,0 +1,661 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "seahorse-keyserver-cache.h"
+
+#include <glib/gstdio.h>
+
+#include <errno.h>
+#include <string.h>
+
+/*
+ * The files are small, and only read and written when we talk to a key
+ * server anyway, so all of this is done synchronously.
+ */
+
+#define CACHE_MAGIC      "SHKSCACH"
+#define CACHE_MAGIC_LEN  8
+#define CACHE_VERSION    1
+
+#define DEFAULT_MAX_SIZE    (32 * 1024 * 1024)
+#define DEFAULT_SEARCH_TTL  (10 * 60)               /* Seconds */
+#define DEFAULT_KEY_TTL     (24 * 60 * 60)
+
+/* Entries are named after a SHA-256 */
+#define ENTRY_NAME_LEN   64
+
+typedef struct {
+    guint64 size;
+    gint64 used;
+} IndexEntry;
+
+struct _SeahorseKeyserverCache {
+    GObject parent;
+
+    char *directory;
+    guint64 max_size;
+    unsigned int search_ttl;
+    unsigned int key_ttl;
+
+    gint64 revalidate_since;        /* Anything fetched until then is stale */
+    GHashTable *index;              /* Entry name → IndexEntry, loaded on demand */
+    guint64 total_size;
+    gint64 clock;                   /* Last use handed out, see next_use() */
+};
+
+enum {
+    PROP_0,
+    PROP_DIRECTORY,
+    PROP_MAX_SIZE,
+    PROP_SEARCH_TTL,
+    PROP_KEY_TTL,
+    N_PROPS
+};
+
+static GParamSpec *obj_props[N_PROPS] = { NULL, };
+
+G_DEFINE_TYPE (SeahorseKeyserverCache, seahorse_keyserver_cache, G_TYPE_OBJECT);
+
+void
+seahorse_keyserver_cache_entry_free (SeahorseKeyserverCacheEntry *entry)
+{
+    if (entry == NULL)
+        return;
+
+    g_clear_pointer (&entry->body, g_bytes_unref);
+    g_free (entry->etag);
+    g_free (entry->last_modified);
+    g_free (entry);
+}
+
+static char *
+entry_name (const char *server,
+            const char *operation,
+            const char *query)
+{
+    g_autofree char *key = NULL;
+
+    key = g_strdup_printf ("%s\n%s\n%s", server, operation, query);
+    return g_compute_checksum_for_string (G_CHECKSUM_SHA256, key, -1);
+}
+
+static gboolean
+is_entry_name (const char *name)
+{
+    if (strlen (name) != ENTRY_NAME_LEN)
+        return FALSE;
+
+    for (size_t i = 0; i < ENTRY_NAME_LEN; i++)
+        if (!g_ascii_isxdigit (name[i]))
+            return FALSE;
+
+    return TRUE;
+}
+
+/* Strictly increasing, so entries used in the same instant are still ordered */
+static gint64
+next_use (SeahorseKeyserverCache *self)
+{
+    self->clock = MAX (self->clock + 1, g_get_real_time ());
+    return self->clock;
+}
+
+/* -----------------------------------------------------------------------------
+ * LRU INDEX
+ */
+
+static void
+ensure_index (SeahorseKeyserverCache *self)
+{
+    g_autoptr(GDir) dir = NULL;
+    const char *name;
+
+    if (self->index != NULL)
+        return;
+
+    self->index = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+    self->total_size = 0;
+
+    dir = g_dir_open (self->directory, 0, NULL);
+    if (dir == NULL)
+        return;
+
+    /* Hits touch the file, so its mtime is when it was last used */
+    while ((name = g_dir_read_name (dir)) != NULL) {
+        g_autofree char *path = NULL;
+        IndexEntry *entry;
+        GStatBuf sb;
+
+        if (!is_entry_name (name))
+            continue;
+
+        path = g_build_filename (self->directory, name, NULL);
+        if (g_stat (path, &sb) < 0 || !S_ISREG (sb.st_mode))
+            continue;
+
+        entry = g_new0 (IndexEntry, 1);
+        entry->size = sb.st_size;
+        entry->used = (gint64) sb.st_mtime * G_USEC_PER_SEC;
+        g_hash_table_insert (self->index, g_strdup (name), entry);
+        self->total_size += entry->size;
+    }
+
+    g_debug ("[keyserver-cache] %u entries, %" G_GUINT64_FORMAT " bytes",
+             g_hash_table_size (self->index), self->total_size);
+}
+
+static void
+remove_entry (SeahorseKeyserverCache *self,
+              const char             *name)
+{
+    g_autofree char *path = NULL;
+    IndexEntry *entry;
+
+    path = g_build_filename (self->directory, name, NULL);
+    if (g_unlink (path) < 0 && errno != ENOENT)
+        g_debug ("[keyserver-cache] couldn't remove %s: %s", path, g_strerror (errno));
+
+    entry = g_hash_table_lookup (self->index, name);
+    if (entry != NULL) {
+        self->total_size -= entry->size;
+        g_hash_table_remove (self->index, name);
+    }
+}
+
+static int
+compare_used (const void *a,
+              const void *b,
+              void       *user_data)
+{
+    GHashTable *index = user_data;
+    const IndexEntry *ea = g_hash_table_lookup (index, *(const char **) a);
+    const IndexEntry *eb = g_hash_table_lookup (index, *(const char **) b);
+
+    return (ea->used > eb->used) - (ea->used < eb->used);
+}
+
+/* Drops the least recently used entries, down to some room below the cap */
+static void
+evict (SeahorseKeyserverCache *self)
+{
+    g_autoptr(GPtrArray) names = NULL;
+    GHashTableIter iter;
+    char *name;
+    guint64 target;
+    guint n_evicted = 0;
+
+    if (self->total_size <= self->max_size)
+        return;
+
+    names = g_ptr_array_new_with_free_func (g_free);
+    g_hash_table_iter_init (&iter, self->index);
+    while (g_hash_table_iter_next (&iter, (void **) &name, NULL))
+        g_ptr_array_add (names, g_strdup (name));
+    g_ptr_array_sort_with_data (names, compare_used, self->index);
+
+    target = self->max_size / 10 * 9;
+    for (guint i = 0; i < names->len && self->total_size > target; i++) {
+        remove_entry (self, g_ptr_array_index (names, i));
+        n_evicted++;
+    }
+
+    g_debug ("[keyserver-cache] evicted %u entries", n_evicted);
+}
+
+/* -----------------------------------------------------------------------------
+ * READING
+ */
+
+typedef struct {
+    const guint8 *at;
+    const guint8 *end;
+    gboolean failed;
+} EntryReader;
+
+static gboolean
+reader_take (EntryReader *reader,
+             void        *data,
+             gsize        len)
+{
+    if (reader->failed || (gsize) (reader->end - reader->at) < len) {
+        reader->failed = TRUE;
+        return FALSE;
+    }
+
+    memcpy (data, reader->at, len);
+    reader->at += len;
+    return TRUE;
+}
+
+static guint32
+read_uint32 (EntryReader *reader)
+{
+    guint32 val = 0;
+    reader_take (reader, &val, sizeof (val));
+    return val;
+}
+
+static gint64
+read_int64 (EntryReader *reader)
+{
+    gint64 val = 0;
+    reader_take (reader, &val, sizeof (val));
+    return val;
+}
+
+/* Empty strings come back as NULL, since that's how missing ones are written */
+static char *
+read_string (EntryReader *reader)
+{
+    guint32 len;
+    char *str;
+
+    len = read_uint32 (reader);
+    if (reader->failed || (gsize) (reader->end - reader->at) < len) {
+        reader->failed = TRUE;
+        return NULL;
+    }
+    if (len == 0)
+        return NULL;
+
+    str = g_strndup ((const char *) reader->at, len);
+    reader->at += len;
+    return str;
+}
+
+static SeahorseKeyserverCacheEntry *
+parse_entry (GBytes *contents,
+             gint64  revalidate_since)
+{
+    g_autoptr(SeahorseKeyserverCacheEntry) entry = NULL;
+    EntryReader reader = { NULL, };
+    char magic[CACHE_MAGIC_LEN];
+    gint64 fetched, expires;
+    gsize len;
+
+    reader.at = g_bytes_get_data (contents, &len);
+    reader.end = reader.at + len;
+
+    if (!reader_take (&reader, magic, CACHE_MAGIC_LEN) ||
+        memcmp (magic, CACHE_MAGIC, CACHE_MAGIC_LEN) != 0 ||
+        read_uint32 (&reader) != CACHE_VERSION)
+        return NULL;
+
+    entry = g_new0 (SeahorseKeyserverCacheEntry, 1);
+    fetched = read_int64 (&reader);
+    expires = read_int64 (&reader);
+    entry->etag = read_string (&reader);
+    entry->last_modified = read_string (&reader);
+    if (reader.failed)
+        return NULL;
+
+    entry->fresh = g_get_real_time () / G_USEC_PER_SEC < expires &&
+                   fetched > revalidate_since;
+    entry->body = g_bytes_new_from_bytes (contents,
+                                          reader.at - (const guint8 *) g_bytes_get_data (contents, NULL),
+                                          reader.end - reader.at);
+    return g_steal_pointer (&entry);
+}
+
+/**
+ * seahorse_keyserver_cache_lookup:
+ * @self: A #SeahorseKeyserverCache
+ * @server: The address of the key server
+ * @operation: What was asked, eg: "index" or "get"
+ * @query: What was searched for
+ *
+ * Looks up what the key server answered last time. The answer can be stale,
+ * in which case it should only be used if the server says it didn't change.
+ *
+ * Returns: (transfer full) (nullable): The cached answer, or %NULL
+ */
+SeahorseKeyserverCacheEntry *
+seahorse_keyserver_cache_lookup (SeahorseKeyserverCache *self,
+                                 const char             *server,
+                                 const char             *operation,
+                                 const char             *query)
+{
+    g_autofree char *name = NULL;
+    g_autofree char *path = NULL;
+    g_autofree char *contents = NULL;
+    g_autoptr(GBytes) bytes = NULL;
+    SeahorseKeyserverCacheEntry *entry;
+    IndexEntry *index_entry;
+    gsize len;
+
+    g_return_val_if_fail (SEAHORSE_IS_KEYSERVER_CACHE (self), NULL);
+    g_return_val_if_fail (server != NULL, NULL);
+    g_return_val_if_fail (operation != NULL, NULL);
+    g_return_val_if_fail (query != NULL, NULL);
+
+    ensure_index (self);
+
+    name = entry_name (server, operation, query);
+    path = g_build_filename (self->directory, name, NULL);
+    if (!g_file_get_contents (path, &contents, &len, NULL)) {
+        if (g_hash_table_contains (self->index, name))
+            remove_entry (self, name);
+        return NULL;
+    }
+
+    bytes = g_bytes_new_take (g_steal_pointer (&contents), len);
+    entry = parse_entry (bytes, self->revalidate_since);
+    if (entry == NULL) {
+        g_debug ("[keyserver-cache] removing unreadable entry %s", name);
+        remove_entry (self, name);
+        return NULL;
+    }
+
+    /* Touch it, so it survives a restart as recently used */
+    index_entry = g_hash_table_lookup (self->index, name);
+    if (index_entry != NULL)
+        index_entry->used = next_use (self);
+    g_utime (path, NULL);
+
+    g_debug ("[keyserver-cache] %s hit for %s %s", entry->fresh ? "fresh" : "stale",
+             operation, query);
+    return entry;
+}
+
+/**
+ * seahorse_keyserver_cache_revalidate:
+ * @self: A #SeahorseKeyserverCache
+ *
+ * Makes everything cached so far stale, eg: when the user explicitly asks
+ * to refresh keys from the key servers. The answers are still used to
+ * revalidate with the server, so unchanged ones needn't be downloaded
+ * again.
+ */
+void
+seahorse_keyserver_cache_revalidate (SeahorseKeyserverCache *self)
+{
+    g_return_if_fail (SEAHORSE_IS_KEYSERVER_CACHE (self));
+
+    self->revalidate_since = g_get_real_time () / G_USEC_PER_SEC;
+}
+
+/* -----------------------------------------------------------------------------
+ * WRITING
+ */
+
+static void
+write_uint32 (GByteArray *buf,
+              guint32     val)
+{
+    g_byte_array_append (buf, (const guint8 *) &val, sizeof (val));
+}
+
+static void
+write_int64 (GByteArray *buf,
+             gint64      val)
+{
+    g_byte_array_append (buf, (const guint8 *) &val, sizeof (val));
+}
+
+static void
+write_string (GByteArray *buf,
+              const char *str)
+{
+    gsize len = str ? strlen (str) : 0;
+
+    write_uint32 (buf, len);
+    g_byte_array_append (buf, (const guint8 *) str, len);
+}
+
+/**
+ * seahorse_keyserver_cache_store:
+ * @self: A #SeahorseKeyserverCache
+ * @server: The address of the key server
+ * @operation: What was asked, eg: "index" or "get"
+ * @query: What was searched for
+ * @kind: How long the answer can be trusted
+ * @body: What the server answered
+ * @etag: (nullable): The ETag header of the answer
+ * @last_modified: (nullable): The Last-Modified header of the answer
+ *
+ * Remembers what the key server answered, replacing any earlier answer.
+ * Failing to write the cache isn't an error, the next lookup just misses.
+ */
+void
+seahorse_keyserver_cache_store (SeahorseKeyserverCache     *self,
+                                const char                 *server,
+                                const char                 *operation,
+                                const char                 *query,
+                                SeahorseKeyserverCacheKind  kind,
+                                GBytes                     *body,
+                                const char                 *etag,
+                                const char                 *last_modified)
+{
+    g_autofree char *name = NULL;
+    g_autofree char *path = NULL;
+    g_autoptr(GByteArray) buf = NULL;
+    g_autoptr(GError) error = NULL;
+    IndexEntry *entry;
+    gint64 now;
+    unsigned int ttl;
+    const guint8 *data;
+    gsize len;
+
+    g_return_if_fail (SEAHORSE_IS_KEYSERVER_CACHE (self));
+    g_return_if_fail (server != NULL);
+    g_return_if_fail (operation != NULL);
+    g_return_if_fail (query != NULL);
+    g_return_if_fail (body != NULL);
+
+    ensure_index (self);
+    name = entry_name (server, operation, query);
+
+    /* Don't let one huge answer push out everything else */
+    data = g_bytes_get_data (body, &len);
+    if (len > self->max_size / 4) {
+        g_debug ("[keyserver-cache] not caching %" G_GSIZE_FORMAT " bytes for %s %s",
+                 len, operation, query);
+        remove_entry (self, name);
+        return;
+    }
+
+    now = g_get_real_time () / G_USEC_PER_SEC;
+    ttl = kind == SEAHORSE_KEYSERVER_CACHE_KEY ? self->key_ttl : self->search_ttl;
+
+    buf = g_byte_array_sized_new (len + 64);
+    g_byte_array_append (buf, (const guint8 *) CACHE_MAGIC, CACHE_MAGIC_LEN);
+    write_uint32 (buf, CACHE_VERSION);
+    write_int64 (buf, now);
+    write_int64 (buf, now + ttl);
+    write_string (buf, etag);
+    write_string (buf, last_modified);
+    g_byte_array_append (buf, data, len);
+
+    if (g_mkdir_with_parents (self->directory, 0700) < 0) {
+        g_debug ("[keyserver-cache] couldn't create directory %s: %s",
+                 self->directory, g_strerror (errno));
+        return;
+    }
+
+    path = g_build_filename (self->directory, name, NULL);
+    if (!g_file_set_contents_full (path, (const char *) buf->data, buf->len,
+                                   G_FILE_SET_CONTENTS_CONSISTENT, 0600, &error)) {
+        g_debug ("[keyserver-cache] couldn't write entry: %s", error->message);
+        return;
+    }
+
+    entry = g_hash_table_lookup (self->index, name);
+    if (entry == NULL) {
+        entry = g_new0 (IndexEntry, 1);
+        g_hash_table_insert (self->index, g_strdup (name), entry);
+    } else {
+        self->total_size -= entry->size;
+    }
+    entry->size = buf->len;
+    entry->used = next_use (self);
+    self->total_size += entry->size;
+
+    evict (self);
+}
+
+/* -----------------------------------------------------------------------------
+ * OBJECT
+ */
+
+static void
+seahorse_keyserver_cache_init (SeahorseKeyserverCache *self)
+{
+}
+
+static void
+seahorse_keyserver_cache_get_property (GObject      *object,
+                                       unsigned int  prop_id,
+                                       GValue       *value,
+                                       GParamSpec   *pspec)
+{
+    SeahorseKeyserverCache *self = SEAHORSE_KEYSERVER_CACHE (object);
+
+    switch (prop_id) {
+    case PROP_DIRECTORY:
+        g_value_set_string (value, self->directory);
+        break;
+    case PROP_MAX_SIZE:
+        g_value_set_uint64 (value, self->max_size);
+        break;
+    case PROP_SEARCH_TTL:
+        g_value_set_uint (value, self->search_ttl);
+        break;
+    case PROP_KEY_TTL:
+        g_value_set_uint (value, self->key_ttl);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+seahorse_keyserver_cache_set_property (GObject      *object,
+                                       unsigned int  prop_id,
+                                       const GValue *value,
+                                       GParamSpec   *pspec)
+{
+    SeahorseKeyserverCache *self = SEAHORSE_KEYSERVER_CACHE (object);
+
+    switch (prop_id) {
+    case PROP_DIRECTORY:
+        self->directory = g_value_dup_string (value);
+        break;
+    case PROP_MAX_SIZE:
+        self->max_size = g_value_get_uint64 (value);
+        if (self->index != NULL)
+            evict (self);
+        break;
+    case PROP_SEARCH_TTL:
+        self->search_ttl = g_value_get_uint (value);
+        break;
+    case PROP_KEY_TTL:
+        self->key_ttl = g_value_get_uint (value);
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+        break;
+    }
+}
+
+static void
+seahorse_keyserver_cache_finalize (GObject *object)
+{
+    SeahorseKeyserverCache *self = SEAHORSE_KEYSERVER_CACHE (object);
+
+    g_free (self->directory);
+    g_clear_pointer (&self->index, g_hash_table_unref);
+
+    G_OBJECT_CLASS (seahorse_keyserver_cache_parent_class)->finalize (object);
+}
+
+static void
+seahorse_keyserver_cache_class_init (SeahorseKeyserverCacheClass *klass)
+{
+    GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+    gobject_class->get_property = seahorse_keyserver_cache_get_property;
+    gobject_class->set_property = seahorse_keyserver_cache_set_property;
+    gobject_class->finalize = seahorse_keyserver_cache_finalize;
+
+    obj_props[PROP_DIRECTORY] =
+        g_param_spec_string ("directory", "Directory",
+                             "Where the cached answers are stored",
+                             NULL,
+                             G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+    obj_props[PROP_MAX_SIZE] =
+        g_param_spec_uint64 ("max-size", "Max size",
+                             "How many bytes the cache can use on disk",
+                             0, G_MAXUINT64, DEFAULT_MAX_SIZE,
+                             G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS);
+
+    obj_props[PROP_SEARCH_TTL] =
+        g_param_spec_uint ("search-ttl", "Search TTL",
+                           "How many seconds search results stay fresh",
+                           0, G_MAXUINT, DEFAULT_SEARCH_TTL,
+                           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS);
+
+    obj_props[PROP_KEY_TTL] =
+        g_param_spec_uint ("key-ttl", "Key TTL",
+                           "How many seconds keys retrieved by fingerprint stay fresh",
+                           0, G_MAXUINT, DEFAULT_KEY_TTL,
+                           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS);
+
+    g_object_class_install_properties (gobject_class, N_PROPS, obj_props);
+}
+
+/**
+ * seahorse_keyserver_cache_new:
+ * @directory: Where to store the cached answers
+ *
+ * Returns: (transfer full): A new cache
+ */
+SeahorseKeyserverCache *
+seahorse_keyserver_cache_new (const char *directory)
+{
+    g_return_val_if_fail (directory != NULL, NULL);
+
+    return g_object_new (SEAHORSE_TYPE_KEYSERVER_CACHE,
+                         "directory", directory,
+                         NULL);
+}
+
+/**
+ * seahorse_keyserver_cache_get_default:
+ *
+ * Returns: (transfer none): The cache in the user's cache directory
+ */
+SeahorseKeyserverCache *
+seahorse_keyserver_cache_get_default (void)
+{
+    static SeahorseKeyserverCache *default_cache = NULL;
+
+    if (default_cache == NULL) {
+        g_autofree char *directory = NULL;
+
+        directory = g_build_filename (g_get_user_cache_dir (),
+                                      "seahorse", "keyserver", NULL);
+        default_cache = seahorse_keyserver_cache_new (directory);
+    }
+
+    return default_cache;
+}
@@ -0,0 +1,76 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SeahorseKeyserverCache: Remembers what key servers answered.
+ *
+ * - Each response is a file in the user cache directory, named after a
+ *   hash of the server, the operation and the query.
+ * - Responses are fresh for a while, after which they can still be used to
+ *   revalidate with the server (eg: with an ETag).
+ * - Once the cache grows over its size limit, the least recently used
+ *   responses are removed.
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+typedef enum {
+    /* Searches, and anything else that can change any time */
+    SEAHORSE_KEYSERVER_CACHE_SEARCH,
+    /* A key asked for by its full fingerprint */
+    SEAHORSE_KEYSERVER_CACHE_KEY,
+} SeahorseKeyserverCacheKind;
+
+typedef struct _SeahorseKeyserverCacheEntry {
+    GBytes *body;
+    char *etag;                 /* NULL if the server didn't send one */
+    char *last_modified;        /* NULL if the server didn't send one */
+    gboolean fresh;             /* No need to ask the server again yet */
+} SeahorseKeyserverCacheEntry;
+
+void                          seahorse_keyserver_cache_entry_free  (SeahorseKeyserverCacheEntry *entry);
+
+#define SEAHORSE_TYPE_KEYSERVER_CACHE (seahorse_keyserver_cache_get_type ())
+G_DECLARE_FINAL_TYPE (SeahorseKeyserverCache, seahorse_keyserver_cache,
+                      SEAHORSE, KEYSERVER_CACHE,
+                      GObject)
+
+SeahorseKeyserverCache *      seahorse_keyserver_cache_new         (const char *directory);
+
+SeahorseKeyserverCache *      seahorse_keyserver_cache_get_default (void);
+
+SeahorseKeyserverCacheEntry * seahorse_keyserver_cache_lookup      (SeahorseKeyserverCache     *self,
+                                                                    const char                 *server,
+                                                                    const char                 *operation,
+                                                                    const char                 *query);
+
+void                          seahorse_keyserver_cache_store       (SeahorseKeyserverCache     *self,
+                                                                    const char                 *server,
+                                                                    const char                 *operation,
+                                                                    const char                 *query,
+                                                                    SeahorseKeyserverCacheKind  kind,
+                                                                    GBytes                     *body,
+                                                                    const char                 *etag,
+                                                                    const char                 *last_modified);
+
+void                          seahorse_keyserver_cache_revalidate  (SeahorseKeyserverCache     *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (SeahorseKeyserverCacheEntry, seahorse_keyserver_cache_entry_free)
@@ -22,6 +22,7 @@
 
 #include "seahorse-keyserver-sync.h"
 
+#include "seahorse-keyserver-cache.h"
 #include "seahorse-pgp-backend.h"
 #include "seahorse-transfer.h"
 
@@ -270,6 +271,9 @@ seahorse_keyserver_sync_do_sync (GList *keys)
         g_ptr_array_add (keyids, (char *) seahorse_pgp_key_get_keyid (l->data));
     g_ptr_array_add (keyids, NULL);
 
+    /* The user asked for it, so don't settle for what we have cached */
+    seahorse_keyserver_cache_revalidate (seahorse_keyserver_cache_get_default ());
+
     /* And now synchronizing keys from the servers */
     keyservers = seahorse_pgp_settings_get_uris (pgp_settings);
     for (guint i = 0; keyservers[i] != NULL; i++) {
@@ -28,6 +28,7 @@
 
 #include "seahorse-ldap-source.h"
 
+#include "seahorse-pgp-armor.h"
 #include "seahorse-pgp-key.h"
 #include "seahorse-pgp-subkey.h"
 #include "seahorse-pgp-uid.h"
@@ -931,7 +932,7 @@ seahorse_ldap_source_search_finish (SeahorseServerSource *source,
 }
 
 typedef struct {
-    GPtrArray *keydatas;
+    GPtrArray *keydatas;                /* GBytes, one armored key each */
     int current_index;
     LDAP *ldap;
 } ImportClosure;
@@ -994,7 +995,7 @@ import_send_key (SeahorseLDAPSource *self, GTask *task)
     char *values[2];
     g_autoptr(GSource) gsource = NULL;
     GError *error = NULL;
-    char *keydata;
+    GBytes *keydata;
     int ldap_op;
     int rc;
 
@@ -1013,7 +1014,8 @@ import_send_key (SeahorseLDAPSource *self, GTask *task)
 
     keydata = g_ptr_array_index (closure->keydatas, closure->current_index);
     seahorse_progress_begin (cancellable, keydata);
-    values[0] = keydata;
+    /* The blocks we read are nul-terminated */
+    values[0] = (char *) g_bytes_get_data (keydata, NULL);
     values[1] = NULL;
 
     sinfo = get_ldap_server_info (self, TRUE);
@@ -1058,6 +1060,37 @@ on_import_connect_completed (GObject *source,
     import_send_key (self, task);
 }
 
+static void
+on_import_blocks_read (GObject      *source,
+                       GAsyncResult *result,
+                       gpointer      user_data)
+{
+    g_autoptr(GTask) task = G_TASK (user_data);
+    ImportClosure *closure = g_task_get_task_data (task);
+    SeahorseLDAPSource *self = SEAHORSE_LDAP_SOURCE (g_task_get_source_object (task));
+    GCancellable *cancellable = g_task_get_cancellable (task);
+    g_autoptr(GPtrArray) blocks = NULL;
+    g_autoptr(GError) error = NULL;
+
+    blocks = seahorse_pgp_armor_read_blocks_finish (G_INPUT_STREAM (source),
+                                                    result, &error);
+    if (blocks == NULL) {
+        g_task_return_error (task, g_steal_pointer (&error));
+        return;
+    }
+
+    for (unsigned int i = 0; i < blocks->len; i++) {
+        GBytes *block = g_ptr_array_index (blocks, i);
+
+        seahorse_progress_prep (cancellable, block, NULL);
+        g_ptr_array_add (closure->keydatas, g_bytes_ref (block));
+    }
+
+    seahorse_ldap_source_connect_async (self, cancellable,
+                                        on_import_connect_completed,
+                                        g_steal_pointer (&task));
+}
+
 static void
 seahorse_ldap_source_import_async (SeahorseServerSource *source,
                                    GInputStream *input,
@@ -1065,7 +1098,6 @@ seahorse_ldap_source_import_async (SeahorseServerSource *source,
                                    GAsyncReadyCallback callback,
                                    gpointer user_data)
 {
-    SeahorseLDAPSource *self = SEAHORSE_LDAP_SOURCE (source);
     g_autoptr(GTask) task = NULL;
     ImportClosure *closure;
 
@@ -1074,27 +1106,12 @@ seahorse_ldap_source_import_async (SeahorseServerSource *source,
 
     closure = g_new0 (ImportClosure, 1);
     closure->current_index = -1;
+    closure->keydatas = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
     g_task_set_task_data (task, closure, import_closure_free);
 
-    closure->keydatas = g_ptr_array_new_with_free_func (g_free);
-    for (;;) {
-        g_autoptr(GString) buf = g_string_sized_new (2048);
-        guint len;
-        g_autofree char *keydata = NULL;
-
-        len = seahorse_util_read_data_block (buf, input, "-----BEGIN PGP PUBLIC KEY BLOCK-----",
-                                             "-----END PGP PUBLIC KEY BLOCK-----");
-        if (len <= 0)
-            break;
-
-        keydata = g_string_free (g_steal_pointer (&buf), FALSE);
-        seahorse_progress_prep (cancellable, keydata, NULL);
-        g_ptr_array_add (closure->keydatas, g_steal_pointer (&keydata));
-    }
-
-    seahorse_ldap_source_connect_async (self, cancellable,
-                                        on_import_connect_completed,
-                                        g_steal_pointer (&task));
+    seahorse_pgp_armor_read_blocks_async (input, SEAHORSE_PGP_ARMOR_PUBLIC_KEY,
+                                          cancellable, on_import_blocks_read,
+                                          g_steal_pointer (&task));
 }
 
 static GList *
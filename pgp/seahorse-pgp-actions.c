@@ -27,6 +27,7 @@
 #include "seahorse-gpgme-generate-dialog.h"
 #include "seahorse-gpgme-key.h"
 #include "seahorse-gpgme-key-op.h"
+#include "seahorse-gpgme-sign-dialog.h"
 #include "seahorse-gpgme-uid.h"
 #include "seahorse-pgp-backend.h"
 #include "seahorse-pgp-actions.h"
@@ -151,8 +152,52 @@ on_pgp_generate_key (GSimpleAction *action,
   g_clear_object (&catalog);
 }
 
+/* Other people's keys, which is what one signs after a key signing party */
+static GPtrArray *
+get_keys_to_sign (GList *objects)
+{
+    GPtrArray *keys = g_ptr_array_new_with_free_func (g_object_unref);
+
+    for (GList *l = objects; l != NULL; l = g_list_next (l)) {
+        if (SEAHORSE_GPGME_IS_KEY (l->data) &&
+            seahorse_object_get_usage (l->data) == SEAHORSE_USAGE_PUBLIC_KEY)
+            g_ptr_array_add (keys, g_object_ref (l->data));
+    }
+
+    return keys;
+}
+
+static void
+on_pgp_sign_keys (GSimpleAction *action,
+                  GVariant *param,
+                  gpointer user_data)
+{
+    SeahorseActionGroup *actions = SEAHORSE_ACTION_GROUP (user_data);
+    g_autoptr(SeahorseCatalog) catalog = NULL;
+    g_autoptr(GList) objects = NULL;
+    g_autoptr(GPtrArray) keys = NULL;
+    SeahorseGpgmeSignDialog *dialog;
+
+    catalog = seahorse_action_group_get_catalog (actions);
+    g_return_if_fail (catalog != NULL);
+
+    objects = seahorse_catalog_get_selected_objects (catalog);
+    keys = get_keys_to_sign (objects);
+    if (keys->len == 0)
+        return;
+
+    dialog = seahorse_gpgme_sign_dialog_new_for_keys (keys);
+    if (dialog == NULL)
+        return;
+
+    gtk_window_set_transient_for (GTK_WINDOW (dialog), GTK_WINDOW (catalog));
+    gtk_dialog_run (GTK_DIALOG (dialog));
+    gtk_widget_destroy (GTK_WIDGET (dialog));
+}
+
 static const GActionEntry ACTION_ENTRIES[] = {
     { "pgp-generate-key", on_pgp_generate_key },
+    { "sign-keys",        on_pgp_sign_keys },
 #ifdef WITH_KEYSERVER
     { "remote-sync",      on_remote_sync },
     { "remote-find",      on_remote_find }
@@ -170,10 +215,24 @@ seahorse_pgp_backend_actions_init (SeahorsePgpBackendActions *self)
                                      self);
 }
 
+static void
+seahorse_pgp_backend_actions_set_actions_for_selected_objects (SeahorseActionGroup *actions,
+                                                               GList               *objects)
+{
+    g_autoptr(GPtrArray) keys = NULL;
+    GAction *action;
+
+    keys = get_keys_to_sign (objects);
+    action = g_action_map_lookup_action (G_ACTION_MAP (actions), "sign-keys");
+    g_simple_action_set_enabled (G_SIMPLE_ACTION (action), keys->len > 0);
+}
+
 static void
 seahorse_pgp_backend_actions_class_init (SeahorsePgpBackendActionsClass *klass)
 {
+    SeahorseActionGroupClass *actions_class = SEAHORSE_ACTION_GROUP_CLASS (klass);
 
+    actions_class->set_actions_for_selected_objects = seahorse_pgp_backend_actions_set_actions_for_selected_objects;
 }
 
 SeahorseActionGroup *
@@ -0,0 +1,533 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "seahorse-pgp-armor.h"
+
+#include <string.h>
+
+#define ARMOR_READ_SIZE (64 * 1024)
+
+/* Finds @marker in @data. Base64 has no dashes, so memchr() for the first
+ * one skips over the bulk of an armored block quickly. */
+static const char *
+find_marker (const char *data,
+             gsize       len,
+             const char *marker,
+             gsize       marker_len)
+{
+    const char *end = data + len;
+    const char *p = data;
+
+    while (end - p >= (gssize) marker_len) {
+        p = memchr (p, marker[0], (end - p) - marker_len + 1);
+        if (p == NULL)
+            return NULL;
+        if (memcmp (p, marker, marker_len) == 0)
+            return p;
+
+        /* Start over right after the dash, since it can start a match */
+        p++;
+    }
+
+    return NULL;
+}
+
+/**
+ * seahorse_pgp_armor_find_blocks:
+ * @data: The armored text
+ * @type: The kind of block, eg: %SEAHORSE_PGP_ARMOR_PUBLIC_KEY
+ *
+ * Finds all the complete armored blocks of @type in @data. Anything in
+ * between them, and a block that's missing its end line, is skipped.
+ *
+ * Returns: (transfer full) (element-type GBytes): Each block, from the start
+ *   of its BEGIN line to the end of its END line
+ */
+GPtrArray *
+seahorse_pgp_armor_find_blocks (GBytes     *data,
+                                const char *type)
+{
+    g_autofree char *begin = NULL;
+    g_autofree char *end = NULL;
+    gsize begin_len, end_len;
+    GPtrArray *blocks;
+    const char *text;
+    gsize len, at = 0;
+
+    g_return_val_if_fail (data != NULL, NULL);
+    g_return_val_if_fail (type != NULL, NULL);
+
+    begin = g_strdup_printf ("-----BEGIN %s-----", type);
+    end = g_strdup_printf ("-----END %s-----", type);
+    begin_len = strlen (begin);
+    end_len = strlen (end);
+
+    blocks = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+    text = g_bytes_get_data (data, &len);
+
+    for (;;) {
+        const char *start, *stop;
+
+        start = find_marker (text + at, len - at, begin, begin_len);
+        if (start == NULL)
+            break;
+
+        stop = find_marker (start + begin_len, (text + len) - (start + begin_len),
+                            end, end_len);
+        if (stop == NULL)
+            break;
+
+        stop += end_len;
+        g_ptr_array_add (blocks, g_bytes_new_from_bytes (data, start - text, stop - start));
+        at = stop - text;
+    }
+
+    return blocks;
+}
+
+/*
+ * Finds the blocks in a stream as it is read, a chunk at a time. Only the
+ * block we're in the middle of is kept around, and what's before it is
+ * never looked at again.
+ */
+typedef struct {
+    char *begin;
+    char *end;
+    gsize begin_len;
+    gsize end_len;
+    GByteArray *pending;                /* Starts with a BEGIN line if in_block */
+    gboolean in_block;
+    gsize scanned;                      /* How much of pending has no marker */
+    GPtrArray *blocks;
+} ArmorScanner;
+
+static ArmorScanner *
+armor_scanner_new (const char *type)
+{
+    ArmorScanner *scanner = g_new0 (ArmorScanner, 1);
+
+    scanner->begin = g_strdup_printf ("-----BEGIN %s-----", type);
+    scanner->end = g_strdup_printf ("-----END %s-----", type);
+    scanner->begin_len = strlen (scanner->begin);
+    scanner->end_len = strlen (scanner->end);
+    scanner->pending = g_byte_array_sized_new (ARMOR_READ_SIZE);
+    scanner->blocks = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+    return scanner;
+}
+
+static void
+armor_scanner_free (ArmorScanner *scanner)
+{
+    g_free (scanner->begin);
+    g_free (scanner->end);
+    g_byte_array_unref (scanner->pending);
+    g_clear_pointer (&scanner->blocks, g_ptr_array_unref);
+    g_free (scanner);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (ArmorScanner, armor_scanner_free)
+
+/* Copies a block out with a terminating nul, so it can be used as a string */
+static GBytes *
+copy_block (const char *data,
+            gsize       len)
+{
+    char *block;
+
+    block = g_malloc (len + 1);
+    memcpy (block, data, len);
+    block[len] = '\0';
+    return g_bytes_new_take (block, len);
+}
+
+static void
+armor_scanner_feed (ArmorScanner *scanner,
+                    const guint8 *data,
+                    gsize         len)
+{
+    const char *text, *end, *marker;
+
+    g_byte_array_append (scanner->pending, data, len);
+    text = (const char *) scanner->pending->data;
+    end = text + scanner->pending->len;
+
+    for (;;) {
+        if (!scanner->in_block) {
+            marker = find_marker (text + scanner->scanned, end - (text + scanner->scanned),
+                                  scanner->begin, scanner->begin_len);
+
+            /* Only keep what could be the start of a BEGIN line */
+            if (marker == NULL) {
+                text = end - MIN ((gsize) (end - text), scanner->begin_len - 1);
+                scanner->scanned = 0;
+                break;
+            }
+
+            text = marker;
+            scanner->in_block = TRUE;
+            scanner->scanned = scanner->begin_len;
+            continue;
+        }
+
+        marker = find_marker (text + scanner->scanned, end - (text + scanner->scanned),
+                              scanner->end, scanner->end_len);
+
+        /* The END line might still be cut off at the end */
+        if (marker == NULL) {
+            if ((gsize) (end - text) >= scanner->end_len)
+                scanner->scanned = MAX (scanner->scanned,
+                                        (end - text) - scanner->end_len + 1);
+            break;
+        }
+
+        marker += scanner->end_len;
+        g_ptr_array_add (scanner->blocks, copy_block (text, marker - text));
+        text = marker;
+        scanner->in_block = FALSE;
+        scanner->scanned = 0;
+    }
+
+    /* Everything before text is done with */
+    g_byte_array_remove_range (scanner->pending, 0,
+                               text - (const char *) scanner->pending->data);
+}
+
+/* A block without its END line is dropped, like in find_blocks() */
+static GPtrArray *
+armor_scanner_finish (ArmorScanner *scanner)
+{
+    return g_steal_pointer (&scanner->blocks);
+}
+
+/**
+ * seahorse_pgp_armor_read_blocks:
+ * @input: The stream to read the armored text from
+ * @type: The kind of block, eg: %SEAHORSE_PGP_ARMOR_PUBLIC_KEY
+ * @cancellable: (nullable): Cancellation object
+ * @error: Error location
+ *
+ * Reads all of @input, and finds the blocks in it like
+ * seahorse_pgp_armor_find_blocks(). The blocks are found while reading, so
+ * @input is never in memory all at once.
+ *
+ * Returns: (transfer full) (element-type GBytes): The blocks. Their data is
+ *   nul-terminated, so it can be used as a string.
+ */
+GPtrArray *
+seahorse_pgp_armor_read_blocks (GInputStream *input,
+                                const char   *type,
+                                GCancellable *cancellable,
+                                GError      **error)
+{
+    g_autoptr(ArmorScanner) scanner = NULL;
+    g_autofree guint8 *buffer = NULL;
+
+    g_return_val_if_fail (G_IS_INPUT_STREAM (input), NULL);
+    g_return_val_if_fail (type != NULL, NULL);
+    g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+    scanner = armor_scanner_new (type);
+    buffer = g_malloc (ARMOR_READ_SIZE);
+    for (;;) {
+        gssize nread;
+
+        nread = g_input_stream_read (input, buffer, ARMOR_READ_SIZE,
+                                     cancellable, error);
+        if (nread < 0)
+            return NULL;
+        if (nread == 0)
+            break;
+
+        armor_scanner_feed (scanner, buffer, nread);
+    }
+
+    return armor_scanner_finish (scanner);
+}
+
+typedef struct {
+    ArmorScanner *scanner;
+    guint8 *buffer;
+} ReadClosure;
+
+static void
+read_closure_free (void *data)
+{
+    ReadClosure *closure = data;
+
+    armor_scanner_free (closure->scanner);
+    g_free (closure->buffer);
+    g_free (closure);
+}
+
+static void
+on_armor_read (GObject      *source,
+               GAsyncResult *result,
+               void         *user_data)
+{
+    GInputStream *input = G_INPUT_STREAM (source);
+    g_autoptr(GTask) task = G_TASK (user_data);
+    ReadClosure *closure = g_task_get_task_data (task);
+    GError *error = NULL;
+    gssize nread;
+
+    nread = g_input_stream_read_finish (input, result, &error);
+    if (nread < 0) {
+        g_task_return_error (task, error);
+        return;
+    }
+
+    if (nread > 0) {
+        armor_scanner_feed (closure->scanner, closure->buffer, nread);
+        g_input_stream_read_async (input, closure->buffer, ARMOR_READ_SIZE,
+                                   G_PRIORITY_DEFAULT,
+                                   g_task_get_cancellable (task),
+                                   on_armor_read, g_steal_pointer (&task));
+        return;
+    }
+
+    g_task_return_pointer (task, armor_scanner_finish (closure->scanner),
+                           (GDestroyNotify) g_ptr_array_unref);
+}
+
+/**
+ * seahorse_pgp_armor_read_blocks_async:
+ * @input: The stream to read the armored text from
+ * @type: The kind of block, eg: %SEAHORSE_PGP_ARMOR_PUBLIC_KEY
+ * @cancellable: (nullable): Cancellation object
+ * @callback: Called when done
+ * @user_data: Data for @callback
+ *
+ * Like seahorse_pgp_armor_read_blocks(), without blocking on @input.
+ */
+void
+seahorse_pgp_armor_read_blocks_async (GInputStream        *input,
+                                      const char          *type,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      void                *user_data)
+{
+    g_autoptr(GTask) task = NULL;
+    ReadClosure *closure;
+
+    g_return_if_fail (G_IS_INPUT_STREAM (input));
+    g_return_if_fail (type != NULL);
+
+    task = g_task_new (input, cancellable, callback, user_data);
+    g_task_set_source_tag (task, seahorse_pgp_armor_read_blocks_async);
+
+    closure = g_new0 (ReadClosure, 1);
+    closure->scanner = armor_scanner_new (type);
+    closure->buffer = g_malloc (ARMOR_READ_SIZE);
+    g_task_set_task_data (task, closure, read_closure_free);
+
+    g_input_stream_read_async (input, closure->buffer, ARMOR_READ_SIZE,
+                               G_PRIORITY_DEFAULT, cancellable,
+                               on_armor_read, g_steal_pointer (&task));
+}
+
+/**
+ * seahorse_pgp_armor_read_blocks_finish:
+ * @input: The stream passed to seahorse_pgp_armor_read_blocks_async()
+ * @result: The result passed to the callback
+ * @error: Error location
+ *
+ * Returns: (transfer full) (element-type GBytes): The blocks, with
+ *   nul-terminated data like seahorse_pgp_armor_read_blocks()
+ */
+GPtrArray *
+seahorse_pgp_armor_read_blocks_finish (GInputStream  *input,
+                                       GAsyncResult  *result,
+                                       GError       **error)
+{
+    g_return_val_if_fail (g_task_is_valid (result, input), NULL);
+    g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) ==
+                          seahorse_pgp_armor_read_blocks_async, NULL);
+
+    return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/*
+ * Decodes the blocks in a stream as it is read, a piece at a time. Only the
+ * start of the current line is kept, in case it's a BEGIN line, so the body
+ * of a block never needs to be in memory all at once.
+ */
+typedef enum {
+    DECODER_OUTSIDE,                    /* Looking for a BEGIN line */
+    DECODER_HEADERS,                    /* Up to the first empty line */
+    DECODER_BODY,                       /* Up to the checksum or the END line */
+} DecoderState;
+
+/* Enough for any BEGIN line */
+#define DECODER_LINE_SIZE 64
+
+struct _SeahorsePgpArmorDecoder {
+    GStrv begins;
+    DecoderState state;
+    char line[DECODER_LINE_SIZE];       /* The start of the current line */
+    gsize column;                       /* How much of the line was fed */
+    gboolean blank;                     /* Whether the line is empty so far */
+    int base64_state;
+    unsigned int base64_save;
+};
+
+/**
+ * seahorse_pgp_armor_decoder_new:
+ * @types: (array zero-terminated=1): The kinds of block to decode, eg:
+ *   %SEAHORSE_PGP_ARMOR_PUBLIC_KEY
+ *
+ * Creates a decoder for the base64 bodies of the blocks of @types. Armor
+ * headers and anything outside those blocks are skipped, and checksums
+ * aren't verified, that's left to gpg.
+ *
+ * Returns: (transfer full): The new decoder
+ */
+SeahorsePgpArmorDecoder *
+seahorse_pgp_armor_decoder_new (const char * const *types)
+{
+    SeahorsePgpArmorDecoder *decoder;
+    unsigned int n_types;
+
+    g_return_val_if_fail (types != NULL, NULL);
+
+    n_types = g_strv_length ((char **) types);
+    decoder = g_new0 (SeahorsePgpArmorDecoder, 1);
+    decoder->begins = g_new0 (char *, n_types + 1);
+    for (unsigned int i = 0; i < n_types; i++)
+        decoder->begins[i] = g_strdup_printf ("-----BEGIN %s-----", types[i]);
+    decoder->blank = TRUE;
+    return decoder;
+}
+
+void
+seahorse_pgp_armor_decoder_free (SeahorsePgpArmorDecoder *decoder)
+{
+    if (decoder == NULL)
+        return;
+
+    g_strfreev (decoder->begins);
+    g_free (decoder);
+}
+
+static gboolean
+decoder_is_begin_line (SeahorsePgpArmorDecoder *decoder,
+                       gsize                    len)
+{
+    for (unsigned int i = 0; decoder->begins[i] != NULL; i++) {
+        gsize begin_len = strlen (decoder->begins[i]);
+
+        if (len >= begin_len && memcmp (decoder->line, decoder->begins[i], begin_len) == 0)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+static void
+decoder_decode (SeahorsePgpArmorDecoder *decoder,
+                const char              *text,
+                gsize                    len,
+                GByteArray              *output)
+{
+    unsigned int at = output->len;
+    gsize written;
+
+    g_byte_array_set_size (output, at + (len / 4) * 3 + 3);
+    written = g_base64_decode_step (text, len, output->data + at,
+                                    &decoder->base64_state, &decoder->base64_save);
+    g_byte_array_set_size (output, at + written);
+}
+
+/* Handles @len bytes of the current line, which end with its newline if
+ * @eol is set */
+static void
+decoder_feed_line (SeahorsePgpArmorDecoder *decoder,
+                   const char              *text,
+                   gsize                    len,
+                   gboolean                 eol,
+                   GByteArray              *output)
+{
+    /* Base64 lines never start with either of these */
+    if (decoder->state == DECODER_BODY && decoder->column == 0 &&
+        (text[0] == '=' || text[0] == '-'))
+        decoder->state = DECODER_OUTSIDE;
+
+    switch (decoder->state) {
+    case DECODER_OUTSIDE:
+        if (decoder->column < DECODER_LINE_SIZE)
+            memcpy (decoder->line + decoder->column, text,
+                    MIN (len, DECODER_LINE_SIZE - decoder->column));
+        if (eol && decoder_is_begin_line (decoder, MIN (decoder->column + len,
+                                                        DECODER_LINE_SIZE)))
+            decoder->state = DECODER_HEADERS;
+        break;
+
+    case DECODER_HEADERS:
+        for (gsize i = 0; i < len && decoder->blank; i++)
+            decoder->blank = g_ascii_isspace (text[i]);
+        if (eol && decoder->blank) {
+            decoder->state = DECODER_BODY;
+            decoder->base64_state = 0;
+            decoder->base64_save = 0;
+        }
+        break;
+
+    case DECODER_BODY:
+        decoder_decode (decoder, text, len, output);
+        break;
+    }
+
+    if (eol) {
+        decoder->column = 0;
+        decoder->blank = TRUE;
+    } else {
+        decoder->column += len;
+    }
+}
+
+/**
+ * seahorse_pgp_armor_decoder_feed:
+ * @decoder: The decoder
+ * @text: The next piece of armored text
+ * @len: The length of @text
+ * @output: Where the decoded data is appended
+ *
+ * Decodes what it can of @text. Lines can be cut off anywhere between
+ * calls. A block that's missing its END line is decoded as far as it goes.
+ */
+void
+seahorse_pgp_armor_decoder_feed (SeahorsePgpArmorDecoder *decoder,
+                                 const char              *text,
+                                 gsize                    len,
+                                 GByteArray              *output)
+{
+    const char *end = text + len;
+
+    g_return_if_fail (decoder != NULL);
+    g_return_if_fail (output != NULL);
+
+    while (text < end) {
+        const char *eol = memchr (text, '\n', end - text);
+        const char *stop = eol ? eol + 1 : end;
+
+        decoder_feed_line (decoder, text, stop - text, eol != NULL, output);
+        text = stop;
+    }
+}
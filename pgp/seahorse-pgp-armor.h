@@ -0,0 +1,67 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Finds the ASCII armored blocks (RFC 4880, section 6.2) in a bundle of
+ * them, like "-----BEGIN PGP PUBLIC KEY BLOCK-----" up to the matching
+ * "-----END PGP PUBLIC KEY BLOCK-----". Blocks found in data are returned
+ * as slices of it, so they aren't copied. Blocks read from a stream are
+ * found as it is read, and copied out with a terminating nul.
+ *
+ * SeahorsePgpArmorDecoder decodes blocks a piece at a time instead, for
+ * when even a single block is too big to keep around.
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+#define SEAHORSE_PGP_ARMOR_PUBLIC_KEY "PGP PUBLIC KEY BLOCK"
+#define SEAHORSE_PGP_ARMOR_PRIVATE_KEY "PGP PRIVATE KEY BLOCK"
+
+typedef struct _SeahorsePgpArmorDecoder SeahorsePgpArmorDecoder;
+
+GPtrArray *  seahorse_pgp_armor_find_blocks      (GBytes       *data,
+                                                  const char   *type);
+
+GPtrArray *  seahorse_pgp_armor_read_blocks      (GInputStream *input,
+                                                  const char   *type,
+                                                  GCancellable *cancellable,
+                                                  GError      **error);
+
+void         seahorse_pgp_armor_read_blocks_async  (GInputStream        *input,
+                                                    const char          *type,
+                                                    GCancellable        *cancellable,
+                                                    GAsyncReadyCallback  callback,
+                                                    void                *user_data);
+
+GPtrArray *  seahorse_pgp_armor_read_blocks_finish (GInputStream        *input,
+                                                    GAsyncResult        *result,
+                                                    GError             **error);
+
+SeahorsePgpArmorDecoder * seahorse_pgp_armor_decoder_new  (const char * const *types);
+
+void         seahorse_pgp_armor_decoder_free     (SeahorsePgpArmorDecoder *decoder);
+
+void         seahorse_pgp_armor_decoder_feed     (SeahorsePgpArmorDecoder *decoder,
+                                                  const char              *text,
+                                                  gsize                    len,
+                                                  GByteArray              *output);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (SeahorsePgpArmorDecoder, seahorse_pgp_armor_decoder_free)
@@ -21,8 +21,10 @@
 #include "config.h"
 
 #include "seahorse-gpgme-dialogs.h"
+#include "seahorse-hkp-source.h"
 #include "seahorse-pgp-actions.h"
 #include "seahorse-pgp-backend.h"
+#include "seahorse-server-search.h"
 #include "seahorse-server-source.h"
 #include "seahorse-transfer.h"
 #include "seahorse-unknown-source.h"
@@ -38,6 +40,12 @@
 
 static SeahorsePgpBackend *pgp_backend = NULL;
 
+/* How long a single key server gets to answer a search */
+#define DEFAULT_SEARCH_TIMEOUT   30      /* Seconds */
+
+/* By default, wait for every server that answers within the timeout */
+#define DEFAULT_SEARCH_DEADLINE  0
+
 struct _SeahorsePgpBackend {
     GObject parent;
 
@@ -50,11 +58,18 @@ struct _SeahorsePgpBackend {
     GListModel *remotes;
     SeahorseActionGroup *actions;
     gboolean loaded;
+
+    unsigned int search_quorum;
+    unsigned int search_timeout;
+    unsigned int search_deadline;
 };
 
 enum {
     PROP_0,
     PROP_GPG_HOMEDIR,
+    PROP_SEARCH_QUORUM,
+    PROP_SEARCH_TIMEOUT,
+    PROP_SEARCH_DEADLINE,
     N_PROPS,
 
     /* overridden properties */
@@ -162,6 +177,9 @@ static void
 seahorse_pgp_backend_constructed (GObject *obj)
 {
     SeahorsePgpBackend *self = SEAHORSE_PGP_BACKEND (obj);
+#ifdef WITH_KEYSERVER
+    GSettings *app_settings;
+#endif
 
     G_OBJECT_CLASS (seahorse_pgp_backend_parent_class)->constructed (obj);
 
@@ -183,6 +201,14 @@ seahorse_pgp_backend_constructed (GObject *obj)
     on_settings_keyservers_changed (G_SETTINGS (self->pgp_settings),
                                     "keyservers",
                                     self);
+
+    app_settings = G_SETTINGS (seahorse_app_settings_instance ());
+    g_settings_bind (app_settings, "server-search-quorum",
+                     self, "search-quorum", G_SETTINGS_BIND_GET);
+    g_settings_bind (app_settings, "server-search-timeout",
+                     self, "search-timeout", G_SETTINGS_BIND_GET);
+    g_settings_bind (app_settings, "server-search-deadline",
+                     self, "search-deadline", G_SETTINGS_BIND_GET);
 #endif
 }
 
@@ -240,6 +266,15 @@ seahorse_pgp_backend_get_property (GObject *obj,
     case PROP_GPG_HOMEDIR:
         g_value_set_string (value,  seahorse_pgp_backend_get_gpg_homedir (self));
         break;
+    case PROP_SEARCH_QUORUM:
+        g_value_set_uint (value, self->search_quorum);
+        break;
+    case PROP_SEARCH_TIMEOUT:
+        g_value_set_uint (value, self->search_timeout);
+        break;
+    case PROP_SEARCH_DEADLINE:
+        g_value_set_uint (value, self->search_deadline);
+        break;
     case PROP_NAME:
         g_value_set_string (value,  seahorse_pgp_backend_get_name (backend));
         break;
@@ -274,6 +309,15 @@ seahorse_pgp_backend_set_property (GObject      *obj,
         g_free (self->gpg_homedir);
         self->gpg_homedir = g_value_dup_string (value);
         break;
+    case PROP_SEARCH_QUORUM:
+        self->search_quorum = g_value_get_uint (value);
+        break;
+    case PROP_SEARCH_TIMEOUT:
+        self->search_timeout = g_value_get_uint (value);
+        break;
+    case PROP_SEARCH_DEADLINE:
+        self->search_deadline = g_value_get_uint (value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
         break;
@@ -316,6 +360,24 @@ seahorse_pgp_backend_class_init (SeahorsePgpBackendClass *klass)
                              NULL,
                              G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
 
+    obj_props[PROP_SEARCH_QUORUM] =
+        g_param_spec_uint ("search-quorum", "Search quorum",
+                           "How many key servers need to answer a search, or 0 for all of them",
+                           0, G_MAXUINT, 0,
+                           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS);
+
+    obj_props[PROP_SEARCH_TIMEOUT] =
+        g_param_spec_uint ("search-timeout", "Search timeout",
+                           "How many seconds a single key server gets to answer a search, or 0 for no limit",
+                           0, G_MAXUINT, DEFAULT_SEARCH_TIMEOUT,
+                           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS);
+
+    obj_props[PROP_SEARCH_DEADLINE] =
+        g_param_spec_uint ("search-deadline", "Search deadline",
+                           "After how many seconds a search stops waiting for slower key servers, or 0 for no deadline",
+                           0, G_MAXUINT, DEFAULT_SEARCH_DEADLINE,
+                           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS);
+
     g_object_class_install_properties (gobject_class, N_PROPS, obj_props);
 
     /* Overridden properties */
@@ -507,8 +569,18 @@ seahorse_pgp_backend_add_remote (SeahorsePgpBackend   *self,
         ssrc = seahorse_server_category_create_server (uri);
         /* If the scheme of the uri is ldap, but ldap support is disabled
          * in the build, ssrc will be NULL. */
-        if (ssrc)
-            g_list_store_append (G_LIST_STORE (self->remotes), ssrc);
+        if (!ssrc)
+            return;
+
+#ifdef WITH_HKP
+        if (SEAHORSE_IS_HKP_SOURCE (ssrc))
+            g_settings_bind (G_SETTINGS (seahorse_app_settings_instance ()),
+                             "server-search-max-results",
+                             ssrc, "max-results",
+                             G_SETTINGS_BIND_GET);
+#endif
+
+        g_list_store_append (G_LIST_STORE (self->remotes), ssrc);
     }
 }
 
@@ -536,40 +608,20 @@ seahorse_pgp_backend_remove_remote (SeahorsePgpBackend *self,
     seahorse_pgp_settings_remove_keyserver (self->pgp_settings, uri);
 }
 
-typedef struct {
-    int num_searches;
-} search_remote_closure;
-
-static void
-search_remote_closure_free (gpointer user_data)
-{
-    search_remote_closure *closure = user_data;
-    g_free (closure);
-}
-
 static void
-on_source_search_ready (GObject *source,
+on_server_search_ready (GObject      *source,
                         GAsyncResult *result,
-                        gpointer user_data)
+                        void         *user_data)
 {
     g_autoptr(GTask) task = G_TASK (user_data);
-    search_remote_closure *closure = g_task_get_task_data (task);
-    g_autoptr(GError) error = NULL;
-
-    g_return_if_fail (closure->num_searches > 0);
-
-    if (!seahorse_server_source_search_finish (SEAHORSE_SERVER_SOURCE (source),
-                                               result, &error)) {
-        g_task_return_error (task, g_steal_pointer (&error));
-        return;
-    }
-
-    closure->num_searches--;
-    seahorse_progress_end (g_task_get_cancellable (task),
-                           GINT_TO_POINTER (closure->num_searches));
+    GError *error = NULL;
+    gboolean found;
 
-    if (closure->num_searches == 0)
-        g_task_return_boolean (task, TRUE);
+    found = seahorse_server_search_finish (result, &error);
+    if (error != NULL)
+        g_task_return_error (task, error);
+    else
+        g_task_return_boolean (task, found);
 }
 
 void
@@ -580,9 +632,9 @@ seahorse_pgp_backend_search_remote_async (SeahorsePgpBackend *self,
                                           GAsyncReadyCallback callback,
                                           gpointer user_data)
 {
-    search_remote_closure *closure;
     g_autoptr(GTask) task = NULL;
     g_autoptr(GHashTable) servers = NULL;
+    g_autoptr(GPtrArray) sources = NULL;
     g_auto(GStrv) names = NULL;
 
     self = self ? self : seahorse_pgp_backend_get ();
@@ -596,10 +648,7 @@ seahorse_pgp_backend_search_remote_async (SeahorsePgpBackend *self,
             g_hash_table_insert (servers, g_strdup (names[i]), GINT_TO_POINTER (TRUE));
     }
 
-    task = g_task_new (self, cancellable, callback, user_data);
-    closure = g_new0 (search_remote_closure, 1);
-    g_task_set_task_data (task, closure, search_remote_closure_free);
-
+    sources = g_ptr_array_new_with_free_func (g_object_unref);
     for (guint i = 0; i < g_list_model_get_n_items (self->remotes); i++) {
         g_autoptr(SeahorseServerSource) ssrc = NULL;
 
@@ -611,14 +660,17 @@ seahorse_pgp_backend_search_remote_async (SeahorsePgpBackend *self,
                 continue;
         }
 
-        seahorse_progress_prep_and_begin (cancellable, GINT_TO_POINTER (closure->num_searches), NULL);
-        seahorse_server_source_search_async (ssrc, search, results, cancellable,
-                                             on_source_search_ready, g_object_ref (task));
-        closure->num_searches++;
+        g_ptr_array_add (sources, g_steal_pointer (&ssrc));
     }
 
-    if (closure->num_searches == 0)
-        g_task_return_boolean (task, FALSE);
+    task = g_task_new (self, cancellable, callback, user_data);
+    seahorse_server_search_async (sources, search, results,
+                                  self->search_quorum,
+                                  self->search_timeout,
+                                  self->search_deadline,
+                                  cancellable,
+                                  on_server_search_ready,
+                                  g_steal_pointer (&task));
 }
 
 gboolean
@@ -34,7 +34,6 @@
 #include "seahorse-gpgme-revoke-dialog.h"
 #include "seahorse-gpgme-sign-dialog.h"
 #include "seahorse-pgp-backend.h"
-#include "seahorse-gpg-op.h"
 #include "seahorse-pgp-dialogs.h"
 #include "seahorse-pgp-key.h"
 #include "seahorse-pgp-uid.h"
@@ -190,6 +189,22 @@ on_photos_add (GSimpleAction *action, GVariant *param, void *user_data)
         g_object_set_data (G_OBJECT (self), "current-photoid", NULL);
 }
 
+static void
+on_photo_deleted (GObject *source, GAsyncResult *result, void *user_data)
+{
+    g_autoptr(SeahorsePgpKeyProperties) self = SEAHORSE_PGP_KEY_PROPERTIES (user_data);
+    g_autoptr(GError) error = NULL;
+
+    if (!seahorse_gpgme_key_op_photo_delete_finish (SEAHORSE_GPGME_PHOTO (source),
+                                                    result, &error)) {
+        seahorse_util_handle_error (&error, self, _("Couldn’t delete photo"));
+        return;
+    }
+
+    if (g_object_get_data (G_OBJECT (self), "current-photoid") == source)
+        g_object_set_data (G_OBJECT (self), "current-photoid", NULL);
+}
+
 static void
 on_photos_delete (GSimpleAction *action, GVariant *param, void *user_data)
 {
@@ -199,23 +214,32 @@ on_photos_delete (GSimpleAction *action, GVariant *param, void *user_data)
     photo = g_object_get_data (G_OBJECT (self), "current-photoid");
     g_return_if_fail (SEAHORSE_IS_GPGME_PHOTO (photo));
 
-    if (seahorse_gpgme_key_op_photo_delete (photo))
-        g_object_set_data (G_OBJECT (self), "current-photoid", NULL);
+    seahorse_gpgme_key_op_photo_delete_async (photo, NULL, on_photo_deleted,
+                                              g_object_ref (self));
+}
+
+static void
+on_photo_made_primary (GObject *source, GAsyncResult *result, void *user_data)
+{
+    g_autoptr(SeahorsePgpKeyProperties) self = SEAHORSE_PGP_KEY_PROPERTIES (user_data);
+    g_autoptr(GError) error = NULL;
+
+    if (!seahorse_gpgme_key_op_photo_primary_finish (SEAHORSE_GPGME_PHOTO (source),
+                                                     result, &error))
+        seahorse_util_handle_error (&error, self, _("Couldn’t change primary photo"));
 }
 
 static void
 on_photos_make_primary (GSimpleAction *action, GVariant *param, void *user_data)
 {
     SeahorsePgpKeyProperties *self = SEAHORSE_PGP_KEY_PROPERTIES (user_data);
-    gpgme_error_t gerr;
     SeahorseGpgmePhoto *photo;
 
     photo = g_object_get_data (G_OBJECT (self), "current-photoid");
     g_return_if_fail (SEAHORSE_IS_GPGME_PHOTO (photo));
 
-    gerr = seahorse_gpgme_key_op_photo_primary (photo);
-    if (!GPG_IS_OK (gerr))
-        seahorse_gpgme_handle_error (gerr, _("Couldn’t change primary photo"));
+    seahorse_gpgme_key_op_photo_primary_async (photo, NULL, on_photo_made_primary,
+                                               g_object_ref (self));
 }
 
 static void
@@ -581,6 +605,17 @@ on_subkeys_add (GSimpleAction *action, GVariant *param, void *user_data)
     gtk_widget_destroy (GTK_WIDGET (dialog));
 }
 
+static void
+on_trust_changed (GObject *source, GAsyncResult *result, void *user_data)
+{
+    g_autoptr(SeahorsePgpKeyProperties) self = SEAHORSE_PGP_KEY_PROPERTIES (user_data);
+    g_autoptr(GError) error = NULL;
+
+    if (!seahorse_gpgme_key_op_set_trust_finish (SEAHORSE_GPGME_KEY (source),
+                                                 result, &error))
+        seahorse_util_handle_error (&error, self, _("Unable to change trust"));
+}
+
 static void
 on_pgp_details_trust_changed (GtkComboBox *selection, void *user_data)
 {
@@ -598,12 +633,10 @@ on_pgp_details_trust_changed (GtkComboBox *selection, void *user_data)
     gtk_tree_model_get (model, &iter, TRUST_VALIDITY, &trust, -1);
 
     if (seahorse_pgp_key_get_trust (self->key) != trust) {
-        gpgme_error_t err;
-
-        err = seahorse_gpgme_key_op_set_trust (SEAHORSE_GPGME_KEY (self->key),
-                                               trust);
-        if (err)
-            seahorse_gpgme_handle_error (err, _("Unable to change trust"));
+        seahorse_gpgme_key_op_set_trust_async (SEAHORSE_GPGME_KEY (self->key),
+                                               trust, NULL,
+                                               on_trust_changed,
+                                               g_object_ref (self));
     }
 }
 
@@ -767,7 +800,6 @@ on_trust_marginal_changed (GSimpleAction *action,
 {
     SeahorsePgpKeyProperties *self = SEAHORSE_PGP_KEY_PROPERTIES (user_data);
     SeahorseValidity trust;
-    gpgme_error_t err;
 
     g_return_if_fail (SEAHORSE_GPGME_IS_KEY (self->key));
 
@@ -776,9 +808,10 @@ on_trust_marginal_changed (GSimpleAction *action,
     g_simple_action_set_state (action, new_state);
 
     if (seahorse_pgp_key_get_trust (self->key) != trust) {
-        err = seahorse_gpgme_key_op_set_trust (SEAHORSE_GPGME_KEY (self->key), trust);
-        if (err)
-            seahorse_gpgme_handle_error (err, _("Unable to change trust"));
+        seahorse_gpgme_key_op_set_trust_async (SEAHORSE_GPGME_KEY (self->key),
+                                               trust, NULL,
+                                               on_trust_changed,
+                                               g_object_ref (self));
     }
 }
 
@@ -1144,10 +1177,12 @@ seahorse_pgp_key_properties_new (SeahorsePgpKey *pkey, GtkWindow *parent)
 {
     g_autoptr(SeahorsePgpKeyProperties) dialog = NULL;
 
-    /* This causes the key source to get any specific info about the key */
+    /* This causes the key source to get any specific info about the key.
+     * The dialog follows along through property notifications. */
     if (SEAHORSE_GPGME_IS_KEY (pkey)) {
-        seahorse_gpgme_key_refresh (SEAHORSE_GPGME_KEY (pkey));
-        seahorse_gpgme_key_ensure_signatures (SEAHORSE_GPGME_KEY (pkey));
+        seahorse_gpgme_key_refresh_async (SEAHORSE_GPGME_KEY (pkey),
+                                          GPGME_KEYLIST_MODE_LOCAL | GPGME_KEYLIST_MODE_SIGS,
+                                          NULL, NULL, NULL);
     }
 
     dialog = g_object_new (SEAHORSE_PGP_TYPE_KEY_PROPERTIES,
@@ -0,0 +1,612 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "seahorse-pgp-packet.h"
+
+#include <gio/gio.h>
+
+/* RFC 4880, section 4.3 */
+#define PACKET_TAG_SIGNATURE        2
+#define PACKET_TAG_SECRET_KEY       5
+#define PACKET_TAG_PUBLIC_KEY       6
+#define PACKET_TAG_USER_ID          13
+#define PACKET_TAG_USER_ATTRIBUTE   17
+
+/* RFC 4880, section 5.12.1 */
+#define SUBPACKET_TYPE_IMAGE        1
+#define IMAGE_HEADER_VERSION        1
+
+typedef struct {
+    const guint8 *data;
+    gsize len;
+    gsize pos;
+} PacketReader;
+
+static gsize
+reader_remaining (PacketReader *reader)
+{
+    return reader->len - reader->pos;
+}
+
+static guint32
+reader_read_be32 (PacketReader *reader)
+{
+    const guint8 *p = reader->data + reader->pos;
+
+    reader->pos += 4;
+    return ((guint32) p[0] << 24) | ((guint32) p[1] << 16) |
+           ((guint32) p[2] << 8) | (guint32) p[3];
+}
+
+/* Reads a new format length. Packets and subpackets use the same encoding,
+ * except that packets can also have partial lengths, which we don't support
+ * since they can't appear in a keyblock. */
+static gboolean
+reader_read_length (PacketReader *reader,
+                    gboolean      is_packet,
+                    gsize        *length)
+{
+    guint8 first;
+
+    if (reader_remaining (reader) < 1)
+        return FALSE;
+
+    first = reader->data[reader->pos++];
+    if (first < 192) {
+        *length = first;
+    } else if (first == 255) {
+        if (reader_remaining (reader) < 4)
+            return FALSE;
+        *length = reader_read_be32 (reader);
+    } else if (first < 224 || !is_packet) {
+        if (reader_remaining (reader) < 1)
+            return FALSE;
+        *length = ((first - 192) << 8) + reader->data[reader->pos++] + 192;
+    } else {
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+typedef enum {
+    PACKET_OK,
+    PACKET_INCOMPLETE,          /* Could still be fine with more data */
+    PACKET_BAD_HEADER,
+    PACKET_UNSUPPORTED,
+} PacketStatus;
+
+/* Reads the next packet, or leaves @reader where it was if it can't. The
+ * data only runs up to the end of @reader if @at_end is set. */
+static PacketStatus
+reader_next_packet (PacketReader  *reader,
+                    gboolean       at_end,
+                    unsigned int  *tag,
+                    const guint8 **body,
+                    gsize         *body_len)
+{
+    gsize offset = reader->pos;
+    PacketStatus status = PACKET_INCOMPLETE;
+    gsize length = 0;
+    guint8 ctb;
+
+    if (reader_remaining (reader) < 1)
+        return PACKET_INCOMPLETE;
+
+    ctb = reader->data[reader->pos++];
+    if (!(ctb & 0x80)) {
+        status = PACKET_BAD_HEADER;
+        goto invalid;
+    }
+
+    if (ctb & 0x40) {
+        *tag = ctb & 0x3f;
+
+        /* Partial lengths can't appear in a keyblock */
+        if (reader_remaining (reader) >= 1 &&
+            reader->data[reader->pos] >= 224 && reader->data[reader->pos] < 255) {
+            status = PACKET_UNSUPPORTED;
+            goto invalid;
+        }
+        if (!reader_read_length (reader, TRUE, &length))
+            goto invalid;
+    } else {
+        *tag = (ctb >> 2) & 0x0f;
+        switch (ctb & 0x03) {
+        case 0:
+            if (reader_remaining (reader) < 1)
+                goto invalid;
+            length = reader->data[reader->pos++];
+            break;
+        case 1:
+            if (reader_remaining (reader) < 2)
+                goto invalid;
+            length = (reader->data[reader->pos] << 8) | reader->data[reader->pos + 1];
+            reader->pos += 2;
+            break;
+        case 2:
+            if (reader_remaining (reader) < 4)
+                goto invalid;
+            length = reader_read_be32 (reader);
+            break;
+        case 3:
+            /* Indeterminate length, runs until the end of the data */
+            if (!at_end)
+                goto invalid;
+            length = reader_remaining (reader);
+            break;
+        }
+    }
+
+    if (length > reader_remaining (reader))
+        goto invalid;
+
+    *body = reader->data + reader->pos;
+    *body_len = length;
+    reader->pos += length;
+    return PACKET_OK;
+
+invalid:
+    reader->pos = offset;
+    return status;
+}
+
+static gboolean
+reader_read_packet (PacketReader  *reader,
+                    unsigned int  *tag,
+                    const guint8 **body,
+                    gsize         *body_len,
+                    GError       **error)
+{
+    gsize offset = reader->pos;
+
+    switch (reader_next_packet (reader, TRUE, tag, body, body_len)) {
+    case PACKET_OK:
+        return TRUE;
+    case PACKET_BAD_HEADER:
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                     "Invalid OpenPGP packet header at offset %" G_GSIZE_FORMAT,
+                     offset);
+        return FALSE;
+    default:
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                     "Truncated or unsupported OpenPGP packet at offset %" G_GSIZE_FORMAT,
+                     offset);
+        return FALSE;
+    }
+}
+
+/* Returns the first image in a user attribute packet, as a slice of the
+ * keyblock so we don't copy it. Attributes we don't understand are skipped,
+ * gpg still counts them as a user ID though. */
+static GBytes *
+find_attribute_image (GBytes       *keyblock,
+                      const guint8 *body,
+                      gsize         body_len)
+{
+    const guint8 *base = g_bytes_get_data (keyblock, NULL);
+    PacketReader reader = { body, body_len, 0 };
+
+    while (reader_remaining (&reader) > 0) {
+        const guint8 *sub;
+        gsize sub_len;
+        gsize header_len;
+        guint8 type;
+
+        if (!reader_read_length (&reader, FALSE, &sub_len) ||
+            sub_len == 0 || sub_len > reader_remaining (&reader))
+            return NULL;
+
+        type = reader.data[reader.pos];
+        sub = reader.data + reader.pos + 1;
+        sub_len -= 1;
+        reader.pos += sub_len + 1;
+
+        if (type != SUBPACKET_TYPE_IMAGE || sub_len < 3)
+            continue;
+
+        /* The image header length is little endian, for historical reasons */
+        header_len = sub[0] | (sub[1] << 8);
+        if (sub[2] != IMAGE_HEADER_VERSION || header_len < 3 || header_len > sub_len)
+            continue;
+
+        return g_bytes_new_from_bytes (keyblock, (sub + header_len) - base,
+                                       sub_len - header_len);
+    }
+
+    return NULL;
+}
+
+/* RFC 4880, section 12.2 for v4 keys, RFC 9580 for v5 and v6 keys */
+static char *
+calculate_fingerprint (const guint8 *body,
+                       gsize         body_len)
+{
+    g_autoptr(GChecksum) checksum = NULL;
+    guint8 header[5];
+    guint8 digest[32];
+    gsize digest_len = sizeof (digest);
+    GString *fingerprint;
+
+    if (body_len < 1)
+        return NULL;
+
+    switch (body[0]) {
+    case 4:
+        if (body_len > G_MAXUINT16)
+            return NULL;
+        header[0] = 0x99;
+        header[1] = body_len >> 8;
+        header[2] = body_len & 0xff;
+        checksum = g_checksum_new (G_CHECKSUM_SHA1);
+        g_checksum_update (checksum, header, 3);
+        break;
+    case 5:
+    case 6:
+        if (body_len > G_MAXUINT32)
+            return NULL;
+        header[0] = body[0] == 5 ? 0x9a : 0x9b;
+        header[1] = (body_len >> 24) & 0xff;
+        header[2] = (body_len >> 16) & 0xff;
+        header[3] = (body_len >> 8) & 0xff;
+        header[4] = body_len & 0xff;
+        checksum = g_checksum_new (G_CHECKSUM_SHA256);
+        g_checksum_update (checksum, header, 5);
+        break;
+    default:
+        return NULL;
+    }
+
+    g_checksum_update (checksum, body, body_len);
+    g_checksum_get_digest (checksum, digest, &digest_len);
+
+    fingerprint = g_string_sized_new (digest_len * 2);
+    for (gsize i = 0; i < digest_len; i++)
+        g_string_append_printf (fingerprint, "%02X", digest[i]);
+    return g_string_free (fingerprint, FALSE);
+}
+
+void
+seahorse_pgp_photo_packet_free (SeahorsePgpPhotoPacket *packet)
+{
+    if (packet == NULL)
+        return;
+
+    g_free (packet->fingerprint);
+    g_bytes_unref (packet->image);
+    g_free (packet);
+}
+
+static GPtrArray *
+parse_photos (GBytes   *keyblock,
+              gboolean  all_keys,
+              GError  **error)
+{
+    g_autoptr(GPtrArray) photos = NULL;
+    g_autofree char *fingerprint = NULL;
+    const guint8 *key_body = NULL;
+    gsize key_len = 0;
+    PacketReader reader;
+    unsigned int uid_index = 0;
+
+    reader.data = g_bytes_get_data (keyblock, &reader.len);
+    reader.pos = 0;
+
+    photos = g_ptr_array_new_with_free_func ((GDestroyNotify) seahorse_pgp_photo_packet_free);
+
+    while (reader_remaining (&reader) > 0) {
+        const guint8 *body;
+        gsize body_len;
+        unsigned int tag;
+
+        if (!reader_read_packet (&reader, &tag, &body, &body_len, error))
+            return NULL;
+
+        switch (tag) {
+        case PACKET_TAG_PUBLIC_KEY:
+        case PACKET_TAG_SECRET_KEY:
+            if (key_body != NULL && !all_keys)
+                return g_steal_pointer (&photos);
+
+            /* The fingerprint is only calculated once we find a photo */
+            key_body = tag == PACKET_TAG_PUBLIC_KEY ? body : NULL;
+            key_len = body_len;
+            g_clear_pointer (&fingerprint, g_free);
+            uid_index = 0;
+            break;
+
+        case PACKET_TAG_USER_ID:
+            uid_index++;
+            break;
+
+        case PACKET_TAG_USER_ATTRIBUTE: {
+            SeahorsePgpPhotoPacket *photo;
+            GBytes *image;
+
+            uid_index++;
+            image = find_attribute_image (keyblock, body, body_len);
+            if (image == NULL)
+                break;
+
+            if (fingerprint == NULL && key_body != NULL)
+                fingerprint = calculate_fingerprint (key_body, key_len);
+
+            photo = g_new0 (SeahorsePgpPhotoPacket, 1);
+            photo->fingerprint = g_strdup (fingerprint);
+            photo->uid_index = uid_index;
+            photo->image = image;
+            g_ptr_array_add (photos, photo);
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    return g_steal_pointer (&photos);
+}
+
+/**
+ * seahorse_pgp_packet_parse_photos:
+ * @keyblock: An unarmored OpenPGP keyblock, as exported by GPGME
+ * @error: Error location
+ *
+ * Finds the photo IDs of the first key in @keyblock. Any keys after that
+ * are ignored.
+ *
+ * Returns: (transfer full) (element-type SeahorsePgpPhotoPacket): The photos,
+ *   in the order they appear in the key
+ */
+GPtrArray *
+seahorse_pgp_packet_parse_photos (GBytes  *keyblock,
+                                  GError **error)
+{
+    g_return_val_if_fail (keyblock != NULL, NULL);
+    g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+    return parse_photos (keyblock, FALSE, error);
+}
+
+/**
+ * seahorse_pgp_packet_parse_keyring_photos:
+ * @keyring: Several unarmored OpenPGP keyblocks, one after the other
+ * @error: Error location
+ *
+ * Finds the photo IDs of all the keys in @keyring. Use the fingerprint of
+ * each photo to tell which key it belongs to, since gpg doesn't necessarily
+ * export the keys in the order they were asked for.
+ *
+ * Returns: (transfer full) (element-type SeahorsePgpPhotoPacket): The photos
+ */
+GPtrArray *
+seahorse_pgp_packet_parse_keyring_photos (GBytes  *keyring,
+                                          GError **error)
+{
+    g_return_val_if_fail (keyring != NULL, NULL);
+    g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+    return parse_photos (keyring, TRUE, error);
+}
+
+void
+seahorse_pgp_keyblock_free (SeahorsePgpKeyblock *keyblock)
+{
+    if (keyblock == NULL)
+        return;
+
+    g_free (keyblock->fingerprint);
+    g_free (keyblock->signatures);
+    g_bytes_unref (keyblock->packets);
+    g_free (keyblock);
+}
+
+/*
+ * Splits a stream of keyblocks as it is read. Only the keyblock we're in
+ * the middle of is kept around.
+ */
+struct _SeahorsePgpKeyblockSplitter {
+    GByteArray *pending;                /* The current keyblock, then a partial packet */
+    gsize scanned;                      /* How much of pending is whole packets */
+    SeahorsePgpKeyblock *current;       /* Gets its packets once it's done */
+    GChecksum *signatures;              /* Of the current keyblock */
+    gboolean invalid;                   /* Gave up on splitting */
+};
+
+/**
+ * seahorse_pgp_keyblock_splitter_new:
+ *
+ * Creates a splitter for unarmored OpenPGP keyblocks, one after the other.
+ * Each keyblock comes with what's needed to tell whether we've seen a key
+ * before: its fingerprint, and a digest of all its signatures.
+ *
+ * Anything before the first key (eg: a revocation certificate) is a
+ * keyblock of its own, without a fingerprint. So is anything from where
+ * the data stops making sense, so nothing gets lost.
+ *
+ * Returns: (transfer full): The new splitter
+ */
+SeahorsePgpKeyblockSplitter *
+seahorse_pgp_keyblock_splitter_new (void)
+{
+    SeahorsePgpKeyblockSplitter *splitter;
+
+    splitter = g_new0 (SeahorsePgpKeyblockSplitter, 1);
+    splitter->pending = g_byte_array_new ();
+    splitter->signatures = g_checksum_new (G_CHECKSUM_SHA256);
+    return splitter;
+}
+
+void
+seahorse_pgp_keyblock_splitter_free (SeahorsePgpKeyblockSplitter *splitter)
+{
+    if (splitter == NULL)
+        return;
+
+    g_byte_array_unref (splitter->pending);
+    g_checksum_free (splitter->signatures);
+    seahorse_pgp_keyblock_free (splitter->current);
+    g_free (splitter);
+}
+
+static void
+splitter_start_keyblock (SeahorsePgpKeyblockSplitter *splitter)
+{
+    splitter->current = g_new0 (SeahorsePgpKeyblock, 1);
+    g_checksum_reset (splitter->signatures);
+}
+
+/* Finishes the current keyblock with @len bytes of pending from @start */
+static SeahorsePgpKeyblock *
+splitter_take_keyblock (SeahorsePgpKeyblockSplitter *splitter,
+                        gsize                        start,
+                        gsize                        len)
+{
+    SeahorsePgpKeyblock *keyblock = g_steal_pointer (&splitter->current);
+
+    keyblock->signatures = g_strdup (g_checksum_get_string (splitter->signatures));
+    keyblock->packets = g_bytes_new (splitter->pending->data + start, len);
+    return keyblock;
+}
+
+static void
+splitter_scan (SeahorsePgpKeyblockSplitter *splitter,
+               gboolean                     at_end,
+               GPtrArray                   *keyblocks)
+{
+    PacketReader reader;
+    gsize start = 0;
+
+    reader.data = splitter->pending->data;
+    reader.len = splitter->pending->len;
+    reader.pos = splitter->scanned;
+
+    while (!splitter->invalid && reader_remaining (&reader) > 0) {
+        gsize offset = reader.pos;
+        PacketStatus status;
+        const guint8 *body;
+        gsize body_len;
+        unsigned int tag;
+        gboolean is_key;
+
+        status = reader_next_packet (&reader, at_end, &tag, &body, &body_len);
+        if (status == PACKET_INCOMPLETE && !at_end)
+            break;
+        if (status != PACKET_OK) {
+            splitter->invalid = TRUE;
+            break;
+        }
+
+        is_key = tag == PACKET_TAG_PUBLIC_KEY || tag == PACKET_TAG_SECRET_KEY;
+        if (splitter->current == NULL || is_key) {
+            if (splitter->current != NULL)
+                g_ptr_array_add (keyblocks, splitter_take_keyblock (splitter, start,
+                                                                    offset - start));
+            splitter_start_keyblock (splitter);
+            start = offset;
+        }
+
+        switch (tag) {
+        case PACKET_TAG_PUBLIC_KEY:
+        case PACKET_TAG_SECRET_KEY:
+            splitter->current->secret = tag == PACKET_TAG_SECRET_KEY;
+            if (!splitter->current->secret)
+                splitter->current->fingerprint = calculate_fingerprint (body, body_len);
+            break;
+
+        /* The whole packet, since any change to a signature matters */
+        case PACKET_TAG_SIGNATURE:
+            g_checksum_update (splitter->signatures, reader.data + offset,
+                               reader.pos - offset);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    /* Pass on the rest as it is, and leave it to gpg to make sense of */
+    if (splitter->invalid) {
+        if (reader.len > start) {
+            if (splitter->current == NULL)
+                splitter_start_keyblock (splitter);
+            g_clear_pointer (&splitter->current->fingerprint, g_free);
+            g_ptr_array_add (keyblocks, splitter_take_keyblock (splitter, start,
+                                                                reader.len - start));
+        }
+        g_clear_pointer (&splitter->current, seahorse_pgp_keyblock_free);
+        g_byte_array_set_size (splitter->pending, 0);
+        splitter->scanned = 0;
+        return;
+    }
+
+    /* Only keep the keyblock that isn't done yet */
+    g_byte_array_remove_range (splitter->pending, 0, start);
+    splitter->scanned = reader.pos - start;
+}
+
+/**
+ * seahorse_pgp_keyblock_splitter_feed:
+ * @splitter: The splitter
+ * @data: The next piece of data
+ * @len: The length of @data
+ * @keyblocks: (element-type SeahorsePgpKeyblock): Where the keyblocks that
+ *   are done are added, in the order they appear in
+ *
+ * Splits what it can of @data. Packets can be cut off anywhere between
+ * calls, the last keyblock is only done once seahorse_pgp_keyblock_splitter_finish()
+ * is called.
+ */
+void
+seahorse_pgp_keyblock_splitter_feed (SeahorsePgpKeyblockSplitter *splitter,
+                                     const guint8                *data,
+                                     gsize                        len,
+                                     GPtrArray                   *keyblocks)
+{
+    g_return_if_fail (splitter != NULL);
+    g_return_if_fail (keyblocks != NULL);
+
+    g_byte_array_append (splitter->pending, data, len);
+    splitter_scan (splitter, FALSE, keyblocks);
+}
+
+/**
+ * seahorse_pgp_keyblock_splitter_finish:
+ * @splitter: The splitter
+ * @keyblocks: (element-type SeahorsePgpKeyblock): Where the last keyblocks
+ *   are added
+ *
+ * Splits what was left over, once all the data was fed.
+ */
+void
+seahorse_pgp_keyblock_splitter_finish (SeahorsePgpKeyblockSplitter *splitter,
+                                       GPtrArray                   *keyblocks)
+{
+    g_return_if_fail (splitter != NULL);
+    g_return_if_fail (keyblocks != NULL);
+
+    splitter_scan (splitter, TRUE, keyblocks);
+    if (splitter->current != NULL)
+        g_ptr_array_add (keyblocks, splitter_take_keyblock (splitter, 0,
+                                                            splitter->pending->len));
+    g_byte_array_set_size (splitter->pending, 0);
+    splitter->scanned = 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * A minimal reader for binary (unarmored) OpenPGP keyblocks, as described in
+ * RFC 4880. It only knows enough to find the photo IDs of a key, which lets
+ * us load them from an in-memory export instead of going through gpg's
+ * "showphoto" command, and to tell the keys in an import apart.
+ */
+
+#pragma once
+
+#include <glib.h>
+
+typedef struct _SeahorsePgpPhotoPacket {
+    /* Fingerprint of the key the photo belongs to, in uppercase hex like
+     * GPGME has it. NULL when we can't calculate it (eg: for v3 keys). */
+    char *fingerprint;
+
+    /* Index of the user ID or attribute in the key, as used by gpg --edit-key.
+     * Starts at 1 and counts both user IDs and user attributes. */
+    unsigned int uid_index;
+
+    /* The raw image (usually a JPEG) */
+    GBytes *image;
+} SeahorsePgpPhotoPacket;
+
+typedef struct _SeahorsePgpKeyblock {
+    /* Fingerprint of the primary key, in uppercase hex like GPGME has it.
+     * NULL for secret keys, for packets before the first key, or when we
+     * can't calculate it. */
+    char *fingerprint;
+
+    /* SHA-256 of all the signature packets in the keyblock, in order, as
+     * hex. Any added, removed or changed signature changes it. */
+    char *signatures;
+
+    gboolean secret;
+
+    /* All the packets of the key */
+    GBytes *packets;
+} SeahorsePgpKeyblock;
+
+typedef struct _SeahorsePgpKeyblockSplitter SeahorsePgpKeyblockSplitter;
+
+void         seahorse_pgp_photo_packet_free      (SeahorsePgpPhotoPacket *packet);
+
+void         seahorse_pgp_keyblock_free          (SeahorsePgpKeyblock *keyblock);
+
+GPtrArray *  seahorse_pgp_packet_parse_photos    (GBytes  *keyblock,
+                                                  GError **error);
+
+GPtrArray *  seahorse_pgp_packet_parse_keyring_photos (GBytes  *keyring,
+                                                       GError **error);
+
+SeahorsePgpKeyblockSplitter * seahorse_pgp_keyblock_splitter_new    (void);
+
+void         seahorse_pgp_keyblock_splitter_free   (SeahorsePgpKeyblockSplitter *splitter);
+
+void         seahorse_pgp_keyblock_splitter_feed   (SeahorsePgpKeyblockSplitter *splitter,
+                                                    const guint8                *data,
+                                                    gsize                        len,
+                                                    GPtrArray                   *keyblocks);
+
+void         seahorse_pgp_keyblock_splitter_finish (SeahorsePgpKeyblockSplitter *splitter,
+                                                    GPtrArray                   *keyblocks);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (SeahorsePgpPhotoPacket, seahorse_pgp_photo_packet_free)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (SeahorsePgpKeyblock, seahorse_pgp_keyblock_free)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (SeahorsePgpKeyblockSplitter, seahorse_pgp_keyblock_splitter_free)
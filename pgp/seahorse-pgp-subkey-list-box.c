@@ -189,13 +189,22 @@ get_toplevel_window (SeahorsePgpSubkeyListBoxRow *row)
     return NULL;
 }
 
+static void
+on_subkey_deleted (GObject *source, GAsyncResult *res, void *user_data)
+{
+    GtkWindow *toplevel = GTK_WINDOW (user_data);
+    g_autoptr(GError) error = NULL;
+
+    if (!seahorse_gpgme_key_op_del_subkey_finish (SEAHORSE_GPGME_SUBKEY (source), res, &error))
+        seahorse_util_handle_error (&error, toplevel, _("Couldn’t delete subkey"));
+}
+
 static void
 on_subkey_delete (GSimpleAction *action, GVariant *param, void *user_data)
 {
     SeahorsePgpSubkeyListBoxRow *row = SEAHORSE_PGP_SUBKEY_LIST_BOX_ROW (user_data);
     const char *fingerprint;
     g_autofree char *message = NULL;
-    gpgme_error_t err;
 
     g_return_if_fail (SEAHORSE_GPGME_IS_SUBKEY (row->subkey));
 
@@ -205,9 +214,11 @@ on_subkey_delete (GSimpleAction *action, GVariant *param, void *user_data)
     if (!seahorse_delete_dialog_prompt (get_toplevel_window (row), message))
         return;
 
-    err = seahorse_gpgme_key_op_del_subkey (SEAHORSE_GPGME_SUBKEY (row->subkey));
-    if (!GPG_IS_OK (err))
-        seahorse_gpgme_handle_error (err, _("Couldn’t delete subkey"));
+    /* The row goes away with the subkey, so don't pass it along */
+    seahorse_gpgme_key_op_del_subkey_async (SEAHORSE_GPGME_SUBKEY (row->subkey),
+                                            NULL,
+                                            on_subkey_deleted,
+                                            get_toplevel_window (row));
 }
 
 static void
@@ -246,13 +246,22 @@ on_only_trusted_changed (GSimpleAction *action,
     gtk_widget_set_visible (row->signatures_list, n_shown > 0);
 }
 
+static void
+on_uid_deleted (GObject *source, GAsyncResult *res, void *user_data)
+{
+    GtkWidget *toplevel = GTK_WIDGET (user_data);
+    g_autoptr(GError) error = NULL;
+
+    if (!seahorse_gpgme_key_op_del_uid_finish (SEAHORSE_GPGME_UID (source), res, &error))
+        seahorse_util_handle_error (&error, toplevel, _("Couldn’t delete user ID"));
+}
+
 static void
 on_uid_delete (GSimpleAction *action, GVariant *param, void *user_data)
 {
     SeahorsePgpUidListBoxRow *row = SEAHORSE_PGP_UID_LIST_BOX_ROW (user_data);
     GtkWidget *window;
     g_autofree char *message = NULL;
-    gpgme_error_t gerr;
 
     g_return_if_fail (SEAHORSE_GPGME_IS_UID (row->uid));
 
@@ -263,9 +272,11 @@ on_uid_delete (GSimpleAction *action, GVariant *param, void *user_data)
     if (!seahorse_delete_dialog_prompt (GTK_WINDOW (window), message))
         return;
 
-    gerr = seahorse_gpgme_key_op_del_uid (SEAHORSE_GPGME_UID (row->uid));
-    if (!GPG_IS_OK (gerr))
-        seahorse_gpgme_handle_error (gerr, _("Couldn’t delete user ID"));
+    /* The row goes away with the user ID, so don't pass it along */
+    seahorse_gpgme_key_op_del_uid_async (SEAHORSE_GPGME_UID (row->uid),
+                                         NULL,
+                                         on_uid_deleted,
+                                         window);
 }
 
 static void
@@ -0,0 +1,392 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "seahorse-server-search.h"
+
+#include "seahorse-pgp-key.h"
+
+#include "seahorse-common.h"
+
+#include "libseahorse/seahorse-progress.h"
+
+#include <glib/gi18n.h>
+
+#include <string.h>
+
+typedef struct {
+    GTask *task;                        /* Only while the search is running */
+    SeahorseServerSource *source;
+    GCancellable *cancellable;
+    GcrSimpleCollection *results;       /* What this server found */
+    gulong added_sig;
+    guint timeout_id;
+    gboolean timed_out;
+    gboolean done;
+} server_search;
+
+typedef struct {
+    GCancellable *cancellable;          /* The caller's */
+    gulong cancelled_sig;
+    GcrSimpleCollection *results;
+    GHashTable *seen;                   /* Merged keys, by fingerprint */
+    GPtrArray *servers;                 /* server_search */
+    guint deadline_id;
+    gboolean deadline_passed;
+    gboolean returned;
+    unsigned int quorum;
+    unsigned int pending;
+    unsigned int succeeded;
+    unsigned int failed;
+    GError *error;                      /* Why the first server failed */
+} search_remote_closure;
+
+static void
+server_search_free (server_search *server)
+{
+    if (server->added_sig)
+        g_signal_handler_disconnect (server->results, server->added_sig);
+    if (server->timeout_id)
+        g_source_remove (server->timeout_id);
+    g_clear_object (&server->task);
+    g_clear_object (&server->source);
+    g_clear_object (&server->cancellable);
+    g_clear_object (&server->results);
+    g_free (server);
+}
+
+static void
+search_remote_closure_free (gpointer user_data)
+{
+    search_remote_closure *closure = user_data;
+
+    if (closure->cancelled_sig)
+        g_cancellable_disconnect (closure->cancellable, closure->cancelled_sig);
+    if (closure->deadline_id)
+        g_source_remove (closure->deadline_id);
+    g_clear_object (&closure->cancellable);
+    g_clear_object (&closure->results);
+    g_clear_pointer (&closure->seen, g_hash_table_unref);
+    g_clear_pointer (&closure->servers, g_ptr_array_unref);
+    g_clear_error (&closure->error);
+    g_free (closure);
+}
+
+/* The fingerprint if the server sent one, otherwise the key ID */
+static char *
+get_merge_id (SeahorsePgpKey *key)
+{
+    const char *fingerprint = seahorse_pgp_key_get_fingerprint (key);
+    GString *id;
+
+    if (fingerprint == NULL || !fingerprint[0])
+        return g_ascii_strup (seahorse_pgp_key_get_keyid (key), -1);
+
+    id = g_string_sized_new (strlen (fingerprint));
+    for (const char *c = fingerprint; *c; c++) {
+        if (!g_ascii_isspace (*c))
+            g_string_append_c (id, g_ascii_toupper (*c));
+    }
+    return g_string_free (id, FALSE);
+}
+
+static void
+on_server_result_added (GcrCollection *collection,
+                        GObject       *object,
+                        gpointer       user_data)
+{
+    search_remote_closure *closure = user_data;
+    g_autofree char *id = NULL;
+
+    if (!SEAHORSE_PGP_IS_KEY (object)) {
+        gcr_simple_collection_add (closure->results, object);
+        return;
+    }
+
+    /* The first server to find a key wins */
+    id = get_merge_id (SEAHORSE_PGP_KEY (object));
+    if (g_hash_table_contains (closure->seen, id))
+        return;
+
+    g_hash_table_add (closure->seen, g_steal_pointer (&id));
+    gcr_simple_collection_add (closure->results, object);
+}
+
+/* Stops listening to a server, whether it answered or not */
+static void
+server_search_done (GTask         *task,
+                    server_search *server)
+{
+    server->done = TRUE;
+    g_clear_handle_id (&server->timeout_id, g_source_remove);
+    g_clear_signal_handler (&server->added_sig, server->results);
+    seahorse_progress_end (g_task_get_cancellable (task), server);
+}
+
+static void
+search_remote_complete (GTask *task)
+{
+    search_remote_closure *closure = g_task_get_task_data (task);
+    unsigned int dropped = 0;
+    GError *error = NULL;
+
+    closure->returned = TRUE;
+    g_clear_handle_id (&closure->deadline_id, g_source_remove);
+
+    /* Don't wait for the stragglers */
+    for (guint i = 0; i < closure->servers->len; i++) {
+        server_search *server = g_ptr_array_index (closure->servers, i);
+
+        if (server->done)
+            continue;
+
+        server_search_done (task, server);
+        g_cancellable_cancel (server->cancellable);
+        dropped++;
+    }
+
+    if (dropped > 0)
+        g_message ("Stopped waiting for %u slower key servers", dropped);
+
+    if (g_cancellable_set_error_if_cancelled (closure->cancellable, &error)) {
+        g_task_return_error (task, error);
+        return;
+    }
+
+    /* Some results are better than none */
+    if (closure->succeeded == 0) {
+        if (closure->error != NULL)
+            g_task_return_error (task, g_steal_pointer (&closure->error));
+        else
+            g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_TIMED_OUT,
+                                     _("No key server answered in time"));
+        return;
+    }
+
+    if (closure->failed > 0)
+        g_message ("%u of %u key servers couldn't be searched: %s",
+                   closure->failed, closure->servers->len, closure->error->message);
+
+    g_task_return_boolean (task, TRUE);
+}
+
+static void
+search_remote_maybe_complete (GTask *task)
+{
+    search_remote_closure *closure = g_task_get_task_data (task);
+
+    if (closure->returned)
+        return;
+
+    if (closure->pending == 0 ||
+        (closure->quorum > 0 && closure->succeeded >= closure->quorum) ||
+        (closure->deadline_passed && closure->succeeded > 0))
+        search_remote_complete (task);
+}
+
+static void
+on_source_search_ready (GObject *source,
+                        GAsyncResult *result,
+                        gpointer user_data)
+{
+    server_search *server = user_data;
+    g_autoptr(GTask) task = g_steal_pointer (&server->task);
+    search_remote_closure *closure = g_task_get_task_data (task);
+    g_autoptr(GError) error = NULL;
+    g_autofree char *uri = NULL;
+
+    seahorse_server_source_search_finish (SEAHORSE_SERVER_SOURCE (source),
+                                          result, &error);
+
+    /* We already gave up on this one */
+    if (server->done)
+        return;
+
+    g_return_if_fail (closure->pending > 0);
+    closure->pending--;
+    server_search_done (task, server);
+
+    uri = seahorse_place_get_uri (SEAHORSE_PLACE (server->source));
+    if (error != NULL && server->timed_out) {
+        g_clear_error (&error);
+        error = g_error_new (G_IO_ERROR, G_IO_ERROR_TIMED_OUT,
+                             _("The key server %s didn’t answer in time"), uri);
+    }
+
+    if (error != NULL) {
+        g_debug ("Searching %s failed: %s", uri, error->message);
+        closure->failed++;
+        if (closure->error == NULL)
+            closure->error = g_steal_pointer (&error);
+    } else {
+        closure->succeeded++;
+    }
+
+    search_remote_maybe_complete (task);
+}
+
+static gboolean
+on_server_search_timeout (gpointer user_data)
+{
+    server_search *server = user_data;
+
+    server->timeout_id = 0;
+    server->timed_out = TRUE;
+    g_cancellable_cancel (server->cancellable);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+on_search_remote_deadline (gpointer user_data)
+{
+    GTask *task = G_TASK (user_data);
+    search_remote_closure *closure = g_task_get_task_data (task);
+
+    closure->deadline_id = 0;
+    closure->deadline_passed = TRUE;
+    search_remote_maybe_complete (task);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+on_search_remote_cancelled (GCancellable *cancellable,
+                            gpointer      user_data)
+{
+    search_remote_closure *closure = user_data;
+
+    for (guint i = 0; i < closure->servers->len; i++) {
+        server_search *server = g_ptr_array_index (closure->servers, i);
+        g_cancellable_cancel (server->cancellable);
+    }
+}
+
+/**
+ * seahorse_server_search_async:
+ * @sources: (element-type SeahorseServerSource): The key servers to search
+ * @match: What to search for
+ * @results: Where the keys that were found are added
+ * @quorum: How many servers need to answer, or 0 for all of them
+ * @timeout: How many seconds a single server gets, or 0 for no limit
+ * @deadline: After how many seconds any answer is good enough, or 0 for no
+ *   deadline
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: Called when the search is done
+ * @user_data: Data for @callback
+ *
+ * Searches all @sources at once. Servers that are still running once the
+ * search completes are cancelled.
+ */
+void
+seahorse_server_search_async (GPtrArray           *sources,
+                              const char          *match,
+                              GcrSimpleCollection *results,
+                              unsigned int         quorum,
+                              unsigned int         timeout,
+                              unsigned int         deadline,
+                              GCancellable        *cancellable,
+                              GAsyncReadyCallback  callback,
+                              void                *user_data)
+{
+    search_remote_closure *closure;
+    g_autoptr(GTask) task = NULL;
+
+    g_return_if_fail (sources != NULL);
+    g_return_if_fail (GCR_IS_SIMPLE_COLLECTION (results));
+
+    task = g_task_new (NULL, cancellable, callback, user_data);
+    g_task_set_source_tag (task, seahorse_server_search_async);
+    closure = g_new0 (search_remote_closure, 1);
+    closure->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+    closure->results = g_object_ref (results);
+    closure->seen = g_hash_table_new_full (seahorse_pgp_keyid_hash,
+                                           seahorse_pgp_keyid_equal,
+                                           g_free, NULL);
+    closure->servers = g_ptr_array_new_with_free_func ((GDestroyNotify) server_search_free);
+    closure->quorum = quorum;
+    g_task_set_task_data (task, closure, search_remote_closure_free);
+
+    if (g_task_return_error_if_cancelled (task))
+        return;
+
+    if (sources->len == 0) {
+        g_task_return_boolean (task, FALSE);
+        return;
+    }
+
+    for (guint i = 0; i < sources->len; i++) {
+        server_search *server;
+
+        server = g_new0 (server_search, 1);
+        server->source = g_object_ref (g_ptr_array_index (sources, i));
+        server->cancellable = g_cancellable_new ();
+        server->results = gcr_simple_collection_new ();
+        server->added_sig = g_signal_connect (server->results, "added",
+                                              G_CALLBACK (on_server_result_added),
+                                              closure);
+        g_ptr_array_add (closure->servers, server);
+    }
+
+    if (cancellable)
+        closure->cancelled_sig = g_cancellable_connect (cancellable,
+                                                        G_CALLBACK (on_search_remote_cancelled),
+                                                        closure, NULL);
+
+    if (deadline > 0)
+        closure->deadline_id = g_timeout_add_seconds_full (G_PRIORITY_DEFAULT,
+                                                           deadline,
+                                                           on_search_remote_deadline,
+                                                           g_object_ref (task),
+                                                           g_object_unref);
+
+    for (guint i = 0; i < closure->servers->len; i++) {
+        server_search *server = g_ptr_array_index (closure->servers, i);
+
+        if (timeout > 0)
+            server->timeout_id = g_timeout_add_seconds (timeout,
+                                                        on_server_search_timeout,
+                                                        server);
+
+        seahorse_progress_prep_and_begin (cancellable, server, NULL);
+        server->task = g_object_ref (task);
+        closure->pending++;
+        seahorse_server_source_search_async (server->source, match, server->results,
+                                             server->cancellable,
+                                             on_source_search_ready, server);
+    }
+}
+
+/**
+ * seahorse_server_search_finish:
+ * @result: The result passed to the callback
+ * @error: Set when no server could be searched
+ *
+ * Returns: %TRUE if at least one server answered, %FALSE if there were no
+ *   servers to search or on error
+ */
+gboolean
+seahorse_server_search_finish (GAsyncResult  *result,
+                               GError       **error)
+{
+    g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+    g_return_val_if_fail (g_task_get_source_tag (G_TASK (result))
+                          == seahorse_server_search_async, FALSE);
+
+    return g_task_propagate_boolean (G_TASK (result), error);
+}
@@ -0,0 +1,45 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Searches several key servers at once:
+ *
+ * - Each server gets its own cancellable and timeout, so one slow or broken
+ *   server can't hold up or fail the whole search.
+ * - Results are merged into one collection as they arrive, with keys found
+ *   on several servers only added once.
+ * - Failures are only an error if no server answered at all.
+ */
+
+#pragma once
+
+#include "seahorse-server-source.h"
+
+void            seahorse_server_search_async    (GPtrArray           *sources,
+                                                 const char          *match,
+                                                 GcrSimpleCollection *results,
+                                                 unsigned int         quorum,
+                                                 unsigned int         timeout,
+                                                 unsigned int         deadline,
+                                                 GCancellable        *cancellable,
+                                                 GAsyncReadyCallback  callback,
+                                                 void                *user_data);
+
+gboolean        seahorse_server_search_finish   (GAsyncResult        *result,
+                                                 GError             **error);
@@ -35,27 +35,101 @@
 #include "libseahorse/seahorse-util.h"
 
 #include <glib/gi18n.h>
+#include <glib-unix.h>
+#include <gio/gunixinputstream.h>
+#include <gio/gunixoutputstream.h>
 
 #include <stdlib.h>
 
+/* A transfer is a pipeline: the export writes into one end of a pipe while
+ * the import reads from the other end. The pipe buffer is small, so a slow
+ * import holds up the export instead of the whole export piling up here. */
+
 typedef struct {
     SeahorsePlace *from;
     SeahorsePlace *to;
     char **keyids;
     GList *keys;
+
+    /* Cancelled when either side fails, to stop the other one */
+    GCancellable *cancellable;
+    gulong cancelled_sig;
+
+    GOutputStream *pipe_out;
+    GInputStream *pipe_in;
+    guint wait_source;
+    void *export_data;
+    gsize export_size;
+
+    gboolean exporting;
+    gboolean importing;
+    GError *error;
 } TransferClosure;
 
 static void
 transfer_closure_free (gpointer user_data)
 {
     TransferClosure *closure = user_data;
+
+    g_assert (closure->wait_source == 0);
+
     g_clear_object (&closure->from);
     g_clear_object (&closure->to);
     g_strfreev (closure->keyids);
     g_list_free_full (closure->keys, g_object_unref);
+    g_clear_object (&closure->cancellable);
+    g_clear_object (&closure->pipe_out);
+    g_clear_object (&closure->pipe_in);
+    g_free (closure->export_data);
+    g_clear_error (&closure->error);
     g_free (closure);
 }
 
+static void
+on_transfer_cancelled (GCancellable *cancellable,
+                       void *user_data)
+{
+    GCancellable *internal = G_CANCELLABLE (user_data);
+    g_cancellable_cancel (internal);
+}
+
+/* Keeps the first error, and stops the other side of the pipe */
+static void
+transfer_set_error (TransferClosure *closure,
+                    GError *error)
+{
+    if (closure->error == NULL)
+        closure->error = error;
+    else
+        g_error_free (error);
+    g_cancellable_cancel (closure->cancellable);
+}
+
+static void
+transfer_complete_if_done (GTask *task)
+{
+    TransferClosure *closure = g_task_get_task_data (task);
+    GCancellable *cancellable = g_task_get_cancellable (task);
+    GError *error = NULL;
+
+    if (closure->exporting || closure->importing || closure->wait_source != 0)
+        return;
+
+    if (cancellable)
+        g_cancellable_disconnect (cancellable, closure->cancelled_sig);
+    closure->cancelled_sig = 0;
+
+    /* Report the user cancelling, rather than whatever it caused */
+    if (g_cancellable_set_error_if_cancelled (cancellable, &error) ||
+        (error = g_steal_pointer (&closure->error)) != NULL) {
+        g_debug ("[transfer] failed: %s", error->message);
+        g_task_return_error (task, error);
+    } else {
+        g_debug ("[transfer] done");
+        g_task_return_boolean (task, TRUE);
+    }
+}
+
 static void
 on_source_import_ready (GObject *object,
                         GAsyncResult *result,
@@ -78,113 +152,206 @@ on_source_import_ready (GObject *object,
                                                         result, &error);
     }
 
-    if (results != NULL)
-        g_cancellable_set_error_if_cancelled (cancellable, &error);
+    /* Anything the import didn't read makes the export fail with a broken pipe */
+    g_input_stream_close (closure->pipe_in, NULL, NULL);
 
     if (error != NULL)
-        g_task_return_error (task, g_steal_pointer (&error));
-    else
-        g_task_return_boolean (task, TRUE);
+        transfer_set_error (closure, error);
+
+    closure->importing = FALSE;
+    transfer_complete_if_done (task);
 }
 
-static void
-on_source_export_ready (GObject *object,
-                        GAsyncResult *result,
-                        gpointer user_data)
+static gboolean
+on_pipe_readable (int fd,
+                  GIOCondition condition,
+                  void *user_data)
 {
-    g_autoptr(GTask) task = G_TASK (user_data);
+    GTask *task = G_TASK (user_data);
     TransferClosure *closure = g_task_get_task_data (task);
     GCancellable *cancellable = g_task_get_cancellable (task);
-    GError *error = NULL;
-    gsize stream_size;
-    g_autoptr(GInputStream) input = NULL;
-    gpointer stream_data = NULL;
-
-    g_debug ("[transfer] export done");
-    seahorse_progress_end (cancellable, &closure->from);
-
-    if (SEAHORSE_IS_SERVER_SOURCE (closure->from)) {
-        stream_data = seahorse_server_source_export_finish (SEAHORSE_SERVER_SOURCE (object),
-                                                            result, &stream_size, &error);
-
-    } else if (SEAHORSE_IS_GPGME_KEYRING (closure->from)) {
-        stream_data = seahorse_exporter_export_finish (SEAHORSE_EXPORTER (object), result,
-                                                       &stream_size, &error);
-
-    } else {
-        g_warning ("unsupported source for export: %s", G_OBJECT_TYPE_NAME (object));
-    }
-
-    if (error == NULL)
-        g_cancellable_set_error_if_cancelled (cancellable, &error);
-
-    if (error != NULL) {
-        g_debug ("[transfer] stopped after export");
-        g_task_return_error (task, g_steal_pointer (&error));
-        return;
-    }
 
+    closure->wait_source = 0;
     seahorse_progress_begin (cancellable, &closure->to);
 
-    if (!stream_size) {
+    /* The export finished (or failed) without writing anything */
+    if (!(condition & G_IO_IN) || closure->error != NULL) {
         g_debug ("[transfer] nothing to import");
         seahorse_progress_end (cancellable, &closure->to);
-        g_task_return_boolean (task, TRUE);
-        return;
+        transfer_complete_if_done (task);
+        return G_SOURCE_REMOVE;
     }
 
-    input = g_memory_input_stream_new_from_data (stream_data, stream_size, g_free);
-    stream_data = NULL;
-    stream_size = 0;
-
     g_debug ("[transfer] starting import");
+    closure->importing = TRUE;
     if (SEAHORSE_IS_GPGME_KEYRING (closure->to)) {
         seahorse_gpgme_keyring_import_async (SEAHORSE_GPGME_KEYRING (closure->to),
-                                             input, cancellable,
+                                             closure->pipe_in, closure->cancellable,
                                              on_source_import_ready,
-                                             g_steal_pointer (&task));
+                                             g_object_ref (task));
     } else {
         seahorse_server_source_import_async (SEAHORSE_SERVER_SOURCE (closure->to),
-                                             input, cancellable,
+                                             closure->pipe_in, closure->cancellable,
                                              on_source_import_ready,
-                                             g_steal_pointer (&task));
+                                             g_object_ref (task));
     }
 
-    g_free (stream_data);
+    return G_SOURCE_REMOVE;
 }
 
-static gboolean
-on_timeout_start_transfer (gpointer user_data)
+static void
+transfer_export_done (GTask *task,
+                      GError *error)
+{
+    TransferClosure *closure = g_task_get_task_data (task);
+    GCancellable *cancellable = g_task_get_cancellable (task);
+
+    g_debug ("[transfer] export done");
+    seahorse_progress_end (cancellable, &closure->from);
+
+    /* Lets the import see the end of the data */
+    g_output_stream_close (closure->pipe_out, NULL, NULL);
+
+    if (error != NULL)
+        transfer_set_error (closure, error);
+
+    closure->exporting = FALSE;
+    transfer_complete_if_done (task);
+}
+
+static void
+on_exporter_export_ready (GObject *object,
+                          GAsyncResult *result,
+                          gpointer user_data)
+{
+    g_autoptr(GTask) task = G_TASK (user_data);
+    GError *error = NULL;
+
+    seahorse_exporter_export_to_stream_finish (SEAHORSE_EXPORTER (object),
+                                               result, &error);
+    transfer_export_done (task, error);
+}
+
+/* Blocks while the pipe is full, until the import catches up */
+static void
+server_export_write_thread (GTask        *task,
+                            void         *source_object,
+                            void         *task_data,
+                            GCancellable *cancellable)
+{
+    TransferClosure *closure = task_data;
+    GError *error = NULL;
+
+    if (!g_output_stream_write_all (closure->pipe_out, closure->export_data,
+                                    closure->export_size, NULL, cancellable, &error))
+        g_task_return_error (task, error);
+    else
+        g_task_return_boolean (task, TRUE);
+}
+
+static void
+on_server_export_written (GObject *object,
+                          GAsyncResult *result,
+                          gpointer user_data)
+{
+    g_autoptr(GTask) task = G_TASK (user_data);
+    TransferClosure *closure = g_task_get_task_data (task);
+    GError *error = NULL;
+
+    g_task_propagate_boolean (G_TASK (result), &error);
+    g_clear_pointer (&closure->export_data, g_free);
+    transfer_export_done (task, error);
+}
+
+static void
+on_server_export_ready (GObject *object,
+                        GAsyncResult *result,
+                        gpointer user_data)
+{
+    g_autoptr(GTask) task = G_TASK (user_data);
+    TransferClosure *closure = g_task_get_task_data (task);
+    g_autoptr(GTask) write_task = NULL;
+    GError *error = NULL;
+
+    /* Key servers don't stream their results, so this arrives in one go */
+    closure->export_data = seahorse_server_source_export_finish (SEAHORSE_SERVER_SOURCE (object),
+                                                                 result, &closure->export_size,
+                                                                 &error);
+    if (error != NULL || closure->export_size == 0) {
+        transfer_export_done (task, error);
+        return;
+    }
+
+    /* Not from the main loop: the import might be waiting on the pipe there */
+    write_task = g_task_new (NULL, closure->cancellable, on_server_export_written,
+                             g_object_ref (task));
+    g_task_set_task_data (write_task, closure, NULL);
+    g_task_run_in_thread (write_task, server_export_write_thread);
+}
+
+static void
+start_transfer (GTask *task)
 {
-    GTask *task = G_TASK (user_data);
     TransferClosure *closure = g_task_get_task_data (task);
     GCancellable *cancellable = g_task_get_cancellable (task);
+    GError *error = NULL;
+    int fds[2];
 
     g_assert (SEAHORSE_IS_PLACE (closure->from));
 
+    if (!SEAHORSE_IS_SERVER_SOURCE (closure->from) &&
+        !SEAHORSE_IS_GPGME_KEYRING (closure->from)) {
+        g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                                 "Unsupported source for transfer: %s",
+                                 G_OBJECT_TYPE_NAME (closure->from));
+        return;
+    }
+
+    if (!g_unix_open_pipe (fds, FD_CLOEXEC, &error)) {
+        g_task_return_error (task, error);
+        return;
+    }
+
+    /* Both kinds of export write the pipe from a thread, which waits for
+     * the import to make room in it */
+    closure->pipe_in = g_unix_input_stream_new (fds[0], TRUE);
+    closure->pipe_out = g_unix_output_stream_new (fds[1], TRUE);
+
+    closure->cancellable = g_cancellable_new ();
+    if (cancellable)
+        closure->cancelled_sig = g_cancellable_connect (cancellable,
+                                                        G_CALLBACK (on_transfer_cancelled),
+                                                        g_object_ref (closure->cancellable),
+                                                        g_object_unref);
+
+    /* Only start the import once there's something to import */
+    closure->wait_source = g_unix_fd_add_full (G_PRIORITY_DEFAULT, fds[0],
+                                               G_IO_IN | G_IO_HUP,
+                                               on_pipe_readable,
+                                               g_object_ref (task),
+                                               g_object_unref);
+
+    g_debug ("[transfer] starting export");
     seahorse_progress_begin (cancellable, &closure->from);
+    closure->exporting = TRUE;
+
     if (SEAHORSE_IS_SERVER_SOURCE (closure->from)) {
         g_assert (closure->keyids != NULL);
         seahorse_server_source_export_async (SEAHORSE_SERVER_SOURCE (closure->from),
                                              (const char **) closure->keyids,
-                                             cancellable, on_source_export_ready,
+                                             closure->cancellable, on_server_export_ready,
                                              g_object_ref (task));
-        return G_SOURCE_REMOVE;
-    }
-
-    if (SEAHORSE_IS_GPGME_KEYRING (closure->from)) {
-        SeahorseExporter *exporter = NULL;
+    } else {
+        SeahorseExporter *exporter;
 
         g_assert (closure->keys != NULL);
         exporter = seahorse_gpgme_exporter_new_multiple (closure->keys, TRUE);
-        seahorse_exporter_export (exporter, cancellable,
-                                  on_source_export_ready, g_object_ref (task));
+        seahorse_exporter_export_to_stream (exporter, closure->pipe_out,
+                                            closure->cancellable,
+                                            on_exporter_export_ready,
+                                            g_object_ref (task));
         g_object_unref (exporter);
-        return G_SOURCE_REMOVE;
     }
-
-    g_warning ("unsupported source for transfer: %s", G_OBJECT_TYPE_NAME (closure->from));
-    return G_SOURCE_REMOVE;
 }
 
 void
@@ -235,12 +402,7 @@ seahorse_transfer_keys_async (SeahorsePlace *from,
                             SEAHORSE_IS_GPGME_KEYRING (closure->to) ?
                             _("Importing data") : _("Sending data"));
 
-    g_debug ("starting export");
-
-    /* We delay and continue from a callback */
-    g_timeout_add_seconds_full (G_PRIORITY_DEFAULT, 0,
-                                on_timeout_start_transfer,
-                                g_steal_pointer (&task), g_object_unref);
+    start_transfer (task);
 }
 
 void
@@ -278,12 +440,7 @@ seahorse_transfer_keyids_async (SeahorseServerSource *from,
                             SEAHORSE_IS_GPGME_KEYRING (closure->to) ?
                             _("Importing data") : _("Sending data"));
 
-    g_debug ("starting export");
-
-    /* We delay and continue from a callback */
-    g_timeout_add_seconds_full (G_PRIORITY_DEFAULT, 0,
-                                on_timeout_start_transfer,
-                                g_steal_pointer (&task), g_object_unref);
+    start_transfer (task);
 }
 
 gboolean
@@ -18,18 +18,15 @@
  */
 
 #include "seahorse-pgp-backend.h"
+#include "seahorse-gpgme-keyring.h"
+#include "seahorse-gpgme-key-op.h"
 
 #include <glib.h>
 #include <glib/gstdio.h>
 
-typedef struct _PgpTestFixture {
-    char *tmpdir;
-} PgpTestFixture;
-
 /* Basic sanity test: check if we don't crash on an empty keyring */
 static void
-test_pgp_check_empty_keyring (PgpTestFixture *fixture,
-                              const void     *user_data)
+test_pgp_check_empty_keyring (void)
 {
     SeahorsePgpBackend *backend;
     SeahorseGpgmeKeyring *keyring;
@@ -46,36 +43,104 @@ test_pgp_check_empty_keyring (PgpTestFixture *fixture,
     g_assert_null (gcr_collection_get_objects (GCR_COLLECTION (keyring)));
 }
 
+/* A context which was handed back is reused, with its settings reset */
 static void
-pgp_test_fixture_setup (PgpTestFixture *fixture,
-                        const void     *user_data)
+test_pgp_context_pool (void)
 {
+    gpgme_ctx_t ctx, reused;
+    gpgme_error_t gerr;
+    unsigned int created_before, reused_before;
+    unsigned int created, n_reused;
+
+    /* The pool is shared by the whole process, so only look at what changed */
+    seahorse_gpgme_keyring_get_context_stats ("test", &created_before, &reused_before);
+
+    ctx = seahorse_gpgme_keyring_acquire_context ("test", &gerr);
+    g_assert_nonnull (ctx);
+    g_assert_cmpint (gerr, ==, 0);
+
+    gpgme_set_armor (ctx, 1);
+    gpgme_set_keylist_mode (ctx, GPGME_KEYLIST_MODE_LOCAL | GPGME_KEYLIST_MODE_SIGS);
+    seahorse_gpgme_keyring_release_context (ctx);
+
+    reused = seahorse_gpgme_keyring_acquire_context ("test", &gerr);
+    g_assert_true (reused == ctx);
+    g_assert_cmpint (gpgme_get_armor (reused), ==, 0);
+    g_assert_cmpint (gpgme_get_keylist_mode (reused), ==, GPGME_KEYLIST_MODE_LOCAL);
+
+    seahorse_gpgme_keyring_get_context_stats ("test", &created, &n_reused);
+    g_assert_cmpuint (created - created_before, <=, 1);
+    g_assert_cmpuint (n_reused - reused_before, >=, 1);
+
+    seahorse_gpgme_keyring_release_context (reused);
+}
+
+static void
+on_bulk_done (GObject      *source,
+              GAsyncResult *result,
+              void         *user_data)
+{
+    GAsyncResult **out = user_data;
+
+    *out = g_object_ref (result);
+}
+
+/* A bulk operation over no keys finishes right away, without failures */
+static void
+test_pgp_bulk_empty (void)
+{
+    g_autoptr(GPtrArray) keys = g_ptr_array_new ();
+    g_autoptr(GAsyncResult) result = NULL;
+    g_autoptr(GHashTable) failures = NULL;
     g_autoptr(GError) error = NULL;
+    gboolean ret;
 
-    fixture->tmpdir = g_dir_make_tmp ("seahorse-gpgme-test-XXXXXX.d", &error);
-    g_assert_no_error (error);
+    seahorse_gpgme_key_op_set_trust_keys_async (keys, SEAHORSE_VALIDITY_FULL, NULL,
+                                                on_bulk_done, &result);
+    while (result == NULL)
+        g_main_context_iteration (NULL, TRUE);
 
-    seahorse_pgp_backend_initialize (fixture->tmpdir);
-    g_assert_nonnull (seahorse_pgp_backend_get ());
+    ret = seahorse_gpgme_key_op_bulk_finish (result, &failures, &error);
+    g_assert_no_error (error);
+    g_assert_true (ret);
+    g_assert_cmpuint (g_hash_table_size (failures), ==, 0);
 }
 
+/* Removes the test homedir, and whatever gpg left in it */
 static void
-pgp_test_fixture_teardown (PgpTestFixture *fixture,
-                           const void     *user_data)
+remove_homedir (const char *homedir)
 {
-    g_rmdir (fixture->tmpdir);
-    g_clear_pointer (&fixture->tmpdir, g_free);
+    g_autoptr(GDir) dir = NULL;
+    const char *name;
+
+    dir = g_dir_open (homedir, 0, NULL);
+    while (dir && (name = g_dir_read_name (dir)) != NULL) {
+        g_autofree char *path = g_build_filename (homedir, name, NULL);
+        g_remove (path);
+    }
+    g_rmdir (homedir);
 }
 
 int
 main (int argc, char **argv)
 {
-    g_test_init (&argc, &argv, NULL);
+    g_autofree char *homedir = NULL;
+    g_autoptr(GError) error = NULL;
+    int ret;
+
+    g_test_init (&argc, &argv, G_TEST_OPTION_ISOLATE_DIRS, NULL);
+
+    /* The backend is a singleton, so all tests share it */
+    homedir = g_dir_make_tmp ("seahorse-gpgme-test-XXXXXX.d", &error);
+    g_assert_no_error (error);
+    seahorse_pgp_backend_initialize (homedir);
+    g_assert_nonnull (seahorse_pgp_backend_get ());
 
-    g_test_add ("/pgp/list-empty-keyring", PgpTestFixture, NULL,
-                pgp_test_fixture_setup,
-                test_pgp_check_empty_keyring,
-                pgp_test_fixture_teardown);
+    g_test_add_func ("/pgp/list-empty-keyring", test_pgp_check_empty_keyring);
+    g_test_add_func ("/pgp/context-pool", test_pgp_context_pool);
+    g_test_add_func ("/pgp/bulk-empty", test_pgp_bulk_empty);
 
-    return g_test_run ();
+    ret = g_test_run ();
+    remove_homedir (homedir);
+    return ret;
 }
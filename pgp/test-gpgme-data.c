@@ -0,0 +1,161 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "seahorse-gpgme-data.h"
+
+#include <gpgme.h>
+
+#include <glib.h>
+
+/* Big enough to fill the pipe, and to need several flushes */
+#define TEST_DATA_SIZE (1024 * 1024 + 17)
+
+typedef struct {
+    gboolean done;
+    GError *error;
+} PipeResult;
+
+static void
+on_pipe_done (GObject      *source,
+              GAsyncResult *result,
+              void         *user_data)
+{
+    PipeResult *res = user_data;
+
+    seahorse_gpgme_data_pipe_finish (result, &res->error);
+    res->done = TRUE;
+}
+
+static void
+wait_for_pipe (PipeResult *res)
+{
+    while (!res->done)
+        g_main_context_iteration (NULL, TRUE);
+}
+
+static GBytes *
+make_test_data (void)
+{
+    guint8 *data = g_malloc (TEST_DATA_SIZE);
+
+    for (gsize i = 0; i < TEST_DATA_SIZE; i++)
+        data[i] = i % 251;
+    return g_bytes_new_take (data, TEST_DATA_SIZE);
+}
+
+static void
+test_data_output (void)
+{
+    g_autoptr(GBytes) expected = make_test_data ();
+    g_autoptr(GOutputStream) output = NULL;
+    g_autoptr(GBytes) written = NULL;
+    g_autoptr(GError) error = NULL;
+    PipeResult res = { FALSE, NULL };
+    gpgme_data_t data;
+    const guint8 *bytes;
+    gsize len, at = 0;
+
+    output = g_memory_output_stream_new_resizable ();
+    data = seahorse_gpgme_data_output_pipe (output, NULL, on_pipe_done, &res, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (data);
+
+    /* Odd sized writes, like gpgme does. The pipe fills up many times over,
+     * and is drained by its thread without the main loop running. */
+    bytes = g_bytes_get_data (expected, &len);
+    while (at < len) {
+        gsize chunk = MIN (len - at, 4093);
+
+        g_assert_cmpint (gpgme_data_write (data, bytes + at, chunk), ==, chunk);
+        at += chunk;
+    }
+
+    gpgme_data_release (data);
+    wait_for_pipe (&res);
+    g_assert_no_error (res.error);
+
+    g_output_stream_close (output, NULL, NULL);
+    written = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (output));
+    g_assert_true (g_bytes_equal (written, expected));
+}
+
+static void
+test_data_input (void)
+{
+    g_autoptr(GBytes) expected = make_test_data ();
+    g_autoptr(GInputStream) input = NULL;
+    g_autoptr(GByteArray) read = g_byte_array_new ();
+    g_autoptr(GError) error = NULL;
+    PipeResult res = { FALSE, NULL };
+    gpgme_data_t data;
+    guint8 buffer[4093];
+    ssize_t nread;
+
+    input = g_memory_input_stream_new_from_bytes (expected);
+    data = seahorse_gpgme_data_input_pipe (input, NULL, on_pipe_done, &res, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (data);
+
+    while ((nread = gpgme_data_read (data, buffer, sizeof (buffer))) > 0)
+        g_byte_array_append (read, buffer, nread);
+    g_assert_cmpint (nread, ==, 0);
+
+    gpgme_data_release (data);
+    wait_for_pipe (&res);
+    g_assert_no_error (res.error);
+
+    g_assert_cmpmem (read->data, read->len,
+                     g_bytes_get_data (expected, NULL), g_bytes_get_size (expected));
+}
+
+/* gpgme doesn't have to read everything */
+static void
+test_data_input_released_early (void)
+{
+    g_autoptr(GBytes) expected = make_test_data ();
+    g_autoptr(GInputStream) input = NULL;
+    g_autoptr(GError) error = NULL;
+    PipeResult res = { FALSE, NULL };
+    gpgme_data_t data;
+    guint8 buffer[128];
+
+    input = g_memory_input_stream_new_from_bytes (expected);
+    data = seahorse_gpgme_data_input_pipe (input, NULL, on_pipe_done, &res, &error);
+    g_assert_no_error (error);
+
+    g_assert_cmpint (gpgme_data_read (data, buffer, sizeof (buffer)), >, 0);
+
+    gpgme_data_release (data);
+    wait_for_pipe (&res);
+    g_assert_no_error (res.error);
+}
+
+int
+main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    gpgme_check_version (NULL);
+
+    g_test_add_func ("/pgp/data/output", test_data_output);
+    g_test_add_func ("/pgp/data/input", test_data_input);
+    g_test_add_func ("/pgp/data/input-released-early", test_data_input_released_early);
+
+    return g_test_run ();
+}
@@ -0,0 +1,202 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "seahorse-gpgme-snapshot.h"
+
+#include <gpgme.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+typedef struct _SnapshotTestFixture {
+    char *homedir;
+} SnapshotTestFixture;
+
+static SeahorseGpgmeSnapshotKey *
+new_test_key (const char *keyid,
+              SeahorseUsage usage)
+{
+    SeahorseGpgmeSnapshotKey *key;
+
+    key = g_new0 (SeahorseGpgmeSnapshotKey, 1);
+    key->keyid = g_strdup (keyid);
+    key->fingerprint = g_strdup_printf ("AAAA BBBB CCCC DDDD EEEE  FFFF 0000 1111 %.4s %.4s",
+                                        keyid + 8, keyid + 12);
+    key->digest = g_strdup ("0123456789abcdef");
+    key->label = g_strdup ("Test Key");
+    key->markup = g_strdup ("Test Key<span size='small'>\ntest@example.org</span>");
+    key->nickname = g_strdup ("Test Key");
+    key->algo = g_strdup ("EdDSA");
+    key->length = 255;
+    key->created = 1600000000;
+    key->expires = 0;
+    key->flags = SEAHORSE_FLAG_EXPORTABLE | SEAHORSE_FLAG_DELETABLE;
+    key->usage = usage;
+    key->validity = SEAHORSE_VALIDITY_ULTIMATE;
+    key->trust = SEAHORSE_VALIDITY_ULTIMATE;
+    key->n_subkeys = 2;
+    key->n_uids = 1;
+    return key;
+}
+
+static void
+on_snapshot_written (GObject      *source,
+                     GAsyncResult *result,
+                     void         *user_data)
+{
+    gboolean *done = user_data;
+    g_autoptr(GError) error = NULL;
+
+    seahorse_gpgme_snapshot_write_finish (result, &error);
+    g_assert_no_error (error);
+    *done = TRUE;
+}
+
+static void
+write_snapshot (GPtrArray *keys)
+{
+    gboolean done = FALSE;
+
+    seahorse_gpgme_snapshot_write_async (keys, NULL, on_snapshot_written, &done);
+    while (!done)
+        g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+test_snapshot_missing (SnapshotTestFixture *fixture,
+                       const void          *user_data)
+{
+    g_autoptr(GPtrArray) keys = NULL;
+    g_autoptr(GError) error = NULL;
+
+    keys = seahorse_gpgme_snapshot_read (&error);
+    g_assert_no_error (error);
+    g_assert_null (keys);
+}
+
+static void
+test_snapshot_round_trip (SnapshotTestFixture *fixture,
+                          const void          *user_data)
+{
+    g_autoptr(GPtrArray) keys = NULL;
+    g_autoptr(GPtrArray) read = NULL;
+    g_autoptr(GError) error = NULL;
+
+    keys = g_ptr_array_new_with_free_func ((GDestroyNotify) seahorse_gpgme_snapshot_key_free);
+    g_ptr_array_add (keys, new_test_key ("0123456789ABCDEF", SEAHORSE_USAGE_PUBLIC_KEY));
+    g_ptr_array_add (keys, new_test_key ("FEDCBA9876543210", SEAHORSE_USAGE_PRIVATE_KEY));
+    write_snapshot (keys);
+
+    read = seahorse_gpgme_snapshot_read (&error);
+    g_assert_no_error (error);
+    g_assert_nonnull (read);
+    g_assert_cmpuint (read->len, ==, keys->len);
+
+    for (unsigned int i = 0; i < keys->len; i++) {
+        SeahorseGpgmeSnapshotKey *a = g_ptr_array_index (keys, i);
+        SeahorseGpgmeSnapshotKey *b = g_ptr_array_index (read, i);
+
+        g_assert_cmpstr (a->keyid, ==, b->keyid);
+        g_assert_cmpstr (a->fingerprint, ==, b->fingerprint);
+        g_assert_cmpstr (a->digest, ==, b->digest);
+        g_assert_cmpstr (a->label, ==, b->label);
+        g_assert_cmpstr (a->markup, ==, b->markup);
+        g_assert_cmpstr (a->nickname, ==, b->nickname);
+        g_assert_cmpstr (a->algo, ==, b->algo);
+        g_assert_cmpuint (a->length, ==, b->length);
+        g_assert_cmpint (a->created, ==, b->created);
+        g_assert_cmpint (a->expires, ==, b->expires);
+        g_assert_cmpuint (a->flags, ==, b->flags);
+        g_assert_cmpint (a->usage, ==, b->usage);
+        g_assert_cmpint (a->validity, ==, b->validity);
+        g_assert_cmpint (a->trust, ==, b->trust);
+        g_assert_cmpuint (a->n_subkeys, ==, b->n_subkeys);
+        g_assert_cmpuint (a->n_uids, ==, b->n_uids);
+    }
+}
+
+/* Changing the keyring makes the snapshot useless */
+static void
+test_snapshot_stale (SnapshotTestFixture *fixture,
+                     const void          *user_data)
+{
+    g_autoptr(GPtrArray) keys = NULL;
+    g_autoptr(GPtrArray) read = NULL;
+    g_autofree char *pubring = NULL;
+    g_autoptr(GError) error = NULL;
+
+    keys = g_ptr_array_new_with_free_func ((GDestroyNotify) seahorse_gpgme_snapshot_key_free);
+    g_ptr_array_add (keys, new_test_key ("0123456789ABCDEF", SEAHORSE_USAGE_PUBLIC_KEY));
+    write_snapshot (keys);
+
+    pubring = g_build_filename (fixture->homedir, "pubring.kbx", NULL);
+    g_file_set_contents (pubring, "changed", -1, &error);
+    g_assert_no_error (error);
+
+    read = seahorse_gpgme_snapshot_read (&error);
+    g_assert_no_error (error);
+    g_assert_null (read);
+}
+
+static void
+snapshot_test_fixture_setup (SnapshotTestFixture *fixture,
+                             const void          *user_data)
+{
+    g_autoptr(GError) error = NULL;
+
+    fixture->homedir = g_dir_make_tmp ("seahorse-gpgme-test-XXXXXX.d", &error);
+    g_assert_no_error (error);
+
+    gpgme_set_engine_info (GPGME_PROTOCOL_OpenPGP, NULL, fixture->homedir);
+}
+
+static void
+snapshot_test_fixture_teardown (SnapshotTestFixture *fixture,
+                                const void          *user_data)
+{
+    g_autofree char *pubring = NULL;
+
+    pubring = g_build_filename (fixture->homedir, "pubring.kbx", NULL);
+    g_remove (pubring);
+    g_rmdir (fixture->homedir);
+    g_clear_pointer (&fixture->homedir, g_free);
+}
+
+int
+main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, G_TEST_OPTION_ISOLATE_DIRS, NULL);
+
+    gpgme_check_version (NULL);
+
+    g_test_add ("/pgp/snapshot/missing", SnapshotTestFixture, NULL,
+                snapshot_test_fixture_setup,
+                test_snapshot_missing,
+                snapshot_test_fixture_teardown);
+    g_test_add ("/pgp/snapshot/round-trip", SnapshotTestFixture, NULL,
+                snapshot_test_fixture_setup,
+                test_snapshot_round_trip,
+                snapshot_test_fixture_teardown);
+    g_test_add ("/pgp/snapshot/stale", SnapshotTestFixture, NULL,
+                snapshot_test_fixture_setup,
+                test_snapshot_stale,
+                snapshot_test_fixture_teardown);
+
+    return g_test_run ();
+}
@@ -22,6 +22,9 @@
 #include "seahorse-pgp-uid.h"
 
 #include <glib.h>
+#include <libsoup/soup.h>
+
+#include <string.h>
 
 static void
 test_hkp_lookup_response_simple_no_uid (void)
@@ -115,6 +118,56 @@ test_hkp_lookup_response_empty (void)
     g_assert_cmpuint (g_list_length (keys), ==, 0);
 }
 
+#define INDEX_THREE_KEYS \
+    "info:1:3\r\n" \
+    "pub:0123456789ABCDEF0123456789ABCDEF01234567:1:4096:712627200::\r\n" \
+    "uid:First%20Key%20%3Cfirst@example.org%3E:::\r\n" \
+    "pub:1123456789ABCDEF0123456789ABCDEF01234567:17:2048:712627200::r\r\n" \
+    "uid:Second%20Key%20%3Csecond@example.org%3E:::\r\n" \
+    "uid:Second%20Again%20%3Csecond@example.com%3E:::\r\n" \
+    "pub:2123456789ABCDEF0123456789ABCDEF01234567:1:3072:712627200::\r\n"
+
+static void
+test_hkp_index_parser_chunks (void)
+{
+    const char *index = INDEX_THREE_KEYS;
+    gsize len = strlen (index);
+
+    /* The result can't depend on where the chunks end */
+    for (gsize chunk = 1; chunk <= len; chunk++) {
+        g_autoptr(SeahorseHKPIndexParser) parser = seahorse_hkp_index_parser_new ();
+        g_autoptr(GPtrArray) all = g_ptr_array_new_with_free_func (g_object_unref);
+        SeahorsePgpKey *key;
+
+        for (gsize at = 0; at < len; at += chunk) {
+            g_autoptr(GPtrArray) keys = NULL;
+
+            seahorse_hkp_index_parser_feed (parser, index + at, MIN (chunk, len - at));
+            keys = seahorse_hkp_index_parser_take_keys (parser);
+            g_ptr_array_extend_and_steal (all, g_steal_pointer (&keys));
+        }
+
+        /* The last key is only complete at the end */
+        g_assert_cmpuint (all->len, ==, 2);
+        seahorse_hkp_index_parser_finish (parser);
+        g_ptr_array_extend_and_steal (all, seahorse_hkp_index_parser_take_keys (parser));
+        g_assert_cmpuint (all->len, ==, 3);
+
+        key = g_ptr_array_index (all, 0);
+        g_assert_cmpstr (seahorse_pgp_key_get_fingerprint (key), ==,
+                         "0123 4567 89AB CDEF 0123 4567 89AB CDEF 0123 4567");
+        g_assert_cmpuint (g_list_model_get_n_items (seahorse_pgp_key_get_uids (key)), ==, 1);
+
+        key = g_ptr_array_index (all, 1);
+        g_assert_cmpstr (seahorse_pgp_key_get_algo (key), ==, "DSA");
+        g_assert_cmpuint (g_list_model_get_n_items (seahorse_pgp_key_get_uids (key)), ==, 2);
+
+        key = g_ptr_array_index (all, 2);
+        g_assert_cmpuint (seahorse_pgp_key_get_length (key), ==, 3072);
+        g_assert_cmpuint (g_list_model_get_n_items (seahorse_pgp_key_get_uids (key)), ==, 0);
+    }
+}
+
 static void
 test_hkp_is_valid_uri (void)
 {
@@ -131,15 +184,318 @@ test_hkp_is_valid_uri (void)
     g_assert_false (seahorse_hkp_is_valid_uri ("ldap://keys.openpgp.org"));
 }
 
+/* Exporting talks to a local server, which answers depending on the key */
+#define KEY_OK        "0x00000000000000A1"
+#define KEY_FLAKY     "0x00000000000000A2"
+#define KEY_BROKEN    "0x00000000000000A3"
+#define KEY_MISSING   "0x00000000000000A4"
+#define KEY_SLOW      "0x00000000000000A5"
+
+typedef struct _ExportTestFixture {
+    SoupServer *server;
+    char *uri;
+    GHashTable *requests;               /* search → number of requests */
+    unsigned int in_flight;
+    unsigned int max_in_flight;
+    GCancellable *cancellable;
+} ExportTestFixture;
+
+typedef struct {
+    ExportTestFixture *fixture;
+    SoupServerMessage *message;
+    char *search;
+} PendingResponse;
+
+static void
+respond (SoupServerMessage *message,
+         const char        *search,
+         unsigned int       n_request)
+{
+    SoupMessageHeaders *headers = soup_server_message_get_response_headers (message);
+    g_autofree char *body = NULL;
+
+    if (g_str_equal (search, KEY_MISSING)) {
+        soup_server_message_set_status (message, SOUP_STATUS_NOT_FOUND, NULL);
+        return;
+    }
+
+    if (g_str_equal (search, KEY_BROKEN) ||
+        (g_str_equal (search, KEY_FLAKY) && n_request == 1)) {
+        soup_server_message_set_status (message, SOUP_STATUS_SERVICE_UNAVAILABLE, NULL);
+        soup_message_headers_append (headers, "Retry-After", "0");
+        return;
+    }
+
+    if (g_str_equal (search, KEY_SLOW)) {
+        soup_server_message_set_status (message, SOUP_STATUS_SERVICE_UNAVAILABLE, NULL);
+        soup_message_headers_append (headers, "Retry-After", "60");
+        return;
+    }
+
+    body = g_strdup_printf ("-----BEGIN PGP PUBLIC KEY BLOCK-----\n\n"
+                            "key %s\n"
+                            "-----END PGP PUBLIC KEY BLOCK-----\n", search);
+    soup_server_message_set_status (message, SOUP_STATUS_OK, NULL);
+    soup_server_message_set_response (message, "application/pgp-keys",
+                                      SOUP_MEMORY_COPY, body, strlen (body));
+}
+
+static gboolean
+on_cancel_later (void *user_data)
+{
+    ExportTestFixture *fixture = user_data;
+
+    g_cancellable_cancel (fixture->cancellable);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+on_respond_later (void *user_data)
+{
+    PendingResponse *pending = user_data;
+    ExportTestFixture *fixture = pending->fixture;
+    unsigned int n_request;
+
+    n_request = GPOINTER_TO_UINT (g_hash_table_lookup (fixture->requests, pending->search));
+    respond (pending->message, pending->search, n_request);
+    soup_server_message_unpause (pending->message);
+    fixture->in_flight--;
+
+    /* Cancel once the slow key is waiting for its retry */
+    if (g_str_equal (pending->search, KEY_SLOW))
+        g_timeout_add (200, on_cancel_later, fixture);
+
+    g_object_unref (pending->message);
+    g_free (pending->search);
+    g_free (pending);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+on_lookup_request (SoupServer        *server,
+                   SoupServerMessage *message,
+                   const char        *path,
+                   GHashTable        *query,
+                   void              *user_data)
+{
+    ExportTestFixture *fixture = user_data;
+    PendingResponse *pending;
+    const char *search;
+    unsigned int n_request;
+
+    search = query ? g_hash_table_lookup (query, "search") : NULL;
+    g_assert_nonnull (search);
+    g_assert_cmpstr (g_hash_table_lookup (query, "op"), ==, "get");
+
+    n_request = GPOINTER_TO_UINT (g_hash_table_lookup (fixture->requests, search)) + 1;
+    g_hash_table_replace (fixture->requests, g_strdup (search), GUINT_TO_POINTER (n_request));
+
+    /* Keep the request in flight a bit, so they overlap */
+    fixture->in_flight++;
+    fixture->max_in_flight = MAX (fixture->max_in_flight, fixture->in_flight);
+
+    pending = g_new0 (PendingResponse, 1);
+    pending->fixture = fixture;
+    pending->message = g_object_ref (message);
+    pending->search = g_strdup (search);
+    soup_server_message_pause (message);
+    g_timeout_add (20, on_respond_later, pending);
+}
+
+static unsigned int
+count_requests (ExportTestFixture *fixture,
+                const char        *search)
+{
+    return GPOINTER_TO_UINT (g_hash_table_lookup (fixture->requests, search));
+}
+
+static void
+on_async_ready (GObject      *source,
+                GAsyncResult *result,
+                void         *user_data)
+{
+    GAsyncResult **ret = user_data;
+    *ret = g_object_ref (result);
+}
+
+static char *
+export_keys (ExportTestFixture  *fixture,
+             const char        **keyids,
+             unsigned int        max_connections,
+             GError            **error)
+{
+    g_autoptr(SeahorseHKPSource) source = NULL;
+    g_autoptr(GAsyncResult) result = NULL;
+    char *data;
+    gsize size;
+
+    source = seahorse_hkp_source_new (fixture->uri);
+    g_object_set (source, "max-connections", max_connections, NULL);
+
+    seahorse_server_source_export_async (SEAHORSE_SERVER_SOURCE (source), keyids,
+                                         fixture->cancellable,
+                                         on_async_ready, &result);
+    while (result == NULL)
+        g_main_context_iteration (NULL, TRUE);
+
+    data = seahorse_server_source_export_finish (SEAHORSE_SERVER_SOURCE (source),
+                                                 result, &size, error);
+    g_assert_true (data == NULL || strlen (data) == size);
+    return data;
+}
+
+static void
+test_hkp_export_window (ExportTestFixture *fixture,
+                        const void        *user_data)
+{
+    const char *keyids[] = {
+        "00000000000000B1", "00000000000000B2", "00000000000000B3",
+        "00000000000000B4", "00000000000000B5", "00000000000000B6",
+        NULL,
+    };
+    g_autoptr(GError) error = NULL;
+    g_autofree char *data = NULL;
+
+    data = export_keys (fixture, keyids, 2, &error);
+    g_assert_no_error (error);
+
+    /* Requests overlap, but never more than allowed */
+    g_assert_cmpuint (fixture->max_in_flight, ==, 2);
+    for (guint i = 0; keyids[i] != NULL; i++) {
+        g_autofree char *search = g_strdup_printf ("0x%s", keyids[i]);
+
+        g_assert_cmpuint (count_requests (fixture, search), ==, 1);
+        g_assert_nonnull (strstr (data, search));
+    }
+}
+
+static void
+test_hkp_export_retry (ExportTestFixture *fixture,
+                       const void        *user_data)
+{
+    const char *keyids[] = { KEY_OK + 2, KEY_FLAKY + 2, KEY_MISSING + 2, NULL };
+    g_autoptr(GError) error = NULL;
+    g_autofree char *data = NULL;
+
+    data = export_keys (fixture, keyids, 2, &error);
+    g_assert_no_error (error);
+
+    /* The flaky key made it the second time, the missing one isn't retried */
+    g_assert_cmpuint (count_requests (fixture, KEY_OK), ==, 1);
+    g_assert_cmpuint (count_requests (fixture, KEY_FLAKY), ==, 2);
+    g_assert_cmpuint (count_requests (fixture, KEY_MISSING), ==, 1);
+    g_assert_nonnull (strstr (data, KEY_OK));
+    g_assert_nonnull (strstr (data, KEY_FLAKY));
+    g_assert_null (strstr (data, KEY_MISSING));
+}
+
+static void
+test_hkp_export_partial (ExportTestFixture *fixture,
+                         const void        *user_data)
+{
+    const char *keyids[] = { KEY_OK + 2, KEY_BROKEN + 2, NULL };
+    const char *broken[] = { KEY_BROKEN + 2, NULL };
+    g_autoptr(GError) error = NULL;
+    g_autofree char *data = NULL;
+
+    /* What we did get is kept, even when another key keeps failing */
+    data = export_keys (fixture, keyids, 2, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (strstr (data, KEY_OK));
+    g_assert_null (strstr (data, KEY_BROKEN));
+    g_assert_cmpuint (count_requests (fixture, KEY_BROKEN), ==, 3);
+
+    /* Unless there's nothing at all */
+    g_clear_pointer (&data, g_free);
+    data = export_keys (fixture, broken, 2, &error);
+    g_assert_error (error, HKP_ERROR_DOMAIN, SOUP_STATUS_SERVICE_UNAVAILABLE);
+    g_assert_null (data);
+}
+
+static void
+test_hkp_export_cancel_retry (ExportTestFixture *fixture,
+                              const void        *user_data)
+{
+    const char *keyids[] = { KEY_SLOW + 2, NULL };
+    g_autoptr(GError) error = NULL;
+    g_autofree char *data = NULL;
+    gint64 started;
+
+    /* The server asks to wait a minute, but we get cancelled first */
+    started = g_get_monotonic_time ();
+    data = export_keys (fixture, keyids, 1, &error);
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    g_assert_null (data);
+
+    g_assert_cmpuint (count_requests (fixture, KEY_SLOW), ==, 1);
+    g_assert_cmpint (g_get_monotonic_time () - started, <, 5 * G_USEC_PER_SEC);
+}
+
+static void
+export_test_fixture_setup (ExportTestFixture *fixture,
+                           const void        *user_data)
+{
+    g_autoptr(GError) error = NULL;
+    GSList *uris;
+
+    fixture->requests = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    fixture->cancellable = g_cancellable_new ();
+
+    fixture->server = soup_server_new (NULL, NULL);
+    soup_server_add_handler (fixture->server, "/pks/lookup",
+                             on_lookup_request, fixture, NULL);
+    soup_server_listen_local (fixture->server, 0,
+                              SOUP_SERVER_LISTEN_IPV4_ONLY, &error);
+    g_assert_no_error (error);
+
+    uris = soup_server_get_uris (fixture->server);
+    g_assert_nonnull (uris);
+    fixture->uri = g_strdup_printf ("hkp://127.0.0.1:%d",
+                                    g_uri_get_port (uris->data));
+    g_slist_free_full (uris, (GDestroyNotify) g_uri_unref);
+}
+
+static void
+export_test_fixture_teardown (ExportTestFixture *fixture,
+                              const void        *user_data)
+{
+    /* Let paused responses finish */
+    while (fixture->in_flight > 0)
+        g_main_context_iteration (NULL, TRUE);
+
+    soup_server_disconnect (fixture->server);
+    g_clear_object (&fixture->server);
+    g_clear_object (&fixture->cancellable);
+    g_clear_pointer (&fixture->requests, g_hash_table_unref);
+    g_clear_pointer (&fixture->uri, g_free);
+}
+
 int
 main (int argc, char **argv)
 {
-    g_test_init (&argc, &argv, NULL);
+    g_test_init (&argc, &argv, G_TEST_OPTION_ISOLATE_DIRS, NULL);
 
     g_test_add_func ("/hkp/valid-uri", test_hkp_is_valid_uri);
     g_test_add_func ("/hkp/lookup-response-empty", test_hkp_lookup_response_empty);
     g_test_add_func ("/hkp/lookup-response-simple", test_hkp_lookup_response_simple);
     g_test_add_func ("/hkp/lookup-response-simple-no-uid", test_hkp_lookup_response_simple_no_uid);
+    g_test_add_func ("/hkp/index-parser-chunks", test_hkp_index_parser_chunks);
+    g_test_add ("/hkp/export-window", ExportTestFixture, NULL,
+                export_test_fixture_setup,
+                test_hkp_export_window,
+                export_test_fixture_teardown);
+    g_test_add ("/hkp/export-retry", ExportTestFixture, NULL,
+                export_test_fixture_setup,
+                test_hkp_export_retry,
+                export_test_fixture_teardown);
+    g_test_add ("/hkp/export-partial", ExportTestFixture, NULL,
+                export_test_fixture_setup,
+                test_hkp_export_partial,
+                export_test_fixture_teardown);
+    g_test_add ("/hkp/export-cancel-retry", ExportTestFixture, NULL,
+                export_test_fixture_setup,
+                test_hkp_export_cancel_retry,
+                export_test_fixture_teardown);
 
     return g_test_run ();
 }
@@ -0,0 +1,254 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "seahorse-keyserver-cache.h"
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <string.h>
+
+#define TEST_SERVER "hkps://keys.example.org"
+
+typedef struct _CacheTestFixture {
+    char *directory;
+    SeahorseKeyserverCache *cache;
+} CacheTestFixture;
+
+static GBytes *
+make_body (char   fill,
+           gsize  len)
+{
+    char *data = g_malloc (len);
+
+    memset (data, fill, len);
+    return g_bytes_new_take (data, len);
+}
+
+static void
+test_cache_round_trip (CacheTestFixture *fixture,
+                       const void       *user_data)
+{
+    g_autoptr(GBytes) body = make_body ('a', 100);
+    g_autoptr(SeahorseKeyserverCacheEntry) entry = NULL;
+    g_autoptr(SeahorseKeyserverCacheEntry) other = NULL;
+
+    seahorse_keyserver_cache_store (fixture->cache, TEST_SERVER, "index", "test",
+                                    SEAHORSE_KEYSERVER_CACHE_SEARCH, body,
+                                    "\"abc\"", "Mon, 01 Jan 2024 00:00:00 GMT");
+
+    entry = seahorse_keyserver_cache_lookup (fixture->cache, TEST_SERVER, "index", "test");
+    g_assert_nonnull (entry);
+    g_assert_true (entry->fresh);
+    g_assert_true (g_bytes_equal (entry->body, body));
+    g_assert_cmpstr (entry->etag, ==, "\"abc\"");
+    g_assert_cmpstr (entry->last_modified, ==, "Mon, 01 Jan 2024 00:00:00 GMT");
+
+    /* The operation and the query are both part of the key */
+    other = seahorse_keyserver_cache_lookup (fixture->cache, TEST_SERVER, "get", "test");
+    g_assert_null (other);
+    other = seahorse_keyserver_cache_lookup (fixture->cache, TEST_SERVER, "index", "other");
+    g_assert_null (other);
+}
+
+static void
+test_cache_expired (CacheTestFixture *fixture,
+                    const void       *user_data)
+{
+    g_autoptr(GBytes) body = make_body ('a', 100);
+    g_autoptr(SeahorseKeyserverCacheEntry) entry = NULL;
+
+    g_object_set (fixture->cache, "search-ttl", 0, NULL);
+    seahorse_keyserver_cache_store (fixture->cache, TEST_SERVER, "index", "test",
+                                    SEAHORSE_KEYSERVER_CACHE_SEARCH, body, NULL, NULL);
+
+    /* Still there to revalidate, but not fresh anymore */
+    entry = seahorse_keyserver_cache_lookup (fixture->cache, TEST_SERVER, "index", "test");
+    g_assert_nonnull (entry);
+    g_assert_false (entry->fresh);
+    g_assert_null (entry->etag);
+    g_assert_null (entry->last_modified);
+    g_assert_true (g_bytes_equal (entry->body, body));
+    g_clear_pointer (&entry, seahorse_keyserver_cache_entry_free);
+
+    /* Keys asked for by fingerprint have their own TTL */
+    seahorse_keyserver_cache_store (fixture->cache, TEST_SERVER, "get", "0xABCD",
+                                    SEAHORSE_KEYSERVER_CACHE_KEY, body, NULL, NULL);
+    entry = seahorse_keyserver_cache_lookup (fixture->cache, TEST_SERVER, "get", "0xABCD");
+    g_assert_nonnull (entry);
+    g_assert_true (entry->fresh);
+}
+
+/* Explicit refreshes ask the server again, but can still revalidate */
+static void
+test_cache_revalidate (CacheTestFixture *fixture,
+                       const void       *user_data)
+{
+    g_autoptr(GBytes) body = make_body ('a', 100);
+    g_autoptr(SeahorseKeyserverCacheEntry) entry = NULL;
+
+    seahorse_keyserver_cache_store (fixture->cache, TEST_SERVER, "get", "0xABCD",
+                                    SEAHORSE_KEYSERVER_CACHE_KEY, body, "\"abc\"", NULL);
+    seahorse_keyserver_cache_revalidate (fixture->cache);
+
+    entry = seahorse_keyserver_cache_lookup (fixture->cache, TEST_SERVER, "get", "0xABCD");
+    g_assert_nonnull (entry);
+    g_assert_false (entry->fresh);
+    g_assert_cmpstr (entry->etag, ==, "\"abc\"");
+    g_assert_true (g_bytes_equal (entry->body, body));
+}
+
+static gboolean
+is_cached (CacheTestFixture *fixture,
+           const char       *query)
+{
+    g_autoptr(SeahorseKeyserverCacheEntry) entry = NULL;
+
+    entry = seahorse_keyserver_cache_lookup (fixture->cache, TEST_SERVER, "index", query);
+    return entry != NULL;
+}
+
+static void
+test_cache_eviction (CacheTestFixture *fixture,
+                     const void       *user_data)
+{
+    const char *queries[] = { "a", "b", "c", "d", "e" };
+    g_autoptr(GBytes) body = make_body ('x', 900);
+
+    /* Room for four entries, and bodies over a quarter of that aren't kept */
+    g_object_set (fixture->cache, "max-size", (guint64) 4096, NULL);
+
+    for (guint i = 0; i < 4; i++)
+        seahorse_keyserver_cache_store (fixture->cache, TEST_SERVER, "index", queries[i],
+                                        SEAHORSE_KEYSERVER_CACHE_SEARCH, body, NULL, NULL);
+
+    /* Using "a" makes "b" the least recently used one */
+    g_assert_true (is_cached (fixture, "a"));
+
+    /* The fifth one makes room for a few more */
+    seahorse_keyserver_cache_store (fixture->cache, TEST_SERVER, "index", queries[4],
+                                    SEAHORSE_KEYSERVER_CACHE_SEARCH, body, NULL, NULL);
+
+    g_assert_true (is_cached (fixture, "a"));
+    g_assert_false (is_cached (fixture, "b"));
+    g_assert_false (is_cached (fixture, "c"));
+    g_assert_true (is_cached (fixture, "d"));
+    g_assert_true (is_cached (fixture, "e"));
+}
+
+static void
+test_cache_too_big (CacheTestFixture *fixture,
+                    const void       *user_data)
+{
+    g_autoptr(GBytes) body = make_body ('x', 2000);
+
+    g_object_set (fixture->cache, "max-size", (guint64) 4096, NULL);
+    seahorse_keyserver_cache_store (fixture->cache, TEST_SERVER, "index", "big",
+                                    SEAHORSE_KEYSERVER_CACHE_SEARCH, body, NULL, NULL);
+    g_assert_false (is_cached (fixture, "big"));
+}
+
+/* Entries we can't read are dropped, rather than served */
+static void
+test_cache_corrupt (CacheTestFixture *fixture,
+                    const void       *user_data)
+{
+    g_autoptr(GBytes) body = make_body ('a', 100);
+    g_autoptr(GDir) dir = NULL;
+    g_autoptr(GError) error = NULL;
+    g_autofree char *path = NULL;
+    const char *name;
+
+    seahorse_keyserver_cache_store (fixture->cache, TEST_SERVER, "index", "test",
+                                    SEAHORSE_KEYSERVER_CACHE_SEARCH, body, NULL, NULL);
+
+    dir = g_dir_open (fixture->directory, 0, &error);
+    g_assert_no_error (error);
+    name = g_dir_read_name (dir);
+    g_assert_nonnull (name);
+    path = g_build_filename (fixture->directory, name, NULL);
+    g_file_set_contents (path, "SHKS", 4, &error);
+    g_assert_no_error (error);
+
+    g_assert_false (is_cached (fixture, "test"));
+    g_assert_false (g_file_test (path, G_FILE_TEST_EXISTS));
+}
+
+static void
+cache_test_fixture_setup (CacheTestFixture *fixture,
+                          const void       *user_data)
+{
+    g_autoptr(GError) error = NULL;
+
+    fixture->directory = g_dir_make_tmp ("seahorse-keyserver-cache-XXXXXX.d", &error);
+    g_assert_no_error (error);
+
+    fixture->cache = seahorse_keyserver_cache_new (fixture->directory);
+}
+
+static void
+cache_test_fixture_teardown (CacheTestFixture *fixture,
+                             const void       *user_data)
+{
+    g_autoptr(GDir) dir = NULL;
+    const char *name;
+
+    g_clear_object (&fixture->cache);
+
+    dir = g_dir_open (fixture->directory, 0, NULL);
+    while (dir && (name = g_dir_read_name (dir)) != NULL) {
+        g_autofree char *path = g_build_filename (fixture->directory, name, NULL);
+        g_remove (path);
+    }
+    g_rmdir (fixture->directory);
+    g_clear_pointer (&fixture->directory, g_free);
+}
+
+int
+main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, G_TEST_OPTION_ISOLATE_DIRS, NULL);
+
+    g_test_add ("/pgp/keyserver-cache/round-trip", CacheTestFixture, NULL,
+                cache_test_fixture_setup,
+                test_cache_round_trip,
+                cache_test_fixture_teardown);
+    g_test_add ("/pgp/keyserver-cache/expired", CacheTestFixture, NULL,
+                cache_test_fixture_setup,
+                test_cache_expired,
+                cache_test_fixture_teardown);
+    g_test_add ("/pgp/keyserver-cache/revalidate", CacheTestFixture, NULL,
+                cache_test_fixture_setup,
+                test_cache_revalidate,
+                cache_test_fixture_teardown);
+    g_test_add ("/pgp/keyserver-cache/eviction", CacheTestFixture, NULL,
+                cache_test_fixture_setup,
+                test_cache_eviction,
+                cache_test_fixture_teardown);
+    g_test_add ("/pgp/keyserver-cache/too-big", CacheTestFixture, NULL,
+                cache_test_fixture_setup,
+                test_cache_too_big,
+                cache_test_fixture_teardown);
+    g_test_add ("/pgp/keyserver-cache/corrupt", CacheTestFixture, NULL,
+                cache_test_fixture_setup,
+                test_cache_corrupt,
+                cache_test_fixture_teardown);
+
+    return g_test_run ();
+}
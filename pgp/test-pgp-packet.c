@@ -0,0 +1,438 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "seahorse-pgp-packet.h"
+
+#include <gio/gio.h>
+
+#include <string.h>
+
+/* Old format v4 public key packet with a 2 byte length and a dummy body */
+static void
+append_public_key (GByteArray *keyblock,
+                   guint8      serial)
+{
+    guint8 packet[] = { 0x99, 0x00, 0x04, 0x04, serial, 0x00, 0x00 };
+
+    g_byte_array_append (keyblock, packet, sizeof (packet));
+}
+
+static char *
+dummy_key_fingerprint (guint8 serial)
+{
+    guint8 packet[] = { 0x99, 0x00, 0x04, 0x04, serial, 0x00, 0x00 };
+    g_autofree char *digest = NULL;
+
+    digest = g_compute_checksum_for_data (G_CHECKSUM_SHA1, packet, sizeof (packet));
+    return g_ascii_strup (digest, -1);
+}
+
+/* New format user ID packet */
+static void
+append_user_id (GByteArray *keyblock,
+                const char *userid)
+{
+    guint8 header[] = { 0xc0 | 13, strlen (userid) };
+
+    g_byte_array_append (keyblock, header, sizeof (header));
+    g_byte_array_append (keyblock, (const guint8 *) userid, strlen (userid));
+}
+
+/* New format one or two byte length, as used by packets and subpackets */
+static void
+append_length (GByteArray *keyblock,
+               gsize       len)
+{
+    guint8 octets[2];
+
+    g_assert_cmpuint (len, <, 8384);
+    if (len < 192) {
+        octets[0] = len;
+        g_byte_array_append (keyblock, octets, 1);
+    } else {
+        octets[0] = ((len - 192) >> 8) + 192;
+        octets[1] = (len - 192) & 0xff;
+        g_byte_array_append (keyblock, octets, 2);
+    }
+}
+
+/* New format user attribute packet with a single JPEG image subpacket */
+static void
+append_photo (GByteArray *keyblock,
+              const char *image)
+{
+    static const guint8 image_header[16] = { 0x10, 0x00, 0x01, 0x01 };
+    guint8 tag = 0xc0 | 17;
+    guint8 type = 1;
+    gsize sub_len = 1 + sizeof (image_header) + strlen (image);
+
+    g_byte_array_append (keyblock, &tag, 1);
+    append_length (keyblock, (sub_len < 192 ? 1 : 2) + sub_len);
+    append_length (keyblock, sub_len);
+    g_byte_array_append (keyblock, &type, 1);
+    g_byte_array_append (keyblock, image_header, sizeof (image_header));
+    g_byte_array_append (keyblock, (const guint8 *) image, strlen (image));
+}
+
+/* Old format v4 signature packet, with a creation time subpacket */
+static void
+append_signature (GByteArray *keyblock,
+                  guint32     created)
+{
+    guint8 packet[] = {
+        0x88, 14,
+        0x04, 0x13, 0x01, 0x08,
+        0x00, 0x06,                                 /* hashed subpackets */
+        0x05, 0x02,
+        created >> 24, created >> 16, created >> 8, created,
+        0x00, 0x00,                                 /* unhashed subpackets */
+    };
+
+    g_byte_array_append (keyblock, packet, sizeof (packet));
+}
+
+static void
+assert_photo (GPtrArray    *photos,
+              unsigned int  i,
+              unsigned int  uid_index,
+              const char   *image)
+{
+    SeahorsePgpPhotoPacket *photo = g_ptr_array_index (photos, i);
+    const char *data;
+    gsize len;
+
+    g_assert_cmpuint (photo->uid_index, ==, uid_index);
+    data = g_bytes_get_data (photo->image, &len);
+    g_assert_cmpmem (data, len, image, strlen (image));
+}
+
+static const char *IMAGE_A = "short image";
+
+/* Long enough to need two byte lengths */
+static const char *IMAGE_B =
+    "a longer image, which is padded out with some more text so its length "
+    "doesn't fit in a single byte anymore. 0123456789 0123456789 0123456789 "
+    "0123456789 0123456789 0123456789 0123456789 0123456789 0123456789";
+
+static void
+test_packet_photos (void)
+{
+    g_autoptr(GByteArray) keyblock = g_byte_array_new ();
+    g_autoptr(GBytes) bytes = NULL;
+    g_autoptr(GPtrArray) photos = NULL;
+    g_autoptr(GError) error = NULL;
+
+    append_public_key (keyblock, 0);
+    append_user_id (keyblock, "Test <test@example.org>");
+    append_photo (keyblock, IMAGE_A);
+    append_user_id (keyblock, "Other <other@example.org>");
+    append_photo (keyblock, IMAGE_B);
+    bytes = g_byte_array_free_to_bytes (g_steal_pointer (&keyblock));
+
+    photos = seahorse_pgp_packet_parse_photos (bytes, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (photos);
+    g_assert_cmpuint (photos->len, ==, 2);
+    assert_photo (photos, 0, 2, IMAGE_A);
+    assert_photo (photos, 1, 4, IMAGE_B);
+}
+
+/* Only the photos of the first key are returned */
+static void
+test_packet_first_key (void)
+{
+    g_autoptr(GByteArray) keyblock = g_byte_array_new ();
+    g_autoptr(GBytes) bytes = NULL;
+    g_autoptr(GPtrArray) photos = NULL;
+    g_autoptr(GError) error = NULL;
+
+    append_public_key (keyblock, 0);
+    append_photo (keyblock, IMAGE_A);
+    append_public_key (keyblock, 1);
+    append_photo (keyblock, IMAGE_B);
+    bytes = g_byte_array_free_to_bytes (g_steal_pointer (&keyblock));
+
+    photos = seahorse_pgp_packet_parse_photos (bytes, &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (photos->len, ==, 1);
+    assert_photo (photos, 0, 1, IMAGE_A);
+}
+
+static void
+test_packet_keyring (void)
+{
+    g_autoptr(GByteArray) keyblock = g_byte_array_new ();
+    g_autoptr(GBytes) bytes = NULL;
+    g_autoptr(GPtrArray) photos = NULL;
+    g_autoptr(GError) error = NULL;
+    g_autofree char *first = dummy_key_fingerprint (0);
+    g_autofree char *third = dummy_key_fingerprint (2);
+    SeahorsePgpPhotoPacket *photo;
+
+    append_public_key (keyblock, 0);
+    append_user_id (keyblock, "Test <test@example.org>");
+    append_photo (keyblock, IMAGE_A);
+    append_public_key (keyblock, 1);
+    append_user_id (keyblock, "No photo <nophoto@example.org>");
+    append_public_key (keyblock, 2);
+    append_photo (keyblock, IMAGE_B);
+    bytes = g_byte_array_free_to_bytes (g_steal_pointer (&keyblock));
+
+    photos = seahorse_pgp_packet_parse_keyring_photos (bytes, &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (photos->len, ==, 2);
+
+    /* The user ID index starts over with each key */
+    assert_photo (photos, 0, 2, IMAGE_A);
+    assert_photo (photos, 1, 1, IMAGE_B);
+
+    photo = g_ptr_array_index (photos, 0);
+    g_assert_cmpstr (photo->fingerprint, ==, first);
+    photo = g_ptr_array_index (photos, 1);
+    g_assert_cmpstr (photo->fingerprint, ==, third);
+}
+
+static void
+test_packet_no_photos (void)
+{
+    g_autoptr(GByteArray) keyblock = g_byte_array_new ();
+    g_autoptr(GBytes) bytes = NULL;
+    g_autoptr(GPtrArray) photos = NULL;
+    g_autoptr(GError) error = NULL;
+
+    append_public_key (keyblock, 0);
+    append_user_id (keyblock, "Test <test@example.org>");
+    bytes = g_byte_array_free_to_bytes (g_steal_pointer (&keyblock));
+
+    photos = seahorse_pgp_packet_parse_photos (bytes, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (photos);
+    g_assert_cmpuint (photos->len, ==, 0);
+}
+
+static void
+test_packet_truncated (void)
+{
+    g_autoptr(GByteArray) keyblock = g_byte_array_new ();
+    g_autoptr(GBytes) bytes = NULL;
+    g_autoptr(GPtrArray) photos = NULL;
+    g_autoptr(GError) error = NULL;
+
+    append_public_key (keyblock, 0);
+    append_photo (keyblock, IMAGE_A);
+    g_byte_array_set_size (keyblock, keyblock->len - 10);
+    bytes = g_byte_array_free_to_bytes (g_steal_pointer (&keyblock));
+
+    photos = seahorse_pgp_packet_parse_photos (bytes, &error);
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+    g_assert_null (photos);
+}
+
+/* The digest of some signature packets, as the splitter calculates it */
+static char *
+signatures_digest (const guint32 *created,
+                   unsigned int   n_created)
+{
+    g_autoptr(GByteArray) signatures = g_byte_array_new ();
+
+    for (unsigned int i = 0; i < n_created; i++)
+        append_signature (signatures, created[i]);
+    return g_compute_checksum_for_data (G_CHECKSUM_SHA256, signatures->data, signatures->len);
+}
+
+/* Feeds @keyring to a splitter @chunk bytes at a time */
+static GPtrArray *
+split_keyblocks (GByteArray *keyring,
+                 gsize       chunk)
+{
+    g_autoptr(SeahorsePgpKeyblockSplitter) splitter = seahorse_pgp_keyblock_splitter_new ();
+    GPtrArray *keyblocks;
+
+    keyblocks = g_ptr_array_new_with_free_func ((GDestroyNotify) seahorse_pgp_keyblock_free);
+    for (gsize at = 0; at < keyring->len; at += chunk)
+        seahorse_pgp_keyblock_splitter_feed (splitter, keyring->data + at,
+                                             MIN (chunk, keyring->len - at), keyblocks);
+    seahorse_pgp_keyblock_splitter_finish (splitter, keyblocks);
+    return keyblocks;
+}
+
+static void
+assert_keyblock_packets (SeahorsePgpKeyblock *keyblock,
+                         GByteArray          *keyring,
+                         gsize                start,
+                         gsize                stop)
+{
+    g_assert_cmpmem (g_bytes_get_data (keyblock->packets, NULL),
+                     g_bytes_get_size (keyblock->packets),
+                     keyring->data + start, stop - start);
+}
+
+static void
+test_packet_split_keyblocks (void)
+{
+    g_autoptr(GByteArray) keyring = g_byte_array_new ();
+    g_autofree char *first = dummy_key_fingerprint (0);
+    g_autofree char *second = dummy_key_fingerprint (1);
+    const guint32 created[] = { 1500000000, 1600000000, 1400000000 };
+    g_autofree char *first_sigs = signatures_digest (created, G_N_ELEMENTS (created));
+    g_autofree char *no_sigs = signatures_digest (NULL, 0);
+    gsize first_len;
+
+    append_public_key (keyring, 0);
+    append_user_id (keyring, "Test <test@example.org>");
+    for (unsigned int i = 0; i < G_N_ELEMENTS (created); i++)
+        append_signature (keyring, created[i]);
+    first_len = keyring->len;
+    append_public_key (keyring, 1);
+    append_user_id (keyring, "No signature <nosig@example.org>");
+
+    /* Packets cut off anywhere between pieces */
+    for (gsize chunk = 1; chunk <= keyring->len; chunk++) {
+        g_autoptr(GPtrArray) keyblocks = split_keyblocks (keyring, chunk);
+        SeahorsePgpKeyblock *key;
+
+        g_assert_cmpuint (keyblocks->len, ==, 2);
+
+        key = g_ptr_array_index (keyblocks, 0);
+        g_assert_cmpstr (key->fingerprint, ==, first);
+        g_assert_cmpstr (key->signatures, ==, first_sigs);
+        g_assert_false (key->secret);
+        assert_keyblock_packets (key, keyring, 0, first_len);
+
+        key = g_ptr_array_index (keyblocks, 1);
+        g_assert_cmpstr (key->fingerprint, ==, second);
+        g_assert_cmpstr (key->signatures, ==, no_sigs);
+        assert_keyblock_packets (key, keyring, first_len, keyring->len);
+    }
+}
+
+/* An older signature turning up later still changes the digest */
+static void
+test_packet_split_old_signature (void)
+{
+    g_autoptr(GByteArray) keyring = g_byte_array_new ();
+    g_autoptr(GPtrArray) keyblocks = NULL;
+    g_autoptr(GPtrArray) updated = NULL;
+    SeahorsePgpKeyblock *key, *key_updated;
+
+    append_public_key (keyring, 0);
+    append_user_id (keyring, "Test <test@example.org>");
+    append_signature (keyring, 1600000000);
+    keyblocks = split_keyblocks (keyring, keyring->len);
+
+    append_signature (keyring, 1500000000);
+    updated = split_keyblocks (keyring, keyring->len);
+
+    g_assert_cmpuint (keyblocks->len, ==, 1);
+    g_assert_cmpuint (updated->len, ==, 1);
+    key = g_ptr_array_index (keyblocks, 0);
+    key_updated = g_ptr_array_index (updated, 0);
+    g_assert_cmpstr (key->fingerprint, ==, key_updated->fingerprint);
+    g_assert_cmpstr (key->signatures, !=, key_updated->signatures);
+}
+
+/* Like a revocation certificate, which is just a signature */
+static void
+test_packet_split_before_key (void)
+{
+    g_autoptr(GByteArray) keyring = g_byte_array_new ();
+    g_autoptr(GPtrArray) keyblocks = NULL;
+    g_autofree char *fingerprint = dummy_key_fingerprint (0);
+    SeahorsePgpKeyblock *key;
+    gsize revocation_len;
+
+    append_signature (keyring, 1500000000);
+    revocation_len = keyring->len;
+    append_public_key (keyring, 0);
+    append_user_id (keyring, "Test <test@example.org>");
+
+    keyblocks = split_keyblocks (keyring, 5);
+    g_assert_cmpuint (keyblocks->len, ==, 2);
+
+    key = g_ptr_array_index (keyblocks, 0);
+    g_assert_null (key->fingerprint);
+    g_assert_false (key->secret);
+    assert_keyblock_packets (key, keyring, 0, revocation_len);
+
+    key = g_ptr_array_index (keyblocks, 1);
+    g_assert_cmpstr (key->fingerprint, ==, fingerprint);
+    assert_keyblock_packets (key, keyring, revocation_len, keyring->len);
+}
+
+/* What can't be split is still passed on, without a fingerprint */
+static void
+test_packet_split_truncated (void)
+{
+    g_autoptr(GByteArray) keyring = g_byte_array_new ();
+    g_autoptr(GPtrArray) keyblocks = NULL;
+    g_autofree char *fingerprint = dummy_key_fingerprint (0);
+    const guint8 garbage[] = { 0x00, 0x01, 0x02 };
+    SeahorsePgpKeyblock *key;
+    gsize first_len, total = 0;
+
+    append_public_key (keyring, 0);
+    append_user_id (keyring, "Test <test@example.org>");
+    first_len = keyring->len;
+    append_public_key (keyring, 1);
+    append_signature (keyring, 1500000000);
+    g_byte_array_set_size (keyring, keyring->len - 4);
+
+    keyblocks = split_keyblocks (keyring, 3);
+    g_assert_cmpuint (keyblocks->len, ==, 2);
+
+    key = g_ptr_array_index (keyblocks, 0);
+    g_assert_cmpstr (key->fingerprint, ==, fingerprint);
+    assert_keyblock_packets (key, keyring, 0, first_len);
+
+    key = g_ptr_array_index (keyblocks, 1);
+    g_assert_null (key->fingerprint);
+    assert_keyblock_packets (key, keyring, first_len, keyring->len);
+    g_clear_pointer (&keyblocks, g_ptr_array_unref);
+
+    /* The keyblock with garbage in it goes too, and everything after */
+    g_byte_array_set_size (keyring, first_len);
+    g_byte_array_append (keyring, garbage, sizeof (garbage));
+    append_public_key (keyring, 1);
+
+    keyblocks = split_keyblocks (keyring, 2);
+    for (unsigned int i = 0; i < keyblocks->len; i++) {
+        key = g_ptr_array_index (keyblocks, i);
+        g_assert_null (key->fingerprint);
+        total += g_bytes_get_size (key->packets);
+    }
+    g_assert_cmpuint (total, ==, keyring->len);
+}
+
+int
+main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/pgp/packet/photos", test_packet_photos);
+    g_test_add_func ("/pgp/packet/first-key", test_packet_first_key);
+    g_test_add_func ("/pgp/packet/keyring", test_packet_keyring);
+    g_test_add_func ("/pgp/packet/no-photos", test_packet_no_photos);
+    g_test_add_func ("/pgp/packet/truncated", test_packet_truncated);
+    g_test_add_func ("/pgp/packet/split-keyblocks", test_packet_split_keyblocks);
+    g_test_add_func ("/pgp/packet/split-old-signature", test_packet_split_old_signature);
+    g_test_add_func ("/pgp/packet/split-before-key", test_packet_split_before_key);
+    g_test_add_func ("/pgp/packet/split-truncated", test_packet_split_truncated);
+
+    return g_test_run ();
+}
@@ -0,0 +1,408 @@
+/*
+ * Seahorse
+ *
+ * Copyright (C) 2026 Seahorse contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+#include "seahorse-server-search.h"
+#include "seahorse-pgp-key.h"
+#include "seahorse-pgp-subkey.h"
+
+#include <glib.h>
+
+#include <string.h>
+
+#define FPR_1 "0123456789ABCDEF0123456789ABCDEF01234567"
+#define FPR_2 "1123456789ABCDEF0123456789ABCDEF01234567"
+#define FPR_3 "2123456789ABCDEF0123456789ABCDEF01234567"
+
+/* A key server that answers however the test wants it to */
+typedef enum {
+    FAKE_ANSWER,
+    FAKE_FAIL,
+    FAKE_HANG,                          /* Until it's cancelled */
+} FakeBehaviour;
+
+#define FAKE_TYPE_SERVER (fake_server_get_type ())
+G_DECLARE_FINAL_TYPE (FakeServer, fake_server, FAKE, SERVER, SeahorseServerSource)
+
+struct _FakeServer {
+    SeahorseServerSource parent;
+
+    FakeBehaviour behaviour;
+    GStrv fingerprints;
+    gboolean cancelled;
+};
+
+G_DEFINE_TYPE (FakeServer, fake_server, SEAHORSE_TYPE_SERVER_SOURCE)
+
+typedef struct {
+    GcrSimpleCollection *results;
+    GCancellable *cancellable;
+    gulong cancelled_sig;
+} FakeSearch;
+
+static void
+fake_search_free (void *data)
+{
+    FakeSearch *search = data;
+
+    g_clear_object (&search->results);
+    g_clear_object (&search->cancellable);
+    g_free (search);
+}
+
+static SeahorsePgpKey *
+make_key (const char *fingerprint)
+{
+    g_autoptr(SeahorsePgpSubkey) subkey = NULL;
+    SeahorsePgpKey *key;
+
+    subkey = seahorse_pgp_subkey_new ();
+    seahorse_pgp_subkey_set_keyid (subkey, fingerprint + strlen (fingerprint) - 16);
+    seahorse_pgp_subkey_set_fingerprint (subkey, fingerprint);
+
+    key = seahorse_pgp_key_new ();
+    seahorse_pgp_key_add_subkey (key, subkey);
+    return key;
+}
+
+static gboolean
+on_fake_answer (void *user_data)
+{
+    GTask *task = G_TASK (user_data);
+    FakeServer *self = g_task_get_source_object (task);
+    FakeSearch *search = g_task_get_task_data (task);
+
+    if (self->behaviour == FAKE_FAIL) {
+        g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_CONNECTION_REFUSED,
+                                 "Fake server is down");
+        return G_SOURCE_REMOVE;
+    }
+
+    for (guint i = 0; self->fingerprints && self->fingerprints[i]; i++) {
+        g_autoptr(SeahorsePgpKey) key = make_key (self->fingerprints[i]);
+        gcr_simple_collection_add (search->results, G_OBJECT (key));
+    }
+
+    g_task_return_boolean (task, TRUE);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+on_fake_cancelled_idle (void *user_data)
+{
+    GTask *task = G_TASK (user_data);
+    FakeSearch *search = g_task_get_task_data (task);
+
+    g_cancellable_disconnect (search->cancellable, search->cancelled_sig);
+    search->cancelled_sig = 0;
+    g_task_return_error_if_cancelled (task);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+on_fake_cancelled (GCancellable *cancellable,
+                   void         *user_data)
+{
+    GTask *task = G_TASK (user_data);
+    FakeServer *self = g_task_get_source_object (task);
+
+    self->cancelled = TRUE;
+    g_idle_add_full (G_PRIORITY_DEFAULT, on_fake_cancelled_idle,
+                     g_object_ref (task), g_object_unref);
+}
+
+static void
+fake_server_search_async (SeahorseServerSource *source,
+                          const char           *match,
+                          GcrSimpleCollection  *results,
+                          GCancellable         *cancellable,
+                          GAsyncReadyCallback   callback,
+                          void                 *user_data)
+{
+    FakeServer *self = FAKE_SERVER (source);
+    g_autoptr(GTask) task = NULL;
+    FakeSearch *search;
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    search = g_new0 (FakeSearch, 1);
+    search->results = g_object_ref (results);
+    search->cancellable = g_object_ref (cancellable);
+    g_task_set_task_data (task, search, fake_search_free);
+
+    if (self->behaviour == FAKE_HANG)
+        search->cancelled_sig = g_cancellable_connect (cancellable,
+                                                       G_CALLBACK (on_fake_cancelled),
+                                                       g_object_ref (task),
+                                                       g_object_unref);
+    else
+        g_idle_add_full (G_PRIORITY_DEFAULT, on_fake_answer,
+                         g_object_ref (task), g_object_unref);
+}
+
+static gboolean
+fake_server_search_finish (SeahorseServerSource *source,
+                           GAsyncResult         *result,
+                           GError              **error)
+{
+    return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+static void
+fake_server_finalize (GObject *object)
+{
+    FakeServer *self = FAKE_SERVER (object);
+
+    g_strfreev (self->fingerprints);
+
+    G_OBJECT_CLASS (fake_server_parent_class)->finalize (object);
+}
+
+static void
+fake_server_init (FakeServer *self)
+{
+}
+
+static void
+fake_server_class_init (FakeServerClass *klass)
+{
+    GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+    SeahorseServerSourceClass *server_class = SEAHORSE_SERVER_SOURCE_CLASS (klass);
+
+    gobject_class->finalize = fake_server_finalize;
+    server_class->search_async = fake_server_search_async;
+    server_class->search_finish = fake_server_search_finish;
+}
+
+static FakeServer *
+fake_server_new (FakeBehaviour behaviour,
+                 ...)
+{
+    g_autoptr(GStrvBuilder) builder = g_strv_builder_new ();
+    g_autofree char *uri = NULL;
+    static unsigned int n_servers = 0;
+    FakeServer *self;
+    const char *fingerprint;
+    va_list args;
+
+    uri = g_strdup_printf ("hkp://fake-%u.example.org", n_servers++);
+    self = g_object_new (FAKE_TYPE_SERVER, "uri", uri, NULL);
+    self->behaviour = behaviour;
+
+    va_start (args, behaviour);
+    while ((fingerprint = va_arg (args, const char *)) != NULL)
+        g_strv_builder_add (builder, fingerprint);
+    va_end (args);
+    self->fingerprints = g_strv_builder_end (builder);
+
+    return self;
+}
+
+typedef struct {
+    unsigned int quorum;
+    unsigned int timeout;
+    unsigned int deadline;
+} SearchParams;
+
+static void
+on_async_ready (GObject      *source,
+                GAsyncResult *result,
+                void         *user_data)
+{
+    GAsyncResult **ret = user_data;
+    *ret = g_object_ref (result);
+}
+
+/* Searches the servers, which are released */
+static gboolean
+search_servers (const SearchParams   *params,
+                GcrSimpleCollection  *results,
+                GError              **error,
+                ...)
+{
+    g_autoptr(GPtrArray) sources = g_ptr_array_new_with_free_func (g_object_unref);
+    g_autoptr(GCancellable) cancellable = g_cancellable_new ();
+    g_autoptr(GAsyncResult) result = NULL;
+    SeahorseServerSource *source;
+    va_list args;
+
+    va_start (args, error);
+    while ((source = va_arg (args, SeahorseServerSource *)) != NULL)
+        g_ptr_array_add (sources, source);
+    va_end (args);
+
+    seahorse_server_search_async (sources, "test", results,
+                                  params->quorum, params->timeout, params->deadline,
+                                  cancellable, on_async_ready, &result);
+    while (result == NULL)
+        g_main_context_iteration (NULL, TRUE);
+
+    return seahorse_server_search_finish (result, error);
+}
+
+static gboolean
+has_key (GcrSimpleCollection *results,
+         const char          *fingerprint)
+{
+    g_autolist(GObject) objects = gcr_collection_get_objects (GCR_COLLECTION (results));
+
+    for (GList *l = objects; l != NULL; l = l->next) {
+        g_autoptr(GString) fpr = g_string_new (NULL);
+
+        for (const char *c = seahorse_pgp_key_get_fingerprint (l->data); *c; c++) {
+            if (!g_ascii_isspace (*c))
+                g_string_append_c (fpr, *c);
+        }
+
+        if (g_ascii_strcasecmp (fpr->str, fingerprint) == 0)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+static void
+test_server_search_failing (void)
+{
+    const SearchParams params = { 0, 0, 0 };
+    g_autoptr(GcrSimpleCollection) results = gcr_simple_collection_new ();
+    g_autoptr(GError) error = NULL;
+    gboolean ret;
+
+    /* One broken server doesn't fail the search */
+    ret = search_servers (&params, results, &error,
+                          fake_server_new (FAKE_FAIL, NULL),
+                          fake_server_new (FAKE_ANSWER, FPR_1, FPR_2, NULL),
+                          NULL);
+    g_assert_no_error (error);
+    g_assert_true (ret);
+    g_assert_cmpuint (gcr_collection_get_length (GCR_COLLECTION (results)), ==, 2);
+    g_assert_true (has_key (results, FPR_1));
+    g_assert_true (has_key (results, FPR_2));
+}
+
+static void
+test_server_search_all_failing (void)
+{
+    const SearchParams params = { 0, 0, 0 };
+    g_autoptr(GcrSimpleCollection) results = gcr_simple_collection_new ();
+    g_autoptr(GError) error = NULL;
+    gboolean ret;
+
+    /* But if none of them answered, that's an error */
+    ret = search_servers (&params, results, &error,
+                          fake_server_new (FAKE_FAIL, NULL),
+                          fake_server_new (FAKE_FAIL, NULL),
+                          NULL);
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CONNECTION_REFUSED);
+    g_assert_false (ret);
+    g_assert_cmpuint (gcr_collection_get_length (GCR_COLLECTION (results)), ==, 0);
+}
+
+static void
+test_server_search_duplicates (void)
+{
+    const SearchParams params = { 0, 0, 0 };
+    g_autoptr(GcrSimpleCollection) results = gcr_simple_collection_new ();
+    g_autoptr(GError) error = NULL;
+    gboolean ret;
+
+    /* Servers don't all write fingerprints the same way */
+    ret = search_servers (&params, results, &error,
+                          fake_server_new (FAKE_ANSWER, FPR_1, FPR_2, NULL),
+                          fake_server_new (FAKE_ANSWER,
+                                           "1123 4567 89ab cdef 0123 4567 89ab cdef 0123 4567",
+                                           FPR_3, NULL),
+                          NULL);
+    g_assert_no_error (error);
+    g_assert_true (ret);
+    g_assert_cmpuint (gcr_collection_get_length (GCR_COLLECTION (results)), ==, 3);
+    g_assert_true (has_key (results, FPR_1));
+    g_assert_true (has_key (results, FPR_2));
+    g_assert_true (has_key (results, FPR_3));
+}
+
+static void
+test_server_search_quorum (void)
+{
+    const SearchParams params = { 1, 0, 0 };
+    g_autoptr(GcrSimpleCollection) results = gcr_simple_collection_new ();
+    g_autoptr(FakeServer) slow = fake_server_new (FAKE_HANG, NULL);
+    g_autoptr(GError) error = NULL;
+    gboolean ret;
+
+    /* Once enough servers answered, the slow one is cancelled */
+    ret = search_servers (&params, results, &error,
+                          g_object_ref (slow),
+                          fake_server_new (FAKE_ANSWER, FPR_1, NULL),
+                          NULL);
+    g_assert_no_error (error);
+    g_assert_true (ret);
+    g_assert_true (has_key (results, FPR_1));
+    g_assert_true (slow->cancelled);
+}
+
+static void
+test_server_search_deadline (void)
+{
+    const SearchParams params = { 0, 0, 1 };
+    g_autoptr(GcrSimpleCollection) results = gcr_simple_collection_new ();
+    g_autoptr(FakeServer) slow = fake_server_new (FAKE_HANG, NULL);
+    g_autoptr(GError) error = NULL;
+    gboolean ret;
+
+    /* Past the deadline, what we have is good enough */
+    ret = search_servers (&params, results, &error,
+                          g_object_ref (slow),
+                          fake_server_new (FAKE_ANSWER, FPR_1, NULL),
+                          NULL);
+    g_assert_no_error (error);
+    g_assert_true (ret);
+    g_assert_true (has_key (results, FPR_1));
+    g_assert_true (slow->cancelled);
+}
+
+static void
+test_server_search_timeout (void)
+{
+    const SearchParams params = { 0, 1, 0 };
+    g_autoptr(GcrSimpleCollection) results = gcr_simple_collection_new ();
+    g_autoptr(GError) error = NULL;
+    gboolean ret;
+
+    /* A server that doesn't answer in time counts as failed */
+    ret = search_servers (&params, results, &error,
+                          fake_server_new (FAKE_HANG, NULL),
+                          NULL);
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT);
+    g_assert_false (ret);
+}
+
+int
+main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/pgp/server-search/failing", test_server_search_failing);
+    g_test_add_func ("/pgp/server-search/all-failing", test_server_search_all_failing);
+    g_test_add_func ("/pgp/server-search/duplicates", test_server_search_duplicates);
+    g_test_add_func ("/pgp/server-search/quorum", test_server_search_quorum);
+    g_test_add_func ("/pgp/server-search/deadline", test_server_search_deadline);
+    g_test_add_func ("/pgp/server-search/timeout", test_server_search_timeout);
+
+    return g_test_run ();
+}
@@ -80,6 +80,13 @@ public class CertificateDerExporter : GLib.Object, Exporter {
 		return this._certificate.get_der_data();
 	}
 
+	public async void export_to_stream(GLib.OutputStream output,
+	                                   GLib.Cancellable? cancellable)
+			throws GLib.Error {
+		unowned uint8[] der = this._certificate.get_der_data();
+		yield output.write_all_async(der, GLib.Priority.DEFAULT, cancellable, null);
+	}
+
 }
 
 }
@@ -322,6 +322,10 @@ public class Token : GLib.Object, Gcr.Collection, Place, Lockable {
 
 	private void update_visibility(GLib.List<GLib.Object> objects,
 	                               bool visible) {
+		if (objects == null)
+			return;
+
+		this.batch_started();
 		foreach (var object in objects) {
 			bool have = (this._objects_visible.lookup(object) != null);
 			if (!have && visible) {
@@ -333,7 +337,7 @@ public class Token : GLib.Object, Gcr.Collection, Place, Lockable {
 				this.emit_removed(object);
 			}
 		}
-
+		this.batch_finished();
 	}
 
 	private static bool make_certificate_key_pair(Certificate certificate,
@@ -282,18 +282,22 @@ public class Seahorse.Ssh.Source : GLib.Object, Gcr.Collection, Seahorse.Place {
         string pubfile = authorized_keys_path();
         if (FileUtils.test(pubfile, FileTest.IS_REGULAR)) {
             var result = yield Key.parse_file(pubfile);
+            batch_started();
             foreach (unowned var keydata in result.public_keys) {
                 Source.add_key_from_parsed_data(this, keydata, pubfile, true, true, null);
             }
+            batch_finished();
         }
 
         // Load the "other keys" (public keys without authorization)
         pubfile = other_keys_path();
         if (FileUtils.test(pubfile, FileTest.IS_REGULAR)) {
             var result = yield Key.parse_file(pubfile);
+            batch_started();
             foreach (unowned var keydata in result.public_keys) {
                 Source.add_key_from_parsed_data(this, keydata, pubfile, true, false, null);
             }
+            batch_finished();
         }
 
         return true;